@@ -0,0 +1,221 @@
+#pragma once
+
+#include <core/defines.h>
+#include <core/compiler/compiler.h>
+#include <core/print.h>
+#include <core/sort.h>
+#include <core/containers/array.h>
+#include <core/platform/platform.h>
+
+#include <time.h>
+
+struct Benchmark_Stats
+{
+	U64 sample_count;
+	U64 min;
+	U64 p50;
+	U64 p90;
+	U64 p99;
+	U64 max;
+	U64 mean;
+};
+
+// Every printed result is also appended here as JSON when the run was started with `--json <path>`.
+struct Benchmark_Report
+{
+	const char *filepath;
+	String section;
+	Formatter formatter;
+	bool is_first_result;
+};
+
+inline static Benchmark_Report benchmark_report = {};
+
+inline static U64
+benchmark_now()
+{
+	return platform_query_microseconds();
+}
+
+// Process CPU time across all threads. On Windows `clock` reports wall time instead, so CPU figures are only meaningful on POSIX.
+inline static U64
+benchmark_cpu_now()
+{
+	return (U64)::clock() * 1000000 / CLOCKS_PER_SEC;
+}
+
+// SplitMix64, deterministic inputs for every run.
+inline static U64
+benchmark_random(U64 &state)
+{
+	U64 z = (state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+// Keeps a computed result alive so the measured loop is not optimized away.
+inline static void
+benchmark_consume(U64 value)
+{
+	static volatile U64 sink = 0;
+	sink = sink + value;
+}
+
+// Spins for a while, then starts giving up the time slice so oversubscribed runs still make progress.
+inline static void
+benchmark_backoff(U32 &spin_count)
+{
+	if (spin_count < 64)
+	{
+		++spin_count;
+		compiler_cpu_pause();
+	}
+	else
+	{
+		platform_thread_sleep(0);
+	}
+}
+
+// Sorts the samples in place.
+inline static Benchmark_Stats
+benchmark_stats_from(Array<U64> &samples)
+{
+	if (samples.count == 0)
+		return Benchmark_Stats{};
+
+	array_sort(samples);
+
+	U64 sum = 0;
+	for (U64 sample : samples)
+		sum += sample;
+
+	constexpr auto percentile = [](const Array<U64> &samples, U64 percent) -> U64 {
+		U64 index = (samples.count - 1) * percent / 100;
+		return samples[index];
+	};
+
+	return Benchmark_Stats {
+		.sample_count = samples.count,
+		.min = samples[0],
+		.p50 = percentile(samples, 50),
+		.p90 = percentile(samples, 90),
+		.p99 = percentile(samples, 99),
+		.max = samples[samples.count - 1],
+		.mean = sum / samples.count
+	};
+}
+
+inline static void
+benchmark_report_begin(const char *name, I32 argument_count, char **arguments)
+{
+	for (I32 i = 1; i + 1 < argument_count; ++i)
+		if (string_literal(arguments[i]) == "--json")
+			benchmark_report.filepath = arguments[i + 1];
+
+	if (benchmark_report.filepath == nullptr)
+		return;
+
+	benchmark_report.section = string_init();
+	benchmark_report.formatter = formatter_init();
+	benchmark_report.is_first_result = true;
+	format(benchmark_report.formatter, "{{\"benchmark\":\"{}\",\"results\":[", name);
+}
+
+// Writes the JSON report, if one was requested. Returns false if the file could not be written.
+inline static bool
+benchmark_report_end()
+{
+	if (benchmark_report.filepath == nullptr)
+		return true;
+
+	string_append(benchmark_report.formatter.buffer, "]}");
+	bool is_written = platform_path_write_file(benchmark_report.filepath, benchmark_report.formatter.buffer) == benchmark_report.formatter.buffer.count;
+	if (!is_written)
+		print_to_stdout(PRINT_COLOR_FG_RED, "[BENCHMARK]: Could not write report file '{}'.\n", benchmark_report.filepath);
+
+	string_deinit(benchmark_report.section);
+	formatter_deinit(benchmark_report.formatter);
+	benchmark_report = Benchmark_Report{};
+	return is_written;
+}
+
+// Names are plain text written by the benchmarks, so they are not escaped.
+inline static void
+benchmark_report_result(const char *name, const char *kind, const char *unit, U64 operation_count, const Benchmark_Stats &stats)
+{
+	if (benchmark_report.filepath == nullptr)
+		return;
+
+	format(benchmark_report.formatter, "{}{{\"section\":\"{}\",\"name\":\"{}\",\"kind\":\"{}\",\"unit\":\"{}\",\"operation_count\":{}", benchmark_report.is_first_result ? "" : ",", benchmark_report.section, name, kind, unit, operation_count);
+	format(benchmark_report.formatter, ",\"sample_count\":{},\"min\":{},\"p50\":{},\"p90\":{},\"p99\":{},\"max\":{},\"mean\":{}}}", stats.sample_count, stats.min, stats.p50, stats.p90, stats.p99, stats.max, stats.mean);
+	benchmark_report.is_first_result = false;
+}
+
+inline static void
+benchmark_print_section(const char *name)
+{
+	print_to_stdout("\n");
+	print_to_stdout(PRINT_COLOR_FG_BLUE, "[BENCHMARK]");
+	print_to_stdout(" {}\n", name);
+
+	if (benchmark_report.filepath != nullptr)
+	{
+		string_clear(benchmark_report.section);
+		string_append(benchmark_report.section, name);
+	}
+}
+
+inline static void
+benchmark_print_throughput(const char *name, U64 operation_count, U64 elapsed_microseconds)
+{
+	if (elapsed_microseconds == 0)
+		elapsed_microseconds = 1;
+	U64 operations_per_second = operation_count * 1000000 / elapsed_microseconds;
+	print_to_stdout("  {:<48} {:>12} ops/s {:>10} us\n", name, operations_per_second, elapsed_microseconds);
+
+	Benchmark_Stats stats = {
+		.sample_count = 1,
+		.min = elapsed_microseconds,
+		.p50 = elapsed_microseconds,
+		.p90 = elapsed_microseconds,
+		.p99 = elapsed_microseconds,
+		.max = elapsed_microseconds,
+		.mean = elapsed_microseconds
+	};
+	benchmark_report_result(name, "throughput", "us", operation_count, stats);
+}
+
+// Throughput at the median repetition, followed by the spread of the repetition times.
+inline static void
+benchmark_print_throughput(const char *name, U64 operation_count, const Benchmark_Stats &stats)
+{
+	U64 elapsed_microseconds = stats.p50 == 0 ? 1 : stats.p50;
+	U64 operations_per_second = operation_count * 1000000 / elapsed_microseconds;
+	print_to_stdout("  {:<48} {:>12} ops/s {:>10} us | p90 {:>8} us | max {:>8} us\n", name, operations_per_second, stats.p50, stats.p90, stats.max);
+	benchmark_report_result(name, "throughput", "us", operation_count, stats);
+}
+
+inline static void
+benchmark_print_latency(const char *name, const Benchmark_Stats &stats, const char *unit)
+{
+	print_to_stdout("  {:<48} p50 {:>8} {} | p90 {:>8} {} | p99 {:>8} {} | max {:>8} {}\n", name, stats.p50, unit, stats.p90, unit, stats.p99, unit, stats.max, unit);
+	benchmark_report_result(name, "latency", unit, stats.sample_count, stats);
+}
+
+inline static void
+benchmark_print_value(const char *name, U64 value, const char *unit)
+{
+	print_to_stdout("  {:<48} {:>12} {}\n", name, value, unit);
+
+	Benchmark_Stats stats = {
+		.sample_count = 1,
+		.min = value,
+		.p50 = value,
+		.p90 = value,
+		.p99 = value,
+		.max = value,
+		.mean = value
+	};
+	benchmark_report_result(name, "value", unit, 1, stats);
+}
\ No newline at end of file
@@ -0,0 +1,694 @@
+#include "benchmark.h"
+
+#include <core/atomic.h>
+#include <core/defer.h>
+#include <core/sort.h>
+#include <core/math/u64.h>
+#include <core/memory/pool_allocator.h>
+#include <core/containers/b_tree_map.h>
+#include <core/containers/bit_array.h>
+#include <core/containers/hash_set.h>
+#include <core/containers/hash_table.h>
+#include <core/containers/handle_pool.h>
+#include <core/containers/ring_buffer.h>
+#include <core/containers/spsc_queue.h>
+#include <core/containers/mpmc_queue.h>
+
+constexpr U64 MEMBERSHIP_UNIVERSE_SIZE = 1 << 16;
+constexpr U64 MEMBERSHIP_QUERY_COUNT = 1 << 22;
+constexpr U64 BIT_OPERATION_REPETITION_COUNT = 20000;
+
+constexpr U64 ORDERED_MAP_QUERY_COUNT = 1 << 20;
+constexpr U64 ORDERED_MAP_RANGE_COUNT = 1 << 14;
+constexpr U64 ORDERED_MAP_RANGE_LENGTH = 64;
+
+constexpr U64 HANDLE_POOL_OBJECT_COUNT = 1 << 16;
+constexpr U64 HANDLE_POOL_QUERY_COUNT = 1 << 22;
+constexpr U64 HANDLE_POOL_ITERATION_COUNT = 200;
+
+constexpr U64 QUEUE_CAPACITY = 1024;
+constexpr U64 QUEUE_ITEM_COUNT = 4 * 1024 * 1024;
+constexpr U64 QUEUE_BATCH_SIZE = 32;
+constexpr U64 QUEUE_LATENCY_SAMPLE_COUNT = 2000;
+constexpr U64 QUEUE_LATENCY_ROUND_TRIPS_PER_SAMPLE = 64;
+
+// Baseline: the pattern the queues replace, a Ring_Buffer behind a Platform_Mutex.
+struct Mutex_Queue
+{
+	Platform_Mutex *mutex;
+	Ring_Buffer<U64> buffer;
+	U64 capacity;
+};
+
+struct Benchmark_Object
+{
+	U64 id;
+	F32 position[3];
+	F32 velocity[3];
+};
+
+inline static Mutex_Queue
+mutex_queue_init(U64 capacity)
+{
+	Mutex_Queue self = {
+		.mutex = platform_mutex_init(),
+		.buffer = ring_buffer_init<U64>(),
+		.capacity = capacity
+	};
+	ring_buffer_reserve(self.buffer, capacity);
+	return self;
+}
+
+inline static void
+mutex_queue_deinit(Mutex_Queue &self)
+{
+	ring_buffer_deinit(self.buffer);
+	platform_mutex_deinit(self.mutex);
+}
+
+inline static U64
+_queue_push(Mutex_Queue &self, const U64 *values, U64 count)
+{
+	platform_mutex_lock(self.mutex);
+	count = u64_min(count, self.capacity - self.buffer.count);
+	for (U64 i = 0; i < count; ++i)
+		ring_buffer_push_back(self.buffer, values[i]);
+	platform_mutex_unlock(self.mutex);
+	return count;
+}
+
+inline static U64
+_queue_pop(Mutex_Queue &self, U64 *values, U64 count)
+{
+	platform_mutex_lock(self.mutex);
+	count = u64_min(count, self.buffer.count);
+	for (U64 i = 0; i < count; ++i)
+	{
+		values[i] = ring_buffer_front(self.buffer);
+		ring_buffer_pop_front(self.buffer);
+	}
+	platform_mutex_unlock(self.mutex);
+	return count;
+}
+
+inline static U64
+_queue_push(Spsc_Queue<U64> &self, const U64 *values, U64 count)
+{
+	if (count == 1)
+		return spsc_queue_push(self, values[0]) ? 1 : 0;
+	return spsc_queue_push_batch(self, slice_from(values, count));
+}
+
+inline static U64
+_queue_pop(Spsc_Queue<U64> &self, U64 *values, U64 count)
+{
+	if (count == 1)
+		return spsc_queue_pop(self, values[0]) ? 1 : 0;
+	return spsc_queue_pop_batch(self, slice_from(values, count));
+}
+
+inline static U64
+_queue_push(Mpmc_Queue<U64> &self, const U64 *values, U64 count)
+{
+	if (count == 1)
+		return mpmc_queue_push(self, values[0]) ? 1 : 0;
+	return mpmc_queue_push_batch(self, slice_from(values, count));
+}
+
+inline static U64
+_queue_pop(Mpmc_Queue<U64> &self, U64 *values, U64 count)
+{
+	if (count == 1)
+		return mpmc_queue_pop(self, values[0]) ? 1 : 0;
+	return mpmc_queue_pop_batch(self, slice_from(values, count));
+}
+
+inline static void
+_benchmark_membership()
+{
+	U64 random_state = 1;
+	Array<U64> queries = array_init_with_count<U64>(MEMBERSHIP_QUERY_COUNT);
+	DEFER(array_deinit(queries));
+	for (U64 &query : queries)
+		query = benchmark_random(random_state) % MEMBERSHIP_UNIVERSE_SIZE;
+
+	Hash_Set<U64> hash_set = hash_set_init<U64>();
+	Array<bool> bools = array_init_with_count<bool>(MEMBERSHIP_UNIVERSE_SIZE);
+	Bit_Array bits = bit_array_init_with_count(MEMBERSHIP_UNIVERSE_SIZE);
+	DEFER(hash_set_deinit(hash_set); array_deinit(bools); bit_array_deinit(bits));
+	for (U64 i = 0; i < MEMBERSHIP_UNIVERSE_SIZE; ++i)
+	{
+		bools[i] = benchmark_random(random_state) % 4 == 0;
+		if (bools[i])
+		{
+			hash_set_insert(hash_set, i);
+			bit_array_set(bits, i);
+		}
+	}
+
+	{
+		U64 hit_count = 0;
+		U64 begin = benchmark_now();
+		for (U64 query : queries)
+			hit_count += hash_set_contains(hash_set, query) ? 1 : 0;
+		benchmark_print_throughput("Hash_Set<U64> contains", queries.count, benchmark_now() - begin);
+		benchmark_consume(hit_count);
+	}
+
+	{
+		U64 hit_count = 0;
+		U64 begin = benchmark_now();
+		for (U64 query : queries)
+			hit_count += bools[query] ? 1 : 0;
+		benchmark_print_throughput("Array<bool> index", queries.count, benchmark_now() - begin);
+		benchmark_consume(hit_count);
+	}
+
+	{
+		U64 hit_count = 0;
+		U64 begin = benchmark_now();
+		for (U64 query : queries)
+			hit_count += bit_array_get(bits, query) ? 1 : 0;
+		benchmark_print_throughput("Bit_Array get", queries.count, benchmark_now() - begin);
+		benchmark_consume(hit_count);
+	}
+}
+
+// Random U64 keys, compares building, point lookups and short range scans of
+// B_Tree_Map against Hash_Table and a sorted Array searched with array_lower_bound.
+inline static void
+_benchmark_ordered_map(U64 count)
+{
+	U64 random_state = count;
+	Array<U64> keys = array_init_with_count<U64>(count);
+	Array<U64> queries = array_init_with_count<U64>(ORDERED_MAP_QUERY_COUNT);
+	DEFER(array_deinit(keys); array_deinit(queries));
+	for (U64 &key : keys)
+		key = benchmark_random(random_state);
+	for (U64 &query : queries)
+		query = keys[benchmark_random(random_state) % count];
+
+	Hash_Table<U64, U64> hash_table = hash_table_init<U64, U64>();
+	B_Tree_Map<U64, U64> b_tree = b_tree_map_init<U64, U64>();
+	memory::Pool_Allocator *pool = memory::pool_allocator_init(B_Tree_Map<U64, U64>::NODE_SIZE, count / B_Tree_Map_Leaf<U64, U64>::CAPACITY + 1);
+	B_Tree_Map<U64, U64> pooled_b_tree = b_tree_map_init<U64, U64>(pool);
+	Array<B_Tree_Map_Entry<U64, U64>> sorted = array_init_with_capacity<B_Tree_Map_Entry<U64, U64>>(count);
+	B_Tree_Map<U64, U64> bulk_b_tree = b_tree_map_init<U64, U64>();
+	DEFER(hash_table_deinit(hash_table); b_tree_map_deinit(b_tree); b_tree_map_deinit(pooled_b_tree); memory::pool_allocator_deinit(pool); array_deinit(sorted); b_tree_map_deinit(bulk_b_tree));
+
+	auto entry_less = [](const B_Tree_Map_Entry<U64, U64> &a, const B_Tree_Map_Entry<U64, U64> &b) { return a.key < b.key; };
+	auto entry_key_less = [](const B_Tree_Map_Entry<U64, U64> &entry, U64 key) { return entry.key < key; };
+
+	{
+		U64 begin = benchmark_now();
+		for (U64 key : keys)
+			hash_table_insert(hash_table, key, key);
+		benchmark_print_throughput("Hash_Table insert", count, benchmark_now() - begin);
+	}
+
+	{
+		U64 begin = benchmark_now();
+		for (U64 key : keys)
+			b_tree_map_insert(b_tree, key, key);
+		benchmark_print_throughput("B_Tree_Map insert", count, benchmark_now() - begin);
+	}
+
+	{
+		U64 begin = benchmark_now();
+		for (U64 key : keys)
+			b_tree_map_insert(pooled_b_tree, key, key);
+		benchmark_print_throughput("B_Tree_Map insert, Pool_Allocator", count, benchmark_now() - begin);
+	}
+
+	{
+		U64 begin = benchmark_now();
+		for (U64 key : keys)
+			array_push(sorted, B_Tree_Map_Entry<U64, U64>{key, key});
+		array_sort(sorted, entry_less);
+		benchmark_print_throughput("Array push + array_sort", count, benchmark_now() - begin);
+	}
+
+	{
+		U64 begin = benchmark_now();
+		b_tree_map_bulk_load(bulk_b_tree, slice_from(sorted));
+		benchmark_print_throughput("B_Tree_Map bulk load from sorted", count, benchmark_now() - begin);
+	}
+
+	{
+		U64 sum = 0;
+		U64 begin = benchmark_now();
+		for (U64 query : queries)
+			sum += hash_table_find(hash_table, query)->value;
+		benchmark_print_throughput("Hash_Table find", queries.count, benchmark_now() - begin);
+		benchmark_consume(sum);
+	}
+
+	{
+		U64 sum = 0;
+		U64 begin = benchmark_now();
+		for (U64 query : queries)
+			sum += *b_tree_map_find(b_tree, query);
+		benchmark_print_throughput("B_Tree_Map find", queries.count, benchmark_now() - begin);
+		benchmark_consume(sum);
+	}
+
+	{
+		U64 sum = 0;
+		U64 begin = benchmark_now();
+		for (U64 query : queries)
+			sum += *b_tree_map_find(bulk_b_tree, query);
+		benchmark_print_throughput("B_Tree_Map find, bulk loaded", queries.count, benchmark_now() - begin);
+		benchmark_consume(sum);
+	}
+
+	{
+		U64 sum = 0;
+		U64 begin = benchmark_now();
+		for (U64 query : queries)
+			sum += sorted[array_lower_bound(sorted, query, entry_key_less)].value;
+		benchmark_print_throughput("Sorted Array lower_bound", queries.count, benchmark_now() - begin);
+		benchmark_consume(sum);
+	}
+
+	{
+		U64 sum = 0;
+		U64 begin = benchmark_now();
+		for (U64 i = 0; i < ORDERED_MAP_RANGE_COUNT; ++i)
+		{
+			U64 remaining = ORDERED_MAP_RANGE_LENGTH;
+			for (auto it = b_tree_map_lower_bound(b_tree, queries[i]); it != end(b_tree) && remaining; ++it, --remaining)
+				sum += (*it).value;
+		}
+		benchmark_print_throughput("B_Tree_Map range scan (entries/s)", ORDERED_MAP_RANGE_COUNT * ORDERED_MAP_RANGE_LENGTH, benchmark_now() - begin);
+		benchmark_consume(sum);
+	}
+
+	{
+		U64 sum = 0;
+		U64 begin = benchmark_now();
+		for (U64 i = 0; i < ORDERED_MAP_RANGE_COUNT; ++i)
+		{
+			U64 first = array_lower_bound(sorted, queries[i], entry_key_less);
+			U64 last = u64_min(first + ORDERED_MAP_RANGE_LENGTH, sorted.count);
+			for (U64 j = first; j < last; ++j)
+				sum += sorted[j].value;
+		}
+		benchmark_print_throughput("Sorted Array range scan (entries/s)", ORDERED_MAP_RANGE_COUNT * ORDERED_MAP_RANGE_LENGTH, benchmark_now() - begin);
+		benchmark_consume(sum);
+	}
+
+	{
+		U64 sum = 0;
+		U64 begin = benchmark_now();
+		for (auto [key, value] : b_tree)
+			sum += value;
+		benchmark_print_throughput("B_Tree_Map full iteration", count, benchmark_now() - begin);
+		benchmark_consume(sum);
+	}
+}
+
+// Baseline is the pattern Handle_Pool replaces: objects from a Pool_Allocator looked up through Hash_Table<U64, T *>.
+inline static void
+_benchmark_handle_pool()
+{
+	U64 random_state = 3;
+	memory::Pool_Allocator *object_pool = memory::pool_allocator_init(sizeof(Benchmark_Object), HANDLE_POOL_OBJECT_COUNT);
+	Hash_Table<U64, Benchmark_Object *> table = hash_table_init<U64, Benchmark_Object *>();
+	Handle_Pool<Benchmark_Object> pool = handle_pool_init<Benchmark_Object>();
+	Array<Handle<Benchmark_Object>> handles = array_init_with_capacity<Handle<Benchmark_Object>>(HANDLE_POOL_OBJECT_COUNT);
+	Array<U64> queries = array_init_with_count<U64>(HANDLE_POOL_QUERY_COUNT);
+	DEFER(memory::pool_allocator_deinit(object_pool); hash_table_deinit(table); handle_pool_deinit(pool); array_deinit(handles); array_deinit(queries));
+
+	for (U64 &query : queries)
+		query = benchmark_random(random_state) % HANDLE_POOL_OBJECT_COUNT;
+
+	{
+		U64 begin = benchmark_now();
+		for (U64 i = 0; i < HANDLE_POOL_OBJECT_COUNT; ++i)
+		{
+			Benchmark_Object *object = (Benchmark_Object *)memory::pool_allocator_allocate(object_pool).data;
+			*object = Benchmark_Object{.id = i, .velocity = {1.0f, 2.0f, 3.0f}};
+			hash_table_insert(table, i, object);
+		}
+		benchmark_print_throughput("Hash_Table<U64, T *> + Pool_Allocator insert", HANDLE_POOL_OBJECT_COUNT, benchmark_now() - begin);
+	}
+
+	{
+		U64 begin = benchmark_now();
+		for (U64 i = 0; i < HANDLE_POOL_OBJECT_COUNT; ++i)
+			array_push(handles, handle_pool_insert(pool, Benchmark_Object{.id = i, .velocity = {1.0f, 2.0f, 3.0f}}));
+		benchmark_print_throughput("Handle_Pool insert", HANDLE_POOL_OBJECT_COUNT, benchmark_now() - begin);
+	}
+
+	{
+		U64 sum = 0;
+		U64 begin = benchmark_now();
+		for (U64 query : queries)
+			sum += hash_table_find(table, query)->value->id;
+		benchmark_print_throughput("Hash_Table<U64, T *> find", queries.count, benchmark_now() - begin);
+		benchmark_consume(sum);
+	}
+
+	{
+		U64 sum = 0;
+		U64 begin = benchmark_now();
+		for (U64 query : queries)
+			sum += handle_pool_get(pool, handles[query])->id;
+		benchmark_print_throughput("Handle_Pool get", queries.count, benchmark_now() - begin);
+		benchmark_consume(sum);
+	}
+
+	{
+		U64 begin = benchmark_now();
+		for (U64 r = 0; r < HANDLE_POOL_ITERATION_COUNT; ++r)
+			for (auto &[id, object] : table)
+				for (U64 i = 0; i < 3; ++i)
+					object->position[i] += object->velocity[i];
+		benchmark_print_throughput("Hash_Table<U64, T *> iteration", HANDLE_POOL_ITERATION_COUNT * HANDLE_POOL_OBJECT_COUNT, benchmark_now() - begin);
+	}
+
+	{
+		U64 begin = benchmark_now();
+		for (U64 r = 0; r < HANDLE_POOL_ITERATION_COUNT; ++r)
+			for (Benchmark_Object &object : pool)
+				for (U64 i = 0; i < 3; ++i)
+					object.position[i] += object.velocity[i];
+		benchmark_print_throughput("Handle_Pool iteration", HANDLE_POOL_ITERATION_COUNT * HANDLE_POOL_OBJECT_COUNT, benchmark_now() - begin);
+	}
+
+	{
+		U64 begin = benchmark_now();
+		for (U64 query : queries)
+		{
+			Benchmark_Object *object = hash_table_find(table, query)->value;
+			hash_table_remove(table, query);
+			hash_table_insert(table, query, object);
+		}
+		benchmark_print_throughput("Hash_Table<U64, T *> remove + insert", queries.count, benchmark_now() - begin);
+	}
+
+	{
+		U64 begin = benchmark_now();
+		for (U64 query : queries)
+		{
+			Benchmark_Object object = *handle_pool_get(pool, handles[query]);
+			handle_pool_remove(pool, handles[query]);
+			handles[query] = handle_pool_insert(pool, object);
+		}
+		benchmark_print_throughput("Handle_Pool remove + insert", queries.count, benchmark_now() - begin);
+	}
+}
+
+inline static void
+_benchmark_bit_operations()
+{
+	U64 random_state = 2;
+	Bit_Array a = bit_array_init_with_count(MEMBERSHIP_UNIVERSE_SIZE);
+	Bit_Array b = bit_array_init_with_count(MEMBERSHIP_UNIVERSE_SIZE);
+	Array<bool> bools_a = array_init_with_count<bool>(MEMBERSHIP_UNIVERSE_SIZE);
+	Array<bool> bools_b = array_init_with_count<bool>(MEMBERSHIP_UNIVERSE_SIZE);
+	DEFER(bit_array_deinit(a); bit_array_deinit(b); array_deinit(bools_a); array_deinit(bools_b));
+	for (U64 i = 0; i < MEMBERSHIP_UNIVERSE_SIZE; ++i)
+	{
+		bools_a[i] = benchmark_random(random_state) % 2 == 0;
+		bools_b[i] = benchmark_random(random_state) % 2 == 0;
+		if (bools_a[i])
+			bit_array_set(a, i);
+		if (bools_b[i])
+			bit_array_set(b, i);
+	}
+
+	{
+		U64 count = 0;
+		U64 begin = benchmark_now();
+		for (U64 r = 0; r < BIT_OPERATION_REPETITION_COUNT; ++r)
+		{
+			for (U64 i = 0; i < bools_a.count; ++i)
+				bools_a.data[i] = bools_a.data[i] | bools_b.data[i];
+			count += bools_a.data[r % bools_a.count];
+		}
+		benchmark_print_throughput("Array<bool> or (bits/s)", BIT_OPERATION_REPETITION_COUNT * MEMBERSHIP_UNIVERSE_SIZE, benchmark_now() - begin);
+		benchmark_consume(count);
+	}
+
+	{
+		U64 begin = benchmark_now();
+		for (U64 r = 0; r < BIT_OPERATION_REPETITION_COUNT; ++r)
+			bit_array_or(a, b);
+		benchmark_print_throughput("Bit_Array or (bits/s)", BIT_OPERATION_REPETITION_COUNT * MEMBERSHIP_UNIVERSE_SIZE, benchmark_now() - begin);
+		benchmark_consume(a.words[0]);
+	}
+
+	{
+		U64 count = 0;
+		U64 begin = benchmark_now();
+		for (U64 r = 0; r < BIT_OPERATION_REPETITION_COUNT; ++r)
+			count += bit_array_count_set(b);
+		benchmark_print_throughput("Bit_Array count_set (bits/s)", BIT_OPERATION_REPETITION_COUNT * MEMBERSHIP_UNIVERSE_SIZE, benchmark_now() - begin);
+		benchmark_consume(count);
+	}
+
+	{
+		U64 sum = 0;
+		U64 begin = benchmark_now();
+		for (U64 r = 0; r < BIT_OPERATION_REPETITION_COUNT / 100; ++r)
+			for (U64 index : bit_array_set_bits(b))
+				sum += index;
+		benchmark_print_throughput("Bit_Array set bits iteration (bits/s)", BIT_OPERATION_REPETITION_COUNT / 100 * MEMBERSHIP_UNIVERSE_SIZE, benchmark_now() - begin);
+		benchmark_consume(sum);
+	}
+}
+
+template <typename Q>
+struct Queue_Throughput_Context
+{
+	Q *queue;
+	Atomic<U32> *start;
+	Atomic<U64> *consumed_count;
+	U64 item_count;
+	U64 total_item_count;
+	U64 batch_size;
+};
+
+template <typename Q>
+inline static void
+_queue_throughput_producer(void *data)
+{
+	Queue_Throughput_Context<Q> *context = (Queue_Throughput_Context<Q> *)data;
+	U32 spin_count = 0;
+	while (atomic_load(*context->start, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE) == 0)
+		benchmark_backoff(spin_count);
+
+	U64 values[QUEUE_BATCH_SIZE];
+	for (U64 i = 0; i < QUEUE_BATCH_SIZE; ++i)
+		values[i] = i;
+
+	for (U64 pushed = 0; pushed < context->item_count;)
+	{
+		U64 count = _queue_push(*context->queue, values, u64_min(context->batch_size, context->item_count - pushed));
+		if (count == 0)
+			benchmark_backoff(spin_count);
+		else
+			spin_count = 0;
+		pushed += count;
+	}
+}
+
+template <typename Q>
+inline static void
+_queue_throughput_consumer(void *data)
+{
+	Queue_Throughput_Context<Q> *context = (Queue_Throughput_Context<Q> *)data;
+	U32 spin_count = 0;
+	while (atomic_load(*context->start, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE) == 0)
+		benchmark_backoff(spin_count);
+
+	U64 values[QUEUE_BATCH_SIZE];
+	while (atomic_load(*context->consumed_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED) < context->total_item_count)
+	{
+		U64 count = _queue_pop(*context->queue, values, context->batch_size);
+		if (count == 0)
+		{
+			benchmark_backoff(spin_count);
+			continue;
+		}
+		spin_count = 0;
+		atomic_fetch_add(*context->consumed_count, count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	}
+}
+
+template <typename Q>
+inline static void
+_benchmark_queue_throughput(const char *name, Q &queue, U32 producer_count, U32 consumer_count, U64 batch_size)
+{
+	constexpr U32 MAX_THREAD_COUNT = 16;
+	validate(producer_count + consumer_count <= MAX_THREAD_COUNT, "[BENCHMARK]: Too many queue threads.");
+
+	Atomic<U32> start = atomic_init((U32)0);
+	Atomic<U64> consumed_count = atomic_init((U64)0);
+	U64 item_count_per_producer = QUEUE_ITEM_COUNT / producer_count;
+	Queue_Throughput_Context<Q> context = {
+		.queue = &queue,
+		.start = &start,
+		.consumed_count = &consumed_count,
+		.item_count = item_count_per_producer,
+		.total_item_count = item_count_per_producer * producer_count,
+		.batch_size = batch_size
+	};
+
+	Platform_Thread *threads[MAX_THREAD_COUNT];
+	for (U32 i = 0; i < producer_count + consumer_count; ++i)
+	{
+		threads[i] = platform_thread_init(Platform_Thread_Desc {
+			.function = i < producer_count ? _queue_throughput_producer<Q> : _queue_throughput_consumer<Q>,
+			.data = &context,
+			.name = "QueueBenchmark"
+		});
+	}
+
+	U64 begin = benchmark_now();
+	atomic_store(start, (U32)1, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+	for (U32 i = 0; i < producer_count + consumer_count; ++i)
+		platform_thread_deinit(threads[i]);
+	U64 end = benchmark_now();
+
+	benchmark_print_throughput(name, context.total_item_count, end - begin);
+}
+
+template <typename Q>
+struct Queue_Latency_Context
+{
+	Q *request;
+	Q *response;
+	U64 round_trip_count;
+};
+
+template <typename Q>
+inline static void
+_queue_latency_echo(void *data)
+{
+	Queue_Latency_Context<Q> *context = (Queue_Latency_Context<Q> *)data;
+	for (U64 i = 0; i < context->round_trip_count; ++i)
+	{
+		U64 value = 0;
+		U32 spin_count = 0;
+		while (_queue_pop(*context->request, &value, 1) == 0)
+			benchmark_backoff(spin_count);
+		while (_queue_push(*context->response, &value, 1) == 0)
+			benchmark_backoff(spin_count);
+	}
+}
+
+// Ping-pong between two threads; each sample is the mean round trip over a short burst,
+// which keeps the microsecond clock resolution out of the result.
+template <typename Q>
+inline static void
+_benchmark_queue_latency(const char *name, Q &request, Q &response)
+{
+	Queue_Latency_Context<Q> context = {
+		.request = &request,
+		.response = &response,
+		.round_trip_count = QUEUE_LATENCY_SAMPLE_COUNT * QUEUE_LATENCY_ROUND_TRIPS_PER_SAMPLE
+	};
+	Platform_Thread *thread = platform_thread_init(Platform_Thread_Desc {
+		.function = _queue_latency_echo<Q>,
+		.data = &context,
+		.name = "QueueBenchmark"
+	});
+
+	Array<U64> samples = array_init_with_capacity<U64>(QUEUE_LATENCY_SAMPLE_COUNT);
+	DEFER(array_deinit(samples));
+	for (U64 i = 0; i < QUEUE_LATENCY_SAMPLE_COUNT; ++i)
+	{
+		U64 begin = benchmark_now();
+		for (U64 j = 0; j < QUEUE_LATENCY_ROUND_TRIPS_PER_SAMPLE; ++j)
+		{
+			U64 value = j;
+			U32 spin_count = 0;
+			while (_queue_push(request, &value, 1) == 0)
+				benchmark_backoff(spin_count);
+			while (_queue_pop(response, &value, 1) == 0)
+				benchmark_backoff(spin_count);
+		}
+		U64 end = benchmark_now();
+		array_push(samples, (end - begin) * 1000 / QUEUE_LATENCY_ROUND_TRIPS_PER_SAMPLE);
+	}
+	platform_thread_deinit(thread);
+
+	benchmark_print_latency(name, benchmark_stats_from(samples), "ns");
+}
+
+I32
+main(I32, char **)
+{
+	U32 logical_processor_count = platform_get_logical_processor_count();
+	U32 thread_pair_count = (U32)u64_clamp(logical_processor_count / 2, 1, 4);
+
+	benchmark_print_section("Membership, 64K universe, random queries");
+	_benchmark_membership();
+
+	benchmark_print_section("Bitwise operations, 64K bits");
+	_benchmark_bit_operations();
+
+	benchmark_print_section("Object storage, 64K objects");
+	_benchmark_handle_pool();
+
+	for (U64 count : {10'000, 1'000'000})
+	{
+		String ordered_map_section_name = format("Ordered map, {} random U64 keys", count);
+		benchmark_print_section(ordered_map_section_name.data);
+		string_deinit(ordered_map_section_name);
+		_benchmark_ordered_map(count);
+	}
+
+	benchmark_print_section("Queue throughput, 1 producer / 1 consumer");
+	{
+		Mutex_Queue mutex_queue = mutex_queue_init(QUEUE_CAPACITY);
+		DEFER(mutex_queue_deinit(mutex_queue));
+		Spsc_Queue<U64> spsc_queue = spsc_queue_init<U64>(QUEUE_CAPACITY);
+		DEFER(spsc_queue_deinit(spsc_queue));
+		Mpmc_Queue<U64> mpmc_queue = mpmc_queue_init<U64>(QUEUE_CAPACITY);
+		DEFER(mpmc_queue_deinit(mpmc_queue));
+
+		_benchmark_queue_throughput("Ring_Buffer + Platform_Mutex", mutex_queue, 1, 1, 1);
+		_benchmark_queue_throughput("Ring_Buffer + Platform_Mutex, batch 32", mutex_queue, 1, 1, QUEUE_BATCH_SIZE);
+		_benchmark_queue_throughput("Spsc_Queue", spsc_queue, 1, 1, 1);
+		_benchmark_queue_throughput("Spsc_Queue, batch 32", spsc_queue, 1, 1, QUEUE_BATCH_SIZE);
+		_benchmark_queue_throughput("Mpmc_Queue", mpmc_queue, 1, 1, 1);
+		_benchmark_queue_throughput("Mpmc_Queue, batch 32", mpmc_queue, 1, 1, QUEUE_BATCH_SIZE);
+	}
+
+	String section_name = format("Queue throughput, {} producers / {} consumers", thread_pair_count, thread_pair_count);
+	DEFER(string_deinit(section_name));
+	benchmark_print_section(section_name.data);
+	{
+		Mutex_Queue mutex_queue = mutex_queue_init(QUEUE_CAPACITY);
+		DEFER(mutex_queue_deinit(mutex_queue));
+		Mpmc_Queue<U64> mpmc_queue = mpmc_queue_init<U64>(QUEUE_CAPACITY);
+		DEFER(mpmc_queue_deinit(mpmc_queue));
+
+		_benchmark_queue_throughput("Ring_Buffer + Platform_Mutex", mutex_queue, thread_pair_count, thread_pair_count, 1);
+		_benchmark_queue_throughput("Ring_Buffer + Platform_Mutex, batch 32", mutex_queue, thread_pair_count, thread_pair_count, QUEUE_BATCH_SIZE);
+		_benchmark_queue_throughput("Mpmc_Queue", mpmc_queue, thread_pair_count, thread_pair_count, 1);
+		_benchmark_queue_throughput("Mpmc_Queue, batch 32", mpmc_queue, thread_pair_count, thread_pair_count, QUEUE_BATCH_SIZE);
+	}
+
+	benchmark_print_section("Queue round-trip latency");
+	{
+		Mutex_Queue mutex_request = mutex_queue_init(QUEUE_CAPACITY);
+		Mutex_Queue mutex_response = mutex_queue_init(QUEUE_CAPACITY);
+		DEFER(mutex_queue_deinit(mutex_request); mutex_queue_deinit(mutex_response));
+		Spsc_Queue<U64> spsc_request = spsc_queue_init<U64>(QUEUE_CAPACITY);
+		Spsc_Queue<U64> spsc_response = spsc_queue_init<U64>(QUEUE_CAPACITY);
+		DEFER(spsc_queue_deinit(spsc_request); spsc_queue_deinit(spsc_response));
+		Mpmc_Queue<U64> mpmc_request = mpmc_queue_init<U64>(QUEUE_CAPACITY);
+		Mpmc_Queue<U64> mpmc_response = mpmc_queue_init<U64>(QUEUE_CAPACITY);
+		DEFER(mpmc_queue_deinit(mpmc_request); mpmc_queue_deinit(mpmc_response));
+
+		_benchmark_queue_latency("Ring_Buffer + Platform_Mutex", mutex_request, mutex_response);
+		_benchmark_queue_latency("Spsc_Queue", spsc_request, spsc_response);
+		_benchmark_queue_latency("Mpmc_Queue", mpmc_request, mpmc_response);
+	}
+
+	return 0;
+}
\ No newline at end of file
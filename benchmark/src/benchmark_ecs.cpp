@@ -0,0 +1,459 @@
+#include "benchmark.h"
+
+#include <core/defer.h>
+#include <core/ecs.h>
+#include <core/memory/pool_allocator.h>
+#include <core/containers/hash_table.h>
+
+#include <typeinfo>
+#include <utility>
+
+constexpr U32 BENCHMARK_ECS_ENTITY_COUNT = 100'000;
+constexpr U32 BENCHMARK_ECS_REPETITION_COUNT = 10;
+constexpr U32 BENCHMARK_ECS_QUERY_COUNT = 1 << 20;
+
+struct Benchmark_Ecs_Position
+{
+	F32 x, y, z;
+};
+
+struct Benchmark_Ecs_Velocity
+{
+	F32 x, y, z;
+};
+
+struct Benchmark_Ecs_Health
+{
+	U64 current;
+	U64 max;
+};
+
+// Baseline: the layout archetypes replaced, one pool allocation per component found through a hash table per type.
+template <typename T>
+struct Benchmark_Ecs_Hash_Table_Column
+{
+	memory::Pool_Allocator *pool;
+	Hash_Table<U64, T *> components;
+};
+
+template <typename T>
+inline static Benchmark_Ecs_Hash_Table_Column<T>
+_benchmark_ecs_hash_table_column_init()
+{
+	return Benchmark_Ecs_Hash_Table_Column<T> {
+		.pool = memory::pool_allocator_init(sizeof(T), 64),
+		.components = hash_table_init<U64, T *>()
+	};
+}
+
+template <typename T>
+inline static void
+_benchmark_ecs_hash_table_column_deinit(Benchmark_Ecs_Hash_Table_Column<T> &self)
+{
+	memory::pool_allocator_deinit(self.pool);
+	hash_table_deinit(self.components);
+}
+
+template <typename T>
+inline static void
+_benchmark_ecs_hash_table_column_clear(Benchmark_Ecs_Hash_Table_Column<T> &self)
+{
+	for (auto [_, component] : self.components)
+		memory::pool_allocator_deallocate(self.pool, Memory_Block{component, sizeof(T)});
+	hash_table_clear(self.components);
+}
+
+template <typename T>
+inline static T *
+_benchmark_ecs_hash_table_column_write(Benchmark_Ecs_Hash_Table_Column<T> &self, ecs::Entity e)
+{
+	auto entry = hash_table_find(self.components, e.id);
+	if (entry == nullptr)
+		entry = hash_table_insert(self.components, e.id, (T *)memory::pool_allocator_allocate(self.pool).data);
+	return entry->value;
+}
+
+template <typename T>
+inline static const T *
+_benchmark_ecs_hash_table_column_read(const Benchmark_Ecs_Hash_Table_Column<T> &self, ecs::Entity e)
+{
+	if (auto entry = hash_table_find(self.components, e.id))
+		return entry->value;
+	return nullptr;
+}
+
+struct Benchmark_Ecs_Hash_Table_World
+{
+	Benchmark_Ecs_Hash_Table_Column<Benchmark_Ecs_Position> positions;
+	Benchmark_Ecs_Hash_Table_Column<Benchmark_Ecs_Velocity> velocities;
+	Benchmark_Ecs_Hash_Table_Column<Benchmark_Ecs_Health> healths;
+	Hash_Table<U64, void *> columns;
+};
+
+// Every access found its table by `typeid` hash first, like the old `ECS::read` and `ECS::write`.
+template <typename T>
+inline static Benchmark_Ecs_Hash_Table_Column<T> &
+_benchmark_ecs_hash_table_world_column(Benchmark_Ecs_Hash_Table_World &world)
+{
+	return *(Benchmark_Ecs_Hash_Table_Column<T> *)hash_table_find(world.columns, (U64)typeid(T).hash_code())->value;
+}
+
+// Same steps as the old `ECS::list`: copy the keys of every table, then filter the smallest copy with a lookup per table.
+inline static Array<ecs::Entity>
+_benchmark_ecs_hash_table_list(Benchmark_Ecs_Hash_Table_World &world)
+{
+	Array<ecs::Entity> positions = array_init<ecs::Entity>(memory::temp_allocator());
+	for (auto [id, _] : world.positions.components)
+		array_push(positions, ecs::Entity{id});
+	Array<ecs::Entity> velocities = array_init<ecs::Entity>(memory::temp_allocator());
+	for (auto [id, _] : world.velocities.components)
+		array_push(velocities, ecs::Entity{id});
+
+	Array<ecs::Entity> entities = array_copy(velocities.count < positions.count ? velocities : positions, memory::temp_allocator());
+	array_remove_if(entities, [&](ecs::Entity e) { return _benchmark_ecs_hash_table_column_read(world.positions, e) == nullptr; });
+	array_remove_if(entities, [&](ecs::Entity e) { return _benchmark_ecs_hash_table_column_read(world.velocities, e) == nullptr; });
+	return entities;
+}
+
+template <typename Run>
+inline static void
+_benchmark_ecs_case(const char *name, U64 operation_count, Run run)
+{
+	Array<U64> samples = array_init<U64>();
+	DEFER(array_deinit(samples));
+
+	run();
+	for (U32 r = 0; r < BENCHMARK_ECS_REPETITION_COUNT; ++r)
+	{
+		U64 begin = benchmark_now();
+		run();
+		array_push(samples, benchmark_now() - begin);
+		memory::temp_allocator_clear();
+	}
+
+	benchmark_print_throughput(name, operation_count, benchmark_stats_from(samples));
+}
+
+// Every entity has a position, every second one a velocity and every third one a health, which makes four archetypes.
+inline static void
+_benchmark_ecs_iteration()
+{
+	// The old layout took ids from a global counter that never reused them.
+	Array<ecs::Entity> hash_table_entities = array_init_with_count<ecs::Entity>(BENCHMARK_ECS_ENTITY_COUNT);
+	DEFER(array_deinit(hash_table_entities));
+	for (U32 i = 0; i < BENCHMARK_ECS_ENTITY_COUNT; ++i)
+		hash_table_entities[i] = ecs::Entity{i};
+
+	Benchmark_Ecs_Hash_Table_World hash_table_world = {
+		.positions = _benchmark_ecs_hash_table_column_init<Benchmark_Ecs_Position>(),
+		.velocities = _benchmark_ecs_hash_table_column_init<Benchmark_Ecs_Velocity>(),
+		.healths = _benchmark_ecs_hash_table_column_init<Benchmark_Ecs_Health>(),
+		.columns = hash_table_init<U64, void *>()
+	};
+	hash_table_insert(hash_table_world.columns, (U64)typeid(Benchmark_Ecs_Position).hash_code(), (void *)&hash_table_world.positions);
+	hash_table_insert(hash_table_world.columns, (U64)typeid(Benchmark_Ecs_Velocity).hash_code(), (void *)&hash_table_world.velocities);
+	hash_table_insert(hash_table_world.columns, (U64)typeid(Benchmark_Ecs_Health).hash_code(), (void *)&hash_table_world.healths);
+	DEFER(_benchmark_ecs_hash_table_column_deinit(hash_table_world.positions); _benchmark_ecs_hash_table_column_deinit(hash_table_world.velocities); _benchmark_ecs_hash_table_column_deinit(hash_table_world.healths); hash_table_deinit(hash_table_world.columns));
+
+	ecs::ECS world = ecs::ecs_new();
+	DEFER(ecs::ecs_free(world));
+	ecs::ecs_add_table<Benchmark_Ecs_Position>(world);
+	ecs::ecs_add_table<Benchmark_Ecs_Velocity>(world);
+	ecs::ecs_add_table<Benchmark_Ecs_Health>(world);
+
+	Array<ecs::Entity> entities = array_init_with_count<ecs::Entity>(BENCHMARK_ECS_ENTITY_COUNT);
+	DEFER(array_deinit(entities));
+	ecs::ecs_entity_new(world, slice_from(entities));
+
+	_benchmark_ecs_case("hash tables, add components", BENCHMARK_ECS_ENTITY_COUNT, [&]() {
+		_benchmark_ecs_hash_table_column_clear(hash_table_world.positions);
+		_benchmark_ecs_hash_table_column_clear(hash_table_world.velocities);
+		_benchmark_ecs_hash_table_column_clear(hash_table_world.healths);
+		for (U32 i = 0; i < BENCHMARK_ECS_ENTITY_COUNT; ++i)
+		{
+			*_benchmark_ecs_hash_table_column_write(_benchmark_ecs_hash_table_world_column<Benchmark_Ecs_Position>(hash_table_world), hash_table_entities[i]) = Benchmark_Ecs_Position{(F32)i, 0, 0};
+			if (i % 2 == 0)
+				*_benchmark_ecs_hash_table_column_write(_benchmark_ecs_hash_table_world_column<Benchmark_Ecs_Velocity>(hash_table_world), hash_table_entities[i]) = Benchmark_Ecs_Velocity{1, 1, 1};
+			if (i % 3 == 0)
+				*_benchmark_ecs_hash_table_column_write(_benchmark_ecs_hash_table_world_column<Benchmark_Ecs_Health>(hash_table_world), hash_table_entities[i]) = Benchmark_Ecs_Health{100, 100};
+		}
+	});
+
+	_benchmark_ecs_case("archetypes, add components", BENCHMARK_ECS_ENTITY_COUNT, [&]() {
+		ecs::ecs_entity_free(world, slice_from(entities));
+		ecs::ecs_entity_new(world, slice_from(entities));
+		for (U32 i = 0; i < BENCHMARK_ECS_ENTITY_COUNT; ++i)
+		{
+			*ecs::ecs_component_write<Benchmark_Ecs_Position>(world, entities[i]) = Benchmark_Ecs_Position{(F32)i, 0, 0};
+			if (i % 2 == 0)
+				*ecs::ecs_component_write<Benchmark_Ecs_Velocity>(world, entities[i]) = Benchmark_Ecs_Velocity{1, 1, 1};
+			if (i % 3 == 0)
+				*ecs::ecs_component_write<Benchmark_Ecs_Health>(world, entities[i]) = Benchmark_Ecs_Health{100, 100};
+		}
+	});
+
+	_benchmark_ecs_case("hash tables, list + lookup per entity", BENCHMARK_ECS_ENTITY_COUNT / 2, [&]() {
+		for (ecs::Entity e : _benchmark_ecs_hash_table_list(hash_table_world))
+		{
+			Benchmark_Ecs_Position *position = _benchmark_ecs_hash_table_column_write(_benchmark_ecs_hash_table_world_column<Benchmark_Ecs_Position>(hash_table_world), e);
+			const Benchmark_Ecs_Velocity *velocity = _benchmark_ecs_hash_table_column_read(_benchmark_ecs_hash_table_world_column<Benchmark_Ecs_Velocity>(hash_table_world), e);
+			position->x += velocity->x;
+			position->y += velocity->y;
+			position->z += velocity->z;
+		}
+	});
+
+	_benchmark_ecs_case("archetypes, list + lookup per entity", BENCHMARK_ECS_ENTITY_COUNT / 2, [&]() {
+		for (ecs::Entity e : ecs::ecs_entity_list<Benchmark_Ecs_Position, Benchmark_Ecs_Velocity>(world))
+		{
+			Benchmark_Ecs_Position *position = ecs::ecs_component_write<Benchmark_Ecs_Position>(world, e);
+			const Benchmark_Ecs_Velocity *velocity = ecs::ecs_component_read<Benchmark_Ecs_Velocity>(world, e);
+			position->x += velocity->x;
+			position->y += velocity->y;
+			position->z += velocity->z;
+		}
+	});
+
+	_benchmark_ecs_case("archetypes, for_each over columns", BENCHMARK_ECS_ENTITY_COUNT / 2, [&]() {
+		ecs::ecs_for_each<Benchmark_Ecs_Position, Benchmark_Ecs_Velocity>(world, [](ecs::Entity, Benchmark_Ecs_Position &position, const Benchmark_Ecs_Velocity &velocity) {
+			position.x += velocity.x;
+			position.y += velocity.y;
+			position.z += velocity.z;
+		});
+	});
+
+	ecs::Query<Benchmark_Ecs_Position, const Benchmark_Ecs_Velocity> query = ecs::ecs_query_init<Benchmark_Ecs_Position, const Benchmark_Ecs_Velocity>(world);
+	DEFER(ecs::ecs_query_deinit(query));
+
+	_benchmark_ecs_case("archetypes, cached query for_each", BENCHMARK_ECS_ENTITY_COUNT / 2, [&]() {
+		ecs::ecs_query_for_each(query, [](ecs::Entity, Benchmark_Ecs_Position &position, const Benchmark_Ecs_Velocity &velocity) {
+			position.x += velocity.x;
+			position.y += velocity.y;
+			position.z += velocity.z;
+		});
+	});
+
+	U64 state = 1;
+	Array<U32> query_indices = array_init_with_count<U32>(BENCHMARK_ECS_QUERY_COUNT);
+	DEFER(array_deinit(query_indices));
+	for (U32 &index : query_indices)
+		index = (U32)(benchmark_random(state) % BENCHMARK_ECS_ENTITY_COUNT);
+
+	_benchmark_ecs_case("hash tables, random read", BENCHMARK_ECS_QUERY_COUNT, [&]() {
+		F32 sum = 0;
+		for (U32 index : query_indices)
+			sum += _benchmark_ecs_hash_table_column_read(_benchmark_ecs_hash_table_world_column<Benchmark_Ecs_Position>(hash_table_world), hash_table_entities[index])->x;
+		benchmark_consume((U64)sum);
+	});
+
+	_benchmark_ecs_case("archetypes, random read", BENCHMARK_ECS_QUERY_COUNT, [&]() {
+		F32 sum = 0;
+		for (U32 index : query_indices)
+			sum += ecs::ecs_component_read<Benchmark_Ecs_Position>(world, entities[index])->x;
+		benchmark_consume((U64)sum);
+	});
+
+	_benchmark_ecs_case("generational ids, random liveness check", BENCHMARK_ECS_QUERY_COUNT, [&]() {
+		U64 alive_count = 0;
+		for (U32 index : query_indices)
+			alive_count += ecs::ecs_entity_is_alive(world, entities[index]);
+		benchmark_consume(alive_count);
+	});
+
+	_benchmark_ecs_case("archetypes, add + remove moving rows", BENCHMARK_ECS_ENTITY_COUNT, [&]() {
+		for (U32 i = 1; i < BENCHMARK_ECS_ENTITY_COUNT; i += 2)
+			ecs::ecs_component_write<Benchmark_Ecs_Velocity>(world, entities[i]);
+		for (U32 i = 1; i < BENCHMARK_ECS_ENTITY_COUNT; i += 2)
+			ecs::ecs_component_remove<Benchmark_Ecs_Velocity>(world, entities[i]);
+	});
+}
+
+// Freed slots are reused, so the registry stays as large as the peak entity count however many entities come and go.
+inline static void
+_benchmark_ecs_entities()
+{
+	ecs::ECS world = ecs::ecs_new();
+	DEFER(ecs::ecs_free(world));
+	ecs::ecs_add_table<Benchmark_Ecs_Position>(world);
+
+	Array<ecs::Entity> entities = array_init_with_count<ecs::Entity>(BENCHMARK_ECS_ENTITY_COUNT);
+	DEFER(array_deinit(entities));
+
+	_benchmark_ecs_case("bulk create + free, no components", BENCHMARK_ECS_ENTITY_COUNT, [&]() {
+		ecs::ecs_entity_new(world, slice_from(entities));
+		ecs::ecs_entity_free(world, slice_from(entities));
+	});
+
+	_benchmark_ecs_case("bulk create + free, one component", BENCHMARK_ECS_ENTITY_COUNT, [&]() {
+		ecs::ecs_entity_new(world, slice_from(entities));
+		for (ecs::Entity e : entities)
+			ecs::ecs_component_write<Benchmark_Ecs_Position>(world, e);
+		ecs::ecs_entity_free(world, slice_from(entities));
+	});
+
+	benchmark_print_value("entity slots after all runs", world.entity_slots.count, "slots");
+}
+
+// The old `ECS::component_index` looked the `typeid` hash up in a table on every access.
+template <typename T>
+inline static U32
+_benchmark_ecs_hashed_component_index(const Hash_Table<ecs::Component_Hash, U32> &hashed_indices)
+{
+	return hash_table_find(hashed_indices, (U64)typeid(T).hash_code())->value;
+}
+
+// Per access cost of finding a component's index, before and after component types got static ids.
+inline static void
+_benchmark_ecs_component_access()
+{
+	ecs::ECS world = ecs::ecs_new();
+	DEFER(ecs::ecs_free(world));
+	ecs::ecs_add_table<Benchmark_Ecs_Position>(world);
+	ecs::ecs_add_table<Benchmark_Ecs_Velocity>(world);
+	ecs::ecs_add_table<Benchmark_Ecs_Health>(world);
+
+	Hash_Table<ecs::Component_Hash, U32> hashed_indices = hash_table_init<ecs::Component_Hash, U32>();
+	DEFER(hash_table_deinit(hashed_indices));
+	hash_table_insert(hashed_indices, (U64)typeid(Benchmark_Ecs_Position).hash_code(), world.component_index<Benchmark_Ecs_Position>());
+	hash_table_insert(hashed_indices, (U64)typeid(Benchmark_Ecs_Velocity).hash_code(), world.component_index<Benchmark_Ecs_Velocity>());
+	hash_table_insert(hashed_indices, (U64)typeid(Benchmark_Ecs_Health).hash_code(), world.component_index<Benchmark_Ecs_Health>());
+
+	Array<ecs::Entity> entities = array_init_with_count<ecs::Entity>(BENCHMARK_ECS_ENTITY_COUNT);
+	DEFER(array_deinit(entities));
+	ecs::ecs_entity_new(world, slice_from(entities));
+	for (U32 i = 0; i < BENCHMARK_ECS_ENTITY_COUNT; ++i)
+	{
+		*ecs::ecs_component_write<Benchmark_Ecs_Position>(world, entities[i]) = Benchmark_Ecs_Position{(F32)i, 0, 0};
+		*ecs::ecs_component_write<Benchmark_Ecs_Velocity>(world, entities[i]) = Benchmark_Ecs_Velocity{1, 0, 0};
+		*ecs::ecs_component_write<Benchmark_Ecs_Health>(world, entities[i]) = Benchmark_Ecs_Health{1, 1};
+	}
+
+	U64 state = 1;
+	Array<U32> query_indices = array_init_with_count<U32>(BENCHMARK_ECS_QUERY_COUNT);
+	DEFER(array_deinit(query_indices));
+	for (U32 &index : query_indices)
+		index = (U32)(benchmark_random(state) % BENCHMARK_ECS_ENTITY_COUNT);
+
+	_benchmark_ecs_case("typeid hash + hash table, index only", BENCHMARK_ECS_QUERY_COUNT, [&]() {
+		U64 sum = 0;
+		for (U32 index : query_indices)
+			sum += index + _benchmark_ecs_hashed_component_index<Benchmark_Ecs_Position>(hashed_indices);
+		benchmark_consume(sum);
+	});
+
+	_benchmark_ecs_case("static type id + flat array, index only", BENCHMARK_ECS_QUERY_COUNT, [&]() {
+		U64 sum = 0;
+		for (U32 index : query_indices)
+			sum += index + world.component_index<Benchmark_Ecs_Position>();
+		benchmark_consume(sum);
+	});
+
+	_benchmark_ecs_case("typeid hash + hash table, read 3 components", BENCHMARK_ECS_QUERY_COUNT, [&]() {
+		F32 sum = 0;
+		for (U32 index : query_indices)
+		{
+			sum += ((const Benchmark_Ecs_Position *)world.read(entities[index], _benchmark_ecs_hashed_component_index<Benchmark_Ecs_Position>(hashed_indices)))->x;
+			sum += ((const Benchmark_Ecs_Velocity *)world.read(entities[index], _benchmark_ecs_hashed_component_index<Benchmark_Ecs_Velocity>(hashed_indices)))->x;
+			sum += ((const Benchmark_Ecs_Health *)world.read(entities[index], _benchmark_ecs_hashed_component_index<Benchmark_Ecs_Health>(hashed_indices)))->current;
+		}
+		benchmark_consume((U64)sum);
+	});
+
+	_benchmark_ecs_case("static type id + flat array, read 3 components", BENCHMARK_ECS_QUERY_COUNT, [&]() {
+		F32 sum = 0;
+		for (U32 index : query_indices)
+		{
+			sum += ecs::ecs_component_read<Benchmark_Ecs_Position>(world, entities[index])->x;
+			sum += ecs::ecs_component_read<Benchmark_Ecs_Velocity>(world, entities[index])->x;
+			sum += ecs::ecs_component_read<Benchmark_Ecs_Health>(world, entities[index])->current;
+		}
+		benchmark_consume((U64)sum);
+	});
+}
+
+template <U32 N>
+struct Benchmark_Ecs_Tag
+{
+	U32 value;
+};
+
+template <U32 ...N>
+inline static void
+_benchmark_ecs_add_tags(ecs::ECS &world, ecs::Entity e, U32 tags, std::integer_sequence<U32, N...>)
+{
+	((tags & (1u << N) ? (void)ecs::ecs_component_write<Benchmark_Ecs_Tag<N>>(world, e) : (void)0), ...);
+}
+
+// Per frame cost of finding the entities when few of many archetypes match, as in a world with many component combinations.
+inline static void
+_benchmark_ecs_many_archetypes()
+{
+	constexpr U32 TAG_COUNT = 8;
+	constexpr U32 ENTITY_COUNT = 4'096;
+	constexpr U32 FRAME_COUNT = 1'000;
+
+	ecs::ECS world = ecs::ecs_new();
+	DEFER(ecs::ecs_free(world));
+	ecs::ecs_add_table<Benchmark_Ecs_Position>(world);
+	ecs::ecs_add_table<Benchmark_Ecs_Velocity>(world);
+	[&]<U32 ...N>(std::integer_sequence<U32, N...>) {
+		(ecs::ecs_add_table<Benchmark_Ecs_Tag<N>>(world), ...);
+	}(std::make_integer_sequence<U32, TAG_COUNT>{});
+
+	// Every entity has a position and one of 256 tag combinations, one in sixteen also has a velocity.
+	for (U32 i = 0; i < ENTITY_COUNT; ++i)
+	{
+		ecs::Entity e = ecs::ecs_entity_new(world);
+		*ecs::ecs_component_write<Benchmark_Ecs_Position>(world, e) = Benchmark_Ecs_Position{(F32)i, 0, 0};
+		if (i % 16 == 0)
+			*ecs::ecs_component_write<Benchmark_Ecs_Velocity>(world, e) = Benchmark_Ecs_Velocity{1, 1, 1};
+		_benchmark_ecs_add_tags(world, e, i % (1 << TAG_COUNT), std::make_integer_sequence<U32, TAG_COUNT>{});
+	}
+	benchmark_print_value("world size", world.archetypes.count, "archetypes");
+
+	auto update = [](ecs::Entity, Benchmark_Ecs_Position &position, const Benchmark_Ecs_Velocity &velocity) {
+		position.x += velocity.x;
+	};
+
+	_benchmark_ecs_case("list + lookup per entity, per frame", FRAME_COUNT, [&]() {
+		for (U32 frame = 0; frame < FRAME_COUNT; ++frame)
+		{
+			for (ecs::Entity e : ecs::ecs_entity_list<Benchmark_Ecs_Position, Benchmark_Ecs_Velocity>(world))
+				update(e, *ecs::ecs_component_write<Benchmark_Ecs_Position>(world, e), *ecs::ecs_component_read<Benchmark_Ecs_Velocity>(world, e));
+			memory::temp_allocator_clear();
+		}
+	});
+
+	_benchmark_ecs_case("for_each, every archetype checked, per frame", FRAME_COUNT, [&]() {
+		for (U32 frame = 0; frame < FRAME_COUNT; ++frame)
+			ecs::ecs_for_each<Benchmark_Ecs_Position, Benchmark_Ecs_Velocity>(world, update);
+	});
+
+	ecs::Query<Benchmark_Ecs_Position, const Benchmark_Ecs_Velocity> query = ecs::ecs_query_init<Benchmark_Ecs_Position, const Benchmark_Ecs_Velocity>(world);
+	DEFER(ecs::ecs_query_deinit(query));
+
+	_benchmark_ecs_case("cached query for_each, per frame", FRAME_COUNT, [&]() {
+		for (U32 frame = 0; frame < FRAME_COUNT; ++frame)
+			ecs::ecs_query_for_each(query, update);
+	});
+}
+
+I32
+main(I32 argument_count, char **arguments)
+{
+	benchmark_report_begin("ecs", argument_count, arguments);
+
+	benchmark_print_section("ECS, 100K entities, 4 archetypes");
+	_benchmark_ecs_iteration();
+
+	benchmark_print_section("ECS entities, 100K per run");
+	_benchmark_ecs_entities();
+
+	benchmark_print_section("ECS component access, 1M random entities");
+	_benchmark_ecs_component_access();
+
+	benchmark_print_section("ECS queries, 4K entities, 256 tag combinations");
+	_benchmark_ecs_many_archetypes();
+
+	return benchmark_report_end() ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,771 @@
+#include "benchmark.h"
+
+#include <core/defer.h>
+#include <core/atomic.h>
+#include <core/scheduler.h>
+
+constexpr U32 BENCHMARK_SCHEDULER_TASK_COUNT = 200'000;
+constexpr U32 BENCHMARK_SCHEDULER_FAN_OUT_COUNT = 64;
+constexpr U32 BENCHMARK_SCHEDULER_WARMUP_COUNT = 1;
+constexpr U32 BENCHMARK_SCHEDULER_REPETITION_COUNT = 5;
+constexpr U32 BENCHMARK_SCHEDULER_WAKEUP_SAMPLE_COUNT = 200;
+constexpr U32 BENCHMARK_SCHEDULER_RANGE_COUNT = 1 << 20;
+constexpr U64 BENCHMARK_SCHEDULER_STREAM_SIZE = 4ull << 30;
+constexpr U64 BENCHMARK_SCHEDULER_STREAM_GROUPED_SIZE = 256ull << 20;
+constexpr U64 BENCHMARK_SCHEDULER_STREAM_CHUNK_SIZE = 1ull << 20;
+
+struct Benchmark_Scheduler_Fan_Out_Context
+{
+	Scheduler *scheduler;
+	Scheduler_Task *leaf_tasks;
+};
+
+// A few hundred nanoseconds of work, so the measurement is dominated by scheduling cost.
+inline static void
+_benchmark_scheduler_leaf_task(void *data)
+{
+	Atomic<U64> *counter = (Atomic<U64> *)data;
+	U64 state = (U64)data;
+	U64 value = 0;
+	for (U32 i = 0; i < 16; ++i)
+		value += benchmark_random(state);
+	benchmark_consume(value);
+	atomic_fetch_add(*counter, (U64)1, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+}
+
+// Each root task spawns its leaves from inside a worker, which is the path the worker deques serve.
+inline static void
+_benchmark_scheduler_fan_out_task(void *data)
+{
+	Benchmark_Scheduler_Fan_Out_Context *context = (Benchmark_Scheduler_Fan_Out_Context *)data;
+	Scheduler_Group *group = scheduler_group_init(context->scheduler);
+	scheduler_submit(context->scheduler, slice_from(context->leaf_tasks, BENCHMARK_SCHEDULER_FAN_OUT_COUNT), group);
+	scheduler_wait_group(context->scheduler, group);
+	scheduler_group_deinit(context->scheduler, group);
+}
+
+inline static void
+_benchmark_scheduler_record_start_task(void *data)
+{
+	Atomic<U64> *start_time = (Atomic<U64> *)data;
+	atomic_store(*start_time, benchmark_now());
+}
+
+// Time from an external submit until the task starts, once with the workers parked and once with them still spinning.
+inline static void
+_benchmark_scheduler_wakeup_latency(Scheduler *scheduler)
+{
+	Atomic<U64> start_time = atomic_init((U64)0);
+	Array<U64> samples = array_init<U64>();
+	DEFER(array_deinit(samples));
+
+	for (bool is_parked : {true, false})
+	{
+		array_clear(samples);
+		for (U32 i = 0; i < BENCHMARK_SCHEDULER_WAKEUP_SAMPLE_COUNT; ++i)
+		{
+			if (is_parked)
+				platform_thread_sleep(2);
+
+			U64 submit_time = benchmark_now();
+			scheduler_submit(scheduler, Scheduler_Task{.function = _benchmark_scheduler_record_start_task, .data = &start_time});
+			scheduler_wait_all(scheduler);
+			array_push(samples, atomic_load(start_time) - submit_time);
+		}
+
+		Benchmark_Stats stats = benchmark_stats_from(samples);
+		benchmark_print_latency(is_parked ? "wakeup latency, parked workers" : "wakeup latency, back to back submits", stats, "us");
+	}
+}
+
+// CPU time the process burns while the scheduler has nothing to do, and per task when tasks trickle in.
+inline static void
+_benchmark_scheduler_cpu_burn(Scheduler *scheduler, Slice<const Scheduler_Task> tasks)
+{
+	constexpr U32 IDLE_MILLISECONDS = 200;
+	constexpr U32 TRICKLE_TASK_COUNT = 100;
+
+	scheduler_submit(scheduler, tasks);
+	scheduler_wait_all(scheduler);
+
+	U64 cpu_begin = benchmark_cpu_now();
+	platform_thread_sleep(IDLE_MILLISECONDS);
+	benchmark_print_value("idle cpu after a burst, per second", (benchmark_cpu_now() - cpu_begin) * 1000 / IDLE_MILLISECONDS, "us");
+
+	cpu_begin = benchmark_cpu_now();
+	for (U32 i = 0; i < TRICKLE_TASK_COUNT; ++i)
+	{
+		scheduler_submit(scheduler, tasks.data[i]);
+		platform_thread_sleep(1);
+	}
+	scheduler_wait_all(scheduler);
+	benchmark_print_value("cpu per task, one task per millisecond", (benchmark_cpu_now() - cpu_begin) / TRICKLE_TASK_COUNT, "us");
+}
+
+inline static void
+_benchmark_scheduler_empty_task(void *)
+{
+}
+
+// Four stages of 64 tasks, each stage starting after the previous one: chained with group waits, then as one graph.
+inline static void
+_benchmark_scheduler_stages(Scheduler *scheduler, Slice<const Scheduler_Task> tasks)
+{
+	constexpr U32 STAGE_COUNT = 4;
+	constexpr U32 STAGE_TASK_COUNT = 64;
+	constexpr U32 FRAME_COUNT = 500;
+
+	Scheduler_Group *group = scheduler_group_init(scheduler);
+	DEFER(scheduler_group_deinit(scheduler, group));
+
+	U64 begin = benchmark_now();
+	for (U32 frame = 0; frame < FRAME_COUNT; ++frame)
+	{
+		for (U32 stage = 0; stage < STAGE_COUNT; ++stage)
+		{
+			scheduler_submit(scheduler, slice_from(tasks.data, STAGE_TASK_COUNT), group);
+			scheduler_wait_group(scheduler, group);
+		}
+	}
+	benchmark_print_throughput("4 stages x 64 tasks, wait_group per stage", FRAME_COUNT * STAGE_COUNT * STAGE_TASK_COUNT, benchmark_now() - begin);
+
+	// Stages are joined by an empty node, which keeps the edge count linear in the task count.
+	Scheduler_Graph *graph = scheduler_graph_init(scheduler);
+	DEFER(scheduler_graph_deinit(scheduler, graph));
+
+	U32 join_node = U32_MAX;
+	for (U32 stage = 0; stage < STAGE_COUNT; ++stage)
+	{
+		U32 next_join_node = scheduler_graph_add_task(scheduler, graph, Scheduler_Task{.function = _benchmark_scheduler_empty_task});
+		for (U32 i = 0; i < STAGE_TASK_COUNT; ++i)
+		{
+			U32 node = scheduler_graph_add_task(scheduler, graph, tasks.data[i]);
+			if (join_node != U32_MAX)
+				scheduler_graph_add_edge(scheduler, graph, join_node, node);
+			scheduler_graph_add_edge(scheduler, graph, node, next_join_node);
+		}
+		join_node = next_join_node;
+	}
+
+	begin = benchmark_now();
+	for (U32 frame = 0; frame < FRAME_COUNT; ++frame)
+	{
+		scheduler_graph_submit(scheduler, graph);
+		scheduler_graph_wait(scheduler, graph);
+	}
+	benchmark_print_throughput("4 stages x 64 tasks, one graph per frame", FRAME_COUNT * STAGE_COUNT * STAGE_TASK_COUNT, benchmark_now() - begin);
+}
+
+struct Benchmark_Scheduler_Stream_Context
+{
+	U64 chunk_count;
+	U64 checksum;
+};
+
+// Read: generates the chunk, standing in for a file or socket read.
+inline static void
+_benchmark_scheduler_stream_read(U64 *words, U64 chunk_index)
+{
+	U64 state = chunk_index + 1;
+	for (U64 i = 0; i < BENCHMARK_SCHEDULER_STREAM_CHUNK_SIZE / sizeof(U64); ++i)
+		words[i] = benchmark_random(state);
+}
+
+// Parse and transform: one pass over the chunk that rewrites every word in place.
+inline static void
+_benchmark_scheduler_stream_transform(U64 *words)
+{
+	for (U64 i = 0; i < BENCHMARK_SCHEDULER_STREAM_CHUNK_SIZE / sizeof(U64); ++i)
+		words[i] = (words[i] ^ (words[i] >> 29)) * 0xbf58476d1ce4e5b9ull;
+}
+
+// Serialize and write: folds the chunk into an order dependent checksum.
+inline static void
+_benchmark_scheduler_stream_write(const U64 *words, U64 &checksum)
+{
+	checksum = (checksum * 31) ^ words[0] ^ words[BENCHMARK_SCHEDULER_STREAM_CHUNK_SIZE / sizeof(U64) - 1];
+}
+
+/*
+	A stream read in chunks, transformed in parallel and written in order. With groups every stage finishes
+	before the next starts, so the whole data set is in memory at once, which limits that run to a smaller
+	stream. The pipeline keeps two chunks per worker in flight and runs the multi gigabyte stream in that much
+	memory.
+*/
+inline static void
+_benchmark_scheduler_stream(Scheduler *scheduler)
+{
+	constexpr U64 GROUPED_CHUNK_COUNT = BENCHMARK_SCHEDULER_STREAM_GROUPED_SIZE / BENCHMARK_SCHEDULER_STREAM_CHUNK_SIZE;
+	constexpr U64 STREAM_MEGABYTE_COUNT = BENCHMARK_SCHEDULER_STREAM_SIZE >> 20;
+
+	Memory_Block data_set = memory::allocate(BENCHMARK_SCHEDULER_STREAM_GROUPED_SIZE, CACHE_LINE_SIZE);
+	DEFER(memory::deallocate(data_set));
+
+	Benchmark_Scheduler_Stream_Context context = {};
+	Scheduler_Group *group = scheduler_group_init(scheduler);
+	DEFER(scheduler_group_deinit(scheduler, group));
+
+	U64 begin = benchmark_now();
+	for (U64 chunk = 0; chunk < GROUPED_CHUNK_COUNT; ++chunk)
+	{
+		U64 *words = (U64 *)((U8 *)data_set.data + chunk * BENCHMARK_SCHEDULER_STREAM_CHUNK_SIZE);
+		scheduler_submit_fn(scheduler, [words, chunk]() { _benchmark_scheduler_stream_read(words, chunk); }, group);
+	}
+	scheduler_wait_group(scheduler, group);
+	for (U64 chunk = 0; chunk < GROUPED_CHUNK_COUNT; ++chunk)
+	{
+		U64 *words = (U64 *)((U8 *)data_set.data + chunk * BENCHMARK_SCHEDULER_STREAM_CHUNK_SIZE);
+		scheduler_submit_fn(scheduler, [words]() { _benchmark_scheduler_stream_transform(words); }, group);
+	}
+	scheduler_wait_group(scheduler, group);
+	for (U64 chunk = 0; chunk < GROUPED_CHUNK_COUNT; ++chunk)
+		_benchmark_scheduler_stream_write((U64 *)((U8 *)data_set.data + chunk * BENCHMARK_SCHEDULER_STREAM_CHUNK_SIZE), context.checksum);
+	benchmark_print_throughput("stream, group per stage, MB", BENCHMARK_SCHEDULER_STREAM_GROUPED_SIZE >> 20, benchmark_now() - begin);
+	benchmark_print_value("stream, group per stage, peak buffer memory", BENCHMARK_SCHEDULER_STREAM_GROUPED_SIZE >> 20, "MB");
+
+	Scheduler_Pipeline *pipeline = scheduler_pipeline_init(scheduler, Scheduler_Pipeline_Desc {
+		.buffer_size = BENCHMARK_SCHEDULER_STREAM_CHUNK_SIZE
+	});
+	DEFER(scheduler_pipeline_deinit(scheduler, pipeline));
+
+	context.chunk_count = BENCHMARK_SCHEDULER_STREAM_SIZE / BENCHMARK_SCHEDULER_STREAM_CHUNK_SIZE;
+	scheduler_pipeline_add_stage(scheduler, pipeline, Scheduler_Pipeline_Stage {
+		.mode = SCHEDULER_PIPELINE_STAGE_MODE_SERIAL,
+		.function = [](Scheduler_Pipeline_Token *token, void *data) {
+			if (token->index == ((Benchmark_Scheduler_Stream_Context *)data)->chunk_count)
+				return false;
+			_benchmark_scheduler_stream_read((U64 *)token->buffer, token->index);
+			token->size = token->buffer_size;
+			return true;
+		},
+		.data = &context
+	});
+	scheduler_pipeline_add_stage(scheduler, pipeline, Scheduler_Pipeline_Stage {
+		.mode = SCHEDULER_PIPELINE_STAGE_MODE_PARALLEL,
+		.function = [](Scheduler_Pipeline_Token *token, void *) {
+			_benchmark_scheduler_stream_transform((U64 *)token->buffer);
+			return true;
+		}
+	});
+	scheduler_pipeline_add_stage(scheduler, pipeline, Scheduler_Pipeline_Stage {
+		.mode = SCHEDULER_PIPELINE_STAGE_MODE_SERIAL,
+		.function = [](Scheduler_Pipeline_Token *token, void *data) {
+			_benchmark_scheduler_stream_write((const U64 *)token->buffer, ((Benchmark_Scheduler_Stream_Context *)data)->checksum);
+			return true;
+		},
+		.data = &context
+	});
+
+	begin = benchmark_now();
+	scheduler_pipeline_submit(scheduler, pipeline);
+	scheduler_pipeline_wait(scheduler, pipeline);
+	U64 elapsed = benchmark_now() - begin;
+
+	Scheduler_Pipeline_Stats stats = scheduler_pipeline_get_stats(scheduler, pipeline);
+	benchmark_print_throughput("stream, pipeline, MB", STREAM_MEGABYTE_COUNT, elapsed);
+	benchmark_print_value("stream, pipeline, peak buffer memory", stats.buffer_bytes >> 20, "MB");
+	benchmark_print_value("stream, pipeline, peak tokens in flight", stats.max_in_flight_token_count, "tokens");
+	benchmark_consume(context.checksum);
+}
+
+template <typename Run>
+inline static void
+_benchmark_scheduler_case(const char *name, U64 task_count, Run run)
+{
+	Array<U64> samples = array_init<U64>();
+	DEFER(array_deinit(samples));
+
+	// Warmup runs fault in queues, groups and allocator caches, and are not sampled.
+	for (U32 r = 0; r < BENCHMARK_SCHEDULER_WARMUP_COUNT; ++r)
+		run();
+
+	for (U32 r = 0; r < BENCHMARK_SCHEDULER_REPETITION_COUNT; ++r)
+	{
+		U64 begin = benchmark_now();
+		run();
+		array_push(samples, benchmark_now() - begin);
+	}
+
+	Benchmark_Stats stats = benchmark_stats_from(samples);
+	benchmark_print_throughput(name, task_count, stats);
+}
+
+struct Benchmark_Scheduler_Range_Context
+{
+	U32 begin;
+	U32 end;
+	bool is_skewed;
+	Atomic<U64> *counter;
+};
+
+// Uniform items all cost the same, skewed items get 32 times heavier in the last eighth of the range.
+inline static void
+_benchmark_scheduler_range(U32 begin, U32 end, bool is_skewed, Atomic<U64> *counter)
+{
+	U64 value = 0;
+	for (U32 i = begin; i < end; ++i)
+	{
+		U64 state = i;
+		U32 round_count = is_skewed && i >= BENCHMARK_SCHEDULER_RANGE_COUNT / 8 * 7 ? 32 : 1;
+		for (U32 round = 0; round < round_count; ++round)
+			value += benchmark_random(state);
+	}
+	benchmark_consume(value);
+	atomic_fetch_add(*counter, (U64)(end - begin), COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+}
+
+// Lazy splitting against the same range cut into `4 * worker_count` fixed chunks up front.
+inline static void
+_benchmark_scheduler_parallel_for_scaling(Scheduler *scheduler, U32 worker_count)
+{
+	Atomic<U64> counter = atomic_init((U64)0);
+	Scheduler_Group *group = scheduler_group_init(scheduler);
+	DEFER(scheduler_group_deinit(scheduler, group));
+
+	U32 chunk_count = worker_count * 4;
+	Array<Benchmark_Scheduler_Range_Context> chunks = array_init_with_count<Benchmark_Scheduler_Range_Context>(chunk_count);
+	Array<Scheduler_Task> chunk_tasks = array_init_with_count<Scheduler_Task>(chunk_count);
+	DEFER(array_deinit(chunks); array_deinit(chunk_tasks));
+
+	for (bool is_skewed : {false, true})
+	{
+		Benchmark_Scheduler_Range_Context context = {.is_skewed = is_skewed, .counter = &counter};
+		_benchmark_scheduler_case(is_skewed ? "parallel_for skewed, lazy splitting" : "parallel_for uniform, lazy splitting", BENCHMARK_SCHEDULER_RANGE_COUNT, [&]() {
+			scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+				.count = BENCHMARK_SCHEDULER_RANGE_COUNT,
+				.function = [](U32 begin, U32 end, void *data) {
+					Benchmark_Scheduler_Range_Context *context = (Benchmark_Scheduler_Range_Context *)data;
+					_benchmark_scheduler_range(begin, end, context->is_skewed, context->counter);
+				},
+				.data = &context
+			});
+		});
+
+		for (U32 i = 0; i < chunk_count; ++i)
+		{
+			chunks[i] = Benchmark_Scheduler_Range_Context {
+				.begin = (U32)((U64)BENCHMARK_SCHEDULER_RANGE_COUNT * i / chunk_count),
+				.end = (U32)((U64)BENCHMARK_SCHEDULER_RANGE_COUNT * (i + 1) / chunk_count),
+				.is_skewed = is_skewed,
+				.counter = &counter
+			};
+			chunk_tasks[i] = Scheduler_Task {
+				.function = [](void *data) {
+					Benchmark_Scheduler_Range_Context *chunk = (Benchmark_Scheduler_Range_Context *)data;
+					_benchmark_scheduler_range(chunk->begin, chunk->end, chunk->is_skewed, chunk->counter);
+				},
+				.data = &chunks[i]
+			};
+		}
+
+		_benchmark_scheduler_case(is_skewed ? "parallel_for skewed, fixed chunks" : "parallel_for uniform, fixed chunks", BENCHMARK_SCHEDULER_RANGE_COUNT, [&]() {
+			scheduler_submit(scheduler, slice_from(chunk_tasks), group);
+			scheduler_wait_group(scheduler, group);
+		});
+	}
+
+	_benchmark_scheduler_case("parallel_for_2d, 1024 x 1024, default tiles", BENCHMARK_SCHEDULER_RANGE_COUNT, [&]() {
+		scheduler_parallel_for_2d(scheduler, Scheduler_Parallel_For_2D_Desc {
+			.count_x = 1024,
+			.count_y = 1024,
+			.function = [](Scheduler_Tile tile, void *data) {
+				for (U32 y = tile.begin_y; y < tile.end_y; ++y)
+					_benchmark_scheduler_range(y * 1024 + tile.begin_x, y * 1024 + tile.end_x, false, (Atomic<U64> *)data);
+			},
+			.data = &counter
+		});
+	});
+
+	Array<U64> values = array_init_with_count<U64>(BENCHMARK_SCHEDULER_RANGE_COUNT);
+	DEFER(array_deinit(values));
+	for (U32 i = 0; i < BENCHMARK_SCHEDULER_RANGE_COUNT; ++i)
+		values[i] = i;
+
+	_benchmark_scheduler_case("parallel_reduce, sum", BENCHMARK_SCHEDULER_RANGE_COUNT, [&]() {
+		U64 sum = scheduler_parallel_reduce(scheduler, BENCHMARK_SCHEDULER_RANGE_COUNT, (U64)0,
+			[&](U32 begin, U32 end, U64 &partial) {
+				for (U32 i = begin; i < end; ++i)
+					partial += values[i];
+			},
+			[](U64 a, U64 b) { return a + b; });
+		benchmark_consume(sum);
+	});
+
+	_benchmark_scheduler_case("parallel_scan, in place prefix sum", BENCHMARK_SCHEDULER_RANGE_COUNT, [&]() {
+		scheduler_parallel_scan(scheduler, slice_from(values), slice_from(values), (U64)0, [](U64 a, U64 b) { return a + b; });
+	});
+
+	benchmark_consume(atomic_load(counter));
+}
+
+// Many short parallel for calls, where creating, waiting for and releasing the group costs as much as the work.
+inline static void
+_benchmark_scheduler_small_parallel_for(Scheduler *scheduler)
+{
+	constexpr U32 CALL_COUNT = 20'000;
+	constexpr U32 ITEM_COUNT = 256;
+
+	struct Benchmark_Scheduler_Small_Parallel_For_Context
+	{
+		Scheduler *scheduler;
+		Atomic<U64> counter;
+	};
+
+	Benchmark_Scheduler_Small_Parallel_For_Context context = {.scheduler = scheduler};
+	auto run_calls = [](Benchmark_Scheduler_Small_Parallel_For_Context *context) {
+		for (U32 i = 0; i < CALL_COUNT; ++i)
+		{
+			scheduler_parallel_for(context->scheduler, Scheduler_Parallel_For_Desc {
+				.count = ITEM_COUNT,
+				.chunk_size = 16,
+				.function = [](U32 begin, U32 end, void *data) {
+					_benchmark_scheduler_range(begin, end, false, (Atomic<U64> *)data);
+				},
+				.data = &context->counter
+			});
+		}
+	};
+
+	_benchmark_scheduler_case("small parallel_for calls, external thread", CALL_COUNT, [&]() {
+		run_calls(&context);
+	});
+
+	_benchmark_scheduler_case("small parallel_for calls, inside a task", CALL_COUNT, [&]() {
+		scheduler_submit_fn(scheduler, [&context, run_calls]() {
+			run_calls(&context);
+		});
+		scheduler_wait_all(scheduler);
+	});
+
+	benchmark_consume(atomic_load(context.counter));
+}
+
+struct Benchmark_Scheduler_Fork_Join_Context
+{
+	Scheduler *scheduler;
+	U32 depth;
+};
+
+// A binary tree of tasks: each node forks one child as a task, runs the other inline and joins on its group.
+inline static void
+_benchmark_scheduler_fork_join_task(void *data)
+{
+	Benchmark_Scheduler_Fork_Join_Context *context = (Benchmark_Scheduler_Fork_Join_Context *)data;
+	if (context->depth == 0)
+		return;
+
+	Benchmark_Scheduler_Fork_Join_Context children[2] = {
+		{.scheduler = context->scheduler, .depth = context->depth - 1},
+		{.scheduler = context->scheduler, .depth = context->depth - 1}
+	};
+
+	Scheduler_Group *group = scheduler_group_init(context->scheduler);
+	scheduler_submit(context->scheduler, Scheduler_Task{.function = _benchmark_scheduler_fork_join_task, .data = &children[0]}, group);
+	_benchmark_scheduler_fork_join_task(&children[1]);
+	scheduler_wait_group(context->scheduler, group);
+	scheduler_group_deinit(context->scheduler, group);
+}
+
+inline static void
+_benchmark_scheduler_fork_join(Scheduler *scheduler)
+{
+	for (U32 depth : {8u, 16u})
+	{
+		Benchmark_Scheduler_Fork_Join_Context root = {.scheduler = scheduler, .depth = depth};
+		String name = format("fork/join, binary tree of depth {}", depth);
+		_benchmark_scheduler_case(name.data, (1ull << (depth + 1)) - 1, [&]() {
+			scheduler_submit(scheduler, Scheduler_Task{.function = _benchmark_scheduler_fork_join_task, .data = &root});
+			scheduler_wait_all(scheduler);
+		});
+		string_deinit(name);
+	}
+}
+
+struct Benchmark_Scheduler_Helping_Context
+{
+	Scheduler *scheduler;
+	Scheduler_Task *middle_tasks;
+	Scheduler_Task *leaf_tasks;
+};
+
+// Two levels of waits: a root waits on 8 tasks that each wait on 64 leaves, so every waiting worker has to help to make progress.
+inline static void
+_benchmark_scheduler_helping_middle_task(void *data)
+{
+	Benchmark_Scheduler_Helping_Context *context = (Benchmark_Scheduler_Helping_Context *)data;
+	Scheduler_Group *group = scheduler_group_init(context->scheduler);
+	scheduler_submit(context->scheduler, slice_from(context->leaf_tasks, BENCHMARK_SCHEDULER_FAN_OUT_COUNT), group);
+	scheduler_wait_group(context->scheduler, group);
+	scheduler_group_deinit(context->scheduler, group);
+}
+
+inline static void
+_benchmark_scheduler_helping_root_task(void *data)
+{
+	Benchmark_Scheduler_Helping_Context *context = (Benchmark_Scheduler_Helping_Context *)data;
+	Scheduler_Group *group = scheduler_group_init(context->scheduler);
+	scheduler_submit(context->scheduler, slice_from(context->middle_tasks, 8), group);
+	scheduler_wait_group(context->scheduler, group);
+	scheduler_group_deinit(context->scheduler, group);
+}
+
+inline static void
+_benchmark_scheduler_wait_group_helping(Scheduler *scheduler, Slice<const Scheduler_Task> tasks)
+{
+	constexpr U32 ROOT_TASK_COUNT = 256;
+
+	Benchmark_Scheduler_Helping_Context context = {
+		.scheduler = scheduler,
+		.leaf_tasks = (Scheduler_Task *)tasks.data
+	};
+
+	Scheduler_Task middle_tasks[8];
+	for (Scheduler_Task &task : middle_tasks)
+		task = Scheduler_Task{.function = _benchmark_scheduler_helping_middle_task, .data = &context};
+	context.middle_tasks = middle_tasks;
+
+	Array<Scheduler_Task> root_tasks = array_init_with_count<Scheduler_Task>(ROOT_TASK_COUNT);
+	DEFER(array_deinit(root_tasks));
+	for (Scheduler_Task &task : root_tasks)
+		task = Scheduler_Task{.function = _benchmark_scheduler_helping_root_task, .data = &context};
+
+	_benchmark_scheduler_case("wait_group helping, 8 x 64 nested children", ROOT_TASK_COUNT * (1 + 8 * (1 + BENCHMARK_SCHEDULER_FAN_OUT_COUNT)), [&]() {
+		scheduler_submit(scheduler, slice_from(root_tasks));
+		scheduler_wait_all(scheduler);
+	});
+}
+
+struct Benchmark_Scheduler_Submit_Sample
+{
+	U64 submit_time;
+	U64 call_microseconds;
+	Atomic<U64> start_time;
+};
+
+struct Benchmark_Scheduler_Submitter
+{
+	Scheduler *scheduler;
+	Scheduler_Group *group;
+	Benchmark_Scheduler_Submit_Sample *samples;
+	U32 sample_count;
+};
+
+inline static void
+_benchmark_scheduler_submit_sample_task(void *data)
+{
+	Benchmark_Scheduler_Submit_Sample *sample = (Benchmark_Scheduler_Submit_Sample *)data;
+	atomic_store(sample->start_time, benchmark_now());
+}
+
+inline static void
+_benchmark_scheduler_submitter_thread(void *data)
+{
+	Benchmark_Scheduler_Submitter *submitter = (Benchmark_Scheduler_Submitter *)data;
+	for (U32 i = 0; i < submitter->sample_count; ++i)
+	{
+		Benchmark_Scheduler_Submit_Sample *sample = &submitter->samples[i];
+		sample->submit_time = benchmark_now();
+		scheduler_submit(submitter->scheduler, Scheduler_Task{.function = _benchmark_scheduler_submit_sample_task, .data = sample}, submitter->group);
+		sample->call_microseconds = benchmark_now() - sample->submit_time;
+	}
+}
+
+// Several threads outside the scheduler submitting single tasks at once: the cost of the submit call and the time until the task starts.
+inline static void
+_benchmark_scheduler_external_submit_latency(Scheduler *scheduler)
+{
+	constexpr U32 SAMPLE_COUNT = 2'000;
+	constexpr U32 MAX_THREAD_COUNT = 4;
+
+	Scheduler_Group *group = scheduler_group_init(scheduler);
+	DEFER(scheduler_group_deinit(scheduler, group));
+
+	Array<Benchmark_Scheduler_Submit_Sample> samples = array_init_with_count<Benchmark_Scheduler_Submit_Sample>(SAMPLE_COUNT * MAX_THREAD_COUNT);
+	Array<U64> call_samples = array_init<U64>();
+	Array<U64> start_samples = array_init<U64>();
+	DEFER(array_deinit(samples); array_deinit(call_samples); array_deinit(start_samples));
+
+	for (U32 thread_count : {1u, MAX_THREAD_COUNT})
+	{
+		Benchmark_Scheduler_Submitter submitters[MAX_THREAD_COUNT] = {};
+		Platform_Thread *threads[MAX_THREAD_COUNT] = {};
+		for (U32 i = 0; i < thread_count; ++i)
+		{
+			submitters[i] = Benchmark_Scheduler_Submitter {
+				.scheduler = scheduler,
+				.group = group,
+				.samples = &samples[i * SAMPLE_COUNT],
+				.sample_count = SAMPLE_COUNT
+			};
+			threads[i] = platform_thread_init(Platform_Thread_Desc {
+				.function = _benchmark_scheduler_submitter_thread,
+				.data = &submitters[i],
+				.name = "bench submit"
+			});
+		}
+		for (U32 i = 0; i < thread_count; ++i)
+			platform_thread_deinit(threads[i]);
+		scheduler_wait_group(scheduler, group);
+
+		array_clear(call_samples);
+		array_clear(start_samples);
+		for (U32 i = 0; i < thread_count * SAMPLE_COUNT; ++i)
+		{
+			array_push(call_samples, samples[i].call_microseconds);
+			array_push(start_samples, atomic_load(samples[i].start_time) - samples[i].submit_time);
+		}
+
+		String name = format("submit call, {} external threads", thread_count);
+		benchmark_print_latency(name.data, benchmark_stats_from(call_samples), "us");
+		string_deinit(name);
+
+		name = format("submit to start, {} external threads", thread_count);
+		benchmark_print_latency(name.data, benchmark_stats_from(start_samples), "us");
+		string_deinit(name);
+	}
+}
+
+inline static void
+_benchmark_scheduler_blocking_task(void *data)
+{
+	Scheduler *scheduler = (Scheduler *)data;
+	scheduler_worker_block_ahead(scheduler);
+	platform_thread_sleep(10);
+	scheduler_worker_block_clear(scheduler);
+}
+
+// Every worker sleeps 10 ms inside a blocking marker while a batch of short tasks waits behind them, without and with replacement workers.
+inline static void
+_benchmark_scheduler_blocking_replacement(U32 worker_count, Slice<const Scheduler_Task> tasks)
+{
+	constexpr U32 TASK_COUNT = 10'000;
+
+	for (U32 replacement_worker_count : {0u, worker_count})
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = worker_count,
+			.replacement_worker_count = replacement_worker_count
+		});
+		DEFER(scheduler_deinit(scheduler));
+
+		Scheduler_Group *blocking_group = scheduler_group_init(scheduler);
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+		DEFER(scheduler_group_deinit(scheduler, blocking_group); scheduler_group_deinit(scheduler, group));
+
+		Array<Scheduler_Task> blocking_tasks = array_init_with_count<Scheduler_Task>(worker_count);
+		DEFER(array_deinit(blocking_tasks));
+		for (Scheduler_Task &task : blocking_tasks)
+			task = Scheduler_Task{.function = _benchmark_scheduler_blocking_task, .data = scheduler};
+
+		// Measures until the short tasks are done, the blocked workers are joined afterwards.
+		Array<U64> samples = array_init<U64>();
+		DEFER(array_deinit(samples));
+		for (U32 r = 0; r < BENCHMARK_SCHEDULER_WARMUP_COUNT + BENCHMARK_SCHEDULER_REPETITION_COUNT; ++r)
+		{
+			U64 begin = benchmark_now();
+			scheduler_submit(scheduler, slice_from(blocking_tasks), blocking_group);
+			scheduler_submit(scheduler, slice_from(tasks.data, TASK_COUNT), group);
+			scheduler_wait_group(scheduler, group);
+			U64 elapsed = benchmark_now() - begin;
+			scheduler_wait_group(scheduler, blocking_group);
+			if (r >= BENCHMARK_SCHEDULER_WARMUP_COUNT)
+				array_push(samples, elapsed);
+		}
+
+		benchmark_print_throughput(replacement_worker_count == 0 ? "short tasks, blocked workers, no replacement" : "short tasks, blocked workers, replacement", TASK_COUNT, benchmark_stats_from(samples));
+	}
+}
+
+inline static void
+_benchmark_scheduler_worker_count(U32 worker_count)
+{
+	String section_name = format("Tasks per second, {} workers", worker_count);
+	benchmark_print_section(section_name.data);
+	string_deinit(section_name);
+
+	Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = worker_count,
+		.initial_task_queue_capacity = BENCHMARK_SCHEDULER_TASK_COUNT
+	});
+	DEFER(scheduler_deinit(scheduler));
+
+	Atomic<U64> counter = atomic_init((U64)0);
+	Array<Scheduler_Task> tasks = array_init_with_count<Scheduler_Task>(BENCHMARK_SCHEDULER_TASK_COUNT);
+	DEFER(array_deinit(tasks));
+	for (Scheduler_Task &task : tasks)
+		task = Scheduler_Task{.function = _benchmark_scheduler_leaf_task, .data = &counter};
+
+	_benchmark_scheduler_case("external submit, one task per call", BENCHMARK_SCHEDULER_TASK_COUNT, [&]() {
+		for (const Scheduler_Task &task : tasks)
+			scheduler_submit(scheduler, task);
+		scheduler_wait_all(scheduler);
+	});
+
+	_benchmark_scheduler_case("external submit, one batch", BENCHMARK_SCHEDULER_TASK_COUNT, [&]() {
+		scheduler_submit(scheduler, slice_from(tasks));
+		scheduler_wait_all(scheduler);
+	});
+
+	Array<Scheduler_Task> empty_tasks = array_init_with_count<Scheduler_Task>(BENCHMARK_SCHEDULER_TASK_COUNT);
+	DEFER(array_deinit(empty_tasks));
+	array_fill(empty_tasks, Scheduler_Task{.function = _benchmark_scheduler_empty_task});
+
+	_benchmark_scheduler_case("empty tasks, one batch", BENCHMARK_SCHEDULER_TASK_COUNT, [&]() {
+		scheduler_submit(scheduler, slice_from(empty_tasks));
+		scheduler_wait_all(scheduler);
+	});
+
+	constexpr U32 ROOT_TASK_COUNT = BENCHMARK_SCHEDULER_TASK_COUNT / BENCHMARK_SCHEDULER_FAN_OUT_COUNT;
+	Benchmark_Scheduler_Fan_Out_Context fan_out_context = {
+		.scheduler = scheduler,
+		.leaf_tasks = tasks.data
+	};
+	Array<Scheduler_Task> root_tasks = array_init_with_count<Scheduler_Task>(ROOT_TASK_COUNT);
+	DEFER(array_deinit(root_tasks));
+	for (Scheduler_Task &task : root_tasks)
+		task = Scheduler_Task{.function = _benchmark_scheduler_fan_out_task, .data = &fan_out_context};
+
+	_benchmark_scheduler_case("worker fan-out, 64 children per task", ROOT_TASK_COUNT * (BENCHMARK_SCHEDULER_FAN_OUT_COUNT + 1), [&]() {
+		scheduler_submit(scheduler, slice_from(root_tasks));
+		scheduler_wait_all(scheduler);
+	});
+
+	_benchmark_scheduler_case("parallel_for, chunk size 1", BENCHMARK_SCHEDULER_TASK_COUNT, [&]() {
+		scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+			.count = BENCHMARK_SCHEDULER_TASK_COUNT,
+			.chunk_size = 1,
+			.function = [](U32 begin, U32 end, void *data) {
+				for (U32 i = begin; i < end; ++i)
+					_benchmark_scheduler_leaf_task(data);
+			},
+			.data = &counter
+		});
+	});
+
+	_benchmark_scheduler_fork_join(scheduler);
+	_benchmark_scheduler_wait_group_helping(scheduler, slice_from(tasks));
+	_benchmark_scheduler_parallel_for_scaling(scheduler, worker_count);
+	_benchmark_scheduler_small_parallel_for(scheduler);
+	_benchmark_scheduler_stages(scheduler, slice_from(tasks));
+	_benchmark_scheduler_stream(scheduler);
+	_benchmark_scheduler_wakeup_latency(scheduler);
+	_benchmark_scheduler_external_submit_latency(scheduler);
+	_benchmark_scheduler_cpu_burn(scheduler, slice_from(tasks));
+	_benchmark_scheduler_blocking_replacement(worker_count, slice_from(tasks));
+
+	benchmark_consume(atomic_load(counter));
+}
+
+// Pass `--json <path>` to also write every result with its percentiles as JSON.
+I32
+main(I32 argument_count, char **arguments)
+{
+	benchmark_report_begin("scheduler", argument_count, arguments);
+
+	U32 logical_processor_count = platform_get_logical_processor_count();
+	for (U32 worker_count = 1; worker_count < logical_processor_count; worker_count *= 2)
+		_benchmark_scheduler_worker_count(worker_count);
+	_benchmark_scheduler_worker_count(logical_processor_count);
+
+	return benchmark_report_end() ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "benchmark.h"
+
+#include <core/defer.h>
+#include <core/sort.h>
+#include <core/scheduler.h>
+#include <core/math/u64.h>
+
+#include <algorithm>
+
+struct Benchmark_Sort_Record
+{
+	U64 key;
+	U64 payload[3];
+};
+
+inline static U64
+_benchmark_sort_repetition_count(U64 count)
+{
+	return u64_clamp(10'000'000 / count, 3, 50);
+}
+
+// Each repetition sorts a fresh copy of `input`; only the sort itself is timed.
+template <typename T, typename Sort>
+inline static void
+_benchmark_sort_case(const char *name, const Array<T> &input, Sort sort)
+{
+	Array<T> values = array_init_with_count<T>(input.count);
+	Array<U64> samples = array_init<U64>();
+	DEFER(array_deinit(values); array_deinit(samples));
+
+	U64 repetition_count = _benchmark_sort_repetition_count(input.count);
+	for (U64 r = 0; r < repetition_count; ++r)
+	{
+		for (U64 i = 0; i < input.count; ++i)
+			values[i] = input[i];
+
+		U64 begin = benchmark_now();
+		sort(values);
+		array_push(samples, benchmark_now() - begin);
+	}
+
+	Benchmark_Stats stats = benchmark_stats_from(samples);
+	benchmark_print_throughput(name, input.count, stats.p50);
+}
+
+template <typename T, typename Less = Sort_Less>
+inline static void
+_benchmark_sort_comparison_sorts(Scheduler *scheduler, const Array<T> &input, Less less = {})
+{
+	_benchmark_sort_case("std::sort", input, [&](Array<T> &values) { std::sort(values.data, values.data + values.count, less); });
+	_benchmark_sort_case("array_sort", input, [&](Array<T> &values) { array_sort(values, less); });
+	_benchmark_sort_case("array_sort_parallel", input, [&](Array<T> &values) { array_sort_parallel(scheduler, values, less); });
+}
+
+I32
+main(I32, char **)
+{
+	Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = platform_get_logical_processor_count()
+	});
+	DEFER(scheduler_deinit(scheduler));
+
+	for (U64 count : {1'000, 100'000, 1'000'000, 10'000'000})
+	{
+		U64 random_state = count;
+
+		Array<U32> random_u32 = array_init_with_count<U32>(count);
+		Array<U32> sorted_u32 = array_init_with_count<U32>(count);
+		Array<U32> reversed_u32 = array_init_with_count<U32>(count);
+		Array<F32> random_f32 = array_init_with_count<F32>(count);
+		Array<Benchmark_Sort_Record> records = array_init_with_count<Benchmark_Sort_Record>(count);
+		DEFER(array_deinit(random_u32); array_deinit(sorted_u32); array_deinit(reversed_u32); array_deinit(random_f32); array_deinit(records));
+
+		for (U64 i = 0; i < count; ++i)
+		{
+			random_u32[i] = (U32)benchmark_random(random_state);
+			sorted_u32[i] = (U32)i;
+			reversed_u32[i] = (U32)(count - i);
+			random_f32[i] = (F32)((I64)(benchmark_random(random_state) % 2'000'001) - 1'000'000) * 0.001f;
+			records[i] = Benchmark_Sort_Record{.key = benchmark_random(random_state)};
+		}
+
+		String section_name = format("Random U32, {} elements", count);
+		benchmark_print_section(section_name.data);
+		string_deinit(section_name);
+		_benchmark_sort_comparison_sorts(scheduler, random_u32);
+		_benchmark_sort_case("array_radix_sort", random_u32, [](Array<U32> &values) { array_radix_sort(values); });
+
+		section_name = format("Sorted / reversed U32, {} elements", count);
+		benchmark_print_section(section_name.data);
+		string_deinit(section_name);
+		_benchmark_sort_case("std::sort sorted", sorted_u32, [](Array<U32> &values) { std::sort(values.data, values.data + values.count); });
+		_benchmark_sort_case("array_sort sorted", sorted_u32, [](Array<U32> &values) { array_sort(values); });
+		_benchmark_sort_case("std::sort reversed", reversed_u32, [](Array<U32> &values) { std::sort(values.data, values.data + values.count); });
+		_benchmark_sort_case("array_sort reversed", reversed_u32, [](Array<U32> &values) { array_sort(values); });
+
+		section_name = format("Random F32, {} elements", count);
+		benchmark_print_section(section_name.data);
+		string_deinit(section_name);
+		_benchmark_sort_comparison_sorts(scheduler, random_f32);
+		_benchmark_sort_case("array_radix_sort", random_f32, [](Array<F32> &values) { array_radix_sort(values); });
+
+		section_name = format("32-byte records by U64 key, {} elements", count);
+		benchmark_print_section(section_name.data);
+		string_deinit(section_name);
+		auto record_less = [](const Benchmark_Sort_Record &a, const Benchmark_Sort_Record &b) { return a.key < b.key; };
+		_benchmark_sort_comparison_sorts(scheduler, records, record_less);
+		_benchmark_sort_case("array_radix_sort by key", records, [](Array<Benchmark_Sort_Record> &values) {
+			array_radix_sort(values, [](const Benchmark_Sort_Record &record) { return record.key; });
+		});
+
+		section_name = format("Search in sorted U32, {} elements", count);
+		benchmark_print_section(section_name.data);
+		string_deinit(section_name);
+		{
+			constexpr U64 QUERY_COUNT = 1'000'000;
+			U64 found_count = 0;
+			U64 begin = benchmark_now();
+			for (U64 i = 0; i < QUERY_COUNT; ++i)
+				found_count += array_binary_search(sorted_u32, (U32)(benchmark_random(random_state) % (count * 2))) ? 1 : 0;
+			benchmark_print_throughput("array_binary_search", QUERY_COUNT, benchmark_now() - begin);
+			benchmark_consume(found_count);
+
+			U64 index_sum = 0;
+			begin = benchmark_now();
+			for (U64 i = 0; i < QUERY_COUNT; ++i)
+				index_sum += array_lower_bound(sorted_u32, (U32)(benchmark_random(random_state) % (count * 2)));
+			benchmark_print_throughput("array_lower_bound", QUERY_COUNT, benchmark_now() - begin);
+			benchmark_consume(index_sum);
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -119,4 +119,54 @@ inline static U64
 compiler_atomic_fetch_sub_u64(U64 *target, U64 value, Compiler_Atomic_Memory_Order order = COMPILER_ATOMIC_MEMORY_ORDER_SEQUENTIAL)
 {
 	return __atomic_fetch_sub(target, value, _compiler_atomic_memory_order(order));
+}
+
+inline static void
+compiler_cpu_pause()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+inline static U32
+compiler_popcount_u32(U32 x)
+{
+	return (U32)__builtin_popcount(x);
+}
+
+inline static U32
+compiler_popcount_u64(U64 x)
+{
+	return (U32)__builtin_popcountll(x);
+}
+
+// Undefined for 0.
+inline static U32
+compiler_leading_zero_count_u32(U32 x)
+{
+	return (U32)__builtin_clz(x);
+}
+
+// Undefined for 0.
+inline static U32
+compiler_leading_zero_count_u64(U64 x)
+{
+	return (U32)__builtin_clzll(x);
+}
+
+// Undefined for 0.
+inline static U32
+compiler_trailing_zero_count_u32(U32 x)
+{
+	return (U32)__builtin_ctz(x);
+}
+
+// Undefined for 0.
+inline static U32
+compiler_trailing_zero_count_u64(U64 x)
+{
+	return (U32)__builtin_ctzll(x);
 }
\ No newline at end of file
@@ -113,4 +113,72 @@ compiler_atomic_fetch_sub_u64(U64 *target, U64 value, Compiler_Atomic_Memory_Ord
 		if (compiler_atomic_compare_exchange_u64(target, expected, desired, order))
 			return expected;
 	}
+}
+
+inline static void
+compiler_cpu_pause()
+{
+#if defined(_M_X64) || defined(_M_IX86)
+	_mm_pause();
+#elif defined(_M_ARM64) || defined(_M_ARM)
+	__yield();
+#endif
+}
+
+inline static U32
+compiler_popcount_u32(U32 x)
+{
+#if defined(_M_ARM64) || defined(_M_ARM)
+	return (U32)_CountOneBits(x);
+#else
+	return (U32)__popcnt(x);
+#endif
+}
+
+inline static U32
+compiler_popcount_u64(U64 x)
+{
+#if defined(_M_ARM64)
+	return (U32)_CountOneBits64(x);
+#elif defined(_M_X64)
+	return (U32)__popcnt64(x);
+#else
+	return (U32)__popcnt((U32)x) + (U32)__popcnt((U32)(x >> 32));
+#endif
+}
+
+// Undefined for 0.
+inline static U32
+compiler_leading_zero_count_u32(U32 x)
+{
+	unsigned long index = 0;
+	_BitScanReverse(&index, x);
+	return 31 - (U32)index;
+}
+
+// Undefined for 0.
+inline static U32
+compiler_leading_zero_count_u64(U64 x)
+{
+	unsigned long index = 0;
+	_BitScanReverse64(&index, x);
+	return 63 - (U32)index;
+}
+
+// Undefined for 0.
+inline static U32
+compiler_trailing_zero_count_u32(U32 x)
+{
+	unsigned long index = 0;
+	_BitScanForward(&index, x);
+	return (U32)index;
+}
+
+// Undefined for 0.
+inline static U32
+compiler_trailing_zero_count_u64(U64 x)
+{
+	unsigned long index = 0;
+	_BitScanForward64(&index, x);
+	return (U32)index;
 }
\ No newline at end of file
@@ -0,0 +1,838 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/defer.h"
+#include "core/validate.h"
+#include "core/memory/allocator.h"
+#include "core/containers/array.h"
+#include "core/containers/slice.h"
+
+#include <type_traits>
+
+/*
+	Ordered map stored as a B+ tree. Every key/value pair lives in a leaf, leaves are linked in key
+	order, and inner nodes only hold separator keys for routing. Node fan-out is chosen so a node spans
+	a few cache lines, and a key is searched with a linear scan inside each node.
+
+	Leaf and inner nodes are allocated with the same size, `B_Tree_Map<K, V>::NODE_SIZE`, so a
+	`memory::Pool_Allocator` with that chunk size can serve every node of a map.
+
+	Keys are ordered with `operator<`. Pointers and iterators are invalidated by any insert or remove.
+*/
+
+constexpr U64 B_TREE_MAP_NODE_TARGET_SIZE = 4 * CACHE_LINE_SIZE;
+constexpr U64 B_TREE_MAP_MAX_HEIGHT = 32;
+
+template <typename K, typename V>
+struct B_Tree_Map_Entry
+{
+	K key;
+	V value;
+};
+
+struct B_Tree_Map_Node
+{
+	U32 count;
+	bool is_leaf;
+};
+
+template <typename K, typename V>
+struct B_Tree_Map_Leaf
+{
+	static constexpr U64 CAPACITY = (B_TREE_MAP_NODE_TARGET_SIZE - sizeof(B_Tree_Map_Node) - sizeof(void *)) / (sizeof(K) + sizeof(V)) > 4
+		? (B_TREE_MAP_NODE_TARGET_SIZE - sizeof(B_Tree_Map_Node) - sizeof(void *)) / (sizeof(K) + sizeof(V))
+		: 4;
+	static constexpr U64 MIN_COUNT = CAPACITY / 2;
+
+	B_Tree_Map_Node header;
+	B_Tree_Map_Leaf *next;
+	K keys[CAPACITY];
+	V values[CAPACITY];
+};
+
+template <typename K>
+struct B_Tree_Map_Inner
+{
+	static constexpr U64 CAPACITY = (B_TREE_MAP_NODE_TARGET_SIZE - sizeof(B_Tree_Map_Node) - sizeof(void *)) / (sizeof(K) + sizeof(void *)) > 4
+		? (B_TREE_MAP_NODE_TARGET_SIZE - sizeof(B_Tree_Map_Node) - sizeof(void *)) / (sizeof(K) + sizeof(void *))
+		: 4;
+	static constexpr U64 MIN_COUNT = (CAPACITY - 1) / 2;
+
+	B_Tree_Map_Node header;
+	B_Tree_Map_Node *children[CAPACITY + 1];
+	K keys[CAPACITY];
+};
+
+template <typename K, typename V>
+struct B_Tree_Map_Entry_Ref
+{
+	const K &key;
+	V &value;
+};
+
+// `TValue` is `const V` for iterators of a const map, which only hand out const values.
+template <typename K, typename V, typename TValue = V>
+struct B_Tree_Map_Iterator
+{
+	B_Tree_Map_Leaf<K, V> *leaf;
+	U64 index;
+
+	inline B_Tree_Map_Entry_Ref<K, TValue>
+	operator*() const
+	{
+		validate(leaf != nullptr, "[B_TREE_MAP]: Dereferencing end iterator.");
+		return B_Tree_Map_Entry_Ref<K, TValue>{leaf->keys[index], leaf->values[index]};
+	}
+
+	inline B_Tree_Map_Iterator &
+	operator++()
+	{
+		if (++index == leaf->header.count)
+		{
+			leaf = leaf->next;
+			index = 0;
+		}
+		return *this;
+	}
+
+	inline bool
+	operator==(const B_Tree_Map_Iterator &other) const
+	{
+		return leaf == other.leaf && index == other.index;
+	}
+
+	inline bool
+	operator!=(const B_Tree_Map_Iterator &other) const
+	{
+		return !(*this == other);
+	}
+};
+
+template <typename K, typename V>
+using B_Tree_Map_Const_Iterator = B_Tree_Map_Iterator<K, V, const V>;
+
+// Half-open range of entries, usable in range-based `for`.
+template <typename K, typename V, typename TValue = V>
+struct B_Tree_Map_Range
+{
+	B_Tree_Map_Iterator<K, V, TValue> first;
+	B_Tree_Map_Iterator<K, V, TValue> last;
+};
+
+template <typename K, typename V>
+using B_Tree_Map_Const_Range = B_Tree_Map_Range<K, V, const V>;
+
+template <typename K, typename V>
+struct B_Tree_Map
+{
+	using Leaf = B_Tree_Map_Leaf<K, V>;
+	using Inner = B_Tree_Map_Inner<K>;
+
+	static constexpr U64 NODE_SIZE = sizeof(Leaf) > sizeof(Inner) ? sizeof(Leaf) : sizeof(Inner);
+	static constexpr U64 NODE_ALIGNMENT = alignof(Leaf) > alignof(Inner) ? alignof(Leaf) : alignof(Inner);
+
+	memory::Allocator *allocator;
+	B_Tree_Map_Node *root;
+	Leaf *first_leaf;
+	U64 count;
+	U64 height;
+};
+
+template <typename K, typename V>
+inline static B_Tree_Map<K, V>
+b_tree_map_init(memory::Allocator *allocator = memory::heap_allocator())
+{
+	return B_Tree_Map<K, V> {
+		.allocator = allocator ? allocator : memory::heap_allocator(),
+		.root = nullptr,
+		.first_leaf = nullptr,
+		.count = 0,
+		.height = 0
+	};
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map_Node *
+_b_tree_map_node_allocate(B_Tree_Map<K, V> &self, bool is_leaf)
+{
+	B_Tree_Map_Node *node = (B_Tree_Map_Node *)memory::allocate(self.allocator, B_Tree_Map<K, V>::NODE_SIZE, B_Tree_Map<K, V>::NODE_ALIGNMENT).data;
+	node->count = 0;
+	node->is_leaf = is_leaf;
+	if (is_leaf)
+		((B_Tree_Map_Leaf<K, V> *)node)->next = nullptr;
+	return node;
+}
+
+template <typename K, typename V>
+inline static void
+_b_tree_map_node_deallocate(B_Tree_Map<K, V> &self, B_Tree_Map_Node *node)
+{
+	memory::deallocate(self.allocator, Memory_Block{node, B_Tree_Map<K, V>::NODE_SIZE});
+}
+
+template <typename K, typename V>
+inline static void
+_b_tree_map_node_deallocate_recursive(B_Tree_Map<K, V> &self, B_Tree_Map_Node *node)
+{
+	if (!node->is_leaf)
+	{
+		B_Tree_Map_Inner<K> *inner = (B_Tree_Map_Inner<K> *)node;
+		for (U64 i = 0; i <= inner->header.count; ++i)
+			_b_tree_map_node_deallocate_recursive(self, inner->children[i]);
+	}
+	_b_tree_map_node_deallocate(self, node);
+}
+
+template <typename K, typename V>
+inline static void
+b_tree_map_clear(B_Tree_Map<K, V> &self)
+{
+	if (self.root)
+		_b_tree_map_node_deallocate_recursive(self, self.root);
+	self.root = nullptr;
+	self.first_leaf = nullptr;
+	self.count = 0;
+	self.height = 0;
+}
+
+template <typename K, typename V>
+inline static void
+b_tree_map_deinit(B_Tree_Map<K, V> &self)
+{
+	b_tree_map_clear(self);
+}
+
+// Index of the child to descend into, the number of separators that are <= key.
+template <typename K>
+inline static U64
+_b_tree_map_inner_child_index(const B_Tree_Map_Inner<K> *inner, const K &key)
+{
+	U64 index = 0;
+	while (index < inner->header.count && !(key < inner->keys[index]))
+		++index;
+	return index;
+}
+
+// Index of the first key that is not less than `key`.
+template <typename K, typename V>
+inline static U64
+_b_tree_map_leaf_lower_bound(const B_Tree_Map_Leaf<K, V> *leaf, const K &key)
+{
+	U64 index = 0;
+	while (index < leaf->header.count && leaf->keys[index] < key)
+		++index;
+	return index;
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map_Leaf<K, V> *
+_b_tree_map_find_leaf(const B_Tree_Map<K, V> &self, const K &key)
+{
+	B_Tree_Map_Node *node = self.root;
+	while (node && !node->is_leaf)
+	{
+		B_Tree_Map_Inner<K> *inner = (B_Tree_Map_Inner<K> *)node;
+		node = inner->children[_b_tree_map_inner_child_index(inner, key)];
+	}
+	return (B_Tree_Map_Leaf<K, V> *)node;
+}
+
+template <typename K, typename V>
+inline static V *
+b_tree_map_find(B_Tree_Map<K, V> &self, const K &key)
+{
+	B_Tree_Map_Leaf<K, V> *leaf = _b_tree_map_find_leaf(self, key);
+	if (leaf == nullptr)
+		return nullptr;
+	U64 index = _b_tree_map_leaf_lower_bound(leaf, key);
+	if (index == leaf->header.count || key < leaf->keys[index])
+		return nullptr;
+	return &leaf->values[index];
+}
+
+template <typename K, typename V>
+inline static const V *
+b_tree_map_find(const B_Tree_Map<K, V> &self, const K &key)
+{
+	return b_tree_map_find((B_Tree_Map<K, V> &)self, key);
+}
+
+template <typename K, typename V>
+inline static bool
+b_tree_map_contains(const B_Tree_Map<K, V> &self, const K &key)
+{
+	return b_tree_map_find(self, key) != nullptr;
+}
+
+// Inserts or overwrites. Returns a pointer to the stored value.
+template <typename K, typename V>
+inline static V *
+b_tree_map_insert(B_Tree_Map<K, V> &self, const K &key, const V &value)
+{
+	using Leaf = B_Tree_Map_Leaf<K, V>;
+	using Inner = B_Tree_Map_Inner<K>;
+
+	if (self.root == nullptr)
+	{
+		if (self.allocator == nullptr)
+			self.allocator = memory::heap_allocator();
+		self.root = _b_tree_map_node_allocate(self, true);
+		self.first_leaf = (Leaf *)self.root;
+		self.height = 1;
+	}
+
+	Inner *path_nodes[B_TREE_MAP_MAX_HEIGHT];
+	U64 path_indices[B_TREE_MAP_MAX_HEIGHT];
+	U64 path_count = 0;
+
+	B_Tree_Map_Node *node = self.root;
+	while (!node->is_leaf)
+	{
+		Inner *inner = (Inner *)node;
+		U64 child_index = _b_tree_map_inner_child_index(inner, key);
+		path_nodes[path_count] = inner;
+		path_indices[path_count] = child_index;
+		++path_count;
+		node = inner->children[child_index];
+	}
+
+	Leaf *leaf = (Leaf *)node;
+	U64 index = _b_tree_map_leaf_lower_bound(leaf, key);
+	if (index < leaf->header.count && !(key < leaf->keys[index]))
+	{
+		leaf->values[index] = value;
+		return &leaf->values[index];
+	}
+
+	++self.count;
+
+	if (leaf->header.count < Leaf::CAPACITY)
+	{
+		for (U64 i = leaf->header.count; i > index; --i)
+		{
+			leaf->keys[i] = leaf->keys[i - 1];
+			leaf->values[i] = leaf->values[i - 1];
+		}
+		leaf->keys[index] = key;
+		leaf->values[index] = value;
+		++leaf->header.count;
+		return &leaf->values[index];
+	}
+
+	// Split the full leaf, the lower half stays in place.
+	Leaf *right = (Leaf *)_b_tree_map_node_allocate(self, true);
+	U64 total_count = Leaf::CAPACITY + 1;
+	U64 left_count = total_count / 2;
+	V *inserted_value = nullptr;
+	for (U64 i = total_count; i > 0; --i)
+	{
+		U64 source = i - 1;
+		bool is_new = source == index;
+		U64 old_index = source > index ? source - 1 : source;
+		K *target_key = source < left_count ? &leaf->keys[source] : &right->keys[source - left_count];
+		V *target_value = source < left_count ? &leaf->values[source] : &right->values[source - left_count];
+		if (is_new)
+		{
+			*target_key = key;
+			*target_value = value;
+			inserted_value = target_value;
+		}
+		else
+		{
+			*target_key = leaf->keys[old_index];
+			*target_value = leaf->values[old_index];
+		}
+	}
+	leaf->header.count = (U32)left_count;
+	right->header.count = (U32)(total_count - left_count);
+	right->next = leaf->next;
+	leaf->next = right;
+
+	K separator = right->keys[0];
+	B_Tree_Map_Node *new_child = (B_Tree_Map_Node *)right;
+
+	// Insert (separator, new_child) into the parents, splitting them as needed.
+	while (path_count > 0)
+	{
+		--path_count;
+		Inner *parent = path_nodes[path_count];
+		U64 child_index = path_indices[path_count];
+
+		if (parent->header.count < Inner::CAPACITY)
+		{
+			for (U64 i = parent->header.count; i > child_index; --i)
+			{
+				parent->keys[i] = parent->keys[i - 1];
+				parent->children[i + 1] = parent->children[i];
+			}
+			parent->keys[child_index] = separator;
+			parent->children[child_index + 1] = new_child;
+			++parent->header.count;
+			return inserted_value;
+		}
+
+		K keys[Inner::CAPACITY + 1];
+		B_Tree_Map_Node *children[Inner::CAPACITY + 2];
+		for (U64 i = 0, j = 0; i < Inner::CAPACITY + 1; ++i)
+			keys[i] = i == child_index ? separator : parent->keys[j++];
+		for (U64 i = 0, j = 0; i < Inner::CAPACITY + 2; ++i)
+			children[i] = i == child_index + 1 ? new_child : parent->children[j++];
+
+		Inner *right_inner = (Inner *)_b_tree_map_node_allocate(self, false);
+		U64 left_key_count = (Inner::CAPACITY + 1) / 2;
+		U64 right_key_count = Inner::CAPACITY - left_key_count;
+		for (U64 i = 0; i < left_key_count; ++i)
+			parent->keys[i] = keys[i];
+		for (U64 i = 0; i <= left_key_count; ++i)
+			parent->children[i] = children[i];
+		for (U64 i = 0; i < right_key_count; ++i)
+			right_inner->keys[i] = keys[left_key_count + 1 + i];
+		for (U64 i = 0; i <= right_key_count; ++i)
+			right_inner->children[i] = children[left_key_count + 1 + i];
+		parent->header.count = (U32)left_key_count;
+		right_inner->header.count = (U32)right_key_count;
+
+		separator = keys[left_key_count];
+		new_child = (B_Tree_Map_Node *)right_inner;
+	}
+
+	validate(self.height < B_TREE_MAP_MAX_HEIGHT, "[B_TREE_MAP]: Maximum height exceeded.");
+	Inner *root = (Inner *)_b_tree_map_node_allocate(self, false);
+	root->header.count = 1;
+	root->keys[0] = separator;
+	root->children[0] = self.root;
+	root->children[1] = new_child;
+	self.root = (B_Tree_Map_Node *)root;
+	++self.height;
+	return inserted_value;
+}
+
+template <typename K, typename V>
+inline static V *
+b_tree_map_insert(B_Tree_Map<K, V> &self, const B_Tree_Map_Entry<K, V> &entry)
+{
+	return b_tree_map_insert(self, entry.key, entry.value);
+}
+
+template <typename K, typename V>
+inline static bool
+b_tree_map_remove(B_Tree_Map<K, V> &self, const K &key)
+{
+	using Leaf = B_Tree_Map_Leaf<K, V>;
+	using Inner = B_Tree_Map_Inner<K>;
+
+	if (self.root == nullptr)
+		return false;
+
+	Inner *path_nodes[B_TREE_MAP_MAX_HEIGHT];
+	U64 path_indices[B_TREE_MAP_MAX_HEIGHT];
+	U64 path_count = 0;
+
+	B_Tree_Map_Node *node = self.root;
+	while (!node->is_leaf)
+	{
+		Inner *inner = (Inner *)node;
+		U64 child_index = _b_tree_map_inner_child_index(inner, key);
+		path_nodes[path_count] = inner;
+		path_indices[path_count] = child_index;
+		++path_count;
+		node = inner->children[child_index];
+	}
+
+	Leaf *leaf = (Leaf *)node;
+	U64 index = _b_tree_map_leaf_lower_bound(leaf, key);
+	if (index == leaf->header.count || key < leaf->keys[index])
+		return false;
+
+	for (U64 i = index + 1; i < leaf->header.count; ++i)
+	{
+		leaf->keys[i - 1] = leaf->keys[i];
+		leaf->values[i - 1] = leaf->values[i];
+	}
+	--leaf->header.count;
+	--self.count;
+
+	// Rebalance bottom-up by borrowing from a sibling, or merging with it when it has nothing to spare.
+	while (path_count > 0 && node->count < (node->is_leaf ? Leaf::MIN_COUNT : Inner::MIN_COUNT))
+	{
+		--path_count;
+		Inner *parent = path_nodes[path_count];
+		U64 child_index = path_indices[path_count];
+		B_Tree_Map_Node *left = child_index > 0 ? parent->children[child_index - 1] : nullptr;
+		B_Tree_Map_Node *right = child_index < parent->header.count ? parent->children[child_index + 1] : nullptr;
+
+		if (node->is_leaf)
+		{
+			Leaf *current = (Leaf *)node;
+			Leaf *left_leaf = (Leaf *)left;
+			Leaf *right_leaf = (Leaf *)right;
+			if (left_leaf && left_leaf->header.count > Leaf::MIN_COUNT)
+			{
+				for (U64 i = current->header.count; i > 0; --i)
+				{
+					current->keys[i] = current->keys[i - 1];
+					current->values[i] = current->values[i - 1];
+				}
+				--left_leaf->header.count;
+				current->keys[0] = left_leaf->keys[left_leaf->header.count];
+				current->values[0] = left_leaf->values[left_leaf->header.count];
+				++current->header.count;
+				parent->keys[child_index - 1] = current->keys[0];
+				break;
+			}
+
+			if (right_leaf && right_leaf->header.count > Leaf::MIN_COUNT)
+			{
+				current->keys[current->header.count] = right_leaf->keys[0];
+				current->values[current->header.count] = right_leaf->values[0];
+				++current->header.count;
+				for (U64 i = 1; i < right_leaf->header.count; ++i)
+				{
+					right_leaf->keys[i - 1] = right_leaf->keys[i];
+					right_leaf->values[i - 1] = right_leaf->values[i];
+				}
+				--right_leaf->header.count;
+				parent->keys[child_index] = right_leaf->keys[0];
+				break;
+			}
+
+			U64 merge_index = left_leaf ? child_index - 1 : child_index;
+			Leaf *merge_left = left_leaf ? left_leaf : current;
+			Leaf *merge_right = left_leaf ? current : right_leaf;
+			for (U64 i = 0; i < merge_right->header.count; ++i)
+			{
+				merge_left->keys[merge_left->header.count + i] = merge_right->keys[i];
+				merge_left->values[merge_left->header.count + i] = merge_right->values[i];
+			}
+			merge_left->header.count += merge_right->header.count;
+			merge_left->next = merge_right->next;
+			_b_tree_map_node_deallocate(self, (B_Tree_Map_Node *)merge_right);
+
+			for (U64 i = merge_index + 1; i < parent->header.count; ++i)
+			{
+				parent->keys[i - 1] = parent->keys[i];
+				parent->children[i] = parent->children[i + 1];
+			}
+			--parent->header.count;
+		}
+		else
+		{
+			Inner *current = (Inner *)node;
+			Inner *left_inner = (Inner *)left;
+			Inner *right_inner = (Inner *)right;
+			if (left_inner && left_inner->header.count > Inner::MIN_COUNT)
+			{
+				current->children[current->header.count + 1] = current->children[current->header.count];
+				for (U64 i = current->header.count; i > 0; --i)
+				{
+					current->keys[i] = current->keys[i - 1];
+					current->children[i] = current->children[i - 1];
+				}
+				current->keys[0] = parent->keys[child_index - 1];
+				current->children[0] = left_inner->children[left_inner->header.count];
+				++current->header.count;
+				parent->keys[child_index - 1] = left_inner->keys[left_inner->header.count - 1];
+				--left_inner->header.count;
+				break;
+			}
+
+			if (right_inner && right_inner->header.count > Inner::MIN_COUNT)
+			{
+				current->keys[current->header.count] = parent->keys[child_index];
+				current->children[current->header.count + 1] = right_inner->children[0];
+				++current->header.count;
+				parent->keys[child_index] = right_inner->keys[0];
+				for (U64 i = 1; i < right_inner->header.count; ++i)
+					right_inner->keys[i - 1] = right_inner->keys[i];
+				for (U64 i = 1; i <= right_inner->header.count; ++i)
+					right_inner->children[i - 1] = right_inner->children[i];
+				--right_inner->header.count;
+				break;
+			}
+
+			U64 merge_index = left_inner ? child_index - 1 : child_index;
+			Inner *merge_left = left_inner ? left_inner : current;
+			Inner *merge_right = left_inner ? current : right_inner;
+			U64 offset = merge_left->header.count;
+			merge_left->keys[offset] = parent->keys[merge_index];
+			for (U64 i = 0; i < merge_right->header.count; ++i)
+				merge_left->keys[offset + 1 + i] = merge_right->keys[i];
+			for (U64 i = 0; i <= merge_right->header.count; ++i)
+				merge_left->children[offset + 1 + i] = merge_right->children[i];
+			merge_left->header.count += merge_right->header.count + 1;
+			_b_tree_map_node_deallocate(self, (B_Tree_Map_Node *)merge_right);
+
+			for (U64 i = merge_index + 1; i < parent->header.count; ++i)
+			{
+				parent->keys[i - 1] = parent->keys[i];
+				parent->children[i] = parent->children[i + 1];
+			}
+			--parent->header.count;
+		}
+
+		node = (B_Tree_Map_Node *)parent;
+	}
+
+	if (!self.root->is_leaf && self.root->count == 0)
+	{
+		B_Tree_Map_Node *old_root = self.root;
+		self.root = ((Inner *)old_root)->children[0];
+		_b_tree_map_node_deallocate(self, old_root);
+		--self.height;
+	}
+	else if (self.root->is_leaf && self.root->count == 0)
+	{
+		_b_tree_map_node_deallocate(self, self.root);
+		self.root = nullptr;
+		self.first_leaf = nullptr;
+		self.height = 0;
+	}
+
+	return true;
+}
+
+// Builds the tree bottom-up from entries with strictly increasing keys. The map must be empty.
+// Leaves are filled evenly close to capacity, which is the densest layout for range scans.
+template <typename K, typename V>
+inline static void
+b_tree_map_bulk_load(B_Tree_Map<K, V> &self, Slice<const std::type_identity_t<B_Tree_Map_Entry<K, V>>> sorted_entries)
+{
+	using Leaf = B_Tree_Map_Leaf<K, V>;
+	using Inner = B_Tree_Map_Inner<K>;
+
+	validate(self.count == 0, "[B_TREE_MAP]: Bulk load requires an empty map.");
+	if (sorted_entries.count == 0)
+		return;
+
+	for (U64 i = 1; i < sorted_entries.count; ++i)
+		validate(sorted_entries[i - 1].key < sorted_entries[i].key, "[B_TREE_MAP]: Bulk load entries must have strictly increasing keys.");
+
+	if (self.allocator == nullptr)
+		self.allocator = memory::heap_allocator();
+
+	U64 node_count = (sorted_entries.count + Leaf::CAPACITY - 1) / Leaf::CAPACITY;
+	Array<B_Tree_Map_Node *> nodes = array_init_with_count<B_Tree_Map_Node *>(node_count);
+	Array<K> minimum_keys = array_init_with_count<K>(node_count);
+	DEFER(array_deinit(nodes); array_deinit(minimum_keys));
+
+	Leaf *previous = nullptr;
+	for (U64 i = 0; i < node_count; ++i)
+	{
+		U64 first = sorted_entries.count * i / node_count;
+		U64 last = sorted_entries.count * (i + 1) / node_count;
+		Leaf *leaf = (Leaf *)_b_tree_map_node_allocate(self, true);
+		for (U64 j = first; j < last; ++j)
+		{
+			leaf->keys[j - first] = sorted_entries[j].key;
+			leaf->values[j - first] = sorted_entries[j].value;
+		}
+		leaf->header.count = (U32)(last - first);
+		if (previous)
+			previous->next = leaf;
+		else
+			self.first_leaf = leaf;
+		previous = leaf;
+		nodes[i] = (B_Tree_Map_Node *)leaf;
+		minimum_keys[i] = leaf->keys[0];
+	}
+
+	U64 height = 1;
+	while (node_count > 1)
+	{
+		U64 parent_count = (node_count + Inner::CAPACITY) / (Inner::CAPACITY + 1);
+		for (U64 i = 0; i < parent_count; ++i)
+		{
+			U64 first = node_count * i / parent_count;
+			U64 last = node_count * (i + 1) / parent_count;
+			Inner *inner = (Inner *)_b_tree_map_node_allocate(self, false);
+			for (U64 j = first; j < last; ++j)
+			{
+				inner->children[j - first] = nodes[j];
+				if (j > first)
+					inner->keys[j - first - 1] = minimum_keys[j];
+			}
+			inner->header.count = (U32)(last - first - 1);
+			K minimum_key = minimum_keys[first];
+			nodes[i] = (B_Tree_Map_Node *)inner;
+			minimum_keys[i] = minimum_key;
+		}
+		node_count = parent_count;
+		++height;
+	}
+
+	self.root = nodes[0];
+	self.count = sorted_entries.count;
+	self.height = height;
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map<K, V>
+b_tree_map_init_from_sorted(Slice<const B_Tree_Map_Entry<K, V>> sorted_entries, memory::Allocator *allocator = memory::heap_allocator())
+{
+	B_Tree_Map<K, V> self = b_tree_map_init<K, V>(allocator);
+	b_tree_map_bulk_load(self, sorted_entries);
+	return self;
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map_Iterator<K, V>
+begin(B_Tree_Map<K, V> &self)
+{
+	return B_Tree_Map_Iterator<K, V>{self.first_leaf, 0};
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map_Const_Iterator<K, V>
+begin(const B_Tree_Map<K, V> &self)
+{
+	return B_Tree_Map_Const_Iterator<K, V>{self.first_leaf, 0};
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map_Iterator<K, V>
+end(B_Tree_Map<K, V> &)
+{
+	return B_Tree_Map_Iterator<K, V>{nullptr, 0};
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map_Const_Iterator<K, V>
+end(const B_Tree_Map<K, V> &)
+{
+	return B_Tree_Map_Const_Iterator<K, V>{nullptr, 0};
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map_Iterator<K, V>
+_b_tree_map_lower_bound(const B_Tree_Map<K, V> &self, const K &key)
+{
+	B_Tree_Map_Leaf<K, V> *leaf = _b_tree_map_find_leaf(self, key);
+	if (leaf == nullptr)
+		return B_Tree_Map_Iterator<K, V>{nullptr, 0};
+
+	U64 index = _b_tree_map_leaf_lower_bound(leaf, key);
+	if (index == leaf->header.count)
+		return B_Tree_Map_Iterator<K, V>{leaf->next, 0};
+	return B_Tree_Map_Iterator<K, V>{leaf, index};
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map_Iterator<K, V>
+_b_tree_map_upper_bound(const B_Tree_Map<K, V> &self, const K &key)
+{
+	B_Tree_Map_Iterator<K, V> it = _b_tree_map_lower_bound(self, key);
+	if (it.leaf && !(key < it.leaf->keys[it.index]))
+		++it;
+	return it;
+}
+
+// First entry whose key is not less than `key`, or `end`.
+template <typename K, typename V>
+inline static B_Tree_Map_Iterator<K, V>
+b_tree_map_lower_bound(B_Tree_Map<K, V> &self, const K &key)
+{
+	return _b_tree_map_lower_bound(self, key);
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map_Const_Iterator<K, V>
+b_tree_map_lower_bound(const B_Tree_Map<K, V> &self, const K &key)
+{
+	B_Tree_Map_Iterator<K, V> it = _b_tree_map_lower_bound(self, key);
+	return B_Tree_Map_Const_Iterator<K, V>{it.leaf, it.index};
+}
+
+// First entry whose key is greater than `key`, or `end`.
+template <typename K, typename V>
+inline static B_Tree_Map_Iterator<K, V>
+b_tree_map_upper_bound(B_Tree_Map<K, V> &self, const K &key)
+{
+	return _b_tree_map_upper_bound(self, key);
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map_Const_Iterator<K, V>
+b_tree_map_upper_bound(const B_Tree_Map<K, V> &self, const K &key)
+{
+	B_Tree_Map_Iterator<K, V> it = _b_tree_map_upper_bound(self, key);
+	return B_Tree_Map_Const_Iterator<K, V>{it.leaf, it.index};
+}
+
+// Entries with `first <= key < last`.
+template <typename K, typename V>
+inline static B_Tree_Map_Range<K, V>
+b_tree_map_range(B_Tree_Map<K, V> &self, const K &first, const K &last)
+{
+	if (!(first < last))
+		return B_Tree_Map_Range<K, V>{end(self), end(self)};
+	return B_Tree_Map_Range<K, V>{b_tree_map_lower_bound(self, first), b_tree_map_lower_bound(self, last)};
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map_Const_Range<K, V>
+b_tree_map_range(const B_Tree_Map<K, V> &self, const K &first, const K &last)
+{
+	if (!(first < last))
+		return B_Tree_Map_Const_Range<K, V>{end(self), end(self)};
+	return B_Tree_Map_Const_Range<K, V>{b_tree_map_lower_bound(self, first), b_tree_map_lower_bound(self, last)};
+}
+
+template <typename K, typename V, typename TValue>
+inline static B_Tree_Map_Iterator<K, V, TValue>
+begin(const B_Tree_Map_Range<K, V, TValue> &self)
+{
+	return self.first;
+}
+
+template <typename K, typename V, typename TValue>
+inline static B_Tree_Map_Iterator<K, V, TValue>
+end(const B_Tree_Map_Range<K, V, TValue> &self)
+{
+	return self.last;
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map<K, V>
+b_tree_map_copy(const B_Tree_Map<K, V> &self, memory::Allocator *allocator = memory::heap_allocator())
+{
+	Array<B_Tree_Map_Entry<K, V>> entries = array_init_with_capacity<B_Tree_Map_Entry<K, V>>(self.count);
+	DEFER(array_deinit(entries));
+	for (auto [key, value] : self)
+		array_push(entries, B_Tree_Map_Entry<K, V>{key, value});
+	return b_tree_map_init_from_sorted<K, V>(slice_from(entries), allocator);
+}
+
+template <typename K, typename V>
+inline static B_Tree_Map<K, V>
+clone(const B_Tree_Map<K, V> &self, memory::Allocator *allocator = memory::heap_allocator())
+{
+	Array<B_Tree_Map_Entry<K, V>> entries = array_init_with_capacity<B_Tree_Map_Entry<K, V>>(self.count);
+	DEFER(array_deinit(entries));
+	for (auto [key, value] : self)
+	{
+		B_Tree_Map_Entry<K, V> entry = {key, value};
+		if constexpr (std::is_class_v<K>)
+			entry.key = clone(key, allocator);
+		if constexpr (std::is_class_v<V>)
+			entry.value = clone(value, allocator);
+		array_push(entries, entry);
+	}
+	return b_tree_map_init_from_sorted<K, V>(slice_from(entries), allocator);
+}
+
+template <typename K, typename V>
+inline static void
+destroy(B_Tree_Map<K, V> &self)
+{
+	if constexpr (std::is_class_v<K> || std::is_class_v<V>)
+	{
+		for (auto [key, value] : self)
+		{
+			if constexpr (std::is_class_v<K>)
+				destroy((K &)key);
+			if constexpr (std::is_class_v<V>)
+				destroy(value);
+		}
+	}
+	b_tree_map_deinit(self);
+}
\ No newline at end of file
@@ -0,0 +1,383 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/validate.h"
+#include "core/math/u64.h"
+#include "core/memory/allocator.h"
+
+#if defined(SIMD_FORCE_SCALAR)
+#elif defined(SIMD_NEON)
+	#include <arm_neon.h>
+#elif defined(SIMD_AVX)
+	#include <immintrin.h>
+#endif
+
+// Bits are packed into U64 words, bit `i` lives in `words[i / 64]` at position `i % 64`.
+// Bits past `count` in the last word are always kept unset, so whole-word operations
+// (popcount, any, and/or) never have to mask the tail.
+
+inline static U64
+_bit_array_word_count(U64 bit_count)
+{
+	return (bit_count + 63) / 64;
+}
+
+inline static U64
+_bit_array_tail_mask(U64 bit_count)
+{
+	U64 tail = bit_count % 64;
+	return tail == 0 ? ~0ull : (1ull << tail) - 1;
+}
+
+inline static void
+_bit_array_words_and(U64 *words, const U64 *other, U64 word_count)
+{
+	U64 i = 0;
+	#if defined(SIMD_NEON)
+		for (; i + 2 <= word_count; i += 2)
+			vst1q_u64(words + i, vandq_u64(vld1q_u64(words + i), vld1q_u64(other + i)));
+	#elif defined(SIMD_AVX)
+		for (; i + 4 <= word_count; i += 4)
+			_mm256_storeu_pd((F64 *)(words + i), _mm256_and_pd(_mm256_loadu_pd((const F64 *)(words + i)), _mm256_loadu_pd((const F64 *)(other + i))));
+	#endif
+	for (; i < word_count; ++i)
+		words[i] &= other[i];
+}
+
+inline static void
+_bit_array_words_or(U64 *words, const U64 *other, U64 word_count)
+{
+	U64 i = 0;
+	#if defined(SIMD_NEON)
+		for (; i + 2 <= word_count; i += 2)
+			vst1q_u64(words + i, vorrq_u64(vld1q_u64(words + i), vld1q_u64(other + i)));
+	#elif defined(SIMD_AVX)
+		for (; i + 4 <= word_count; i += 4)
+			_mm256_storeu_pd((F64 *)(words + i), _mm256_or_pd(_mm256_loadu_pd((const F64 *)(words + i)), _mm256_loadu_pd((const F64 *)(other + i))));
+	#endif
+	for (; i < word_count; ++i)
+		words[i] |= other[i];
+}
+
+inline static void
+_bit_array_words_and_not(U64 *words, const U64 *other, U64 word_count)
+{
+	U64 i = 0;
+	#if defined(SIMD_NEON)
+		for (; i + 2 <= word_count; i += 2)
+			vst1q_u64(words + i, vbicq_u64(vld1q_u64(words + i), vld1q_u64(other + i)));
+	#elif defined(SIMD_AVX)
+		for (; i + 4 <= word_count; i += 4)
+			_mm256_storeu_pd((F64 *)(words + i), _mm256_andnot_pd(_mm256_loadu_pd((const F64 *)(other + i)), _mm256_loadu_pd((const F64 *)(words + i))));
+	#endif
+	for (; i < word_count; ++i)
+		words[i] &= ~other[i];
+}
+
+inline static U64
+_bit_array_words_popcount(const U64 *words, U64 word_count)
+{
+	U64 count = 0;
+	U64 i = 0;
+	#if defined(SIMD_NEON)
+		for (; i + 2 <= word_count; i += 2)
+			count += vaddvq_u8(vcntq_u8(vreinterpretq_u8_u64(vld1q_u64(words + i))));
+	#endif
+	for (; i < word_count; ++i)
+		count += u64_popcount(words[i]);
+	return count;
+}
+
+inline static bool
+_bit_array_words_any(const U64 *words, U64 word_count)
+{
+	for (U64 i = 0; i < word_count; ++i)
+		if (words[i] != 0)
+			return true;
+	return false;
+}
+
+// Returns `bit_count` when no set bit exists at or after `from`.
+inline static U64
+_bit_array_words_find_next_set(const U64 *words, U64 bit_count, U64 from)
+{
+	if (from >= bit_count)
+		return bit_count;
+
+	U64 word_count = _bit_array_word_count(bit_count);
+	U64 word_index = from / 64;
+	U64 word = words[word_index] & (~0ull << (from % 64));
+	while (word == 0)
+	{
+		if (++word_index == word_count)
+			return bit_count;
+		word = words[word_index];
+	}
+	return word_index * 64 + u64_trailing_zero_count(word);
+}
+
+// Returns `bit_count` when no unset bit exists at or after `from`.
+inline static U64
+_bit_array_words_find_next_unset(const U64 *words, U64 bit_count, U64 from)
+{
+	if (from >= bit_count)
+		return bit_count;
+
+	U64 word_count = _bit_array_word_count(bit_count);
+	U64 word_index = from / 64;
+	U64 word = ~words[word_index] & (~0ull << (from % 64));
+	while (word == 0)
+	{
+		if (++word_index == word_count)
+			return bit_count;
+		word = ~words[word_index];
+	}
+	return u64_min(word_index * 64 + u64_trailing_zero_count(word), bit_count);
+}
+
+struct Bit_Array_Set_Bits_Iterator
+{
+	const U64 *words;
+	U64 word_count;
+	U64 word_index;
+	U64 word;
+
+	inline U64
+	operator*() const
+	{
+		return word_index * 64 + u64_trailing_zero_count(word);
+	}
+
+	inline Bit_Array_Set_Bits_Iterator &
+	operator++()
+	{
+		word &= word - 1;
+		while (word == 0 && ++word_index < word_count)
+			word = words[word_index];
+		return *this;
+	}
+
+	inline bool
+	operator!=(const Bit_Array_Set_Bits_Iterator &other) const
+	{
+		return word_index != other.word_index || word != other.word;
+	}
+};
+
+// Range over the indices of set bits, in increasing order.
+struct Bit_Array_Set_Bits
+{
+	const U64 *words;
+	U64 word_count;
+};
+
+inline static Bit_Array_Set_Bits_Iterator
+end(const Bit_Array_Set_Bits &self)
+{
+	return Bit_Array_Set_Bits_Iterator{self.words, self.word_count, self.word_count, 0};
+}
+
+inline static Bit_Array_Set_Bits_Iterator
+begin(const Bit_Array_Set_Bits &self)
+{
+	if (self.word_count == 0)
+		return end(self);
+	Bit_Array_Set_Bits_Iterator it = {self.words, self.word_count, 0, self.words[0]};
+	if (it.word == 0)
+		++it;
+	return it;
+}
+
+struct Bit_Array
+{
+	memory::Allocator *allocator;
+	U64 *words;
+	U64 count;
+	U64 capacity;
+
+	inline bool
+	operator[](U64 index) const
+	{
+		validate(index < count, "[BIT_ARRAY]: Access out of range.");
+		return (words[index / 64] >> (index % 64)) & 1;
+	}
+};
+
+inline static Bit_Array
+bit_array_init(memory::Allocator *allocator = memory::heap_allocator())
+{
+	return Bit_Array {
+		.allocator = allocator ? allocator : memory::heap_allocator(),
+		.words = nullptr,
+		.count = 0,
+		.capacity = 0
+	};
+}
+
+// All bits start unset.
+inline static Bit_Array
+bit_array_init_with_count(U64 count, memory::Allocator *allocator = memory::heap_allocator())
+{
+	allocator = allocator ? allocator : memory::heap_allocator();
+	U64 word_count = _bit_array_word_count(count);
+	return Bit_Array {
+		.allocator = allocator,
+		.words = (U64 *)memory::allocate_zeroed(allocator, word_count * sizeof(U64), alignof(U64)).data,
+		.count = count,
+		.capacity = word_count * 64
+	};
+}
+
+inline static Bit_Array
+bit_array_copy(const Bit_Array &self, memory::Allocator *allocator = memory::heap_allocator())
+{
+	Bit_Array copy = bit_array_init_with_count(self.count, allocator);
+	U64 word_count = _bit_array_word_count(self.count);
+	for (U64 i = 0; i < word_count; ++i)
+		copy.words[i] = self.words[i];
+	return copy;
+}
+
+inline static void
+bit_array_deinit(Bit_Array &self)
+{
+	if (self.capacity && self.allocator)
+		memory::deallocate(self.allocator, Memory_Block{self.words, self.capacity / 8});
+	self = Bit_Array{.allocator = self.allocator};
+}
+
+// Bits added past the old count start unset.
+inline static void
+bit_array_resize(Bit_Array &self, U64 new_count)
+{
+	if (self.allocator == nullptr)
+		self.allocator = memory::heap_allocator();
+
+	U64 old_word_count = _bit_array_word_count(self.count);
+	U64 new_word_count = _bit_array_word_count(new_count);
+	if (new_count > self.capacity)
+	{
+		U64 capacity_word_count = u64_max(new_word_count, self.capacity / 64 + self.capacity / 128);
+		U64 *words = (U64 *)memory::allocate_zeroed(self.allocator, capacity_word_count * sizeof(U64), alignof(U64)).data;
+		for (U64 i = 0; i < old_word_count; ++i)
+			words[i] = self.words[i];
+		if (self.capacity)
+			memory::deallocate(self.allocator, Memory_Block{self.words, self.capacity / 8});
+		self.words = words;
+		self.capacity = capacity_word_count * 64;
+	}
+	else if (new_count < self.count)
+	{
+		for (U64 i = new_word_count; i < old_word_count; ++i)
+			self.words[i] = 0;
+		if (new_word_count)
+			self.words[new_word_count - 1] &= _bit_array_tail_mask(new_count);
+	}
+	self.count = new_count;
+}
+
+inline static bool
+bit_array_get(const Bit_Array &self, U64 index)
+{
+	return self[index];
+}
+
+inline static void
+bit_array_set(Bit_Array &self, U64 index)
+{
+	validate(index < self.count, "[BIT_ARRAY]: Access out of range.");
+	self.words[index / 64] |= 1ull << (index % 64);
+}
+
+inline static void
+bit_array_unset(Bit_Array &self, U64 index)
+{
+	validate(index < self.count, "[BIT_ARRAY]: Access out of range.");
+	self.words[index / 64] &= ~(1ull << (index % 64));
+}
+
+inline static void
+bit_array_set_all(Bit_Array &self)
+{
+	U64 word_count = _bit_array_word_count(self.count);
+	for (U64 i = 0; i < word_count; ++i)
+		self.words[i] = ~0ull;
+	if (word_count)
+		self.words[word_count - 1] = _bit_array_tail_mask(self.count);
+}
+
+inline static void
+bit_array_unset_all(Bit_Array &self)
+{
+	U64 word_count = _bit_array_word_count(self.count);
+	for (U64 i = 0; i < word_count; ++i)
+		self.words[i] = 0;
+}
+
+inline static U64
+bit_array_count_set(const Bit_Array &self)
+{
+	return _bit_array_words_popcount(self.words, _bit_array_word_count(self.count));
+}
+
+inline static bool
+bit_array_any(const Bit_Array &self)
+{
+	return _bit_array_words_any(self.words, _bit_array_word_count(self.count));
+}
+
+inline static bool
+bit_array_none(const Bit_Array &self)
+{
+	return !bit_array_any(self);
+}
+
+// Returns `self.count` when there is no set bit at or after `from`.
+inline static U64
+bit_array_find_next_set(const Bit_Array &self, U64 from = 0)
+{
+	return _bit_array_words_find_next_set(self.words, self.count, from);
+}
+
+// Returns `self.count` when there is no unset bit at or after `from`.
+inline static U64
+bit_array_find_next_unset(const Bit_Array &self, U64 from = 0)
+{
+	return _bit_array_words_find_next_unset(self.words, self.count, from);
+}
+
+// self &= other.
+inline static void
+bit_array_and(Bit_Array &self, const Bit_Array &other)
+{
+	validate(self.count == other.count, "[BIT_ARRAY]: Bit counts must match.");
+	_bit_array_words_and(self.words, other.words, _bit_array_word_count(self.count));
+}
+
+// self |= other.
+inline static void
+bit_array_or(Bit_Array &self, const Bit_Array &other)
+{
+	validate(self.count == other.count, "[BIT_ARRAY]: Bit counts must match.");
+	_bit_array_words_or(self.words, other.words, _bit_array_word_count(self.count));
+}
+
+// self &= ~other.
+inline static void
+bit_array_and_not(Bit_Array &self, const Bit_Array &other)
+{
+	validate(self.count == other.count, "[BIT_ARRAY]: Bit counts must match.");
+	_bit_array_words_and_not(self.words, other.words, _bit_array_word_count(self.count));
+}
+
+inline static Bit_Array_Set_Bits
+bit_array_set_bits(const Bit_Array &self)
+{
+	return Bit_Array_Set_Bits{self.words, _bit_array_word_count(self.count)};
+}
+
+inline static Bit_Array
+clone(const Bit_Array &self, memory::Allocator *allocator = memory::heap_allocator())
+{
+	return bit_array_copy(self, allocator);
+}
\ No newline at end of file
@@ -0,0 +1,292 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/validate.h"
+#include "core/memory/allocator.h"
+#include "core/containers/array.h"
+
+#include <type_traits>
+
+/*
+	Values are stored densely in `values`, so iterating a pool is a linear scan over a contiguous array.
+	A handle names a slot instead of a position. The slot records where its value currently lives in
+	`values`, and a generation that is bumped every time the slot is freed, so a handle to a removed
+	value is rejected in O(1) even after its slot has been reused.
+
+	Removal swaps the last value into the hole, which keeps `values` dense but does not preserve order.
+	Pointers to values are invalidated by insert and remove, handles are not.
+*/
+
+constexpr U32 HANDLE_POOL_INVALID_INDEX = U32_MAX;
+
+template <typename T>
+struct Handle
+{
+	U32 index;
+	U32 generation;
+
+	inline bool
+	operator==(const Handle &other) const
+	{
+		return index == other.index && generation == other.generation;
+	}
+
+	inline bool
+	operator!=(const Handle &other) const
+	{
+		return !(*this == other);
+	}
+};
+
+struct Handle_Pool_Slot
+{
+	// Index into `values` while the slot is alive, next free slot while it is free.
+	U32 dense_index;
+	U32 generation;
+};
+
+template <typename T>
+struct Handle_Pool
+{
+	Array<T> values;
+	Array<U32> dense_to_slot;
+	Array<Handle_Pool_Slot> slots;
+	U32 free_slot_head;
+	U64 count;
+
+	inline T &
+	operator[](Handle<T> handle)
+	{
+		T *value = handle_pool_get(*this, handle);
+		validate(value != nullptr, "[HANDLE_POOL]: Access with invalid handle.");
+		return *value;
+	}
+
+	inline const T &
+	operator[](Handle<T> handle) const
+	{
+		const T *value = handle_pool_get(*this, handle);
+		validate(value != nullptr, "[HANDLE_POOL]: Access with invalid handle.");
+		return *value;
+	}
+};
+
+template <typename T>
+inline static Handle_Pool<T>
+handle_pool_init(memory::Allocator *allocator = memory::heap_allocator())
+{
+	return Handle_Pool<T> {
+		.values = array_init<T>(allocator),
+		.dense_to_slot = array_init<U32>(allocator),
+		.slots = array_init<Handle_Pool_Slot>(allocator),
+		.free_slot_head = HANDLE_POOL_INVALID_INDEX,
+		.count = 0
+	};
+}
+
+template <typename T>
+inline static Handle_Pool<T>
+handle_pool_init_with_capacity(U64 capacity, memory::Allocator *allocator = memory::heap_allocator())
+{
+	return Handle_Pool<T> {
+		.values = array_init_with_capacity<T>(capacity, allocator),
+		.dense_to_slot = array_init_with_capacity<U32>(capacity, allocator),
+		.slots = array_init_with_capacity<Handle_Pool_Slot>(capacity, allocator),
+		.free_slot_head = HANDLE_POOL_INVALID_INDEX,
+		.count = 0
+	};
+}
+
+template <typename T>
+inline static Handle_Pool<T>
+handle_pool_copy(const Handle_Pool<T> &self, memory::Allocator *allocator = memory::heap_allocator())
+{
+	return Handle_Pool<T> {
+		.values = array_copy(self.values, allocator),
+		.dense_to_slot = array_copy(self.dense_to_slot, allocator),
+		.slots = array_copy(self.slots, allocator),
+		.free_slot_head = self.free_slot_head,
+		.count = self.count
+	};
+}
+
+template <typename T>
+inline static void
+handle_pool_deinit(Handle_Pool<T> &self)
+{
+	array_deinit(self.values);
+	array_deinit(self.dense_to_slot);
+	array_deinit(self.slots);
+	self.free_slot_head = HANDLE_POOL_INVALID_INDEX;
+	self.count = 0;
+}
+
+template <typename T>
+inline static void
+handle_pool_reserve(Handle_Pool<T> &self, U64 added_capacity)
+{
+	array_reserve(self.values, added_capacity);
+	array_reserve(self.dense_to_slot, added_capacity);
+	array_reserve(self.slots, added_capacity);
+}
+
+template <typename T>
+inline static Handle<T>
+handle_pool_insert(Handle_Pool<T> &self, const T &value)
+{
+	validate(self.count < HANDLE_POOL_INVALID_INDEX, "[HANDLE_POOL]: Maximum count exceeded.");
+
+	U32 slot_index = self.free_slot_head;
+	if (slot_index == HANDLE_POOL_INVALID_INDEX)
+	{
+		slot_index = (U32)self.slots.count;
+		// Generations start at 1 so a zero-initialized handle is never valid.
+		array_push(self.slots, Handle_Pool_Slot{.dense_index = 0, .generation = 1});
+	}
+	else
+	{
+		self.free_slot_head = self.slots.data[slot_index].dense_index;
+	}
+
+	Handle_Pool_Slot &slot = self.slots.data[slot_index];
+	slot.dense_index = (U32)self.values.count;
+	array_push(self.values, value);
+	array_push(self.dense_to_slot, slot_index);
+	++self.count;
+	return Handle<T>{slot_index, slot.generation};
+}
+
+template <typename T>
+inline static bool
+handle_pool_is_valid(const Handle_Pool<T> &self, Handle<T> handle)
+{
+	if (handle.index >= self.slots.count)
+		return false;
+
+	// A free slot has already had its generation bumped, so any handle issued for it mismatches.
+	const Handle_Pool_Slot &slot = self.slots.data[handle.index];
+	return slot.generation == handle.generation;
+}
+
+template <typename T>
+inline static T *
+handle_pool_get(Handle_Pool<T> &self, Handle<T> handle)
+{
+	if (!handle_pool_is_valid(self, handle))
+		return nullptr;
+	return &self.values.data[self.slots.data[handle.index].dense_index];
+}
+
+template <typename T>
+inline static const T *
+handle_pool_get(const Handle_Pool<T> &self, Handle<T> handle)
+{
+	return handle_pool_get((Handle_Pool<T> &)self, handle);
+}
+
+// Returns false if the handle is stale.
+template <typename T>
+inline static bool
+handle_pool_remove(Handle_Pool<T> &self, Handle<T> handle)
+{
+	if (!handle_pool_is_valid(self, handle))
+		return false;
+
+	Handle_Pool_Slot &slot = self.slots.data[handle.index];
+	U32 dense_index = slot.dense_index;
+	U32 last_index = (U32)self.values.count - 1;
+	if (dense_index != last_index)
+	{
+		U32 moved_slot_index = self.dense_to_slot.data[last_index];
+		self.values.data[dense_index] = self.values.data[last_index];
+		self.dense_to_slot.data[dense_index] = moved_slot_index;
+		self.slots.data[moved_slot_index].dense_index = dense_index;
+	}
+	--self.values.count;
+	--self.dense_to_slot.count;
+
+	// Skip generation 0 on wrap around, it is reserved for zero-initialized handles.
+	if (++slot.generation == 0)
+		slot.generation = 1;
+	slot.dense_index = self.free_slot_head;
+	self.free_slot_head = handle.index;
+	--self.count;
+	return true;
+}
+
+// Invalidates every handle that was handed out, slots stay allocated for reuse.
+template <typename T>
+inline static void
+handle_pool_clear(Handle_Pool<T> &self)
+{
+	for (U32 dense_index = 0; dense_index < self.dense_to_slot.count; ++dense_index)
+	{
+		U32 slot_index = self.dense_to_slot[dense_index];
+		Handle_Pool_Slot &slot = self.slots[slot_index];
+		if (++slot.generation == 0)
+			slot.generation = 1;
+		slot.dense_index = self.free_slot_head;
+		self.free_slot_head = slot_index;
+	}
+	array_clear(self.values);
+	array_clear(self.dense_to_slot);
+	self.count = 0;
+}
+
+// Handle of the value stored at `dense_index` in `values`, for iterating values together with their handles.
+template <typename T>
+inline static Handle<T>
+handle_pool_handle_at(const Handle_Pool<T> &self, U64 dense_index)
+{
+	U32 slot_index = self.dense_to_slot[dense_index];
+	return Handle<T>{slot_index, self.slots[slot_index].generation};
+}
+
+template <typename T>
+inline static T *
+begin(Handle_Pool<T> &self)
+{
+	return begin(self.values);
+}
+
+template <typename T>
+inline static const T *
+begin(const Handle_Pool<T> &self)
+{
+	return begin(self.values);
+}
+
+template <typename T>
+inline static T *
+end(Handle_Pool<T> &self)
+{
+	return end(self.values);
+}
+
+template <typename T>
+inline static const T *
+end(const Handle_Pool<T> &self)
+{
+	return end(self.values);
+}
+
+template <typename T>
+inline static Handle_Pool<T>
+clone(const Handle_Pool<T> &self, memory::Allocator *allocator = memory::heap_allocator())
+{
+	Handle_Pool<T> copy = handle_pool_copy(self, allocator);
+	if constexpr (std::is_class_v<T>)
+		for (T &value : copy)
+			value = clone(value, allocator);
+	return copy;
+}
+
+template <typename T>
+inline static void
+destroy(Handle_Pool<T> &self)
+{
+	if constexpr (std::is_class_v<T>)
+		for (T &value : self)
+			destroy(value);
+	handle_pool_deinit(self);
+}
\ No newline at end of file
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/atomic.h"
+#include "core/validate.h"
+#include "core/math/u64.h"
+#include "core/memory/allocator.h"
+#include "core/containers/slice.h"
+
+#include <type_traits>
+
+// Bounded lock-free queue for any number of producers and consumers (Dmitry Vyukov's design).
+// Every cell carries a sequence number that tells producers and consumers whether the cell
+// is ready for the current lap, so the only shared writes are one CAS per side.
+template <typename T>
+struct Mpmc_Queue_Cell
+{
+	Atomic<U64> sequence;
+	T value;
+};
+
+template <typename T>
+struct Mpmc_Queue
+{
+	memory::Allocator *allocator;
+	Mpmc_Queue_Cell<T> *cells;
+	U64 capacity;
+	alignas(CACHE_LINE_SIZE) Atomic<U64> enqueue_position;
+	alignas(CACHE_LINE_SIZE) Atomic<U64> dequeue_position;
+};
+
+template <typename T>
+inline static Mpmc_Queue<T>
+mpmc_queue_init(U64 capacity, memory::Allocator *allocator = memory::heap_allocator())
+{
+	validate(capacity > 0, "[MPMC_QUEUE]: Capacity must be greater than 0.");
+	allocator = allocator ? allocator : memory::heap_allocator();
+	capacity = u64_next_power_of_two(capacity);
+
+	Mpmc_Queue_Cell<T> *cells = (Mpmc_Queue_Cell<T> *)memory::allocate(allocator, capacity * sizeof(Mpmc_Queue_Cell<T>), alignof(Mpmc_Queue_Cell<T>)).data;
+	for (U64 i = 0; i < capacity; ++i)
+		atomic_store(cells[i].sequence, i, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+
+	return Mpmc_Queue<T> {
+		.allocator = allocator,
+		.cells = cells,
+		.capacity = capacity,
+		.enqueue_position = atomic_init((U64)0),
+		.dequeue_position = atomic_init((U64)0)
+	};
+}
+
+template <typename T>
+inline static void
+mpmc_queue_deinit(Mpmc_Queue<T> &self)
+{
+	if (self.cells != nullptr)
+		memory::deallocate(self.allocator, Memory_Block{self.cells, self.capacity * sizeof(Mpmc_Queue_Cell<T>)});
+	self.cells = nullptr;
+	self.capacity = 0;
+	atomic_store(self.enqueue_position, (U64)0);
+	atomic_store(self.dequeue_position, (U64)0);
+}
+
+template <typename T, typename R>
+inline static bool
+mpmc_queue_push(Mpmc_Queue<T> &self, const R &value)
+{
+	U64 mask = self.capacity - 1;
+	U64 position = atomic_load(self.enqueue_position, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	Mpmc_Queue_Cell<T> *cell = nullptr;
+	while (true)
+	{
+		cell = &self.cells[position & mask];
+		I64 difference = (I64)(atomic_load(cell->sequence, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE) - position);
+		if (difference == 0)
+		{
+			if (atomic_compare_exchange(self.enqueue_position, position, position + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED))
+				break;
+		}
+		else if (difference < 0)
+		{
+			return false;
+		}
+		else
+		{
+			position = atomic_load(self.enqueue_position, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		}
+	}
+
+	cell->value = (T)value;
+	atomic_store(cell->sequence, position + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+	return true;
+}
+
+// Claims a run of consecutive free cells with a single CAS. A cell that is free for the
+// current lap stays free until a producer claims it, which requires moving the enqueue
+// position past it, so checking the run before the CAS is enough.
+template <typename T>
+inline static U64
+mpmc_queue_push_batch(Mpmc_Queue<T> &self, Slice<const std::type_identity_t<T>> values)
+{
+	if (values.count == 0)
+		return 0;
+
+	U64 mask = self.capacity - 1;
+	U64 position = atomic_load(self.enqueue_position, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	U64 count = 0;
+	while (true)
+	{
+		U64 max_count = u64_min(values.count, self.capacity);
+		count = 0;
+		while (count < max_count && atomic_load(self.cells[(position + count) & mask].sequence, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE) == position + count)
+			++count;
+
+		if (count == 0)
+		{
+			I64 difference = (I64)(atomic_load(self.cells[position & mask].sequence, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE) - position);
+			if (difference < 0)
+				return 0;
+			position = atomic_load(self.enqueue_position, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+			continue;
+		}
+
+		if (atomic_compare_exchange(self.enqueue_position, position, position + count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED))
+			break;
+	}
+
+	for (U64 i = 0; i < count; ++i)
+	{
+		Mpmc_Queue_Cell<T> *cell = &self.cells[(position + i) & mask];
+		cell->value = values.data[i];
+		atomic_store(cell->sequence, position + i + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+	}
+	return count;
+}
+
+template <typename T>
+inline static bool
+mpmc_queue_pop(Mpmc_Queue<T> &self, T &value)
+{
+	U64 mask = self.capacity - 1;
+	U64 position = atomic_load(self.dequeue_position, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	Mpmc_Queue_Cell<T> *cell = nullptr;
+	while (true)
+	{
+		cell = &self.cells[position & mask];
+		I64 difference = (I64)(atomic_load(cell->sequence, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE) - (position + 1));
+		if (difference == 0)
+		{
+			if (atomic_compare_exchange(self.dequeue_position, position, position + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED))
+				break;
+		}
+		else if (difference < 0)
+		{
+			return false;
+		}
+		else
+		{
+			position = atomic_load(self.dequeue_position, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		}
+	}
+
+	value = cell->value;
+	atomic_store(cell->sequence, position + mask + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+	return true;
+}
+
+template <typename T>
+inline static U64
+mpmc_queue_pop_batch(Mpmc_Queue<T> &self, Slice<std::type_identity_t<T>> values)
+{
+	if (values.count == 0)
+		return 0;
+
+	U64 mask = self.capacity - 1;
+	U64 position = atomic_load(self.dequeue_position, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	U64 count = 0;
+	while (true)
+	{
+		U64 max_count = u64_min(values.count, self.capacity);
+		count = 0;
+		while (count < max_count && atomic_load(self.cells[(position + count) & mask].sequence, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE) == position + count + 1)
+			++count;
+
+		if (count == 0)
+		{
+			I64 difference = (I64)(atomic_load(self.cells[position & mask].sequence, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE) - (position + 1));
+			if (difference < 0)
+				return 0;
+			position = atomic_load(self.dequeue_position, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+			continue;
+		}
+
+		if (atomic_compare_exchange(self.dequeue_position, position, position + count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED))
+			break;
+	}
+
+	for (U64 i = 0; i < count; ++i)
+	{
+		Mpmc_Queue_Cell<T> *cell = &self.cells[(position + i) & mask];
+		values.data[i] = cell->value;
+		atomic_store(cell->sequence, position + i + mask + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+	}
+	return count;
+}
+
+// Approximate when called while producers or consumers are running.
+template <typename T>
+inline static U64
+mpmc_queue_count(const Mpmc_Queue<T> &self)
+{
+	U64 dequeue_position = atomic_load(self.dequeue_position, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE);
+	U64 enqueue_position = atomic_load(self.enqueue_position, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE);
+	return enqueue_position > dequeue_position ? enqueue_position - dequeue_position : 0;
+}
+
+template <typename T>
+inline static bool
+mpmc_queue_is_empty(const Mpmc_Queue<T> &self)
+{
+	return mpmc_queue_count(self) == 0;
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/atomic.h"
+#include "core/validate.h"
+#include "core/math/u64.h"
+#include "core/memory/allocator.h"
+#include "core/containers/slice.h"
+
+#include <type_traits>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Head and tail live on separate cache lines; each side caches the other side's index
+// and only reloads it when the queue looks full or empty.
+template <typename T>
+struct Spsc_Queue
+{
+	memory::Allocator *allocator;
+	T *data;
+	U64 capacity;
+	alignas(CACHE_LINE_SIZE) Atomic<U64> head;
+	U64 cached_tail;
+	alignas(CACHE_LINE_SIZE) Atomic<U64> tail;
+	U64 cached_head;
+};
+
+template <typename T>
+inline static Spsc_Queue<T>
+spsc_queue_init(U64 capacity, memory::Allocator *allocator = memory::heap_allocator())
+{
+	validate(capacity > 0, "[SPSC_QUEUE]: Capacity must be greater than 0.");
+	allocator = allocator ? allocator : memory::heap_allocator();
+	capacity = u64_next_power_of_two(capacity);
+	return Spsc_Queue<T> {
+		.allocator = allocator,
+		.data = (T *)memory::allocate(allocator, capacity * sizeof(T), alignof(T)).data,
+		.capacity = capacity,
+		.head = atomic_init((U64)0),
+		.cached_tail = 0,
+		.tail = atomic_init((U64)0),
+		.cached_head = 0
+	};
+}
+
+template <typename T>
+inline static void
+spsc_queue_deinit(Spsc_Queue<T> &self)
+{
+	if (self.data != nullptr)
+		memory::deallocate(self.allocator, Memory_Block{self.data, self.capacity * sizeof(T)});
+	self.data = nullptr;
+	self.capacity = 0;
+	atomic_store(self.head, (U64)0);
+	atomic_store(self.tail, (U64)0);
+	self.cached_head = 0;
+	self.cached_tail = 0;
+}
+
+// Producer only.
+template <typename T, typename R>
+inline static bool
+spsc_queue_push(Spsc_Queue<T> &self, const R &value)
+{
+	U64 tail = atomic_load(self.tail, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	if (tail - self.cached_head == self.capacity)
+	{
+		self.cached_head = atomic_load(self.head, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE);
+		if (tail - self.cached_head == self.capacity)
+			return false;
+	}
+
+	self.data[tail & (self.capacity - 1)] = (T)value;
+	atomic_store(self.tail, tail + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+	return true;
+}
+
+// Producer only. Returns the number of leading values pushed; the tail is published once.
+template <typename T>
+inline static U64
+spsc_queue_push_batch(Spsc_Queue<T> &self, Slice<const std::type_identity_t<T>> values)
+{
+	U64 tail = atomic_load(self.tail, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	U64 free_count = self.capacity - (tail - self.cached_head);
+	if (free_count < values.count)
+	{
+		self.cached_head = atomic_load(self.head, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE);
+		free_count = self.capacity - (tail - self.cached_head);
+	}
+
+	U64 count = u64_min(free_count, values.count);
+	if (count == 0)
+		return 0;
+
+	U64 mask = self.capacity - 1;
+	for (U64 i = 0; i < count; ++i)
+		self.data[(tail + i) & mask] = values.data[i];
+	atomic_store(self.tail, tail + count, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+	return count;
+}
+
+// Consumer only.
+template <typename T>
+inline static bool
+spsc_queue_pop(Spsc_Queue<T> &self, T &value)
+{
+	U64 head = atomic_load(self.head, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	if (head == self.cached_tail)
+	{
+		self.cached_tail = atomic_load(self.tail, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE);
+		if (head == self.cached_tail)
+			return false;
+	}
+
+	value = self.data[head & (self.capacity - 1)];
+	atomic_store(self.head, head + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+	return true;
+}
+
+// Consumer only. Fills the front of `values` and returns how many were popped; the head is published once.
+template <typename T>
+inline static U64
+spsc_queue_pop_batch(Spsc_Queue<T> &self, Slice<std::type_identity_t<T>> values)
+{
+	U64 head = atomic_load(self.head, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	U64 available_count = self.cached_tail - head;
+	if (available_count < values.count)
+	{
+		self.cached_tail = atomic_load(self.tail, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE);
+		available_count = self.cached_tail - head;
+	}
+
+	U64 count = u64_min(available_count, values.count);
+	if (count == 0)
+		return 0;
+
+	U64 mask = self.capacity - 1;
+	for (U64 i = 0; i < count; ++i)
+		values.data[i] = self.data[(head + i) & mask];
+	atomic_store(self.head, head + count, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+	return count;
+}
+
+// Approximate when called while the other side is running.
+template <typename T>
+inline static U64
+spsc_queue_count(const Spsc_Queue<T> &self)
+{
+	U64 head = atomic_load(self.head, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE);
+	U64 tail = atomic_load(self.tail, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE);
+	return tail - head;
+}
+
+template <typename T>
+inline static bool
+spsc_queue_is_empty(const Spsc_Queue<T> &self)
+{
+	return spsc_queue_count(self) == 0;
+}
\ No newline at end of file
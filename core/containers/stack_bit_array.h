@@ -0,0 +1,131 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/validate.h"
+#include "core/containers/bit_array.h"
+
+// Fixed-size Bit_Array with inline storage, all bits start unset.
+template <U64 N>
+struct Stack_Bit_Array
+{
+	static constexpr U64 WORD_COUNT = (N + 63) / 64;
+
+	U64 words[WORD_COUNT];
+
+	Stack_Bit_Array() : words() {}
+
+	inline bool
+	operator[](U64 index) const
+	{
+		validate(index < N, "[STACK_BIT_ARRAY]: Access out of range.");
+		return (words[index / 64] >> (index % 64)) & 1;
+	}
+};
+
+template <U64 N>
+inline static bool
+stack_bit_array_get(const Stack_Bit_Array<N> &self, U64 index)
+{
+	return self[index];
+}
+
+template <U64 N>
+inline static void
+stack_bit_array_set(Stack_Bit_Array<N> &self, U64 index)
+{
+	validate(index < N, "[STACK_BIT_ARRAY]: Access out of range.");
+	self.words[index / 64] |= 1ull << (index % 64);
+}
+
+template <U64 N>
+inline static void
+stack_bit_array_unset(Stack_Bit_Array<N> &self, U64 index)
+{
+	validate(index < N, "[STACK_BIT_ARRAY]: Access out of range.");
+	self.words[index / 64] &= ~(1ull << (index % 64));
+}
+
+template <U64 N>
+inline static void
+stack_bit_array_set_all(Stack_Bit_Array<N> &self)
+{
+	for (U64 i = 0; i < self.WORD_COUNT; ++i)
+		self.words[i] = ~0ull;
+	self.words[self.WORD_COUNT - 1] = _bit_array_tail_mask(N);
+}
+
+template <U64 N>
+inline static void
+stack_bit_array_unset_all(Stack_Bit_Array<N> &self)
+{
+	for (U64 i = 0; i < self.WORD_COUNT; ++i)
+		self.words[i] = 0;
+}
+
+template <U64 N>
+inline static U64
+stack_bit_array_count_set(const Stack_Bit_Array<N> &self)
+{
+	return _bit_array_words_popcount(self.words, self.WORD_COUNT);
+}
+
+template <U64 N>
+inline static bool
+stack_bit_array_any(const Stack_Bit_Array<N> &self)
+{
+	return _bit_array_words_any(self.words, self.WORD_COUNT);
+}
+
+template <U64 N>
+inline static bool
+stack_bit_array_none(const Stack_Bit_Array<N> &self)
+{
+	return !stack_bit_array_any(self);
+}
+
+// Returns `N` when there is no set bit at or after `from`.
+template <U64 N>
+inline static U64
+stack_bit_array_find_next_set(const Stack_Bit_Array<N> &self, U64 from = 0)
+{
+	return _bit_array_words_find_next_set(self.words, N, from);
+}
+
+// Returns `N` when there is no unset bit at or after `from`.
+template <U64 N>
+inline static U64
+stack_bit_array_find_next_unset(const Stack_Bit_Array<N> &self, U64 from = 0)
+{
+	return _bit_array_words_find_next_unset(self.words, N, from);
+}
+
+// self &= other.
+template <U64 N>
+inline static void
+stack_bit_array_and(Stack_Bit_Array<N> &self, const Stack_Bit_Array<N> &other)
+{
+	_bit_array_words_and(self.words, other.words, self.WORD_COUNT);
+}
+
+// self |= other.
+template <U64 N>
+inline static void
+stack_bit_array_or(Stack_Bit_Array<N> &self, const Stack_Bit_Array<N> &other)
+{
+	_bit_array_words_or(self.words, other.words, self.WORD_COUNT);
+}
+
+// self &= ~other.
+template <U64 N>
+inline static void
+stack_bit_array_and_not(Stack_Bit_Array<N> &self, const Stack_Bit_Array<N> &other)
+{
+	_bit_array_words_and_not(self.words, other.words, self.WORD_COUNT);
+}
+
+template <U64 N>
+inline static Bit_Array_Set_Bits
+stack_bit_array_set_bits(const Stack_Bit_Array<N> &self)
+{
+	return Bit_Array_Set_Bits{self.words, self.WORD_COUNT};
+}
\ No newline at end of file
@@ -59,6 +59,9 @@
 	#define NO_UNIQUE_ADDRESS [[no_unique_address]]
 #endif
 
+// Alignment used to keep independently written shared data on separate cache lines.
+#define CACHE_LINE_SIZE 64
+
 #define I8_MIN  INT8_MIN
 #define I8_MAX  INT8_MAX
 #define I16_MIN INT16_MIN
@@ -1,13 +1,341 @@
 #include "ecs.h"
 
 #include "core/atomic.h"
+#include "core/compiler/compiler.h"
+#include "core/memory/allocator.h"
+
+#include <string.h>
 
 namespace ecs
 {
+	inline static U64
+	_ecs_align_up(U64 value, U64 alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	// The entity column comes first, followed by one column per component in component index order.
+	inline static U64
+	_ecs_archetype_layout(const ECS &self, Archetype &archetype, U32 chunk_capacity)
+	{
+		U64 offset = sizeof(Entity) * chunk_capacity;
+		for (U64 bits = archetype.mask; bits != 0; bits &= bits - 1)
+		{
+			U32 index = compiler_trailing_zero_count_u64(bits);
+			const Component_Info &component = self.components[index];
+			offset = _ecs_align_up(offset, component.alignment);
+			archetype.column_offsets[index] = offset;
+			offset += component.size * chunk_capacity;
+		}
+		return offset;
+	}
+
+	inline static U32
+	_ecs_archetype_find_or_add(ECS &self, U64 mask)
+	{
+		if (auto entry = hash_table_find(self.archetype_indices, mask))
+			return entry->value;
+
+		Archetype archetype = {
+			.mask = mask,
+			.chunk_alignment = alignof(Entity),
+			.chunks = array_init<U8 *>()
+		};
+		for (U64 &offset : archetype.column_offsets)
+			offset = ECS_INVALID_COLUMN_OFFSET;
+
+		U64 row_size = sizeof(Entity);
+		for (U64 bits = mask; bits != 0; bits &= bits - 1)
+		{
+			const Component_Info &component = self.components[compiler_trailing_zero_count_u64(bits)];
+			row_size += component.size;
+			if (component.alignment > archetype.chunk_alignment)
+				archetype.chunk_alignment = component.alignment;
+		}
+
+		// Padding between columns can push a chunk past its size, so the capacity shrinks until the layout fits.
+		U32 chunk_capacity = row_size < ECS_CHUNK_SIZE ? (U32)(ECS_CHUNK_SIZE / row_size) : 1;
+		while (chunk_capacity > 1 && _ecs_archetype_layout(self, archetype, chunk_capacity) > ECS_CHUNK_SIZE)
+			--chunk_capacity;
+		archetype.chunk_capacity = chunk_capacity;
+		archetype.chunk_size = _ecs_archetype_layout(self, archetype, chunk_capacity);
+
+		U32 archetype_index = (U32)self.archetypes.count;
+		array_push(self.archetypes, archetype);
+		hash_table_insert(self.archetype_indices, mask, archetype_index);
+		return archetype_index;
+	}
+
+	inline static U32
+	_ecs_archetype_push(Archetype &archetype, Entity e)
+	{
+		U32 row = archetype.count;
+		if (row == archetype.chunks.count * archetype.chunk_capacity)
+			array_push(archetype.chunks, (U8 *)memory::allocate(archetype.chunk_size, archetype.chunk_alignment).data);
+
+		++archetype.count;
+		ecs_archetype_entities(archetype, row / archetype.chunk_capacity)[row % archetype.chunk_capacity] = e;
+		return row;
+	}
+
+	// Moves the archetype's last row into `row`, then releases the last chunk once it is empty.
+	inline static void
+	_ecs_archetype_remove(ECS &self, Archetype &archetype, U32 row)
+	{
+		U32 last_row = archetype.count - 1;
+		if (row != last_row)
+		{
+			Entity moved_entity = ecs_archetype_entities(archetype, last_row / archetype.chunk_capacity)[last_row % archetype.chunk_capacity];
+			ecs_archetype_entities(archetype, row / archetype.chunk_capacity)[row % archetype.chunk_capacity] = moved_entity;
+			for (U64 bits = archetype.mask; bits != 0; bits &= bits - 1)
+			{
+				U32 index = compiler_trailing_zero_count_u64(bits);
+				U64 size = self.components[index].size;
+				::memcpy(ecs_archetype_component(archetype, row, index, size), ecs_archetype_component(archetype, last_row, index, size), size);
+			}
+			self.entity_slots[entity_index(moved_entity)].row = row;
+		}
+
+		--archetype.count;
+		if (archetype.count == (archetype.chunks.count - 1) * archetype.chunk_capacity)
+		{
+			memory::deallocate(Memory_Block{archetype.chunks[archetype.chunks.count - 1], archetype.chunk_size});
+			array_pop(archetype.chunks);
+		}
+	}
+
+	// Moves an entity that already has components to the archetype of `mask`, copying the components both archetypes share.
+	inline static Entity_Location
+	_ecs_entity_move(ECS &self, Entity e, Entity_Location from, U64 mask)
+	{
+		U32 archetype_index = _ecs_archetype_find_or_add(self, mask);
+		Archetype &source = self.archetypes[from.archetype_index];
+		Archetype &target = self.archetypes[archetype_index];
+
+		U32 row = _ecs_archetype_push(target, e);
+		for (U64 bits = source.mask & target.mask; bits != 0; bits &= bits - 1)
+		{
+			U32 index = compiler_trailing_zero_count_u64(bits);
+			U64 size = self.components[index].size;
+			::memcpy(ecs_archetype_component(target, row, index, size), ecs_archetype_component(source, from.row, index, size), size);
+		}
+		_ecs_archetype_remove(self, source, from.row);
+
+		return Entity_Location{archetype_index, row};
+	}
+
+	// Runs once per type and module, so a linear scan under a spin lock is enough, and it allocates nothing that could be reported as a leak.
+	U32
+	ecs_component_type_id(Component_Hash hash)
+	{
+		static Atomic<U32> lock = atomic_init((U32)0);
+		static Component_Hash hashes[ECS_MAX_COMPONENT_TYPE_COUNT];
+		static U32 count = 0;
+
+		U32 expected = 0;
+		while (!atomic_compare_exchange(lock, expected, (U32)1, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE))
+		{
+			expected = 0;
+			compiler_cpu_pause();
+		}
+
+		U32 type_id = 0;
+		while (type_id < count && hashes[type_id] != hash)
+			++type_id;
+
+		if (type_id == count)
+		{
+			validate(count < ECS_MAX_COMPONENT_TYPE_COUNT, "[ECS]: Too many component types, the limit is 1024 per process.");
+			hashes[count++] = hash;
+		}
+
+		atomic_store(lock, (U32)0, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+		return type_id;
+	}
+
+	U32
+	ecs_component_register(ECS &self, U32 type_id, U64 size, U64 alignment)
+	{
+		if (type_id < self.component_indices.count && self.component_indices[type_id] != ECS_INVALID_INDEX)
+			return self.component_indices[type_id];
+
+		validate(self.components.count < ECS_MAX_COMPONENT_COUNT, "[ECS]: Too many component types, the limit is 64.");
+		if (type_id >= self.component_indices.count)
+		{
+			U64 old_count = self.component_indices.count;
+			array_resize(self.component_indices, type_id + 1);
+			for (U64 i = old_count; i < self.component_indices.count; ++i)
+				self.component_indices[i] = ECS_INVALID_INDEX;
+		}
+
+		U32 index = (U32)self.components.count;
+		array_push(self.components, Component_Info{size, alignment});
+		self.component_indices[type_id] = index;
+		return index;
+	}
+
+	void *
+	ecs_component_write(ECS &self, Entity e, U32 component_index)
+	{
+		validate(component_index < self.components.count, "[ECS]: Invalid component index.");
+		U64 component_bit = (U64)1 << component_index;
+		U64 component_size = self.components[component_index].size;
+
+		Entity_Slot *slot = (Entity_Slot *)self.entity_slot(e);
+		validate(slot != nullptr, "[ECS]: Entity is not alive.");
+
+		if (slot->archetype_index == ECS_INVALID_INDEX)
+		{
+			slot->archetype_index = _ecs_archetype_find_or_add(self, component_bit);
+			slot->row = _ecs_archetype_push(self.archetypes[slot->archetype_index], e);
+		}
+		else
+		{
+			const Archetype &archetype = self.archetypes[slot->archetype_index];
+			if (archetype.mask & component_bit)
+				return ecs_archetype_component(archetype, slot->row, component_index, component_size);
+
+			Entity_Location location = _ecs_entity_move(self, e, Entity_Location{slot->archetype_index, slot->row}, archetype.mask | component_bit);
+			slot->archetype_index = location.archetype_index;
+			slot->row = location.row;
+		}
+
+		void *component = ecs_archetype_component(self.archetypes[slot->archetype_index], slot->row, component_index, component_size);
+		::memset(component, 0, component_size);
+		return component;
+	}
+
+	void
+	ecs_component_remove(ECS &self, Entity e, U32 component_index)
+	{
+		validate(component_index < self.components.count, "[ECS]: Invalid component index.");
+		U64 component_bit = (U64)1 << component_index;
+
+		Entity_Slot *slot = (Entity_Slot *)self.entity_slot(e);
+		if (slot == nullptr || slot->archetype_index == ECS_INVALID_INDEX)
+			return;
+
+		U64 mask = self.archetypes[slot->archetype_index].mask;
+		if ((mask & component_bit) == 0)
+			return;
+
+		// An entity without components stays alive but is not stored in any archetype.
+		if (mask == component_bit)
+		{
+			_ecs_archetype_remove(self, self.archetypes[slot->archetype_index], slot->row);
+			slot->archetype_index = ECS_INVALID_INDEX;
+			return;
+		}
+
+		Entity_Location location = _ecs_entity_move(self, e, Entity_Location{slot->archetype_index, slot->row}, mask & ~component_bit);
+		slot->archetype_index = location.archetype_index;
+		slot->row = location.row;
+	}
+
+	Array<Entity>
+	ecs_entity_list(ECS &self, U64 mask)
+	{
+		Array<Entity> entities = array_init<Entity>(memory::temp_allocator());
+		for (const Archetype &archetype : self.archetypes)
+		{
+			if ((archetype.mask & mask) != mask)
+				continue;
+
+			for (U32 chunk_index = 0; chunk_index < archetype.chunks.count; ++chunk_index)
+			{
+				Entity *chunk_entities = ecs_archetype_entities(archetype, chunk_index);
+				for (U32 row = 0; row < ecs_archetype_chunk_count(archetype, chunk_index); ++row)
+					array_push(entities, chunk_entities[row]);
+			}
+		}
+		return entities;
+	}
+
 	Entity
-	entity_new()
+	ecs_entity_new(ECS &self)
 	{
-		static Atomic<U64> id = atomic_init((U64)0);
-		return Entity { atomic_fetch_add(id, (U64)1) };
+		U32 index = self.free_entity_slot;
+		if (index == ECS_INVALID_INDEX)
+		{
+			validate(self.entity_slots.count < ECS_INVALID_INDEX, "[ECS]: Too many entities.");
+			index = (U32)self.entity_slots.count;
+			array_push(self.entity_slots, Entity_Slot{});
+		}
+		else
+		{
+			self.free_entity_slot = self.entity_slots[index].row;
+		}
+
+		Entity_Slot &slot = self.entity_slots[index];
+		slot.archetype_index = ECS_INVALID_INDEX;
+		slot.row = ECS_INVALID_INDEX;
+		slot.is_alive = true;
+		++self.entity_count;
+		return Entity{((U64)slot.generation << 32) | index};
+	}
+
+	void
+	ecs_entity_new(ECS &self, Slice<Entity> entities)
+	{
+		array_reserve(self.entity_slots, entities.count);
+		for (Entity &e : entities)
+			e = ecs_entity_new(self);
+	}
+
+	void
+	ecs_entity_free(ECS &self, Entity e)
+	{
+		Entity_Slot *slot = (Entity_Slot *)self.entity_slot(e);
+		if (slot == nullptr)
+			return;
+
+		if (slot->archetype_index != ECS_INVALID_INDEX)
+			_ecs_archetype_remove(self, self.archetypes[slot->archetype_index], slot->row);
+
+		// Wrapping around after 2^32 reuses of one slot is accepted.
+		++slot->generation;
+		slot->archetype_index = ECS_INVALID_INDEX;
+		slot->row = self.free_entity_slot;
+		slot->is_alive = false;
+		self.free_entity_slot = entity_index(e);
+		--self.entity_count;
+	}
+
+	void
+	ecs_entity_free(ECS &self, Slice<const Entity> entities)
+	{
+		for (Entity e : entities)
+			ecs_entity_free(self, e);
+	}
+
+	ECS
+	ecs_new()
+	{
+		return ECS {
+			.components = array_init<Component_Info>(),
+			.component_indices = array_init<U32>(),
+			.archetypes = array_init<Archetype>(),
+			.archetype_indices = hash_table_init<U64, U32>(),
+			.entity_slots = array_init<Entity_Slot>(),
+			.free_entity_slot = ECS_INVALID_INDEX,
+			.entity_count = 0
+		};
+	}
+
+	void
+	ecs_free(ECS &self)
+	{
+		for (Archetype &archetype : self.archetypes)
+		{
+			for (U8 *chunk : archetype.chunks)
+				memory::deallocate(Memory_Block{chunk, archetype.chunk_size});
+			array_deinit(archetype.chunks);
+		}
+
+		array_deinit(self.components);
+		array_deinit(self.component_indices);
+		array_deinit(self.archetypes);
+		hash_table_deinit(self.archetype_indices);
+		array_deinit(self.entity_slots);
 	}
 }
\ No newline at end of file
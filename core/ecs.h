@@ -2,16 +2,19 @@
 
 #include "core/export.h"
 #include "core/defines.h"
-#include "core/memory/pool_allocator.h"
-#include "core/memory/arena_allocator.h"
+#include "core/validate.h"
+#include "core/containers/array.h"
+#include "core/containers/slice.h"
 #include "core/containers/hash_table.h"
 
 #include <type_traits>
 #include <typeinfo>
 #include <concepts>
+#include <utility>
 
 namespace ecs
 {
+	// The slot index in the low 32 bits and the slot generation in the high 32 bits.
 	struct Entity
 	{
 		U64 id = U64_MAX;
@@ -29,191 +32,305 @@ namespace ecs
 		}
 	};
 
-	CORE_API Entity
-	entity_new();
+	inline static U32
+	entity_index(Entity e)
+	{
+		return (U32)e.id;
+	}
+
+	inline static U32
+	entity_generation(Entity e)
+	{
+		return (U32)(e.id >> 32);
+	}
 
 	typedef U64 Component_Hash;
 
-	struct IComponent_Table
+	template <typename T>
+	concept Component_Type = std::is_compound_v<T>;
+
+	/*
+		Entities with the same set of components share an archetype. An archetype stores its entities in
+		fixed size chunks, and each chunk holds the entity ids followed by one contiguous column per
+		component, so iterating a component walks dense memory instead of chasing one pointer per entity.
+
+		Writing a component an entity does not have yet, or removing one it has, moves the entity's row to
+		the archetype of its new component set. A row is removed by moving the archetype's last row into the
+		hole, which keeps every chunk but the last one full and does not preserve order.
+
+		Components are plain memory: they are zero initialized when added, moved with `memcpy`, and never
+		constructed or destroyed. Pointers returned by read and write are invalidated by any add, remove or
+		entity free that touches the same archetype.
+	*/
+	constexpr U32 ECS_MAX_COMPONENT_COUNT = 64;
+	constexpr U32 ECS_MAX_COMPONENT_TYPE_COUNT = 1024;
+	constexpr U64 ECS_CHUNK_SIZE = 16 * 1024;
+	constexpr U64 ECS_INVALID_COLUMN_OFFSET = U64_MAX;
+	constexpr U32 ECS_INVALID_INDEX = U32_MAX;
+
+	struct Component_Info
 	{
-		virtual ~IComponent_Table() = default;
-		[[nodiscard]] virtual const void *read(Entity e) const = 0;
-		[[nodiscard]] virtual void *write(Entity e) = 0;
-		virtual void remove(Entity e) = 0;
-		[[nodiscard]] virtual const char *name() const = 0;
-		[[nodiscard]] virtual Array<Entity> entities() const = 0;
-		[[nodiscard]] virtual IComponent_Table *reload() = 0;
-		virtual void deinit() = 0;
+		U64 size;
+		U64 alignment;
 	};
 
-	template <typename T>
-	concept Component_Type = std::is_compound_v<T>;
+	struct Archetype
+	{
+		U64 mask;
+		U32 count;
+		U32 chunk_capacity;
+		U64 chunk_size;
+		U64 chunk_alignment;
+		// Byte offset of each component's column inside a chunk, ECS_INVALID_COLUMN_OFFSET for components not in the mask.
+		U64 column_offsets[ECS_MAX_COMPONENT_COUNT];
+		Array<U8 *> chunks;
+	};
 
-	template <Component_Type T>
-	struct Component_Table : IComponent_Table
+	struct Entity_Location
 	{
-		memory::Pool_Allocator *pool;
-		Hash_Table<U64, T *> components;
-		inline static const char *table_name = typeid(T).name();
+		U32 archetype_index;
+		U32 row;
+	};
 
-		Component_Table()
-		{
-			pool       = memory::pool_allocator_init(sizeof(T), 64);
-			components = hash_table_init<U64, T *>();
-		}
+	/*
+		Entities are slots in a per world registry. Freeing an entity bumps its slot's generation and puts the
+		slot on a free list for reuse, so an `Entity` kept after `ecs_entity_free` no longer matches its slot
+		and is detected in O(1), even once the slot belongs to a new entity. The slot also records where the
+		entity's row lives, which makes finding a component an array index instead of a hash lookup.
+	*/
+	struct Entity_Slot
+	{
+		U32 generation;
+		// ECS_INVALID_INDEX while the entity has no components.
+		U32 archetype_index;
+		// Row in the archetype while alive, next free slot or ECS_INVALID_INDEX while free.
+		U32 row;
+		bool is_alive;
+	};
 
-		~Component_Table() override
-		{
-			memory::pool_allocator_deinit(pool);
-			hash_table_deinit(components);
-		}
+	struct ECS;
 
-		[[nodiscard]] const void *
-		read(Entity e) const override
-		{
-			if (auto it = hash_table_find(components, e.id))
-				return it->value;
-			return nullptr;
-		}
+	/*
+		Every component type gets a dense type id the first time it is used, shared by all worlds. Ids are
+		handed out by the core library and keyed by the type's hash, so a type gets the same id from every
+		module and after a module is reloaded. Each module caches the id in a function local static, which
+		leaves one guarded load per access instead of hashing the type name and looking it up.
+	*/
+	CORE_API U32
+	ecs_component_type_id(Component_Hash hash);
 
-		[[nodiscard]] void *
-		write(Entity e) override
-		{
-			auto entry = hash_table_find(components, e.id);
-			if (entry == nullptr)
-			{
-				T *new_component = (T *)memory::pool_allocator_allocate(pool).data;
-				entry = hash_table_insert(components, e.id, new_component);
-			}
-			return entry->value;
-		}
+	template <typename T>
+	inline static U32
+	component_type_id()
+	{
+		static const U32 type_id = ecs_component_type_id((U64)typeid(T).hash_code());
+		return type_id;
+	}
 
-		void
-		remove(Entity e) override
+	CORE_API U32
+	ecs_component_register(ECS &self, U32 type_id, U64 size, U64 alignment);
+
+	CORE_API void *
+	ecs_component_write(ECS &self, Entity e, U32 component_index);
+
+	CORE_API void
+	ecs_component_remove(ECS &self, Entity e, U32 component_index);
+
+	// Entities that have every component in the mask, allocated from the temp allocator.
+	CORE_API Array<Entity>
+	ecs_entity_list(ECS &self, U64 mask);
+
+	CORE_API Entity
+	ecs_entity_new(ECS &self);
+
+	CORE_API void
+	ecs_entity_new(ECS &self, Slice<Entity> entities);
+
+	// Frees the entity and its components. Entities that are not alive are ignored.
+	// TODO: Rename this to ecs_entity_remove()?
+	CORE_API void
+	ecs_entity_free(ECS &self, Entity e);
+
+	CORE_API void
+	ecs_entity_free(ECS &self, Slice<const Entity> entities);
+
+	inline static Entity *
+	ecs_archetype_entities(const Archetype &archetype, U32 chunk_index)
+	{
+		return (Entity *)archetype.chunks[chunk_index];
+	}
+
+	inline static U32
+	ecs_archetype_chunk_count(const Archetype &archetype, U32 chunk_index)
+	{
+		U32 begin = chunk_index * archetype.chunk_capacity;
+		return archetype.count - begin < archetype.chunk_capacity ? archetype.count - begin : archetype.chunk_capacity;
+	}
+
+	inline static void *
+	ecs_archetype_component(const Archetype &archetype, U32 row, U32 component_index, U64 component_size)
+	{
+		U8 *chunk = archetype.chunks[row / archetype.chunk_capacity];
+		return chunk + archetype.column_offsets[component_index] + (row % archetype.chunk_capacity) * component_size;
+	}
+
+	template <typename ...TArgs, typename TFunction, U64 ...I>
+	inline static void
+	_ecs_chunk_call(Entity *entities, U32 count, U8 *const *columns, TFunction &function, std::index_sequence<I...>)
+	{
+		function(entities, count, (TArgs *)columns[I]...);
+	}
+
+	// Calls `function(Entity *entities, U32 count, TArgs *...columns)` once per chunk of the archetype.
+	template <typename ...TArgs, typename TFunction>
+	inline static void
+	_ecs_archetype_for_each_chunk(const Archetype &archetype, const U32 *component_indices, TFunction &&function)
+	{
+		for (U32 chunk_index = 0; chunk_index < archetype.chunks.count; ++chunk_index)
 		{
-			if (auto entry = hash_table_find(components, e.id))
-			{
-				memory::pool_allocator_deallocate(pool, Memory_Block{entry->value, sizeof(T)});
-				hash_table_remove(components, e.id);
-			}
+			U8 *columns[sizeof...(TArgs)];
+			for (U64 i = 0; i < sizeof...(TArgs); ++i)
+				columns[i] = archetype.chunks[chunk_index] + archetype.column_offsets[component_indices[i]];
+			_ecs_chunk_call<TArgs...>(ecs_archetype_entities(archetype, chunk_index), ecs_archetype_chunk_count(archetype, chunk_index), columns, function, std::make_index_sequence<sizeof...(TArgs)>{});
 		}
+	}
 
-		[[nodiscard]] const char *
-		name() const override
+	struct ECS
+	{
+		Array<Component_Info> components;
+		// Component index of each registered type id, ECS_INVALID_INDEX for types the world does not know.
+		Array<U32> component_indices;
+		Array<Archetype> archetypes;
+		Hash_Table<U64, U32> archetype_indices;
+		Array<Entity_Slot> entity_slots;
+		U32 free_entity_slot;
+		U32 entity_count;
+
+		// `const T` shares the index of `T`.
+		template <Component_Type T>
+		U32
+		component_index() const
 		{
-			return table_name;
+			U32 type_id = component_type_id<std::remove_cv_t<T>>();
+			U32 index = type_id < component_indices.count ? component_indices[type_id] : ECS_INVALID_INDEX;
+			validate(index != ECS_INVALID_INDEX, "[ECS]: Component type is not registered, call ecs_add_table first.");
+			return index;
 		}
 
-		[[nodiscard]] Array<Entity>
-		entities() const override
+		template <Component_Type ...TArgs>
+		U64
+		component_mask() const
 		{
-			auto entities = array_init<Entity>(memory::temp_allocator());
-			for (auto [k, _] : components)
-				array_push(entities, Entity{k});
-			return entities;
+			return (((U64)1 << component_index<TArgs>()) | ...);
 		}
 
-		[[nodiscard]] IComponent_Table *
-		reload() override
+		// Returns nullptr if the entity is not alive.
+		const Entity_Slot *
+		entity_slot(Entity e) const
 		{
-			auto res = memory::allocate_zeroed<Component_Table<T>>();
-			std::swap(res->pool, this->pool);
-			std::swap(res->components, this->components);
-			return res;
+			U32 index = entity_index(e);
+			if (index >= entity_slots.count)
+				return nullptr;
+
+			const Entity_Slot &slot = entity_slots[index];
+			if (!slot.is_alive || slot.generation != entity_generation(e))
+				return nullptr;
+			return &slot;
 		}
 
-		void
-		deinit() override
+		const void *
+		read(Entity e, U32 index) const
 		{
-			memory::deallocate_and_call_destructor(this);
+			const Entity_Slot *slot = entity_slot(e);
+			if (slot == nullptr || slot->archetype_index == ECS_INVALID_INDEX)
+				return nullptr;
+
+			const Archetype &archetype = archetypes[slot->archetype_index];
+			if ((archetype.mask & ((U64)1 << index)) == 0)
+				return nullptr;
+			return ecs_archetype_component(archetype, slot->row, index, components[index].size);
 		}
-	};
-
-	struct ECS
-	{
-		Hash_Table<Component_Hash, IComponent_Table *> component_tables;
 
 		template <Component_Type T>
 		const T *
 		read(Entity e)
 		{
-			const auto [_, v] = *hash_table_find(component_tables, (U64)typeid(T).hash_code());
-			return (const T *)v->read(e);
+			return (const T *)read(e, component_index<T>());
 		}
 
 		template <Component_Type T>
 		T *
 		write(Entity e)
 		{
-			auto [_, v] = *hash_table_find(component_tables, (U64)typeid(T).hash_code());
-			return (T *)v->write(e);
+			return (T *)ecs_component_write(*this, e, component_index<T>());
 		}
 
 		template <Component_Type T>
 		void
 		remove(Entity e)
 		{
-			auto [_, v] = *hash_table_find(component_tables, (U64)typeid(T).hash_code());
-			v->remove(e);
+			ecs_component_remove(*this, e, component_index<T>());
 		}
 
 		template <Component_Type ... TArgs>
 		Array<Entity>
 		list()
 		{
-			Array<Entity> entities[sizeof...(TArgs)] = { hash_table_find(component_tables, (U64)typeid(TArgs).hash_code())->value->entities()... };
-			U64 min_idx = U64(-1);
-			for (U64 i = 0; i < sizeof...(TArgs); ++i)
-				if (entities[i].count < min_idx)
-					min_idx = i;
+			return ecs_entity_list(*this, component_mask<TArgs...>());
+		}
 
-			IComponent_Table *tables[sizeof...(TArgs)] = { hash_table_find(component_tables, (U64)typeid(TArgs).hash_code())->value... };
-			Array<Entity> res = array_copy(entities[min_idx], memory::temp_allocator());
-			for (auto table : tables)
-				array_remove_if(res, [table](Entity e) { return table->read(e) == nullptr; });
+		// Visits every entity that has all of `TArgs`, chunk by chunk, as `function(Entity, TArgs &...)`.
+		template <Component_Type ...TArgs, typename TFunction>
+		void
+		for_each(TFunction &&function)
+		{
+			U32 indices[sizeof...(TArgs)] = {component_index<TArgs>()...};
+			U64 mask = 0;
+			for (U32 index : indices)
+				mask |= (U64)1 << index;
 
-			return res;
+			for (const Archetype &archetype : archetypes)
+			{
+				if ((archetype.mask & mask) != mask)
+					continue;
+
+				_ecs_archetype_for_each_chunk<TArgs...>(archetype, indices, [&](Entity *entities, U32 count, TArgs *...columns) {
+					for (U32 row = 0; row < count; ++row)
+						function(entities[row], columns[row]...);
+				});
+			}
 		}
 
+		// Components live in plain chunk memory with no virtual tables, so there is nothing that points into reloaded code.
 		void
 		reload()
 		{
-			for (auto& [_, v] : component_tables)
-			{
-				auto temp = v->reload();
-				std::swap(temp, v);
-				temp->deinit();
-			}
 		}
 
 		void
 		entity_free(Entity e)
 		{
-			for (auto [_, table] : component_tables)
-				table->remove(e);
+			ecs_entity_free(*this, e);
 		}
 	};
 
-	inline static ECS
-	ecs_new()
-	{
-		return {hash_table_init<Component_Hash, IComponent_Table *>()};
-	}
+	CORE_API ECS
+	ecs_new();
 
-	inline static void
-	ecs_free(ECS &self)
-	{
-		for (auto &[_, v] : self.component_tables)
-			v->deinit();
+	CORE_API void
+	ecs_free(ECS &self);
 
-		hash_table_deinit(self.component_tables);
+	inline static bool
+	ecs_entity_is_alive(const ECS &self, Entity e)
+	{
+		return self.entity_slot(e) != nullptr;
 	}
 
 	template <typename T>
 	inline static void
 	ecs_add_table(ECS &self)
 	{
-		hash_table_insert(self.component_tables, (U64)typeid(T).hash_code(), (IComponent_Table *)memory::allocate_and_call_constructor<Component_Table<T>>());
+		ecs_component_register(self, component_type_id<std::remove_cv_t<T>>(), sizeof(T), alignof(T));
 	}
 
 	template <Component_Type T>
@@ -244,17 +361,101 @@ namespace ecs
 		return self.list<TArgs...>();
 	}
 
-	// TODO: Test this.
+	template <Component_Type ...TArgs, typename TFunction>
 	inline static void
-	ecs_reload(ECS &self)
+	ecs_for_each(ECS &self, TFunction &&function)
 	{
-		self.reload();
+		self.for_each<TArgs...>(function);
 	}
 
-	// TODO: Rename this to ecs_entity_remove()?
+	/*
+		A query caches the archetypes that have all of `TArgs`. Archetypes are only ever added, so the cache
+		is brought up to date by checking the archetypes created since the last update, which costs nothing
+		when the set of component combinations did not change. Iterating allocates nothing and reads the
+		columns directly, without a lookup per entity.
+
+		`TArgs` may be const qualified to document read only access. The query keeps a pointer to the world,
+		which must not move while the query is used.
+	*/
+	template <Component_Type ...TArgs>
+	struct Query
+	{
+		ECS *ecs;
+		U64 mask;
+		U32 component_indices[sizeof...(TArgs)];
+		U32 checked_archetype_count;
+		Array<U32> archetype_indices;
+	};
+
+	template <Component_Type ...TArgs>
+	inline static Query<TArgs...>
+	ecs_query_init(ECS &self)
+	{
+		Query<TArgs...> query = {
+			.ecs = &self,
+			.mask = self.component_mask<TArgs...>(),
+			.component_indices = {self.component_index<TArgs>()...},
+			.checked_archetype_count = 0,
+			.archetype_indices = array_init<U32>()
+		};
+		return query;
+	}
+
+	template <Component_Type ...TArgs>
+	inline static void
+	ecs_query_deinit(Query<TArgs...> &self)
+	{
+		array_deinit(self.archetype_indices);
+		self = Query<TArgs...>{};
+	}
+
+	template <Component_Type ...TArgs>
+	inline static void
+	ecs_query_update(Query<TArgs...> &self)
+	{
+		const Array<Archetype> &archetypes = self.ecs->archetypes;
+		for (U32 i = self.checked_archetype_count; i < archetypes.count; ++i)
+			if ((archetypes[i].mask & self.mask) == self.mask)
+				array_push(self.archetype_indices, i);
+		self.checked_archetype_count = (U32)archetypes.count;
+	}
+
+	template <Component_Type ...TArgs>
+	inline static U64
+	ecs_query_count(Query<TArgs...> &self)
+	{
+		ecs_query_update(self);
+		U64 count = 0;
+		for (U32 archetype_index : self.archetype_indices)
+			count += self.ecs->archetypes[archetype_index].count;
+		return count;
+	}
+
+	// Calls `function(Entity *entities, U32 count, TArgs *...columns)` once per chunk, for loops that want the raw columns.
+	template <Component_Type ...TArgs, typename TFunction>
+	inline static void
+	ecs_query_for_each_chunk(Query<TArgs...> &self, TFunction &&function)
+	{
+		ecs_query_update(self);
+		for (U32 archetype_index : self.archetype_indices)
+			_ecs_archetype_for_each_chunk<TArgs...>(self.ecs->archetypes[archetype_index], self.component_indices, function);
+	}
+
+	// Calls `function(Entity e, TArgs &...components)` for every matching entity.
+	template <Component_Type ...TArgs, typename TFunction>
 	inline static void
-	ecs_entity_free(ECS &self, Entity e)
+	ecs_query_for_each(Query<TArgs...> &self, TFunction &&function)
 	{
-		self.entity_free(e);
+		ecs_query_for_each_chunk(self, [&](Entity *entities, U32 count, TArgs *...columns) {
+			for (U32 row = 0; row < count; ++row)
+				function(entities[row], columns[row]...);
+		});
+	}
+
+	// TODO: Test this.
+	inline static void
+	ecs_reload(ECS &self)
+	{
+		self.reload();
 	}
 }
\ No newline at end of file
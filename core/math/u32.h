@@ -2,6 +2,7 @@
 
 #include "core/defines.h"
 #include "core/validate.h"
+#include "core/compiler/compiler.h"
 
 inline static U32
 u32_min(U32 a, U32 b)
@@ -89,33 +90,21 @@ u32_rotate_right(U32 x, U32 shift)
 inline static U32
 u32_popcount(U32 x)
 {
-	U32 count = 0;
-	while (x != 0)
-	{
-		x &= x - 1;
-		++count;
-	}
-	return count;
+	return compiler_popcount_u32(x);
 }
 
 inline static U32
 u32_leading_zero_count(U32 x)
 {
 	validate(x != 0, "[MATH][u32]: leading_zero_count input must be non-zero.");
-	U32 count = 0;
-	for (U32 bit = 0x80000000u; (x & bit) == 0; bit >>= 1)
-		++count;
-	return count;
+	return compiler_leading_zero_count_u32(x);
 }
 
 inline static U32
 u32_trailing_zero_count(U32 x)
 {
 	validate(x != 0, "[MATH][u32]: trailing_zero_count input must be non-zero.");
-	U32 count = 0;
-	for (U32 bit = 1; (x & bit) == 0; bit <<= 1)
-		++count;
-	return count;
+	return compiler_trailing_zero_count_u32(x);
 }
 
 inline static U32
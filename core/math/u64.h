@@ -2,6 +2,7 @@
 
 #include "core/defines.h"
 #include "core/validate.h"
+#include "core/compiler/compiler.h"
 
 inline static U64
 u64_min(U64 a, U64 b)
@@ -91,33 +92,21 @@ u64_rotate_right(U64 x, U32 shift)
 inline static U32
 u64_popcount(U64 x)
 {
-	U32 count = 0;
-	while (x != 0)
-	{
-		x &= x - 1;
-		++count;
-	}
-	return count;
+	return compiler_popcount_u64(x);
 }
 
 inline static U32
 u64_leading_zero_count(U64 x)
 {
 	validate(x != 0, "[MATH][U64]: leading_zero_count input must be non-zero.");
-	U32 count = 0;
-	for (U64 bit = 0x8000000000000000ull; (x & bit) == 0; bit >>= 1)
-		++count;
-	return count;
+	return compiler_leading_zero_count_u64(x);
 }
 
 inline static U32
 u64_trailing_zero_count(U64 x)
 {
 	validate(x != 0, "[MATH][U64]: trailing_zero_count input must be non-zero.");
-	U32 count = 0;
-	for (U64 bit = 1; (x & bit) == 0; bit <<= 1)
-		++count;
-	return count;
+	return compiler_trailing_zero_count_u64(x);
 }
 
 inline static U64
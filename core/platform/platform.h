@@ -915,6 +915,26 @@ platform_virtual_memory_release(Memory_Block block);
 CORE_API U32
 platform_get_logical_processor_count();
 
+/**
+ * Processors that share a physical core, an L2 or an L3 cache report the same id, which is the lowest
+ * logical processor index in that set. Unknown caches report U32_MAX.
+ */
+struct Platform_Processor
+{
+	U32 index;
+	U32 core_id;
+	U32 package_id;
+	U32 l2_cache_id;
+	U32 l3_cache_id;
+};
+
+/**
+ * @return the online logical processors ordered by index. Platforms without topology information report
+ * every processor as its own core in package 0.
+ */
+CORE_API Array<Platform_Processor>
+platform_get_processor_topology(memory::Allocator *allocator = memory::heap_allocator());
+
 // ============================================================
 // Threads
 // ============================================================
@@ -949,6 +969,13 @@ platform_thread_sleep(U32 milliseconds);
 CORE_API void
 platform_thread_set_current_name(const char *name);
 
+/**
+ * Restricts the calling thread to one logical processor.
+ * @return false if the platform does not support affinity or the processor is not available.
+ */
+CORE_API bool
+platform_thread_set_current_affinity(U32 processor_index);
+
 inline static void
 destroy(Platform_Thread *self)
 {
@@ -1014,6 +1041,10 @@ platform_semaphore_deinit(Platform_Semaphore *self);
 CORE_API void
 platform_semaphore_wait(Platform_Semaphore *self);
 
+// Returns false if the semaphore was not signaled within `milliseconds`.
+CORE_API bool
+platform_semaphore_wait_for(Platform_Semaphore *self, U32 milliseconds);
+
 CORE_API void
 platform_semaphore_signal(Platform_Semaphore *self, U32 count = 1);
 
@@ -1023,6 +1054,17 @@ destroy(Platform_Semaphore *self)
 	platform_semaphore_deinit(self);
 }
 
+/*
+	Address waits block while the 32-bit value at `address` still equals `expected_value`, with no object to
+	create or destroy, so they can be embedded in other structures. A waker changes the value before it wakes
+	the address. Wakeups may be spurious, waiters check their condition again in a loop.
+*/
+CORE_API void
+platform_address_wait(const void *address, U32 expected_value);
+
+CORE_API void
+platform_address_wake_all(const void *address);
+
 // ============================================================
 // Timing
 // ============================================================
@@ -3925,6 +3925,17 @@ platform_get_logical_processor_count()
 	return count > 0 ? (U32)count : U32(1);
 }
 
+Array<Platform_Processor>
+platform_get_processor_topology(memory::Allocator *allocator)
+{
+	// Darwin does not expose which logical processors share a core or a cache, each one is described on its own.
+	Array<Platform_Processor> processors = array_init<Platform_Processor>(allocator);
+	U32 count = platform_get_logical_processor_count();
+	for (U32 i = 0; i < count; ++i)
+		array_push(processors, Platform_Processor{.index = i, .core_id = i, .package_id = 0, .l2_cache_id = U32_MAX, .l3_cache_id = U32_MAX});
+	return processors;
+}
+
 struct Platform_Thread
 {
 	pthread_t handle;
@@ -3994,6 +4005,14 @@ platform_thread_set_current_name(const char *name)
 	validate(::pthread_setname_np(name) == 0, "[PLATFORM][IOS]: Failed to set thread name.");
 }
 
+bool
+platform_thread_set_current_affinity(U32 processor_index)
+{
+	// Darwin has no way to bind a thread to a processor.
+	unused(processor_index);
+	return false;
+}
+
 struct Platform_Mutex
 {
 	pthread_mutex_t handle;
@@ -4099,6 +4118,30 @@ platform_semaphore_wait(Platform_Semaphore *self)
 	validate(::pthread_mutex_unlock(&self->mutex) == 0, "[PLATFORM][IOS]: Failed to unlock semaphore mutex.");
 }
 
+bool
+platform_semaphore_wait_for(Platform_Semaphore *self, U32 milliseconds)
+{
+	timespec deadline = {};
+	validate(::clock_gettime(CLOCK_REALTIME, &deadline) == 0, "[PLATFORM][IOS]: Failed to query time for semaphore wait.");
+	U64 nanoseconds = (U64)deadline.tv_nsec + (U64)milliseconds * 1000000;
+	deadline.tv_sec += (time_t)(nanoseconds / 1000000000);
+	deadline.tv_nsec = (long)(nanoseconds % 1000000000);
+
+	validate(::pthread_mutex_lock(&self->mutex) == 0, "[PLATFORM][IOS]: Failed to lock semaphore mutex.");
+	while (self->count == 0)
+	{
+		int result = ::pthread_cond_timedwait(&self->condition_variable, &self->mutex, &deadline);
+		if (result == ETIMEDOUT)
+			break;
+		validate(result == 0, "[PLATFORM][IOS]: Failed to wait for semaphore condition variable.");
+	}
+	bool is_acquired = self->count != 0;
+	if (is_acquired)
+		--self->count;
+	validate(::pthread_mutex_unlock(&self->mutex) == 0, "[PLATFORM][IOS]: Failed to unlock semaphore mutex.");
+	return is_acquired;
+}
+
 void
 platform_semaphore_signal(Platform_Semaphore *self, U32 count)
 {
@@ -4114,6 +4157,50 @@ platform_semaphore_signal(Platform_Semaphore *self, U32 count)
 	validate(::pthread_mutex_unlock(&self->mutex) == 0, "[PLATFORM][IOS]: Failed to unlock semaphore mutex.");
 }
 
+// There is no public futex on Apple platforms, so addresses hash into a fixed set of condition variables.
+// The value is checked under the bucket mutex and wakers lock it too, so a wake between check and wait is not lost.
+struct Platform_Address_Wait_Bucket
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t condition_variable;
+};
+
+constexpr U32 PLATFORM_ADDRESS_WAIT_BUCKET_COUNT = 64;
+
+inline static Platform_Address_Wait_Bucket *
+_platform_ios_address_wait_bucket(const void *address)
+{
+	static Platform_Address_Wait_Bucket *buckets = []() {
+		static Platform_Address_Wait_Bucket storage[PLATFORM_ADDRESS_WAIT_BUCKET_COUNT];
+		for (Platform_Address_Wait_Bucket &bucket : storage)
+		{
+			validate(::pthread_mutex_init(&bucket.mutex, nullptr) == 0, "[PLATFORM][IOS]: Failed to initialize address wait mutex.");
+			validate(::pthread_cond_init(&bucket.condition_variable, nullptr) == 0, "[PLATFORM][IOS]: Failed to initialize address wait condition variable.");
+		}
+		return storage;
+	}();
+	return &buckets[((U64)address >> 2) % PLATFORM_ADDRESS_WAIT_BUCKET_COUNT];
+}
+
+void
+platform_address_wait(const void *address, U32 expected_value)
+{
+	Platform_Address_Wait_Bucket *bucket = _platform_ios_address_wait_bucket(address);
+	validate(::pthread_mutex_lock(&bucket->mutex) == 0, "[PLATFORM][IOS]: Failed to lock address wait mutex.");
+	if (__atomic_load_n((const U32 *)address, __ATOMIC_SEQ_CST) == expected_value)
+		validate(::pthread_cond_wait(&bucket->condition_variable, &bucket->mutex) == 0, "[PLATFORM][IOS]: Failed to wait for address.");
+	validate(::pthread_mutex_unlock(&bucket->mutex) == 0, "[PLATFORM][IOS]: Failed to unlock address wait mutex.");
+}
+
+void
+platform_address_wake_all(const void *address)
+{
+	Platform_Address_Wait_Bucket *bucket = _platform_ios_address_wait_bucket(address);
+	validate(::pthread_mutex_lock(&bucket->mutex) == 0, "[PLATFORM][IOS]: Failed to lock address wait mutex.");
+	validate(::pthread_cond_broadcast(&bucket->condition_variable) == 0, "[PLATFORM][IOS]: Failed to wake address.");
+	validate(::pthread_mutex_unlock(&bucket->mutex) == 0, "[PLATFORM][IOS]: Failed to unlock address wait mutex.");
+}
+
 Platform_Window
 platform_window_init(Platform_Window_Desc)
 {
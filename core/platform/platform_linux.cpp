@@ -21,11 +21,14 @@
 #include <execinfo.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include <sys/select.h>
 #include <X11/Xlib-xcb.h>
 #include <X11/keysym.h>
 #include <X11/XKBlib.h>
 #include <pthread.h>
+#include <sched.h>
 #include <dirent.h>
 #include <dbus/dbus.h>
 
@@ -813,6 +816,100 @@ platform_get_logical_processor_count()
 	return count > 0 ? (U32)count : U32(1);
 }
 
+// Reads a small sysfs file into a null-terminated buffer.
+inline static bool
+_platform_linux_read_sysfs(const char *path, char *buffer, U64 buffer_size)
+{
+	I32 file = ::open(path, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	ssize_t read_size = ::read(file, buffer, buffer_size - 1);
+	::close(file);
+	if (read_size <= 0)
+		return false;
+
+	buffer[read_size] = '\0';
+	return true;
+}
+
+// First processor of a sysfs list such as "0-3,8-11".
+inline static U32
+_platform_linux_read_first_processor(const char *path, U32 fallback)
+{
+	char buffer[256];
+	if (!_platform_linux_read_sysfs(path, buffer, sizeof(buffer)) || buffer[0] < '0' || buffer[0] > '9')
+		return fallback;
+	return (U32)::strtoul(buffer, nullptr, 10);
+}
+
+Array<Platform_Processor>
+platform_get_processor_topology(memory::Allocator *allocator)
+{
+	Array<Platform_Processor> processors = array_init<Platform_Processor>(allocator);
+
+	char online[1024];
+	if (!_platform_linux_read_sysfs("/sys/devices/system/cpu/online", online, sizeof(online)))
+	{
+		U32 count = platform_get_logical_processor_count();
+		for (U32 i = 0; i < count; ++i)
+			array_push(processors, Platform_Processor{.index = i, .core_id = i, .package_id = 0, .l2_cache_id = U32_MAX, .l3_cache_id = U32_MAX});
+		return processors;
+	}
+
+	char path[128];
+	char value[64];
+	const char *cursor = online;
+	while (*cursor >= '0' && *cursor <= '9')
+	{
+		char *end = nullptr;
+		U32 first = (U32)::strtoul(cursor, &end, 10);
+		U32 last = first;
+		if (*end == '-')
+			last = (U32)::strtoul(end + 1, &end, 10);
+		cursor = *end == ',' ? end + 1 : end;
+
+		for (U32 index = first; index <= last; ++index)
+		{
+			Platform_Processor processor = {
+				.index = index,
+				.core_id = index,
+				.package_id = 0,
+				.l2_cache_id = U32_MAX,
+				.l3_cache_id = U32_MAX
+			};
+
+			::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", index);
+			processor.core_id = _platform_linux_read_first_processor(path, index);
+
+			// Reported as -1 when the package is unknown.
+			::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", index);
+			if (_platform_linux_read_sysfs(path, value, sizeof(value)) && value[0] >= '0' && value[0] <= '9')
+				processor.package_id = (U32)::strtoul(value, nullptr, 10);
+
+			for (U32 cache = 0; ; ++cache)
+			{
+				::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/level", index, cache);
+				if (!_platform_linux_read_sysfs(path, value, sizeof(value)))
+					break;
+				U32 level = (U32)::strtoul(value, nullptr, 10);
+
+				::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/type", index, cache);
+				if (_platform_linux_read_sysfs(path, value, sizeof(value)) && ::strncmp(value, "Instruction", 11) == 0)
+					continue;
+
+				::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", index, cache);
+				if (level == 2)
+					processor.l2_cache_id = _platform_linux_read_first_processor(path, index);
+				else if (level == 3)
+					processor.l3_cache_id = _platform_linux_read_first_processor(path, index);
+			}
+			array_push(processors, processor);
+		}
+	}
+	return processors;
+}
+
 struct Platform_Thread
 {
 	pthread_t handle;
@@ -882,6 +979,18 @@ platform_thread_set_current_name(const char *name)
 	validate(::pthread_setname_np(::pthread_self(), name) == 0, "[PLATFORM][LINUX]: Failed to set thread name.");
 }
 
+bool
+platform_thread_set_current_affinity(U32 processor_index)
+{
+	if (processor_index >= CPU_SETSIZE)
+		return false;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(processor_index, &set);
+	return ::sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
 struct Platform_Mutex
 {
 	pthread_mutex_t handle;
@@ -987,6 +1096,30 @@ platform_semaphore_wait(Platform_Semaphore *self)
 	validate(::pthread_mutex_unlock(&self->mutex) == 0, "[PLATFORM][LINUX]: Failed to unlock semaphore mutex.");
 }
 
+bool
+platform_semaphore_wait_for(Platform_Semaphore *self, U32 milliseconds)
+{
+	timespec deadline = {};
+	validate(::clock_gettime(CLOCK_REALTIME, &deadline) == 0, "[PLATFORM][LINUX]: Failed to query time for semaphore wait.");
+	U64 nanoseconds = (U64)deadline.tv_nsec + (U64)milliseconds * 1000000;
+	deadline.tv_sec += (time_t)(nanoseconds / 1000000000);
+	deadline.tv_nsec = (long)(nanoseconds % 1000000000);
+
+	validate(::pthread_mutex_lock(&self->mutex) == 0, "[PLATFORM][LINUX]: Failed to lock semaphore mutex.");
+	while (self->count == 0)
+	{
+		int result = ::pthread_cond_timedwait(&self->condition_variable, &self->mutex, &deadline);
+		if (result == ETIMEDOUT)
+			break;
+		validate(result == 0, "[PLATFORM][LINUX]: Failed to wait for semaphore condition variable.");
+	}
+	bool is_acquired = self->count != 0;
+	if (is_acquired)
+		--self->count;
+	validate(::pthread_mutex_unlock(&self->mutex) == 0, "[PLATFORM][LINUX]: Failed to unlock semaphore mutex.");
+	return is_acquired;
+}
+
 void
 platform_semaphore_signal(Platform_Semaphore *self, U32 count)
 {
@@ -1002,6 +1135,19 @@ platform_semaphore_signal(Platform_Semaphore *self, U32 count)
 	validate(::pthread_mutex_unlock(&self->mutex) == 0, "[PLATFORM][LINUX]: Failed to unlock semaphore mutex.");
 }
 
+void
+platform_address_wait(const void *address, U32 expected_value)
+{
+	// Returns on a wake, on a changed value and on signals alike, the caller checks its condition again.
+	::syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected_value, nullptr, nullptr, 0);
+}
+
+void
+platform_address_wake_all(const void *address)
+{
+	::syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
 struct Platform_Window_Context
 {
 	Display *display;
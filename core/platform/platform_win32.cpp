@@ -2,6 +2,7 @@
 
 #include "core/defer.h"
 #include "core/validate.h"
+#include "core/math/u32.h"
 #include "core/math/u64.h"
 #include "core/memory/allocator.h"
 #include "core/containers/array.h"
@@ -905,6 +906,65 @@ platform_get_logical_processor_count()
 	return system_info.dwNumberOfProcessors ? (U32)system_info.dwNumberOfProcessors : U32(1);
 }
 
+// Lowest processor index in a processor mask, shared ids are reported this way on every platform.
+inline static U32
+_platform_win32_first_processor(ULONG_PTR mask)
+{
+	for (U32 i = 0; i < sizeof(mask) * 8; ++i)
+		if (mask & ((ULONG_PTR)1 << i))
+			return i;
+	return U32_MAX;
+}
+
+Array<Platform_Processor>
+platform_get_processor_topology(memory::Allocator *allocator)
+{
+	Array<Platform_Processor> processors = array_init<Platform_Processor>(allocator);
+
+	// Only the first processor group is described, it is the one threads are scheduled on by default.
+	U32 count = u32_min(platform_get_logical_processor_count(), (U32)(sizeof(ULONG_PTR) * 8));
+	for (U32 i = 0; i < count; ++i)
+		array_push(processors, Platform_Processor{.index = i, .core_id = i, .package_id = 0, .l2_cache_id = U32_MAX, .l3_cache_id = U32_MAX});
+
+	DWORD buffer_size = 0;
+	::GetLogicalProcessorInformation(nullptr, &buffer_size);
+	if (buffer_size == 0)
+		return processors;
+
+	Memory_Block buffer_block = memory::allocate(buffer_size, alignof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+	DEFER(memory::deallocate(buffer_block));
+	SYSTEM_LOGICAL_PROCESSOR_INFORMATION *infos = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION *)buffer_block.data;
+	if (!::GetLogicalProcessorInformation(infos, &buffer_size))
+		return processors;
+
+	U32 package_id = 0;
+	U32 info_count = (U32)(buffer_size / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+	for (U32 i = 0; i < info_count; ++i)
+	{
+		const SYSTEM_LOGICAL_PROCESSOR_INFORMATION &info = infos[i];
+		U32 first = _platform_win32_first_processor(info.ProcessorMask);
+		for (U32 j = 0; j < count; ++j)
+		{
+			if ((info.ProcessorMask & ((ULONG_PTR)1 << j)) == 0)
+				continue;
+
+			Platform_Processor &processor = processors[j];
+			if (info.Relationship == RelationProcessorCore)
+				processor.core_id = first;
+			else if (info.Relationship == RelationProcessorPackage)
+				processor.package_id = package_id;
+			else if (info.Relationship == RelationCache && info.Cache.Type != CacheInstruction && info.Cache.Level == 2)
+				processor.l2_cache_id = first;
+			else if (info.Relationship == RelationCache && info.Cache.Type != CacheInstruction && info.Cache.Level == 3)
+				processor.l3_cache_id = first;
+		}
+
+		if (info.Relationship == RelationProcessorPackage)
+			++package_id;
+	}
+	return processors;
+}
+
 struct Platform_Thread
 {
 	HANDLE handle;
@@ -1023,6 +1083,14 @@ platform_thread_set_current_name(const char *name)
 	validate(SUCCEEDED(::SetThreadDescription(::GetCurrentThread(), name_wide)), "[PLATFORM][WINDOWS]: Failed to set thread name.");
 }
 
+bool
+platform_thread_set_current_affinity(U32 processor_index)
+{
+	if (processor_index >= sizeof(DWORD_PTR) * 8)
+		return false;
+	return ::SetThreadAffinityMask(::GetCurrentThread(), (DWORD_PTR)1 << processor_index) != 0;
+}
+
 struct Platform_Mutex
 {
 	SRWLOCK handle;
@@ -1121,6 +1189,14 @@ platform_semaphore_wait(Platform_Semaphore *self)
 	validate(wait_result == WAIT_OBJECT_0, "[PLATFORM][WINDOWS]: Failed to wait for semaphore.");
 }
 
+bool
+platform_semaphore_wait_for(Platform_Semaphore *self, U32 milliseconds)
+{
+	DWORD wait_result = ::WaitForSingleObject(self->handle, milliseconds);
+	validate(wait_result == WAIT_OBJECT_0 || wait_result == WAIT_TIMEOUT, "[PLATFORM][WINDOWS]: Failed to wait for semaphore.");
+	return wait_result == WAIT_OBJECT_0;
+}
+
 void
 platform_semaphore_signal(Platform_Semaphore *self, U32 count)
 {
@@ -1129,6 +1205,18 @@ platform_semaphore_signal(Platform_Semaphore *self, U32 count)
 	validate(::ReleaseSemaphore(self->handle, (LONG)count, nullptr), "[PLATFORM][WINDOWS]: Failed to signal semaphore.");
 }
 
+void
+platform_address_wait(const void *address, U32 expected_value)
+{
+	::WaitOnAddress((volatile VOID *)address, &expected_value, sizeof(expected_value), INFINITE);
+}
+
+void
+platform_address_wake_all(const void *address)
+{
+	::WakeByAddressAll((PVOID)address);
+}
+
 inline static void
 _platform_win32_window_keep_screen_on_set(Platform_Window_Context *ctx, bool enabled)
 {
@@ -1,430 +1,2833 @@
 #include "core/scheduler.h"
 #include "core/defer.h"
 #include "core/validate.h"
+#include "core/sort.h"
+#include "core/formatter.h"
+#include "core/atomic.h"
 #include "core/memory/allocator.h"
 #include "core/memory/arena_allocator.h"
 #include "core/math/u32.h"
+#include "core/math/u64.h"
 #include "core/containers/array.h"
 #include "core/containers/ring_buffer.h"
 #include "core/platform/platform.h"
 
 inline static thread_local struct Scheduler_Worker *scheduler_current_worker = nullptr;
 
+constexpr U64 SCHEDULER_DEQUE_MIN_CAPACITY = 256;
+constexpr U64 SCHEDULER_INJECTION_BATCH_MAX_COUNT = 32;
+constexpr U32 SCHEDULER_SPIN_COUNT = 64;
+constexpr U32 SCHEDULER_IDLE_SPIN_COUNT_MIN = 16;
+constexpr U32 SCHEDULER_IDLE_SPIN_COUNT_MAX = 1024;
+constexpr U32 SCHEDULER_BACKGROUND_STARVATION_LIMIT = 64;
+constexpr U32 SCHEDULER_TIMER_KEEPER_SLEEP_MILLISECONDS = 1;
+constexpr U64 SCHEDULER_TIMER_TICK_MICROSECONDS = 1000;
+constexpr U32 SCHEDULER_TIMER_WHEEL_LEVEL_COUNT = 4;
+constexpr U32 SCHEDULER_TIMER_WHEEL_SLOT_BITS = 6;
+constexpr U32 SCHEDULER_TIMER_WHEEL_SLOT_COUNT = 1 << SCHEDULER_TIMER_WHEEL_SLOT_BITS;
+constexpr U64 SCHEDULER_TIMER_WHEEL_SLOT_MASK = SCHEDULER_TIMER_WHEEL_SLOT_COUNT - 1;
+constexpr U64 SCHEDULER_COROUTINE_FRAME_GRANULARITY = 128;
+constexpr U64 SCHEDULER_COROUTINE_FRAME_CLASS_COUNT = 16;
+constexpr U64 SCHEDULER_CLOSURE_BLOCK_GRANULARITY = 64;
+constexpr U64 SCHEDULER_CLOSURE_BLOCK_CLASS_COUNT = 8;
+constexpr U32 SCHEDULER_CLOSURE_BLOCK_CACHE_COUNT = 64;
+constexpr U32 SCHEDULER_GROUP_CACHE_COUNT = 16;
+constexpr U32 SCHEDULER_ELASTIC_DEFAULT_QUEUE_DEPTH = 8;
+constexpr U32 SCHEDULER_ELASTIC_DEFAULT_LATENCY_MICROSECONDS = 2000;
+constexpr U32 SCHEDULER_ELASTIC_DEFAULT_IDLE_TIMEOUT_MILLISECONDS = 1000;
+constexpr U32 SCHEDULER_PARALLEL_FOR_GRAINS_PER_WORKER = 32;
+constexpr U32 SCHEDULER_PARALLEL_FOR_2D_TILE_SIZE = 64;
+constexpr U32 SCHEDULER_PARALLEL_FOR_3D_TILE_SIZE = 16;
+
+// Set in a group pending count while waiters or sleeping threads are registered. The group cannot be released
+// until the bit is cleared.
+constexpr U64 SCHEDULER_GROUP_HAS_WAITERS = (U64)1 << 63;
+
+// Lanes are drained in this order, `SCHEDULER_PRIORITY_NORMAL` is first in the enum only so that it is the zero default.
+constexpr Scheduler_Priority SCHEDULER_PRIORITY_DRAIN_ORDER[SCHEDULER_PRIORITY_COUNT] = {
+	SCHEDULER_PRIORITY_HIGH,
+	SCHEDULER_PRIORITY_NORMAL,
+	SCHEDULER_PRIORITY_BACKGROUND
+};
+
+enum SCHEDULER_PARK_STATE : U32
+{
+	SCHEDULER_PARK_STATE_RUNNING,
+	SCHEDULER_PARK_STATE_PARKED
+};
+
+enum SCHEDULER_TRACE_EVENT : U32
+{
+	SCHEDULER_TRACE_EVENT_TASK,
+	SCHEDULER_TRACE_EVENT_STEAL,
+	SCHEDULER_TRACE_EVENT_PARK,
+	SCHEDULER_TRACE_EVENT_UNPARK,
+	SCHEDULER_TRACE_EVENT_BLOCK,
+	SCHEDULER_TRACE_EVENT_GROUP_WAIT,
+	SCHEDULER_TRACE_EVENT_COUNT
+};
+
+// Steals and unparks are instant events, their begin and end are equal.
+struct Scheduler_Trace_Event
+{
+	U64 begin_microseconds;
+	U64 end_microseconds;
+	U64 argument;
+	SCHEDULER_TRACE_EVENT type;
+};
+
+/*
+	Each buffer has a single writer: its worker, or for the external buffer whichever thread holds the trace mutex.
+	Events are never overwritten and the count is published after the event is written, so a reader can walk
+	the first `count` events at any time without a lock.
+*/
+struct Scheduler_Trace_Buffer
+{
+	Scheduler_Trace_Event *events;
+	U32 capacity;
+	Atomic<U32> count;
+	Atomic<U64> dropped_event_count;
+	Atomic<U64> event_counts[SCHEDULER_TRACE_EVENT_COUNT];
+	Atomic<U64> event_microseconds[SCHEDULER_TRACE_EVENT_COUNT];
+};
+
+/*
+	Groups are recycled through free lists and only freed with the scheduler. The thread that drains a group
+	may still wake its address after a waiter saw the group drain and released it, which then only causes a
+	spurious wakeup in a free or reused group.
+*/
 struct Scheduler_Group
 {
 	Scheduler *scheduler;
-	U64 pending_task_count;
+	Atomic<U64> pending_task_count;
+	Atomic<U32> is_cancelled;
+
+	// Periodic timers do not count as pending tasks, but they keep a pointer to the group until they are removed.
+	Atomic<U32> periodic_timer_count;
+
+	// Bumped whenever the group drains with registered waiters, threads outside the scheduler sleep on its address.
+	Atomic<U32> drain_sequence;
+
+	// Spin lock that guards the waiter list and the waiters bit against the thread that drains the group.
+	Atomic<U32> waiter_lock;
+	Scheduler_Group_Waiter *waiters;
+
+	Scheduler_Group *next_free;
 };
 
+// Plain tasks are wrapped in a closure too, so a queue entry is exactly one cache line.
 struct Scheduler_Queued_Task
 {
+	Scheduler_Closure closure;
+	Scheduler_Group *group;
+};
+
+static_assert(sizeof(Scheduler_Queued_Task) == CACHE_LINE_SIZE);
+
+struct alignas(16) Scheduler_Closure_Block_Header
+{
+	Scheduler_Closure_Block_Header *next;
+	U64 size;
+};
+
+// A zero period marks a one-shot timer.
+struct Scheduler_Timer
+{
+	U64 deadline_microseconds;
+	U64 period_microseconds;
 	Scheduler_Task task;
 	Scheduler_Group *group;
+	Scheduler_Priority priority;
+};
+
+// Precedes every coroutine frame, a null scheduler marks a frame that came from the heap.
+struct alignas(16) Scheduler_Coroutine_Frame_Header
+{
+	union
+	{
+		Scheduler *scheduler;
+		Scheduler_Coroutine_Frame_Header *next;
+	};
+	U64 size;
+};
+
+/*
+	Chase-Lev work-stealing deque with a fixed power of two capacity. Only the owning worker pushes and
+	pops at the bottom, other workers steal from the top with a CAS, so the common path takes no lock.
+	When the deque is full the owner spills into the scheduler injection queue instead of growing.
+*/
+struct Scheduler_Deque
+{
+	alignas(CACHE_LINE_SIZE) Atomic<U64> top;
+	alignas(CACHE_LINE_SIZE) Atomic<U64> bottom;
+	Scheduler_Queued_Task *tasks;
+	U64 mask;
 };
 
 struct Scheduler_Worker
 {
+	Scheduler_Deque deques[SCHEDULER_PRIORITY_COUNT];
 	Scheduler *scheduler;
 	Platform_Thread *thread;
-	Ring_Buffer<Scheduler_Queued_Task> tasks;
 	Scheduler_Group *current_group;
+	Scheduler_Group *waited_group;
 	U32 index;
 	U32 blocking_depth;
+
+	// Logical processor the worker is pinned to, or U32_MAX. Other workers are stolen from nearest first.
+	U32 processor_index;
+	Array<U32> victims;
+
+	Scheduler_Trace_Buffer trace;
+	U64 block_begin_microseconds;
+
+	// Only touched by the worker itself, each list keeps at most `SCHEDULER_CLOSURE_BLOCK_CACHE_COUNT` blocks.
+	Scheduler_Closure_Block_Header *free_closure_blocks[SCHEDULER_CLOSURE_BLOCK_CLASS_COUNT];
+	U32 free_closure_block_counts[SCHEDULER_CLOSURE_BLOCK_CLASS_COUNT];
+	Scheduler_Group *free_groups;
+	U32 free_group_count;
+
+	// Only the waker that moves the state from parked back to running signals the semaphore.
+	Platform_Semaphore *park_semaphore;
+	Atomic<U32> park_state;
+	U32 idle_spin_count;
+
+	// Tasks taken from higher lanes since the last background task, capped at the starvation limit.
+	U32 background_starvation_count;
 };
 
 struct Scheduler
 {
 	Platform_Mutex *mutex;
 	Platform_Condition_Variable *startup_condition_variable;
-	Platform_Condition_Variable *work_condition_variable;
 	Platform_Condition_Variable *idle_condition_variable;
-	Platform_Condition_Variable *group_condition_variable;
 	Array<Scheduler_Worker> workers;
 	U32 worker_count;
-	U32 active_replacement_worker_count;
-	U32 queued_task_count;
 	U32 started_worker_count;
-	U32 active_task_count;
-	U32 live_group_count;
-	U32 blocked_worker_count;
-	U32 next_worker_index;
-	bool is_running;
+
+	// Regular workers below the active count run tasks, it only moves between the bounds in elastic pools.
+	// The progress time is when a queued task was last taken, or when the queue last stopped being empty.
+	bool is_elastic;
+	U32 min_worker_count;
+	U32 scale_up_queue_depth;
+	U32 scale_up_latency_microseconds;
+	U32 idle_timeout_milliseconds;
+	alignas(CACHE_LINE_SIZE) Atomic<U32> active_worker_count;
+	Atomic<U64> queue_progress_microseconds;
+	Atomic<U64> scale_up_queue_depth_count;
+	Atomic<U64> scale_up_latency_count;
+	Atomic<U64> scale_down_count;
+
+	// Tasks submitted from outside the scheduler, and tasks that overflowed a full worker deque, one queue per priority.
+	Platform_Mutex *injection_mutex;
+	Ring_Buffer<Scheduler_Queued_Task> injection_tasks[SCHEDULER_PRIORITY_COUNT];
+	Atomic<U32> injection_task_counts[SCHEDULER_PRIORITY_COUNT];
+
+	alignas(CACHE_LINE_SIZE) Atomic<U32> queued_task_count;
+	Atomic<U32> queued_task_counts[SCHEDULER_PRIORITY_COUNT];
+	alignas(CACHE_LINE_SIZE) Atomic<U32> active_task_count;
+	alignas(CACHE_LINE_SIZE) Atomic<U32> spinning_worker_count;
+	Atomic<U32> parked_worker_count;
+	Atomic<U32> idle_waiter_count;
+	Atomic<U32> live_group_count;
+
+	// Groups released outside of workers, or beyond the cache of the releasing worker.
+	Platform_Mutex *group_pool_mutex;
+	Scheduler_Group *free_groups;
+	Atomic<U32> blocked_worker_count;
+	Atomic<U32> active_replacement_worker_count;
+	Atomic<U32> is_running;
+
+	// Hierarchical timing wheel with 1 ms ticks, each level covers 64 slots of the level below and cascades into it
+	// when the level below wraps around. Cancelled timers leave stale handles behind that are skipped when their
+	// slot comes up. There is no timer thread, an idle worker becomes the timer keeper instead of parking.
+	// The timer count only covers one-shot timers, they hold up shutdown and waiting for the scheduler.
+	Platform_Mutex *timer_mutex;
+	Handle_Pool<Scheduler_Timer> timers;
+	Array<Scheduler_Timer_Handle> timer_wheel[SCHEDULER_TIMER_WHEEL_LEVEL_COUNT][SCHEDULER_TIMER_WHEEL_SLOT_COUNT];
+	U64 timer_wheel_occupied_slots[SCHEDULER_TIMER_WHEEL_LEVEL_COUNT];
+	U64 timer_wheel_tick;
+	Atomic<U64> next_timer_microseconds;
+	Atomic<U32> timer_count;
+	Atomic<U32> periodic_timer_count;
+	Atomic<U32> is_timer_kept;
+	Atomic<U64> fired_timer_count;
+	Atomic<U64> timer_jitter_microseconds_total;
+	Atomic<U64> timer_jitter_microseconds_max;
+	Atomic<U64> cancelled_task_count;
+
+	// Released frames are kept on a free list per size class for the next coroutine.
+	Platform_Mutex *coroutine_frame_mutex;
+	Scheduler_Coroutine_Frame_Header *free_coroutine_frames[SCHEDULER_COROUTINE_FRAME_CLASS_COUNT];
+	Atomic<U32> live_coroutine_frame_count;
+
+	// Fixed at init, every trace site is skipped behind this flag when tracing is off.
+	bool is_tracing;
+	U64 trace_begin_microseconds;
+	Platform_Mutex *trace_mutex;
+	Scheduler_Trace_Buffer external_trace;
 };
 
 inline static void
-_scheduler_update_active_replacement_worker_count(Scheduler *self)
+_scheduler_trace_buffer_init(Scheduler_Trace_Buffer &self, U32 capacity)
 {
-	U32 replacement_worker_count = (U32)self->workers.count - self->worker_count;
-	U32 active_replacement_worker_count = u32_min(self->blocked_worker_count, replacement_worker_count);
-	if (self->active_replacement_worker_count == active_replacement_worker_count)
+	self = Scheduler_Trace_Buffer {};
+	if (capacity == 0)
 		return;
 
-	self->active_replacement_worker_count = active_replacement_worker_count;
-	platform_condition_variable_broadcast(self->work_condition_variable);
+	self.events = (Scheduler_Trace_Event *)memory::allocate(capacity * sizeof(Scheduler_Trace_Event), alignof(Scheduler_Trace_Event)).data;
+	self.capacity = capacity;
 }
 
-inline static bool
-_scheduler_try_run_next_task_from_locked_worker_queues(Scheduler *self, Scheduler_Worker *worker)
+inline static void
+_scheduler_trace_buffer_deinit(Scheduler_Trace_Buffer &self)
 {
-	Scheduler_Queued_Task queued_task = {};
-	if (!ring_buffer_is_empty(worker->tasks))
-	{
-		queued_task = ring_buffer_front(worker->tasks);
-		ring_buffer_pop_front(worker->tasks);
-	}
-	else
-	{
-		Scheduler_Worker *source_worker = nullptr;
-		for (U32 i = 0; i < self->worker_count; ++i)
-		{
-			Scheduler_Worker *other_worker = &self->workers[(worker->index + i) % self->worker_count];
-			if (other_worker == worker || ring_buffer_is_empty(other_worker->tasks))
-				continue;
+	if (self.events != nullptr)
+		memory::deallocate(Memory_Block{self.events, self.capacity * sizeof(Scheduler_Trace_Event)});
+	self = Scheduler_Trace_Buffer {};
+}
 
-			source_worker = other_worker;
-			break;
-		}
+// Only the buffer's writer updates it, so a relaxed load and store is enough and keeps the counter readable from other threads.
+inline static void
+_scheduler_trace_counter_add(Atomic<U64> &counter, U64 value)
+{
+	atomic_store(counter, atomic_load(counter, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED) + value, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+}
 
-		if (source_worker == nullptr)
-			return false;
+inline static void
+_scheduler_trace_record(Scheduler_Trace_Buffer &self, SCHEDULER_TRACE_EVENT type, U64 begin_microseconds, U64 end_microseconds, U64 argument)
+{
+	_scheduler_trace_counter_add(self.event_counts[type], 1);
+	_scheduler_trace_counter_add(self.event_microseconds[type], end_microseconds - begin_microseconds);
 
-		queued_task = ring_buffer_back(source_worker->tasks);
-		ring_buffer_pop_back(source_worker->tasks);
+	U32 count = atomic_load(self.count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	if (count == self.capacity)
+	{
+		_scheduler_trace_counter_add(self.dropped_event_count, 1);
+		return;
 	}
 
-	--self->queued_task_count;
-	++self->active_task_count;
-	platform_mutex_unlock(self->mutex);
-
-	Scheduler_Group *previous_group = worker->current_group;
-	worker->current_group = queued_task.group;
-	queued_task.task.function(queued_task.task.data);
-	worker->current_group = previous_group;
-	validate(worker->blocking_depth == 0, "[SCHEDULER]: Scheduler worker finished task while still marked as blocking.");
+	self.events[count] = Scheduler_Trace_Event {
+		.begin_microseconds = begin_microseconds,
+		.end_microseconds = end_microseconds,
+		.argument = argument,
+		.type = type
+	};
+	atomic_store(self.count, count + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+}
 
-	platform_mutex_lock(self->mutex);
-	--self->active_task_count;
-	if (queued_task.group != nullptr)
+// Records into the calling worker's buffer, or into the shared external buffer from any other thread.
+inline static void
+_scheduler_trace_record_current(Scheduler *self, SCHEDULER_TRACE_EVENT type, U64 begin_microseconds, U64 end_microseconds, U64 argument)
+{
+	if (scheduler_current_worker != nullptr && scheduler_current_worker->scheduler == self)
 	{
-		--queued_task.group->pending_task_count;
-		if (queued_task.group->pending_task_count == 0)
-			platform_condition_variable_broadcast(self->group_condition_variable);
+		_scheduler_trace_record(scheduler_current_worker->trace, type, begin_microseconds, end_microseconds, argument);
+		return;
 	}
 
-	if (self->queued_task_count == 0 && self->active_task_count == 0)
-		platform_condition_variable_broadcast(self->idle_condition_variable);
-
-	return true;
+	platform_mutex_lock(self->trace_mutex);
+	_scheduler_trace_record(self->external_trace, type, begin_microseconds, end_microseconds, argument);
+	platform_mutex_unlock(self->trace_mutex);
 }
 
-// API.
-Scheduler *
-scheduler_init(Scheduler_Desc desc)
+inline static void
+_scheduler_deque_init(Scheduler_Deque &self, U64 capacity)
 {
-	validate(desc.worker_count > 0, "[SCHEDULER]: Worker count must be greater than 0.");
-	U32 total_worker_count = desc.worker_count + desc.replacement_worker_count;
-
-	Platform_Thread_Function worker_function = [](void *data) {
-		Scheduler_Worker *worker = (Scheduler_Worker *)data;
-		Scheduler *self = worker->scheduler;
-		scheduler_current_worker = worker;
-		constexpr auto worker_is_active = [](Scheduler *self, Scheduler_Worker *worker) -> bool {
-			if (worker->index < self->worker_count)
-				return true;
-			return worker->index - self->worker_count < self->active_replacement_worker_count;
-		};
+	capacity = u64_next_power_of_two(u64_max(capacity, SCHEDULER_DEQUE_MIN_CAPACITY));
+	self.top = atomic_init((U64)0);
+	self.bottom = atomic_init((U64)0);
+	self.tasks = (Scheduler_Queued_Task *)memory::allocate(capacity * sizeof(Scheduler_Queued_Task), alignof(Scheduler_Queued_Task)).data;
+	self.mask = capacity - 1;
+}
 
-		platform_mutex_lock(self->mutex);
-		++self->started_worker_count;
-		platform_condition_variable_signal(self->startup_condition_variable);
-		while (true)
-		{
-			while (self->is_running && (self->queued_task_count == 0 || !worker_is_active(self, worker)))
-				platform_condition_variable_wait(self->work_condition_variable, self->mutex);
+inline static void
+_scheduler_deque_deinit(Scheduler_Deque &self)
+{
+	memory::deallocate(Memory_Block{self.tasks, (self.mask + 1) * sizeof(Scheduler_Queued_Task)});
+	self.tasks = nullptr;
+	self.mask = 0;
+}
 
-			if (!self->is_running && (self->queued_task_count == 0 || !worker_is_active(self, worker)))
-				break;
+// Owner only. Returns false when the deque is full.
+inline static bool
+_scheduler_deque_push(Scheduler_Deque &self, const Scheduler_Queued_Task &task)
+{
+	U64 bottom = atomic_load(self.bottom, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	U64 top = atomic_load(self.top, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE);
+	if (bottom - top > self.mask)
+		return false;
 
-			_scheduler_try_run_next_task_from_locked_worker_queues(self, worker);
-		}
-		platform_mutex_unlock(self->mutex);
-		scheduler_current_worker = nullptr;
-	};
+	self.tasks[bottom & self.mask] = task;
+	atomic_store(self.bottom, bottom + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+	return true;
+}
 
-	Scheduler *self = memory::allocate_zeroed<Scheduler>();
-	self->mutex                      = platform_mutex_init();
-	self->startup_condition_variable = platform_condition_variable_init();
-	self->work_condition_variable    = platform_condition_variable_init();
-	self->idle_condition_variable    = platform_condition_variable_init();
-	self->group_condition_variable   = platform_condition_variable_init();
-	self->workers                    = array_init_with_count<Scheduler_Worker>(total_worker_count);
-	self->worker_count               = desc.worker_count;
-	self->is_running                 = true;
+// Owner only, takes the most recently pushed task.
+inline static bool
+_scheduler_deque_pop(Scheduler_Deque &self, Scheduler_Queued_Task &task)
+{
+	U64 bottom = atomic_load(self.bottom, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	if (bottom == atomic_load(self.top, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED))
+		return false;
 
-	U64 task_queue_capacity_per_worker = desc.initial_task_queue_capacity / desc.worker_count;
-	U64 extra_task_queue_capacity      = desc.initial_task_queue_capacity % desc.worker_count;
-	for (U32 i = 0; i < total_worker_count; ++i)
+	// Publishing the reservation and then reading top must not be reordered, thieves do the opposite.
+	--bottom;
+	atomic_store(self.bottom, bottom);
+	U64 top = atomic_load(self.top);
+	if ((I64)(bottom - top) < 0)
 	{
-		Scheduler_Worker *worker = &self->workers[i];
-		*worker = Scheduler_Worker {};
-		worker->scheduler = self;
-		worker->tasks = ring_buffer_init<Scheduler_Queued_Task>();
-		if (i < desc.worker_count)
-		{
-			U64 task_queue_capacity = task_queue_capacity_per_worker;
-			if (i < extra_task_queue_capacity)
-				++task_queue_capacity;
-			ring_buffer_reserve(worker->tasks, task_queue_capacity);
-		}
-		worker->index = i;
-		worker->thread = platform_thread_init(Platform_Thread_Desc {
-			.function = worker_function,
-			.data = worker,
-			.name = desc.worker_thread_name != nullptr ? desc.worker_thread_name : "Scheduler"
-		});
+		atomic_store(self.bottom, bottom + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		return false;
 	}
 
-	platform_mutex_lock(self->mutex);
-	while (self->started_worker_count != total_worker_count)
-		platform_condition_variable_wait(self->startup_condition_variable, self->mutex);
-	platform_mutex_unlock(self->mutex);
+	task = self.tasks[bottom & self.mask];
+	if (bottom != top)
+		return true;
 
-	return self;
+	// Last task, a thief may be racing for it.
+	bool is_taken = atomic_compare_exchange(self.top, top, top + 1);
+	atomic_store(self.bottom, bottom + 1, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	return is_taken;
 }
 
-void
-scheduler_deinit(Scheduler *self)
+// Any thread, takes the oldest task. Fails when empty or when another thread won the race.
+inline static bool
+_scheduler_deque_steal(Scheduler_Deque &self, Scheduler_Queued_Task &task)
 {
-	validate(scheduler_current_worker == nullptr || scheduler_current_worker->scheduler != self, "[SCHEDULER]: Scheduler worker cannot deinit its own scheduler.");
+	U64 top = atomic_load(self.top);
+	U64 bottom = atomic_load(self.bottom);
+	if ((I64)(bottom - top) <= 0)
+		return false;
 
-	platform_mutex_lock(self->mutex);
-	validate(self->live_group_count == 0, "[SCHEDULER]: Cannot deinit scheduler while task groups are alive.");
-	self->is_running = false;
-	platform_condition_variable_broadcast(self->work_condition_variable);
-	platform_mutex_unlock(self->mutex);
+	task = self.tasks[top & self.mask];
+	return atomic_compare_exchange(self.top, top, top + 1);
+}
 
-	for (U64 i = 0; i < self->workers.count; ++i)
-		platform_thread_deinit(self->workers[i].thread);
+inline static void
+_scheduler_backoff(U32 &spin_count)
+{
+	if (spin_count < SCHEDULER_SPIN_COUNT)
+	{
+		++spin_count;
+		compiler_cpu_pause();
+	}
+	else
+	{
+		platform_thread_sleep(0);
+	}
+}
 
-	validate(self->queued_task_count == 0 && self->active_task_count == 0, "[SCHEDULER]: Shutdown did not drain all tasks.");
+inline static bool
+_scheduler_worker_is_active(Scheduler *self, Scheduler_Worker *worker)
+{
+	if (worker->index < self->worker_count)
+		return !self->is_elastic || worker->index < atomic_load(self->active_worker_count);
+	return worker->index - self->worker_count < atomic_load(self->active_replacement_worker_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+}
 
-	for (U64 i = 0; i < self->workers.count; ++i)
-		ring_buffer_deinit(self->workers[i].tasks);
-	array_deinit(self->workers);
-	validate(self->blocked_worker_count == 0, "[SCHEDULER]: Cannot deinit scheduler while workers are marked as blocking.");
-	platform_condition_variable_deinit(self->group_condition_variable);
-	platform_condition_variable_deinit(self->idle_condition_variable);
-	platform_condition_variable_deinit(self->work_condition_variable);
-	platform_condition_variable_deinit(self->startup_condition_variable);
-	platform_mutex_deinit(self->mutex);
-	memory::deallocate(self);
+inline static bool
+_scheduler_worker_try_unpark(Scheduler *self, Scheduler_Worker *worker)
+{
+	U32 expected = SCHEDULER_PARK_STATE_PARKED;
+	if (!atomic_compare_exchange(worker->park_state, expected, (U32)SCHEDULER_PARK_STATE_RUNNING))
+		return false;
+
+	atomic_fetch_sub(self->parked_worker_count, (U32)1);
+	platform_semaphore_signal(worker->park_semaphore);
+	if (self->is_tracing)
+	{
+		U64 now_microseconds = platform_query_microseconds();
+		_scheduler_trace_record_current(self, SCHEDULER_TRACE_EVENT_UNPARK, now_microseconds, now_microseconds, worker->index);
+	}
+	return true;
 }
 
-Scheduler_Group *
-scheduler_group_init(Scheduler *self)
+// Wakes at most `count` parked workers that are allowed to run tasks.
+inline static void
+_scheduler_unpark_workers(Scheduler *self, U32 count)
 {
-	platform_mutex_lock(self->mutex);
-	validate(self->is_running, "[SCHEDULER]: Cannot create task group after shutdown.");
-	++self->live_group_count;
-	platform_mutex_unlock(self->mutex);
+	for (U64 i = 0; i < self->workers.count && count != 0; ++i)
+	{
+		if (atomic_load(self->parked_worker_count) == 0)
+			break;
 
-	Scheduler_Group *group = memory::allocate_zeroed<Scheduler_Group>();
-	group->scheduler = self;
-	return group;
+		Scheduler_Worker *worker = &self->workers.data[i];
+		if (_scheduler_worker_is_active(self, worker) && _scheduler_worker_try_unpark(self, worker))
+			--count;
+	}
 }
 
-void
-scheduler_group_deinit(Scheduler *self, Scheduler_Group *group)
+inline static void
+_scheduler_unpark_all_workers(Scheduler *self)
 {
-	validate(group->scheduler == self, "[SCHEDULER]: Task group belongs to a different scheduler.");
+	for (U64 i = 0; i < self->workers.count; ++i)
+		_scheduler_worker_try_unpark(self, &self->workers.data[i]);
+}
 
-	platform_mutex_lock(self->mutex);
-	validate(group->pending_task_count == 0, "[SCHEDULER]: Cannot deinit task group while tasks are pending.");
-	--self->live_group_count;
-	platform_mutex_unlock(self->mutex);
+inline static U64
+_scheduler_group_pending_task_count(Scheduler_Group *group)
+{
+	return atomic_load(group->pending_task_count) & ~SCHEDULER_GROUP_HAS_WAITERS;
+}
 
-	memory::deallocate(group);
+inline static bool
+_scheduler_has_timers(Scheduler *self)
+{
+	return atomic_load(self->timer_count) != 0 || atomic_load(self->periodic_timer_count) != 0;
 }
 
-void
-scheduler_submit(Scheduler *self, Slice<const Scheduler_Task> tasks, Scheduler_Group *group)
+/*
+	The parked state is published before the queued count and shutdown flag are read again, and wakers raise
+	the queued count before they read park states, so either the worker sees the new work or the waker sees
+	the parked worker. A worker whose park is cancelled by a concurrent waker consumes that waker's signal.
+	A worker waiting for a group reads its pending count the same way, against the thread that drains it.
+*/
+inline static bool
+_scheduler_worker_park(Scheduler *self, Scheduler_Worker *worker, Scheduler_Group *waited_group = nullptr, U32 timeout_milliseconds = 0)
 {
-	validate(group == nullptr || group->scheduler == self, "[SCHEDULER]: Task group belongs to a different scheduler.");
+	U64 begin_microseconds = self->is_tracing ? platform_query_microseconds() : 0;
+	atomic_fetch_add(self->parked_worker_count, (U32)1);
+	atomic_store(worker->park_state, (U32)SCHEDULER_PARK_STATE_PARKED);
 
-	platform_mutex_lock(self->mutex);
-	validate(self->is_running, "[SCHEDULER]: Cannot submit task after shutdown.");
-	if (tasks.count != 0)
+	bool is_active = _scheduler_worker_is_active(self, worker);
+	bool has_work = atomic_load(self->queued_task_count) != 0 && is_active;
+	bool has_unkept_timers = _scheduler_has_timers(self) && atomic_load(self->is_timer_kept) == 0 && is_active;
+	bool is_group_drained = waited_group != nullptr && _scheduler_group_pending_task_count(waited_group) == 0;
+	if (has_work || has_unkept_timers || is_group_drained || !atomic_load(self->is_running))
 	{
-		U64 task_count_per_worker = tasks.count / self->worker_count;
-		U64 remaining_task_count = tasks.count % self->worker_count;
-		for (U32 i = 0; i < self->worker_count; ++i)
+		U32 expected = SCHEDULER_PARK_STATE_PARKED;
+		if (atomic_compare_exchange(worker->park_state, expected, (U32)SCHEDULER_PARK_STATE_RUNNING))
 		{
-			U64 worker_offset = i >= self->next_worker_index ? i - self->next_worker_index : self->worker_count - self->next_worker_index + i;
-			U64 worker_task_count = task_count_per_worker;
-			if (worker_offset < remaining_task_count)
-				++worker_task_count;
-			ring_buffer_reserve(self->workers[i].tasks, worker_task_count);
+			atomic_fetch_sub(self->parked_worker_count, (U32)1);
+			return false;
 		}
+	}
 
-		if (group != nullptr)
-			group->pending_task_count += tasks.count;
-
-		for (U64 i = 0; i < tasks.count; ++i)
+	// A timed park ends itself the same way a waker would, unless a waker already claimed it.
+	bool is_timed_out = false;
+	if (timeout_milliseconds == 0)
+	{
+		platform_semaphore_wait(worker->park_semaphore);
+	}
+	else if (!platform_semaphore_wait_for(worker->park_semaphore, timeout_milliseconds))
+	{
+		U32 expected = SCHEDULER_PARK_STATE_PARKED;
+		if (atomic_compare_exchange(worker->park_state, expected, (U32)SCHEDULER_PARK_STATE_RUNNING))
 		{
-			Scheduler_Worker *worker = &self->workers[self->next_worker_index];
-			self->next_worker_index = (self->next_worker_index + 1) % self->worker_count;
-			ring_buffer_push_back(worker->tasks, Scheduler_Queued_Task {
-				.task = tasks.data[i],
-				.group = group
-			});
-			++self->queued_task_count;
+			atomic_fetch_sub(self->parked_worker_count, (U32)1);
+			is_timed_out = true;
+		}
+		else
+		{
+			platform_semaphore_wait(worker->park_semaphore);
 		}
-		platform_condition_variable_broadcast(self->work_condition_variable);
-		platform_condition_variable_broadcast(self->group_condition_variable);
 	}
-	platform_mutex_unlock(self->mutex);
+
+	if (self->is_tracing)
+		_scheduler_trace_record(worker->trace, SCHEDULER_TRACE_EVENT_PARK, begin_microseconds, platform_query_microseconds(), 0);
+	return is_timed_out;
 }
 
-void
-scheduler_wait_group(Scheduler *self, Scheduler_Group *group)
+inline static void
+_scheduler_update_active_replacement_worker_count(Scheduler *self)
 {
-	validate(group->scheduler == self, "[SCHEDULER]: Scheduler group belongs to a different scheduler.");
-	bool is_scheduler_worker = scheduler_current_worker != nullptr && scheduler_current_worker->scheduler == self;
-	validate(!is_scheduler_worker || scheduler_current_worker->current_group != group, "[SCHEDULER]: Scheduler task cannot wait for its own group.");
+	U32 replacement_worker_count = (U32)self->workers.count - self->worker_count;
+	U32 active_replacement_worker_count = u32_min(atomic_load(self->blocked_worker_count), replacement_worker_count);
+	if (atomic_load(self->active_replacement_worker_count) == active_replacement_worker_count)
+		return;
 
-	platform_mutex_lock(self->mutex);
-	while (group->pending_task_count != 0)
-	{
-		if (is_scheduler_worker && _scheduler_try_run_next_task_from_locked_worker_queues(self, scheduler_current_worker))
-			continue;
-		platform_condition_variable_wait(self->group_condition_variable, self->mutex);
-	}
-	platform_mutex_unlock(self->mutex);
+	atomic_store(self->active_replacement_worker_count, active_replacement_worker_count);
+	_scheduler_unpark_workers(self, atomic_load(self->queued_task_count));
 }
 
-void
-scheduler_wait_all(Scheduler *self)
+/*
+	Grows an elastic pool by one worker when the queue is deeper than the threshold for every active worker, or
+	when no queued task was taken within the latency threshold, which happens when all active workers are stuck
+	in long tasks. Checked on every submit and whenever a worker looks for its next task, so a burst keeps
+	activating workers until the queue drains or the pool is at its maximum.
+*/
+inline static void
+_scheduler_elastic_try_scale_up(Scheduler *self)
 {
-	validate(scheduler_current_worker == nullptr || scheduler_current_worker->scheduler != self, "[SCHEDULER]: Scheduler worker cannot wait for all work.");
+	U32 active_worker_count = atomic_load(self->active_worker_count);
+	if (active_worker_count == self->worker_count)
+		return;
 
-	platform_mutex_lock(self->mutex);
-	while (self->queued_task_count != 0 || self->active_task_count != 0)
-		platform_condition_variable_wait(self->idle_condition_variable, self->mutex);
-	platform_mutex_unlock(self->mutex);
+	U32 queued_task_count = atomic_load(self->queued_task_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	if (queued_task_count == 0)
+		return;
+
+	bool is_deep = queued_task_count > (U64)self->scale_up_queue_depth * active_worker_count;
+	bool is_late = !is_deep && platform_query_microseconds() > atomic_load(self->queue_progress_microseconds, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED) + self->scale_up_latency_microseconds;
+	if (!is_deep && !is_late)
+		return;
+
+	if (!atomic_compare_exchange(self->active_worker_count, active_worker_count, active_worker_count + 1))
+		return;
+
+	atomic_fetch_add(is_deep ? self->scale_up_queue_depth_count : self->scale_up_latency_count, (U64)1, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	_scheduler_worker_try_unpark(self, &self->workers[active_worker_count]);
 }
 
-void
-scheduler_worker_block_ahead(Scheduler *self)
+// Only the newest active worker retires, so the active workers always stay the first `active_worker_count` ones.
+// An older worker that timed out parks again and retires once the workers above it are gone.
+inline static void
+_scheduler_elastic_try_retire(Scheduler *self, Scheduler_Worker *worker)
 {
-	validate(scheduler_current_worker != nullptr && scheduler_current_worker->scheduler == self, "[SCHEDULER]: Only a scheduler worker can mark itself as blocking.");
+	U32 expected = worker->index + 1;
+	if (atomic_compare_exchange(self->active_worker_count, expected, worker->index))
+		atomic_fetch_add(self->scale_down_count, (U64)1, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+}
 
-	platform_mutex_lock(self->mutex);
-	if (scheduler_current_worker->blocking_depth == 0)
-	{
-		++self->blocked_worker_count;
-		_scheduler_update_active_replacement_worker_count(self);
-	}
-	++scheduler_current_worker->blocking_depth;
-	platform_mutex_unlock(self->mutex);
+// Wakes one parked worker per new task, minus the workers already spinning for work. Workers waiting inside
+// `scheduler_wait_group` are parked like idle ones, so they are woken to help with the new tasks as well.
+inline static void
+_scheduler_wake_workers(Scheduler *self, U64 task_count)
+{
+	if (self->is_elastic)
+		_scheduler_elastic_try_scale_up(self);
+
+	U32 spinning_worker_count = atomic_load(self->spinning_worker_count);
+	if (task_count > spinning_worker_count)
+		_scheduler_unpark_workers(self, (U32)u64_min(task_count - spinning_worker_count, U32_MAX));
 }
 
-void
-scheduler_worker_block_clear(Scheduler *self)
+// Takes one injected task and moves a share of the rest into the worker deque, so the next tasks are lock-free.
+inline static bool
+_scheduler_try_take_injected_task(Scheduler *self, Scheduler_Worker *worker, Scheduler_Priority priority, Scheduler_Queued_Task &task)
 {
-	validate(scheduler_current_worker != nullptr && scheduler_current_worker->scheduler == self, "[SCHEDULER]: Only a scheduler worker can clear its blocking marker.");
+	if (atomic_load(self->injection_task_counts[priority], COMPILER_ATOMIC_MEMORY_ORDER_RELAXED) == 0)
+		return false;
 
-	platform_mutex_lock(self->mutex);
-	validate(scheduler_current_worker->blocking_depth > 0, "[SCHEDULER]: Worker blocking marker was not set.");
+	Ring_Buffer<Scheduler_Queued_Task> &injection_tasks = self->injection_tasks[priority];
+	platform_mutex_lock(self->injection_mutex);
+	if (ring_buffer_is_empty(injection_tasks))
+	{
+		platform_mutex_unlock(self->injection_mutex);
+		return false;
+	}
+
+	task = ring_buffer_front(injection_tasks);
+	ring_buffer_pop_front(injection_tasks);
+
+	U64 batch_count = u64_min(injection_tasks.count / self->workers.count, SCHEDULER_INJECTION_BATCH_MAX_COUNT);
+	for (U64 i = 0; i < batch_count; ++i)
+	{
+		if (!_scheduler_deque_push(worker->deques[priority], ring_buffer_front(injection_tasks)))
+			break;
+		ring_buffer_pop_front(injection_tasks);
+	}
+	atomic_store(self->injection_task_counts[priority], (U32)injection_tasks.count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	platform_mutex_unlock(self->injection_mutex);
+	return true;
+}
+
+inline static bool
+_scheduler_try_steal_task(Scheduler *self, Scheduler_Worker *worker, Scheduler_Priority priority, Scheduler_Queued_Task &task)
+{
+	for (U32 victim_index : worker->victims)
+	{
+		Scheduler_Worker *victim = &self->workers.data[victim_index];
+		if (_scheduler_deque_steal(victim->deques[priority], task))
+		{
+			if (self->is_tracing)
+			{
+				U64 now_microseconds = platform_query_microseconds();
+				_scheduler_trace_record(worker->trace, SCHEDULER_TRACE_EVENT_STEAL, now_microseconds, now_microseconds, victim_index);
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+inline static void
+_scheduler_notify_idle(Scheduler *self)
+{
+	if (atomic_load(self->idle_waiter_count) == 0)
+		return;
+
+	platform_mutex_lock(self->mutex);
+	platform_condition_variable_broadcast(self->idle_condition_variable);
+	platform_mutex_unlock(self->mutex);
+}
+
+inline static void
+_scheduler_invoke_task(void *storage, bool is_cancelled)
+{
+	if (is_cancelled)
+		return;
+
+	Scheduler_Task *task = (Scheduler_Task *)storage;
+	task->function(task->data);
+}
+
+inline static Scheduler_Closure
+_scheduler_closure_from(const Scheduler_Task &task)
+{
+	Scheduler_Closure closure = {.invoke = _scheduler_invoke_task};
+	::memcpy(closure.storage, &task, sizeof(task));
+	return closure;
+}
+
+inline static Scheduler_Closure
+_scheduler_closure_from(const Scheduler_Closure &closure)
+{
+	return closure;
+}
+
+// Queues tasks whose group pending count was already raised by the caller. Does not check for shutdown, so
+// timers and group waiters that fire while the scheduler drains can still queue their tasks.
+template <typename T>
+inline static void
+_scheduler_push_tasks(Scheduler *self, Slice<const T> tasks, Scheduler_Group *group, Scheduler_Priority priority)
+{
+	// Counts are raised before the tasks become visible, so they never drop below the number of reachable tasks.
+	if (self->is_elastic && atomic_load(self->queued_task_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED) == 0)
+		atomic_store(self->queue_progress_microseconds, platform_query_microseconds(), COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	atomic_fetch_add(self->queued_task_counts[priority], (U32)tasks.count);
+	atomic_fetch_add(self->queued_task_count, (U32)tasks.count);
+
+	// Workers push to their own deque, external threads and deque overflow go through the injection queue.
+	U64 pushed_count = 0;
+	Scheduler_Worker *worker = scheduler_current_worker;
+	if (worker != nullptr && worker->scheduler == self)
+	{
+		for (; pushed_count < tasks.count; ++pushed_count)
+		{
+			Scheduler_Queued_Task queued_task = {.closure = _scheduler_closure_from(tasks.data[pushed_count]), .group = group};
+			if (!_scheduler_deque_push(worker->deques[priority], queued_task))
+				break;
+		}
+	}
+
+	if (pushed_count < tasks.count)
+	{
+		Ring_Buffer<Scheduler_Queued_Task> &injection_tasks = self->injection_tasks[priority];
+		platform_mutex_lock(self->injection_mutex);
+		ring_buffer_reserve(injection_tasks, tasks.count - pushed_count);
+		for (U64 i = pushed_count; i < tasks.count; ++i)
+		{
+			ring_buffer_push_back(injection_tasks, Scheduler_Queued_Task {
+				.closure = _scheduler_closure_from(tasks.data[i]),
+				.group = group
+			});
+		}
+		atomic_store(self->injection_task_counts[priority], (U32)injection_tasks.count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		platform_mutex_unlock(self->injection_mutex);
+	}
+
+	_scheduler_wake_workers(self, tasks.count);
+}
+
+inline static void
+_scheduler_group_lock(Scheduler_Group *group)
+{
+	U32 spin_count = 0;
+	U32 expected = 0;
+	while (!atomic_compare_exchange(group->waiter_lock, expected, (U32)1, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE))
+	{
+		expected = 0;
+		_scheduler_backoff(spin_count);
+	}
+}
+
+inline static void
+_scheduler_group_unlock(Scheduler_Group *group)
+{
+	atomic_store(group->waiter_lock, (U32)0, COMPILER_ATOMIC_MEMORY_ORDER_RELEASE);
+}
+
+// Sets the waiters bit if the group still has pending tasks. Returns false if it already drained.
+// Runs under the group lock, in the same step that observes pending tasks, so the thread that drains the group sees it.
+inline static bool
+_scheduler_group_try_set_waiters(Scheduler_Group *group)
+{
+	U64 pending_task_count = atomic_load(group->pending_task_count);
+	while ((pending_task_count & SCHEDULER_GROUP_HAS_WAITERS) == 0)
+	{
+		if (pending_task_count == 0)
+			return false;
+		if (atomic_compare_exchange(group->pending_task_count, pending_task_count, pending_task_count | SCHEDULER_GROUP_HAS_WAITERS))
+			break;
+	}
+	return true;
+}
+
+// Runs on the thread that drained the group. The waiters bit keeps the group alive until it is cleared here,
+// after that only the detached waiters, the sleeping threads and the workers are touched.
+inline static void
+_scheduler_group_wake_waiters(Scheduler *self, Scheduler_Group *group)
+{
+	Scheduler_Group_Waiter *waiters = nullptr;
+	bool is_drained = false;
+	_scheduler_group_lock(group);
+	// Tasks submitted since the count reached 0 leave the waiters to the next thread that drains the group.
+	if (_scheduler_group_pending_task_count(group) == 0)
+	{
+		waiters = group->waiters;
+		group->waiters = nullptr;
+		atomic_fetch_add(group->drain_sequence, (U32)1);
+		atomic_fetch_sub(group->pending_task_count, SCHEDULER_GROUP_HAS_WAITERS);
+		is_drained = true;
+	}
+	_scheduler_group_unlock(group);
+
+	if (!is_drained)
+		return;
+
+	platform_address_wake_all(&group->drain_sequence.value);
+	for (U64 i = 0; i < self->workers.count; ++i)
+	{
+		Scheduler_Worker *worker = &self->workers.data[i];
+		if (worker->waited_group == group)
+			_scheduler_worker_try_unpark(self, worker);
+	}
+
+	while (waiters != nullptr)
+	{
+		// The waiter lives in the frame it resumes, so it is read before its task is queued.
+		Scheduler_Group_Waiter *next = waiters->next;
+		_scheduler_push_tasks<Scheduler_Task>(self, waiters->task, nullptr, waiters->priority);
+		waiters = next;
+	}
+}
+
+inline static void
+_scheduler_group_finish_task(Scheduler *self, Scheduler_Group *group)
+{
+	// Without registered waiters the group may be released as soon as the count reaches 0, it is not touched afterwards.
+	U64 previous_pending_task_count = atomic_fetch_sub(group->pending_task_count, (U64)1);
+	if ((previous_pending_task_count & ~SCHEDULER_GROUP_HAS_WAITERS) != 1)
+		return;
+
+	if (previous_pending_task_count & SCHEDULER_GROUP_HAS_WAITERS)
+		_scheduler_group_wake_waiters(self, group);
+}
+
+inline static void
+_scheduler_finish_task(Scheduler *self, Scheduler_Group *group)
+{
+	if (group != nullptr)
+		_scheduler_group_finish_task(self, group);
+
+	if (atomic_fetch_sub(self->active_task_count, (U32)1) == 1 && atomic_load(self->queued_task_count) == 0 && atomic_load(self->timer_count) == 0)
+		_scheduler_notify_idle(self);
+}
+
+// Runs under the timer mutex. Deadlines beyond the reach of the top level wait in its furthest slot and are placed
+// again when that slot cascades.
+inline static void
+_scheduler_timer_wheel_insert(Scheduler *self, Scheduler_Timer_Handle handle, U64 deadline_microseconds)
+{
+	constexpr U64 WHEEL_TICK_COUNT = (U64)1 << (SCHEDULER_TIMER_WHEEL_SLOT_BITS * SCHEDULER_TIMER_WHEEL_LEVEL_COUNT);
+
+	U64 tick = self->timer_wheel_tick;
+	U64 deadline_tick = (deadline_microseconds + SCHEDULER_TIMER_TICK_MICROSECONDS - 1) / SCHEDULER_TIMER_TICK_MICROSECONDS;
+	deadline_tick = u64_clamp(deadline_tick, tick, tick + WHEEL_TICK_COUNT - 1);
+
+	U32 level = 0;
+	while (level + 1 < SCHEDULER_TIMER_WHEEL_LEVEL_COUNT && deadline_tick - tick >= (U64)1 << (SCHEDULER_TIMER_WHEEL_SLOT_BITS * (level + 1)))
+		++level;
+
+	U64 slot = (deadline_tick >> (SCHEDULER_TIMER_WHEEL_SLOT_BITS * level)) & SCHEDULER_TIMER_WHEEL_SLOT_MASK;
+	array_push(self->timer_wheel[level][slot], handle);
+	self->timer_wheel_occupied_slots[level] |= (U64)1 << slot;
+}
+
+// The first tick that may have work, either an occupied slot in the current lap of the bottom level or the next cascade.
+inline static U64
+_scheduler_timer_wheel_next_tick(Scheduler *self)
+{
+	U64 tick = self->timer_wheel_tick;
+	U64 upcoming_slots = self->timer_wheel_occupied_slots[0] >> (tick & SCHEDULER_TIMER_WHEEL_SLOT_MASK);
+	if (upcoming_slots != 0)
+		return tick + u64_trailing_zero_count(upcoming_slots);
+	return (tick | SCHEDULER_TIMER_WHEEL_SLOT_MASK) + 1;
+}
+
+// Queues the task of a due timer and returns whether it was a one-shot timer. A periodic timer moves its deadline past
+// now, skipping the periods it missed instead of firing them in a burst.
+inline static bool
+_scheduler_timer_fire(Scheduler *self, Scheduler_Timer_Handle handle, U64 now)
+{
+	Scheduler_Timer *timer = handle_pool_get(self->timers, handle);
+	U64 jitter_microseconds = now - timer->deadline_microseconds;
+	atomic_fetch_add(self->fired_timer_count, (U64)1, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	atomic_fetch_add(self->timer_jitter_microseconds_total, jitter_microseconds, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	if (jitter_microseconds > atomic_load(self->timer_jitter_microseconds_max, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED))
+		atomic_store(self->timer_jitter_microseconds_max, jitter_microseconds, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+
+	if (timer->period_microseconds == 0)
+	{
+		Scheduler_Timer fired_timer = *timer;
+		handle_pool_remove(self->timers, handle);
+		_scheduler_push_tasks<Scheduler_Task>(self, fired_timer.task, fired_timer.group, fired_timer.priority);
+		return true;
+	}
+
+	if (!atomic_load(self->is_running))
+	{
+		if (timer->group != nullptr)
+			atomic_fetch_sub(timer->group->periodic_timer_count, (U32)1);
+		handle_pool_remove(self->timers, handle);
+		atomic_fetch_sub(self->periodic_timer_count, (U32)1);
+		return false;
+	}
+
+	if (timer->group != nullptr)
+		atomic_fetch_add(timer->group->pending_task_count, (U64)1);
+	_scheduler_push_tasks<Scheduler_Task>(self, timer->task, timer->group, timer->priority);
+
+	timer->deadline_microseconds += timer->period_microseconds * ((now - timer->deadline_microseconds) / timer->period_microseconds + 1);
+	_scheduler_timer_wheel_insert(self, handle, timer->deadline_microseconds);
+	return false;
+}
+
+// Fires the due timers of a slot at the bottom level, or moves the timers of an upper level slot one level down.
+// The slot is detached first because timers that are placed again may land in it.
+inline static U32
+_scheduler_timer_wheel_process_slot(Scheduler *self, U32 level, U64 slot, U64 now)
+{
+	Array<Scheduler_Timer_Handle> handles = self->timer_wheel[level][slot];
+	self->timer_wheel[level][slot] = array_init<Scheduler_Timer_Handle>();
+	self->timer_wheel_occupied_slots[level] &= ~((U64)1 << slot);
+
+	U32 fired_one_shot_count = 0;
+	for (Scheduler_Timer_Handle handle : handles)
+	{
+		Scheduler_Timer *timer = handle_pool_get(self->timers, handle);
+		if (timer == nullptr)
+			continue;
+
+		if (level == 0 && timer->deadline_microseconds <= now)
+			fired_one_shot_count += _scheduler_timer_fire(self, handle, now) ? 1 : 0;
+		else
+			_scheduler_timer_wheel_insert(self, handle, timer->deadline_microseconds);
+	}
+
+	// Keep the larger allocation around for the next lap.
+	if (self->timer_wheel[level][slot].count == 0)
+	{
+		array_deinit(self->timer_wheel[level][slot]);
+		array_clear(handles);
+		self->timer_wheel[level][slot] = handles;
+	}
+	else
+	{
+		array_deinit(handles);
+	}
+	return fired_one_shot_count;
+}
+
+// Runs under the timer mutex and processes every tick up to now, skipping the ones without work.
+inline static U32
+_scheduler_timer_wheel_advance(Scheduler *self, U64 now)
+{
+	U64 now_tick = now / SCHEDULER_TIMER_TICK_MICROSECONDS;
+	U32 fired_one_shot_count = 0;
+	while (self->timer_wheel_tick <= now_tick)
+	{
+		if (self->timers.count == 0)
+		{
+			self->timer_wheel_tick = now_tick + 1;
+			break;
+		}
+
+		U64 tick = self->timer_wheel_tick;
+		for (U32 level = SCHEDULER_TIMER_WHEEL_LEVEL_COUNT - 1; level > 0; --level)
+		{
+			U32 shift = SCHEDULER_TIMER_WHEEL_SLOT_BITS * level;
+			if ((tick & (((U64)1 << shift) - 1)) == 0)
+				fired_one_shot_count += _scheduler_timer_wheel_process_slot(self, level, (tick >> shift) & SCHEDULER_TIMER_WHEEL_SLOT_MASK, now);
+		}
+		fired_one_shot_count += _scheduler_timer_wheel_process_slot(self, 0, tick & SCHEDULER_TIMER_WHEEL_SLOT_MASK, now);
+
+		self->timer_wheel_tick = tick + 1;
+		self->timer_wheel_tick = u64_min(_scheduler_timer_wheel_next_tick(self), now_tick + 1);
+	}
+	return fired_one_shot_count;
+}
+
+// Runs under the timer mutex.
+inline static void
+_scheduler_timer_wheel_publish_next_deadline(Scheduler *self)
+{
+	U64 next_timer_microseconds = self->timers.count != 0 ? _scheduler_timer_wheel_next_tick(self) * SCHEDULER_TIMER_TICK_MICROSECONDS : U64_MAX;
+	atomic_store(self->next_timer_microseconds, next_timer_microseconds);
+}
+
+// Queues the tasks of every timer that is due. The timer count drops only after its task is queued, so the
+// scheduler never looks idle in between.
+inline static void
+_scheduler_fire_timers(Scheduler *self)
+{
+	if (!_scheduler_has_timers(self))
+		return;
+
+	U64 now = platform_query_microseconds();
+	if (atomic_load(self->next_timer_microseconds) > now)
+		return;
+
+	platform_mutex_lock(self->timer_mutex);
+	U32 fired_one_shot_count = _scheduler_timer_wheel_advance(self, now);
+	_scheduler_timer_wheel_publish_next_deadline(self);
+	platform_mutex_unlock(self->timer_mutex);
+
+	if (fired_one_shot_count != 0 && atomic_fetch_sub(self->timer_count, fired_one_shot_count) == fired_one_shot_count &&
+		atomic_load(self->queued_task_count) == 0 && atomic_load(self->active_task_count) == 0)
+		_scheduler_notify_idle(self);
+}
+
+// One idle worker at a time sleeps in short steps instead of parking while timers are pending, and fires them
+// when they are due. The others park as usual and are woken by the tasks the timers queue.
+inline static bool
+_scheduler_try_keep_timers(Scheduler *self)
+{
+	if (!_scheduler_has_timers(self))
+		return false;
+
+	U32 expected = 0;
+	if (!atomic_compare_exchange(self->is_timer_kept, expected, (U32)1))
+		return false;
+
+	U64 now = platform_query_microseconds();
+	U64 next_timer_microseconds = atomic_load(self->next_timer_microseconds);
+	if (next_timer_microseconds > now)
+		platform_thread_sleep((U32)u64_min((next_timer_microseconds - now) / 1000, SCHEDULER_TIMER_KEEPER_SLEEP_MILLISECONDS));
+	_scheduler_fire_timers(self);
+
+	atomic_store(self->is_timer_kept, (U32)0);
+	return true;
+}
+
+inline static bool
+_scheduler_try_take_task_with_priority(Scheduler *self, Scheduler_Worker *worker, Scheduler_Priority priority, Scheduler_Queued_Task &queued_task)
+{
+	// A lane reads empty only before a submit has raised its count, the caller retries through the total queued count.
+	if (atomic_load(self->queued_task_counts[priority], COMPILER_ATOMIC_MEMORY_ORDER_RELAXED) == 0)
+		return false;
+
+	if (!_scheduler_deque_pop(worker->deques[priority], queued_task) &&
+		!_scheduler_try_take_injected_task(self, worker, priority, queued_task) &&
+		!_scheduler_try_steal_task(self, worker, priority, queued_task))
+		return false;
+
+	// Active is raised before queued is lowered, so both never read 0 while the task is in flight.
+	atomic_fetch_add(self->active_task_count, (U32)1);
+	atomic_fetch_sub(self->queued_task_counts[priority], (U32)1);
+	atomic_fetch_sub(self->queued_task_count, (U32)1);
+	if (self->is_elastic)
+		atomic_store(self->queue_progress_microseconds, platform_query_microseconds(), COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	return true;
+}
+
+// Drains the lanes from high to background, but a worker that took `SCHEDULER_BACKGROUND_STARVATION_LIMIT`
+// higher priority tasks in a row takes a background task first, so saturated high lanes cannot starve it.
+inline static bool
+_scheduler_try_take_next_task(Scheduler *self, Scheduler_Worker *worker, Scheduler_Queued_Task &queued_task)
+{
+	if (worker->background_starvation_count == SCHEDULER_BACKGROUND_STARVATION_LIMIT && _scheduler_try_take_task_with_priority(self, worker, SCHEDULER_PRIORITY_BACKGROUND, queued_task))
+	{
+		worker->background_starvation_count = 0;
+		return true;
+	}
+
+	for (Scheduler_Priority priority : SCHEDULER_PRIORITY_DRAIN_ORDER)
+	{
+		if (_scheduler_try_take_task_with_priority(self, worker, priority, queued_task))
+		{
+			if (priority == SCHEDULER_PRIORITY_BACKGROUND)
+				worker->background_starvation_count = 0;
+			else if (worker->background_starvation_count < SCHEDULER_BACKGROUND_STARVATION_LIMIT)
+				++worker->background_starvation_count;
+			return true;
+		}
+	}
+	return false;
+}
+
+inline static void
+_scheduler_run_task(Scheduler *self, Scheduler_Worker *worker, const Scheduler_Queued_Task &queued_task)
+{
+	// The entry is a copy owned by this call, so the closure state stays valid for the whole run.
+	Scheduler_Closure closure = queued_task.closure;
+
+	// Tasks of a cancelled group only release their state, they still finish so the group drains as usual.
+	if (queued_task.group != nullptr && atomic_load(queued_task.group->is_cancelled, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED))
+	{
+		closure.invoke(closure.storage, true);
+		atomic_fetch_add(self->cancelled_task_count, (U64)1, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		_scheduler_finish_task(self, queued_task.group);
+		return;
+	}
+
+	U64 begin_microseconds = self->is_tracing ? platform_query_microseconds() : 0;
+	Scheduler_Group *previous_group = worker->current_group;
+	worker->current_group = queued_task.group;
+	closure.invoke(closure.storage, false);
+	worker->current_group = previous_group;
+	validate(worker->blocking_depth == 0, "[SCHEDULER]: Scheduler worker finished task while still marked as blocking.");
+
+	// Recorded before the task finishes, so the event is visible to anyone who waited for it.
+	if (self->is_tracing)
+	{
+		U64 function = (U64)closure.invoke;
+		if (closure.invoke == _scheduler_invoke_task)
+			function = (U64)((Scheduler_Task *)closure.storage)->function;
+		_scheduler_trace_record(worker->trace, SCHEDULER_TRACE_EVENT_TASK, begin_microseconds, platform_query_microseconds(), function);
+	}
+
+	_scheduler_finish_task(self, queued_task.group);
+}
+
+inline static bool
+_scheduler_try_run_next_task(Scheduler *self, Scheduler_Worker *worker)
+{
+	Scheduler_Queued_Task queued_task = {};
+	if (!_scheduler_try_take_next_task(self, worker, queued_task))
+		return false;
+
+	_scheduler_run_task(self, worker, queued_task);
+	return true;
+}
+
+// Spreads workers over physical cores before doubling up on SMT siblings, keeping neighbours on shared caches.
+inline static Array<U32>
+_scheduler_processor_order(const Array<Platform_Processor> &topology)
+{
+	Array<Platform_Processor> processors = array_copy(topology);
+	DEFER(array_deinit(processors));
+	array_sort(processors, [](const Platform_Processor &a, const Platform_Processor &b) {
+		bool is_a_sibling = a.index != a.core_id;
+		bool is_b_sibling = b.index != b.core_id;
+		if (is_a_sibling != is_b_sibling)
+			return is_b_sibling;
+		if (a.package_id != b.package_id)
+			return a.package_id < b.package_id;
+		if (a.l3_cache_id != b.l3_cache_id)
+			return a.l3_cache_id < b.l3_cache_id;
+		if (a.l2_cache_id != b.l2_cache_id)
+			return a.l2_cache_id < b.l2_cache_id;
+		if (a.core_id != b.core_id)
+			return a.core_id < b.core_id;
+		return a.index < b.index;
+	});
+
+	Array<U32> order = array_init<U32>();
+	for (const Platform_Processor &processor : processors)
+		array_push(order, processor.index);
+	return order;
+}
+
+inline static const Platform_Processor *
+_scheduler_find_processor(const Array<Platform_Processor> &topology, U32 index)
+{
+	for (const Platform_Processor &processor : topology)
+		if (processor.index == index)
+			return &processor;
+	return nullptr;
+}
+
+inline static U32
+_scheduler_processor_distance(const Platform_Processor *a, const Platform_Processor *b)
+{
+	if (a == nullptr || b == nullptr)
+		return 0;
+	if (a->core_id == b->core_id && a->package_id == b->package_id)
+		return 0;
+	if (a->l2_cache_id != U32_MAX && a->l2_cache_id == b->l2_cache_id)
+		return 1;
+	if (a->l3_cache_id != U32_MAX && a->l3_cache_id == b->l3_cache_id)
+		return 2;
+	if (a->package_id == b->package_id)
+		return 3;
+	return 4;
+}
+
+// Victims are ordered by processor distance, ties keep the rotation order so unpinned workers spread their steals.
+inline static void
+_scheduler_worker_init_victims(Scheduler *self, Scheduler_Worker *worker, const Array<Platform_Processor> &topology)
+{
+	constexpr U32 MAX_DISTANCE = 4;
+
+	U32 total_worker_count = (U32)self->workers.count;
+	worker->victims = array_init<U32>();
+	array_reserve(worker->victims, total_worker_count - 1);
+
+	const Platform_Processor *processor = _scheduler_find_processor(topology, worker->processor_index);
+	for (U32 distance = 0; distance <= MAX_DISTANCE; ++distance)
+	{
+		for (U32 i = 1; i < total_worker_count; ++i)
+		{
+			U32 victim_index = (worker->index + i) % total_worker_count;
+			const Platform_Processor *victim_processor = _scheduler_find_processor(topology, self->workers[victim_index].processor_index);
+			if (_scheduler_processor_distance(processor, victim_processor) == distance)
+				array_push(worker->victims, victim_index);
+		}
+	}
+}
+
+// API.
+inline static void
+_scheduler_group_free_list_deinit(Scheduler_Group *free_groups)
+{
+	while (free_groups != nullptr)
+	{
+		Scheduler_Group *group = free_groups;
+		free_groups = group->next_free;
+		memory::deallocate(group);
+	}
+}
+
+Scheduler *
+scheduler_init(Scheduler_Desc desc)
+{
+	validate(desc.worker_count > 0, "[SCHEDULER]: Worker count must be greater than 0.");
+	validate(desc.max_worker_count == 0 || desc.max_worker_count >= desc.worker_count, "[SCHEDULER]: Max worker count must not be less than the worker count.");
+	U32 regular_worker_count = u32_max(desc.worker_count, desc.max_worker_count);
+	U32 total_worker_count = regular_worker_count + desc.replacement_worker_count;
+
+	Platform_Thread_Function worker_function = [](void *data) {
+		Scheduler_Worker *worker = (Scheduler_Worker *)data;
+		Scheduler *self = worker->scheduler;
+		scheduler_current_worker = worker;
+		if (worker->processor_index != U32_MAX)
+			platform_thread_set_current_affinity(worker->processor_index);
+
+		platform_mutex_lock(self->mutex);
+		++self->started_worker_count;
+		platform_condition_variable_signal(self->startup_condition_variable);
+		platform_mutex_unlock(self->mutex);
+
+		/*
+			An idle worker spins for a while before parking, since new work often arrives within microseconds.
+			The spin budget adapts per worker: it grows when spinning found work and shrinks when the worker had
+			to park anyway, so workers stop burning CPU when the scheduler goes quiet.
+		*/
+		U32 spin_count = 0;
+		bool is_spinning = false;
+		while (true)
+		{
+			bool is_active = _scheduler_worker_is_active(self, worker);
+			if (is_active && spin_count == 0)
+			{
+				_scheduler_fire_timers(self);
+				if (self->is_elastic)
+					_scheduler_elastic_try_scale_up(self);
+			}
+
+			Scheduler_Queued_Task queued_task = {};
+			if (is_active && _scheduler_try_take_next_task(self, worker, queued_task))
+			{
+				// The last spinner to find work wakes a replacement spinner, so a burst keeps ramping up workers.
+				if (is_spinning)
+				{
+					is_spinning = false;
+					worker->idle_spin_count = u32_min(worker->idle_spin_count * 2, SCHEDULER_IDLE_SPIN_COUNT_MAX);
+					if (atomic_fetch_sub(self->spinning_worker_count, (U32)1) == 1 && atomic_load(self->queued_task_count) != 0)
+						_scheduler_unpark_workers(self, 1);
+				}
+				_scheduler_run_task(self, worker, queued_task);
+				spin_count = 0;
+				continue;
+			}
+
+			if (!atomic_load(self->is_running) && (!is_active || (atomic_load(self->queued_task_count) == 0 && atomic_load(self->timer_count) == 0)))
+				break;
+
+			if (is_active && spin_count < worker->idle_spin_count)
+			{
+				if (!is_spinning)
+				{
+					is_spinning = true;
+					atomic_fetch_add(self->spinning_worker_count, (U32)1);
+				}
+				++spin_count;
+				compiler_cpu_pause();
+				continue;
+			}
+
+			if (is_spinning)
+			{
+				is_spinning = false;
+				atomic_fetch_sub(self->spinning_worker_count, (U32)1);
+			}
+
+			// Work is queued but could not be taken yet: a push is still in flight or a steal lost its race.
+			if (is_active && atomic_load(self->queued_task_count) != 0)
+			{
+				platform_thread_sleep(0);
+				continue;
+			}
+
+			if (is_active && _scheduler_try_keep_timers(self))
+			{
+				spin_count = 0;
+				continue;
+			}
+
+			if (is_active)
+				worker->idle_spin_count = u32_max(worker->idle_spin_count / 2, SCHEDULER_IDLE_SPIN_COUNT_MIN);
+
+			// Workers above the minimum of an elastic pool park with the idle timeout and retire when it runs out.
+			bool is_retirable = is_active && self->is_elastic && worker->index >= self->min_worker_count && worker->index < self->worker_count;
+			if (_scheduler_worker_park(self, worker, nullptr, is_retirable ? self->idle_timeout_milliseconds : 0))
+				_scheduler_elastic_try_retire(self, worker);
+			spin_count = 0;
+		}
+		scheduler_current_worker = nullptr;
+	};
+
+	Scheduler *self = memory::allocate_zeroed<Scheduler>();
+	self->mutex                      = platform_mutex_init();
+	self->startup_condition_variable = platform_condition_variable_init();
+	self->idle_condition_variable    = platform_condition_variable_init();
+	self->workers                    = array_init_with_count<Scheduler_Worker>(total_worker_count);
+	self->worker_count               = regular_worker_count;
+	self->active_worker_count        = atomic_init(desc.worker_count);
+	self->injection_mutex            = platform_mutex_init();
+	self->is_running                 = atomic_init((U32)1);
+	self->group_pool_mutex           = platform_mutex_init();
+	self->timer_mutex                = platform_mutex_init();
+	self->timers                     = handle_pool_init<Scheduler_Timer>();
+	self->timer_wheel_tick           = platform_query_microseconds() / SCHEDULER_TIMER_TICK_MICROSECONDS;
+	self->next_timer_microseconds    = atomic_init(U64_MAX);
+	self->coroutine_frame_mutex      = platform_mutex_init();
+	self->is_tracing                 = desc.trace_event_capacity != 0;
+	self->trace_begin_microseconds   = platform_query_microseconds();
+	self->trace_mutex                = platform_mutex_init();
+	_scheduler_trace_buffer_init(self->external_trace, desc.trace_event_capacity);
+
+	self->is_elastic                    = regular_worker_count > desc.worker_count;
+	self->min_worker_count              = desc.worker_count;
+	self->scale_up_queue_depth          = desc.scale_up_queue_depth != 0 ? desc.scale_up_queue_depth : SCHEDULER_ELASTIC_DEFAULT_QUEUE_DEPTH;
+	self->scale_up_latency_microseconds = desc.scale_up_latency_microseconds != 0 ? desc.scale_up_latency_microseconds : SCHEDULER_ELASTIC_DEFAULT_LATENCY_MICROSECONDS;
+	self->idle_timeout_milliseconds     = desc.idle_timeout_milliseconds != 0 ? desc.idle_timeout_milliseconds : SCHEDULER_ELASTIC_DEFAULT_IDLE_TIMEOUT_MILLISECONDS;
+	self->queue_progress_microseconds   = atomic_init(platform_query_microseconds());
+
+	for (Ring_Buffer<Scheduler_Queued_Task> &injection_tasks : self->injection_tasks)
+		injection_tasks = ring_buffer_init<Scheduler_Queued_Task>();
+	ring_buffer_reserve(self->injection_tasks[SCHEDULER_PRIORITY_NORMAL], desc.initial_task_queue_capacity);
+
+	U64 task_queue_capacity_per_worker = desc.initial_task_queue_capacity / regular_worker_count;
+	for (U32 i = 0; i < total_worker_count; ++i)
+	{
+		Scheduler_Worker *worker = &self->workers[i];
+		*worker = Scheduler_Worker {};
+		for (Scheduler_Deque &deque : worker->deques)
+			_scheduler_deque_init(deque, task_queue_capacity_per_worker);
+		worker->scheduler = self;
+		worker->index = i;
+		worker->park_semaphore = platform_semaphore_init();
+		worker->idle_spin_count = SCHEDULER_IDLE_SPIN_COUNT_MIN;
+		worker->processor_index = U32_MAX;
+		_scheduler_trace_buffer_init(worker->trace, desc.trace_event_capacity);
+	}
+
+	Array<Platform_Processor> topology = array_init<Platform_Processor>();
+	DEFER(array_deinit(topology));
+	if (desc.is_pinned)
+	{
+		topology = platform_get_processor_topology();
+		for (U32 processor_index : desc.worker_processors)
+			validate(_scheduler_find_processor(topology, processor_index) != nullptr, "[SCHEDULER]: Worker processor is not online.");
+
+		Array<U32> processor_order = desc.worker_processors.count == 0 ? _scheduler_processor_order(topology) : array_init<U32>();
+		DEFER(array_deinit(processor_order));
+		Slice<const U32> processors = desc.worker_processors;
+		if (processors.count == 0)
+			processors = slice_from(processor_order);
+		for (U32 i = 0; i < total_worker_count && processors.count != 0; ++i)
+			self->workers[i].processor_index = processors[i % processors.count];
+	}
+
+	for (U32 i = 0; i < total_worker_count; ++i)
+		_scheduler_worker_init_victims(self, &self->workers[i], topology);
+
+	// Workers steal from each other's deques, so every deque exists before the first thread starts.
+	for (U32 i = 0; i < total_worker_count; ++i)
+	{
+		Scheduler_Worker *worker = &self->workers[i];
+		worker->thread = platform_thread_init(Platform_Thread_Desc {
+			.function = worker_function,
+			.data = worker,
+			.name = desc.worker_thread_name != nullptr ? desc.worker_thread_name : "Scheduler"
+		});
+	}
+
+	platform_mutex_lock(self->mutex);
+	while (self->started_worker_count != total_worker_count)
+		platform_condition_variable_wait(self->startup_condition_variable, self->mutex);
+	platform_mutex_unlock(self->mutex);
+
+	return self;
+}
+
+void
+scheduler_deinit(Scheduler *self)
+{
+	validate(scheduler_current_worker == nullptr || scheduler_current_worker->scheduler != self, "[SCHEDULER]: Scheduler worker cannot deinit its own scheduler.");
+	validate(atomic_load(self->live_group_count) == 0, "[SCHEDULER]: Cannot deinit scheduler while task groups are alive.");
+
+	atomic_store(self->is_running, (U32)0);
+	_scheduler_unpark_all_workers(self);
+
+	for (U64 i = 0; i < self->workers.count; ++i)
+		platform_thread_deinit(self->workers[i].thread);
+
+	validate(atomic_load(self->queued_task_count) == 0 && atomic_load(self->active_task_count) == 0 && atomic_load(self->timer_count) == 0, "[SCHEDULER]: Shutdown did not drain all tasks.");
+	validate(atomic_load(self->live_coroutine_frame_count) == 0, "[SCHEDULER]: Cannot deinit scheduler while coroutines are alive.");
+
+	for (Scheduler_Coroutine_Frame_Header *&free_frames : self->free_coroutine_frames)
+	{
+		while (free_frames != nullptr)
+		{
+			Scheduler_Coroutine_Frame_Header *header = free_frames;
+			free_frames = header->next;
+			memory::deallocate(Memory_Block{header, header->size});
+		}
+	}
+	platform_mutex_deinit(self->coroutine_frame_mutex);
+	_scheduler_trace_buffer_deinit(self->external_trace);
+	platform_mutex_deinit(self->trace_mutex);
+	// Periodic timers that were never cancelled are dropped with the scheduler.
+	handle_pool_deinit(self->timers);
+	for (auto &slots : self->timer_wheel)
+		for (Array<Scheduler_Timer_Handle> &handles : slots)
+			array_deinit(handles);
+	platform_mutex_deinit(self->timer_mutex);
+
+	for (U64 i = 0; i < self->workers.count; ++i)
+	{
+		for (Scheduler_Deque &deque : self->workers[i].deques)
+			_scheduler_deque_deinit(deque);
+		platform_semaphore_deinit(self->workers[i].park_semaphore);
+		array_deinit(self->workers[i].victims);
+		_scheduler_trace_buffer_deinit(self->workers[i].trace);
+		for (Scheduler_Closure_Block_Header *free_blocks : self->workers[i].free_closure_blocks)
+		{
+			while (free_blocks != nullptr)
+			{
+				Scheduler_Closure_Block_Header *header = free_blocks;
+				free_blocks = header->next;
+				memory::deallocate(Memory_Block{header, header->size});
+			}
+		}
+		_scheduler_group_free_list_deinit(self->workers[i].free_groups);
+	}
+	_scheduler_group_free_list_deinit(self->free_groups);
+	platform_mutex_deinit(self->group_pool_mutex);
+	array_deinit(self->workers);
+	for (Ring_Buffer<Scheduler_Queued_Task> &injection_tasks : self->injection_tasks)
+		ring_buffer_deinit(injection_tasks);
+	platform_mutex_deinit(self->injection_mutex);
+	validate(atomic_load(self->blocked_worker_count) == 0, "[SCHEDULER]: Cannot deinit scheduler while workers are marked as blocking.");
+	platform_condition_variable_deinit(self->idle_condition_variable);
+	platform_condition_variable_deinit(self->startup_condition_variable);
+	platform_mutex_deinit(self->mutex);
+	memory::deallocate(self);
+}
+
+// Workers take from and release to their own list without any lock, other threads share one list.
+Scheduler_Group *
+scheduler_group_init(Scheduler *self)
+{
+	validate(atomic_load(self->is_running), "[SCHEDULER]: Cannot create task group after shutdown.");
+	atomic_fetch_add(self->live_group_count, (U32)1);
+
+	Scheduler_Group *group = nullptr;
+	Scheduler_Worker *worker = scheduler_current_worker;
+	if (worker != nullptr && worker->scheduler == self && worker->free_groups != nullptr)
+	{
+		group = worker->free_groups;
+		worker->free_groups = group->next_free;
+		--worker->free_group_count;
+	}
+	else
+	{
+		platform_mutex_lock(self->group_pool_mutex);
+		group = self->free_groups;
+		if (group != nullptr)
+			self->free_groups = group->next_free;
+		platform_mutex_unlock(self->group_pool_mutex);
+	}
+
+	if (group == nullptr)
+	{
+		group = memory::allocate_zeroed<Scheduler_Group>();
+		group->scheduler = self;
+	}
+
+	// The drain sequence keeps counting across reuses, a stale sleeper must never see its old value again.
+	atomic_store(group->is_cancelled, (U32)0, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	group->next_free = nullptr;
+	return group;
+}
+
+void
+scheduler_group_deinit(Scheduler *self, Scheduler_Group *group)
+{
+	validate(group->scheduler == self, "[SCHEDULER]: Task group belongs to a different scheduler.");
+	validate(_scheduler_group_pending_task_count(group) == 0, "[SCHEDULER]: Cannot deinit task group while tasks are pending.");
+	validate(atomic_load(group->periodic_timer_count) == 0, "[SCHEDULER]: Cannot deinit task group while periodic timers refer to it, cancel them first.");
+
+	// The thread that drained the group may still be detaching its waiters.
+	while (atomic_load(group->pending_task_count) & SCHEDULER_GROUP_HAS_WAITERS)
+		platform_thread_sleep(0);
+	atomic_fetch_sub(self->live_group_count, (U32)1);
+
+	Scheduler_Worker *worker = scheduler_current_worker;
+	if (worker != nullptr && worker->scheduler == self && worker->free_group_count < SCHEDULER_GROUP_CACHE_COUNT)
+	{
+		group->next_free = worker->free_groups;
+		worker->free_groups = group;
+		++worker->free_group_count;
+		return;
+	}
+
+	platform_mutex_lock(self->group_pool_mutex);
+	group->next_free = self->free_groups;
+	self->free_groups = group;
+	platform_mutex_unlock(self->group_pool_mutex);
+}
+
+void
+scheduler_submit(Scheduler *self, Slice<const Scheduler_Task> tasks, Scheduler_Group *group, Scheduler_Priority priority)
+{
+	validate(group == nullptr || group->scheduler == self, "[SCHEDULER]: Task group belongs to a different scheduler.");
+	validate(priority < SCHEDULER_PRIORITY_COUNT, "[SCHEDULER]: Invalid task priority.");
+	validate(atomic_load(self->is_running), "[SCHEDULER]: Cannot submit task after shutdown.");
+	if (tasks.count == 0)
+		return;
+
+	if (group != nullptr)
+		atomic_fetch_add(group->pending_task_count, tasks.count);
+	_scheduler_push_tasks(self, tasks, group, priority);
+}
+
+void
+scheduler_submit(Scheduler *self, const Scheduler_Closure &closure, Scheduler_Group *group, Scheduler_Priority priority)
+{
+	validate(closure.invoke != nullptr, "[SCHEDULER]: Invalid closure.");
+	validate(group == nullptr || group->scheduler == self, "[SCHEDULER]: Task group belongs to a different scheduler.");
+	validate(priority < SCHEDULER_PRIORITY_COUNT, "[SCHEDULER]: Invalid task priority.");
+	validate(atomic_load(self->is_running), "[SCHEDULER]: Cannot submit task after shutdown.");
+
+	if (group != nullptr)
+		atomic_fetch_add(group->pending_task_count, (U64)1);
+	_scheduler_push_tasks(self, Slice<const Scheduler_Closure>(closure), group, priority);
+}
+
+// Releases delayed tasks that were taken out of the wheel before they fired.
+inline static void
+_scheduler_timer_release_delayed_tasks(Scheduler *self, Scheduler_Group *group, U32 count)
+{
+	if (group != nullptr)
+		for (U32 i = 0; i < count; ++i)
+			_scheduler_group_finish_task(self, group);
+
+	if (atomic_fetch_sub(self->timer_count, count) == count && atomic_load(self->queued_task_count) == 0 && atomic_load(self->active_task_count) == 0)
+		_scheduler_notify_idle(self);
+}
+
+inline static Scheduler_Timer_Handle
+_scheduler_timer_submit(Scheduler *self, U64 delay_microseconds, U64 period_microseconds, Scheduler_Task task, Scheduler_Group *group, Scheduler_Priority priority)
+{
+	validate(group == nullptr || group->scheduler == self, "[SCHEDULER]: Task group belongs to a different scheduler.");
+	validate(priority < SCHEDULER_PRIORITY_COUNT, "[SCHEDULER]: Invalid task priority.");
+	validate(atomic_load(self->is_running), "[SCHEDULER]: Cannot submit task after shutdown.");
+
+	// A one-shot task counts against its group from now on, so waiting for the group also waits for the delay.
+	if (group != nullptr && period_microseconds == 0)
+		atomic_fetch_add(group->pending_task_count, (U64)1);
+	else if (group != nullptr)
+		atomic_fetch_add(group->periodic_timer_count, (U32)1);
+
+	U64 now = platform_query_microseconds();
+	Scheduler_Timer timer = {
+		.deadline_microseconds = now + delay_microseconds,
+		.period_microseconds = period_microseconds,
+		.task = task,
+		.group = group,
+		.priority = priority
+	};
+
+	platform_mutex_lock(self->timer_mutex);
+	// The wheel is not advanced while it is empty, so it catches up before it takes the first timer.
+	if (self->timers.count == 0)
+		self->timer_wheel_tick = now / SCHEDULER_TIMER_TICK_MICROSECONDS;
+	Scheduler_Timer_Handle handle = handle_pool_insert(self->timers, timer);
+	_scheduler_timer_wheel_insert(self, handle, timer.deadline_microseconds);
+	_scheduler_timer_wheel_publish_next_deadline(self);
+	atomic_fetch_add(period_microseconds == 0 ? self->timer_count : self->periodic_timer_count, (U32)1);
+	platform_mutex_unlock(self->timer_mutex);
+
+	// Parking workers read the timer count after they publish their parked state, so one of both sides sees the other.
+	if (atomic_load(self->is_timer_kept) == 0)
+		_scheduler_unpark_workers(self, 1);
+	return handle;
+}
+
+Scheduler_Timer_Handle
+scheduler_submit_after(Scheduler *self, U32 delay_milliseconds, Scheduler_Task task, Scheduler_Group *group, Scheduler_Priority priority)
+{
+	return _scheduler_timer_submit(self, (U64)delay_milliseconds * 1000, 0, task, group, priority);
+}
+
+Scheduler_Timer_Handle
+scheduler_submit_every(Scheduler *self, U32 period_milliseconds, Scheduler_Task task, Scheduler_Group *group, Scheduler_Priority priority)
+{
+	validate(period_milliseconds != 0, "[SCHEDULER]: Timer period cannot be zero.");
+	return _scheduler_timer_submit(self, (U64)period_milliseconds * 1000, (U64)period_milliseconds * 1000, task, group, priority);
+}
+
+bool
+scheduler_timer_cancel(Scheduler *self, Scheduler_Timer_Handle timer)
+{
+	platform_mutex_lock(self->timer_mutex);
+	Scheduler_Timer *live_timer = handle_pool_get(self->timers, timer);
+	if (live_timer == nullptr)
+	{
+		platform_mutex_unlock(self->timer_mutex);
+		return false;
+	}
+
+	// The handle in the wheel goes stale and is dropped when its slot comes up.
+	Scheduler_Timer cancelled_timer = *live_timer;
+	handle_pool_remove(self->timers, timer);
+	if (self->timers.count == 0)
+		atomic_store(self->next_timer_microseconds, U64_MAX);
+	platform_mutex_unlock(self->timer_mutex);
+
+	if (cancelled_timer.period_microseconds != 0)
+	{
+		if (cancelled_timer.group != nullptr)
+			atomic_fetch_sub(cancelled_timer.group->periodic_timer_count, (U32)1);
+		atomic_fetch_sub(self->periodic_timer_count, (U32)1);
+		return true;
+	}
+
+	_scheduler_timer_release_delayed_tasks(self, cancelled_timer.group, 1);
+	return true;
+}
+
+Scheduler_Group_Status
+scheduler_wait_group(Scheduler *self, Scheduler_Group *group)
+{
+	validate(group->scheduler == self, "[SCHEDULER]: Scheduler group belongs to a different scheduler.");
+	bool is_scheduler_worker = scheduler_current_worker != nullptr && scheduler_current_worker->scheduler == self;
+	validate(!is_scheduler_worker || scheduler_current_worker->current_group != group, "[SCHEDULER]: Scheduler task cannot wait for its own group.");
+
+	U64 begin_microseconds = self->is_tracing ? platform_query_microseconds() : 0;
+	bool has_waited = false;
+	U32 spin_count = 0;
+	while (_scheduler_group_pending_task_count(group) != 0)
+	{
+		has_waited = true;
+
+		// Workers keep executing tasks while they wait, which is what lets a task wait on its children.
+		if (is_scheduler_worker)
+		{
+			if (_scheduler_try_run_next_task(self, scheduler_current_worker))
+			{
+				spin_count = 0;
+				continue;
+			}
+
+			if (atomic_load(self->queued_task_count) != 0)
+			{
+				_scheduler_backoff(spin_count);
+				continue;
+			}
+
+			if (_scheduler_try_keep_timers(self))
+				continue;
+		}
+
+		// Sleeping is registered through the waiters bit, so only a group that drains with sleepers pays for the wakeup.
+		_scheduler_group_lock(group);
+		U32 drain_sequence = atomic_load(group->drain_sequence);
+		bool is_registered = _scheduler_group_try_set_waiters(group);
+		_scheduler_group_unlock(group);
+		if (!is_registered)
+			continue;
+
+		// Waiting workers park like idle ones, new tasks wake them to help and the draining thread wakes them when done.
+		if (is_scheduler_worker)
+		{
+			Scheduler_Worker *worker = scheduler_current_worker;
+			worker->waited_group = group;
+			_scheduler_worker_park(self, worker, group);
+			worker->waited_group = nullptr;
+		}
+		else
+		{
+			platform_address_wait(&group->drain_sequence.value, drain_sequence);
+		}
+		spin_count = 0;
+	}
+
+	if (self->is_tracing && has_waited)
+		_scheduler_trace_record_current(self, SCHEDULER_TRACE_EVENT_GROUP_WAIT, begin_microseconds, platform_query_microseconds(), 0);
+
+	return atomic_load(group->is_cancelled) ? SCHEDULER_GROUP_STATUS_CANCELLED : SCHEDULER_GROUP_STATUS_COMPLETED;
+}
+
+void
+scheduler_group_cancel(Scheduler *self, Scheduler_Group *group)
+{
+	validate(group->scheduler == self, "[SCHEDULER]: Task group belongs to a different scheduler.");
+
+	U32 expected = 0;
+	if (!atomic_compare_exchange(group->is_cancelled, expected, (U32)1))
+		return;
+
+	// Delayed tasks would hold the group until their deadline only to be dropped then, and periodic timers would
+	// keep queueing runs that are dropped forever. Removal swaps the last timer into the hole, so the pool is walked backwards.
+	U32 cancelled_timer_count = 0;
+	U32 cancelled_periodic_timer_count = 0;
+	platform_mutex_lock(self->timer_mutex);
+	for (U64 i = self->timers.count; i > 0; --i)
+	{
+		const Scheduler_Timer &timer = self->timers.values[i - 1];
+		if (timer.group != group)
+			continue;
+
+		if (timer.period_microseconds == 0)
+			++cancelled_timer_count;
+		else
+			++cancelled_periodic_timer_count;
+		handle_pool_remove(self->timers, handle_pool_handle_at(self->timers, i - 1));
+	}
+	if (self->timers.count == 0)
+		atomic_store(self->next_timer_microseconds, U64_MAX);
+	platform_mutex_unlock(self->timer_mutex);
+
+	if (cancelled_periodic_timer_count != 0)
+	{
+		atomic_fetch_sub(group->periodic_timer_count, cancelled_periodic_timer_count);
+		atomic_fetch_sub(self->periodic_timer_count, cancelled_periodic_timer_count);
+	}
+
+	if (cancelled_timer_count != 0)
+	{
+		atomic_fetch_add(self->cancelled_task_count, (U64)cancelled_timer_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		_scheduler_timer_release_delayed_tasks(self, group, cancelled_timer_count);
+	}
+}
+
+bool
+scheduler_group_is_cancelled(Scheduler *self, Scheduler_Group *group)
+{
+	validate(group->scheduler == self, "[SCHEDULER]: Task group belongs to a different scheduler.");
+	return atomic_load(group->is_cancelled, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+}
+
+void
+scheduler_wait_all(Scheduler *self)
+{
+	validate(scheduler_current_worker == nullptr || scheduler_current_worker->scheduler != self, "[SCHEDULER]: Scheduler worker cannot wait for all work.");
+
+	platform_mutex_lock(self->mutex);
+	atomic_fetch_add(self->idle_waiter_count, (U32)1);
+	while (atomic_load(self->queued_task_count) != 0 || atomic_load(self->active_task_count) != 0 || atomic_load(self->timer_count) != 0)
+		platform_condition_variable_wait(self->idle_condition_variable, self->mutex);
+	atomic_fetch_sub(self->idle_waiter_count, (U32)1);
+	platform_mutex_unlock(self->mutex);
+}
+
+bool
+scheduler_group_add_waiter(Scheduler *self, Scheduler_Group *group, Scheduler_Group_Waiter *waiter)
+{
+	validate(group->scheduler == self, "[SCHEDULER]: Task group belongs to a different scheduler.");
+	validate(waiter->priority < SCHEDULER_PRIORITY_COUNT, "[SCHEDULER]: Invalid task priority.");
+
+	_scheduler_group_lock(group);
+	DEFER(_scheduler_group_unlock(group));
+
+	if (!_scheduler_group_try_set_waiters(group))
+		return false;
+
+	waiter->next = group->waiters;
+	group->waiters = waiter;
+	return true;
+}
+
+void
+scheduler_group_add_pending(Scheduler *self, Scheduler_Group *group)
+{
+	validate(group->scheduler == self, "[SCHEDULER]: Task group belongs to a different scheduler.");
+	atomic_fetch_add(group->pending_task_count, (U64)1);
+}
+
+void
+scheduler_group_complete_pending(Scheduler *self, Scheduler_Group *group)
+{
+	validate(group->scheduler == self, "[SCHEDULER]: Task group belongs to a different scheduler.");
+	validate(_scheduler_group_pending_task_count(group) != 0, "[SCHEDULER]: Task group has no pending work to complete.");
+	_scheduler_group_finish_task(self, group);
+}
+
+void
+scheduler_worker_block_ahead(Scheduler *self)
+{
+	validate(scheduler_current_worker != nullptr && scheduler_current_worker->scheduler == self, "[SCHEDULER]: Only a scheduler worker can mark itself as blocking.");
+
+	platform_mutex_lock(self->mutex);
+	if (scheduler_current_worker->blocking_depth == 0)
+	{
+		if (self->is_tracing)
+			scheduler_current_worker->block_begin_microseconds = platform_query_microseconds();
+		atomic_fetch_add(self->blocked_worker_count, (U32)1);
+		_scheduler_update_active_replacement_worker_count(self);
+	}
+	++scheduler_current_worker->blocking_depth;
+	platform_mutex_unlock(self->mutex);
+}
+
+void
+scheduler_worker_block_clear(Scheduler *self)
+{
+	validate(scheduler_current_worker != nullptr && scheduler_current_worker->scheduler == self, "[SCHEDULER]: Only a scheduler worker can clear its blocking marker.");
+
+	platform_mutex_lock(self->mutex);
+	validate(scheduler_current_worker->blocking_depth > 0, "[SCHEDULER]: Worker blocking marker was not set.");
 	--scheduler_current_worker->blocking_depth;
 	if (scheduler_current_worker->blocking_depth == 0)
 	{
-		--self->blocked_worker_count;
-		_scheduler_update_active_replacement_worker_count(self);
+		if (self->is_tracing)
+			_scheduler_trace_record(scheduler_current_worker->trace, SCHEDULER_TRACE_EVENT_BLOCK, scheduler_current_worker->block_begin_microseconds, platform_query_microseconds(), 0);
+		atomic_fetch_sub(self->blocked_worker_count, (U32)1);
+		_scheduler_update_active_replacement_worker_count(self);
+	}
+	platform_mutex_unlock(self->mutex);
+}
+
+U32
+scheduler_get_current_worker_index(Scheduler *self)
+{
+	if (scheduler_current_worker == nullptr || scheduler_current_worker->scheduler != self)
+		return U32_MAX;
+
+	return scheduler_current_worker->index;
+}
+
+U32
+scheduler_get_worker_processor(Scheduler *self, U32 worker_index)
+{
+	validate(worker_index < self->workers.count, "[SCHEDULER]: Worker index is out of range.");
+	return self->workers[worker_index].processor_index;
+}
+
+Scheduler_Stats
+scheduler_get_stats(Scheduler *self)
+{
+	Scheduler_Stats stats = {
+		.worker_count = self->worker_count,
+		.active_worker_count = atomic_load(self->active_worker_count),
+		.replacement_worker_count = (U32)self->workers.count - self->worker_count,
+		.active_replacement_worker_count = atomic_load(self->active_replacement_worker_count),
+		.blocked_worker_count = atomic_load(self->blocked_worker_count),
+		.active_task_count = atomic_load(self->active_task_count),
+		.queued_task_count = atomic_load(self->queued_task_count),
+		.live_group_count = atomic_load(self->live_group_count),
+		.pending_timer_count = atomic_load(self->timer_count),
+		.periodic_timer_count = atomic_load(self->periodic_timer_count),
+		.live_coroutine_frame_count = atomic_load(self->live_coroutine_frame_count),
+		.fired_timer_count = atomic_load(self->fired_timer_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED),
+		.timer_jitter_microseconds_total = atomic_load(self->timer_jitter_microseconds_total, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED),
+		.timer_jitter_microseconds_max = atomic_load(self->timer_jitter_microseconds_max, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED),
+		.cancelled_task_count = atomic_load(self->cancelled_task_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED),
+		.scale_up_queue_depth_count = atomic_load(self->scale_up_queue_depth_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED),
+		.scale_up_latency_count = atomic_load(self->scale_up_latency_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED),
+		.scale_down_count = atomic_load(self->scale_down_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED)
+	};
+	for (U32 i = 0; i < SCHEDULER_PRIORITY_COUNT; ++i)
+		stats.queued_task_counts[i] = atomic_load(self->queued_task_counts[i]);
+
+	if (!self->is_tracing)
+		return stats;
+
+	auto add_trace_counters = [&stats](const Scheduler_Trace_Buffer &trace) {
+		stats.trace_task_count              += atomic_load(trace.event_counts[SCHEDULER_TRACE_EVENT_TASK], COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		stats.trace_task_microseconds       += atomic_load(trace.event_microseconds[SCHEDULER_TRACE_EVENT_TASK], COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		stats.trace_steal_count             += atomic_load(trace.event_counts[SCHEDULER_TRACE_EVENT_STEAL], COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		stats.trace_park_count              += atomic_load(trace.event_counts[SCHEDULER_TRACE_EVENT_PARK], COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		stats.trace_park_microseconds       += atomic_load(trace.event_microseconds[SCHEDULER_TRACE_EVENT_PARK], COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		stats.trace_unpark_count            += atomic_load(trace.event_counts[SCHEDULER_TRACE_EVENT_UNPARK], COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		stats.trace_block_microseconds      += atomic_load(trace.event_microseconds[SCHEDULER_TRACE_EVENT_BLOCK], COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		stats.trace_group_wait_microseconds += atomic_load(trace.event_microseconds[SCHEDULER_TRACE_EVENT_GROUP_WAIT], COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		stats.trace_dropped_event_count     += atomic_load(trace.dropped_event_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	};
+	for (const Scheduler_Worker &worker : self->workers)
+		add_trace_counters(worker.trace);
+	add_trace_counters(self->external_trace);
+	return stats;
+}
+
+String
+scheduler_trace_to_json(Scheduler *self, memory::Allocator *allocator)
+{
+	constexpr const char *EVENT_NAMES[SCHEDULER_TRACE_EVENT_COUNT] = {"Task", "Steal", "Park", "Unpark", "Block", "Group Wait"};
+	constexpr const char *EVENT_ARGUMENT_NAMES[SCHEDULER_TRACE_EVENT_COUNT] = {"function", "victim", nullptr, "worker", nullptr, nullptr};
+
+	Formatter formatter = formatter_init(allocator);
+	string_append(formatter.buffer, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+	// One Chrome thread per worker, plus one for events recorded on threads outside the scheduler.
+	U32 thread_count = (U32)self->workers.count + 1;
+	bool is_first_event = true;
+	for (U32 thread_id = 0; thread_id < thread_count; ++thread_id)
+	{
+		const Scheduler_Trace_Buffer &trace = thread_id < self->workers.count ? self->workers[thread_id].trace : self->external_trace;
+		const char *thread_kind = thread_id < self->worker_count ? "Worker" : thread_id < self->workers.count ? "Replacement Worker" : "External";
+
+		format(formatter, "{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{} {}\"}}}}", is_first_event ? "" : ",", thread_id, thread_kind, thread_id);
+		is_first_event = false;
+
+		U32 event_count = atomic_load(trace.count, COMPILER_ATOMIC_MEMORY_ORDER_ACQUIRE);
+		for (U32 i = 0; i < event_count; ++i)
+		{
+			const Scheduler_Trace_Event &event = trace.events[i];
+			format(formatter, ",{{\"name\":\"{}\",\"cat\":\"scheduler\",\"pid\":1,\"tid\":{},\"ts\":{}", EVENT_NAMES[event.type], thread_id, event.begin_microseconds - self->trace_begin_microseconds);
+
+			if (event.type == SCHEDULER_TRACE_EVENT_STEAL || event.type == SCHEDULER_TRACE_EVENT_UNPARK)
+				string_append(formatter.buffer, ",\"ph\":\"i\",\"s\":\"t\"");
+			else
+				format(formatter, ",\"ph\":\"X\",\"dur\":{}", event.end_microseconds - event.begin_microseconds);
+
+			if (event.type == SCHEDULER_TRACE_EVENT_TASK)
+				format(formatter, ",\"args\":{{\"{}\":\"0x{:x}\"}}", EVENT_ARGUMENT_NAMES[event.type], event.argument);
+			else if (EVENT_ARGUMENT_NAMES[event.type] != nullptr)
+				format(formatter, ",\"args\":{{\"{}\":{}}}", EVENT_ARGUMENT_NAMES[event.type], event.argument);
+			string_append(formatter.buffer, '}');
+		}
+	}
+	string_append(formatter.buffer, "]}");
+	return formatter.buffer;
+}
+
+Error
+scheduler_trace_to_file(Scheduler *self, const char *filepath)
+{
+	String json = scheduler_trace_to_json(self, memory::temp_allocator());
+	if (platform_path_write_file(filepath, json) != json.count)
+		return Error{"[SCHEDULER]: Could not write trace file '{}'.", filepath};
+	return {};
+}
+
+struct Scheduler_Parallel_For_Context
+{
+	Scheduler *scheduler;
+	Scheduler_Group *group;
+	Scheduler_Group *cancellation_group;
+	void (*function)(U32 begin, U32 end, void *data);
+	void *data;
+	U32 grain_size;
+	Scheduler_Priority priority;
+};
+
+// Spinning workers, and parked workers that are allowed to run tasks, would take a split range right away.
+// Ranges that are already queued will be taken first, so they count against the idle workers.
+inline static bool
+_scheduler_has_idle_worker(Scheduler *self)
+{
+	U32 inactive_worker_count = (U32)self->workers.count - atomic_load(self->active_worker_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED) - atomic_load(self->active_replacement_worker_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	U32 parked_worker_count = atomic_load(self->parked_worker_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	U32 idle_worker_count = atomic_load(self->spinning_worker_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+	if (parked_worker_count > inactive_worker_count)
+		idle_worker_count += parked_worker_count - inactive_worker_count;
+	return idle_worker_count > atomic_load(self->queued_task_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+}
+
+// Cancelling the outer group cancels the range group as well, so ranges that are already queued are dropped
+// instead of run.
+inline static bool
+_scheduler_parallel_for_is_cancelled(Scheduler_Parallel_For_Context *context)
+{
+	if (atomic_load(context->group->is_cancelled, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED))
+		return true;
+
+	if (context->cancellation_group == nullptr || !atomic_load(context->cancellation_group->is_cancelled, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED))
+		return false;
+
+	atomic_store(context->group->is_cancelled, (U32)1);
+	return true;
+}
+
+/*
+	Lazy binary splitting: a range task runs one grain at a time, and before each grain it gives the upper
+	half of what is left to a new task, but only while some worker is idle. A busy scheduler runs the range
+	as one sequential loop, and skewed ranges keep splitting for as long as other workers run dry.
+	Splits are on grain boundaries, and a split range travels inline in its closure, so nothing is allocated.
+*/
+inline static void
+_scheduler_parallel_for_range(Scheduler_Parallel_For_Context *context, U32 begin, U32 end)
+{
+	Scheduler *self = context->scheduler;
+	U32 grain_size = context->grain_size;
+
+	while (begin < end && !_scheduler_parallel_for_is_cancelled(context))
+	{
+		U32 grain_count = (U32)(((U64)end - begin + grain_size - 1) / grain_size);
+		if (grain_count > 1 && _scheduler_has_idle_worker(self))
+		{
+			U32 middle = begin + grain_count / 2 * grain_size;
+			scheduler_submit_fn(self, [context, middle, end]() {
+				_scheduler_parallel_for_range(context, middle, end);
+			}, context->group, context->priority);
+			end = middle;
+			continue;
+		}
+
+		U32 grain_end = u32_min(begin + grain_size, end);
+		context->function(begin, grain_end, context->data);
+		begin = grain_end;
+	}
+}
+
+inline static void
+_scheduler_parallel_for(Scheduler *self, U32 count, U32 grain_size, void (*function)(U32 begin, U32 end, void *data), void *data, Scheduler_Priority priority, Scheduler_Group *cancellation_group)
+{
+	if (count == 0)
+		return;
+
+	if (grain_size == 0)
+	{
+		U64 target_grain_count = u64_min((U64)self->workers.count * SCHEDULER_PARALLEL_FOR_GRAINS_PER_WORKER, count);
+		grain_size = (U32)(((U64)count + target_grain_count - 1) / target_grain_count);
+	}
+
+	Scheduler_Group *group = scheduler_group_init(self);
+	DEFER(scheduler_group_deinit(self, group));
+
+	Scheduler_Worker *worker = scheduler_current_worker;
+	if (cancellation_group == nullptr && worker != nullptr && worker->scheduler == self)
+		cancellation_group = worker->current_group;
+
+	Scheduler_Parallel_For_Context context = {
+		.scheduler = self,
+		.group = group,
+		.cancellation_group = cancellation_group,
+		.function = function,
+		.data = data,
+		.grain_size = grain_size,
+		.priority = priority
+	};
+
+	scheduler_submit_fn(self, [context = &context, count]() {
+		_scheduler_parallel_for_range(context, 0, count);
+	}, group, priority);
+	scheduler_wait_group(self, group);
+}
+
+void
+scheduler_parallel_for(Scheduler *self, Scheduler_Parallel_For_Desc desc)
+{
+	_scheduler_parallel_for(self, desc.count, desc.chunk_size, desc.function, desc.data, desc.priority, desc.cancellation_group);
+}
+
+// Tiles are numbered row by row, x fastest, so neighbouring tiles in a range are neighbours in memory.
+void
+scheduler_parallel_for_2d(Scheduler *self, Scheduler_Parallel_For_2D_Desc desc)
+{
+	if (desc.count_x == 0 || desc.count_y == 0)
+		return;
+
+	desc.tile_size_x = u32_min(desc.tile_size_x != 0 ? desc.tile_size_x : SCHEDULER_PARALLEL_FOR_2D_TILE_SIZE, desc.count_x);
+	desc.tile_size_y = u32_min(desc.tile_size_y != 0 ? desc.tile_size_y : SCHEDULER_PARALLEL_FOR_2D_TILE_SIZE, desc.count_y);
+
+	U32 tile_count_x = (desc.count_x + desc.tile_size_x - 1) / desc.tile_size_x;
+	U32 tile_count_y = (desc.count_y + desc.tile_size_y - 1) / desc.tile_size_y;
+	validate((U64)tile_count_x * tile_count_y <= U32_MAX, "[SCHEDULER]: Too many tiles.");
+
+	struct Scheduler_Parallel_For_2D_Context
+	{
+		Scheduler_Parallel_For_2D_Desc desc;
+		U32 tile_count_x;
+	};
+
+	Scheduler_Parallel_For_2D_Context context = {
+		.desc = desc,
+		.tile_count_x = tile_count_x
+	};
+
+	_scheduler_parallel_for(self, tile_count_x * tile_count_y, 1, [](U32 begin, U32 end, void *data) {
+		Scheduler_Parallel_For_2D_Context *context = (Scheduler_Parallel_For_2D_Context *)data;
+		const Scheduler_Parallel_For_2D_Desc &desc = context->desc;
+		for (U32 tile = begin; tile < end; ++tile)
+		{
+			U32 begin_x = tile % context->tile_count_x * desc.tile_size_x;
+			U32 begin_y = tile / context->tile_count_x * desc.tile_size_y;
+			desc.function(Scheduler_Tile {
+				.begin_x = begin_x,
+				.end_x = u32_min(begin_x + desc.tile_size_x, desc.count_x),
+				.begin_y = begin_y,
+				.end_y = u32_min(begin_y + desc.tile_size_y, desc.count_y),
+				.begin_z = 0,
+				.end_z = 1
+			}, desc.data);
+		}
+	}, &context, desc.priority, desc.cancellation_group);
+}
+
+void
+scheduler_parallel_for_3d(Scheduler *self, Scheduler_Parallel_For_3D_Desc desc)
+{
+	if (desc.count_x == 0 || desc.count_y == 0 || desc.count_z == 0)
+		return;
+
+	desc.tile_size_x = u32_min(desc.tile_size_x != 0 ? desc.tile_size_x : SCHEDULER_PARALLEL_FOR_3D_TILE_SIZE, desc.count_x);
+	desc.tile_size_y = u32_min(desc.tile_size_y != 0 ? desc.tile_size_y : SCHEDULER_PARALLEL_FOR_3D_TILE_SIZE, desc.count_y);
+	desc.tile_size_z = u32_min(desc.tile_size_z != 0 ? desc.tile_size_z : SCHEDULER_PARALLEL_FOR_3D_TILE_SIZE, desc.count_z);
+
+	U32 tile_count_x = (desc.count_x + desc.tile_size_x - 1) / desc.tile_size_x;
+	U32 tile_count_y = (desc.count_y + desc.tile_size_y - 1) / desc.tile_size_y;
+	U32 tile_count_z = (desc.count_z + desc.tile_size_z - 1) / desc.tile_size_z;
+	validate((U64)tile_count_x * tile_count_y * tile_count_z <= U32_MAX, "[SCHEDULER]: Too many tiles.");
+
+	struct Scheduler_Parallel_For_3D_Context
+	{
+		Scheduler_Parallel_For_3D_Desc desc;
+		U32 tile_count_x;
+		U32 tile_count_y;
+	};
+
+	Scheduler_Parallel_For_3D_Context context = {
+		.desc = desc,
+		.tile_count_x = tile_count_x,
+		.tile_count_y = tile_count_y
+	};
+
+	_scheduler_parallel_for(self, tile_count_x * tile_count_y * tile_count_z, 1, [](U32 begin, U32 end, void *data) {
+		Scheduler_Parallel_For_3D_Context *context = (Scheduler_Parallel_For_3D_Context *)data;
+		const Scheduler_Parallel_For_3D_Desc &desc = context->desc;
+		for (U32 tile = begin; tile < end; ++tile)
+		{
+			U32 begin_x = tile % context->tile_count_x * desc.tile_size_x;
+			U32 begin_y = tile / context->tile_count_x % context->tile_count_y * desc.tile_size_y;
+			U32 begin_z = tile / context->tile_count_x / context->tile_count_y * desc.tile_size_z;
+			desc.function(Scheduler_Tile {
+				.begin_x = begin_x,
+				.end_x = u32_min(begin_x + desc.tile_size_x, desc.count_x),
+				.begin_y = begin_y,
+				.end_y = u32_min(begin_y + desc.tile_size_y, desc.count_y),
+				.begin_z = begin_z,
+				.end_z = u32_min(begin_z + desc.tile_size_z, desc.count_z)
+			}, desc.data);
+		}
+	}, &context, desc.priority, desc.cancellation_group);
+}
+
+void *
+scheduler_coroutine_frame_allocate(Scheduler *self, U64 size)
+{
+	U64 block_size = sizeof(Scheduler_Coroutine_Frame_Header) + size;
+	U64 size_class = (block_size - 1) / SCHEDULER_COROUTINE_FRAME_GRANULARITY;
+	if (size_class >= SCHEDULER_COROUTINE_FRAME_CLASS_COUNT)
+		self = nullptr;
+
+	Scheduler_Coroutine_Frame_Header *header = nullptr;
+	if (self != nullptr)
+	{
+		block_size = (size_class + 1) * SCHEDULER_COROUTINE_FRAME_GRANULARITY;
+		platform_mutex_lock(self->coroutine_frame_mutex);
+		header = self->free_coroutine_frames[size_class];
+		if (header != nullptr)
+			self->free_coroutine_frames[size_class] = header->next;
+		platform_mutex_unlock(self->coroutine_frame_mutex);
+		atomic_fetch_add(self->live_coroutine_frame_count, (U32)1);
 	}
-	platform_mutex_unlock(self->mutex);
+
+	if (header == nullptr)
+		header = (Scheduler_Coroutine_Frame_Header *)memory::allocate(block_size, alignof(Scheduler_Coroutine_Frame_Header)).data;
+	header->scheduler = self;
+	header->size = block_size;
+	return header + 1;
 }
 
-U32
-scheduler_get_current_worker_index(Scheduler *self)
+void
+scheduler_coroutine_frame_deallocate(void *frame)
 {
-	if (scheduler_current_worker == nullptr || scheduler_current_worker->scheduler != self)
+	Scheduler_Coroutine_Frame_Header *header = (Scheduler_Coroutine_Frame_Header *)frame - 1;
+	Scheduler *self = header->scheduler;
+	if (self == nullptr)
+	{
+		memory::deallocate(Memory_Block{header, header->size});
+		return;
+	}
+
+	U64 size_class = header->size / SCHEDULER_COROUTINE_FRAME_GRANULARITY - 1;
+	platform_mutex_lock(self->coroutine_frame_mutex);
+	header->next = self->free_coroutine_frames[size_class];
+	self->free_coroutine_frames[size_class] = header;
+	platform_mutex_unlock(self->coroutine_frame_mutex);
+	atomic_fetch_sub(self->live_coroutine_frame_count, (U32)1);
+}
+
+// Blocks are rounded up to their size class even on the heap path, so any worker can cache any block it releases.
+void *
+scheduler_closure_allocate(Scheduler *self, U64 size)
+{
+	U64 block_size = sizeof(Scheduler_Closure_Block_Header) + size;
+	U64 size_class = (block_size - 1) / SCHEDULER_CLOSURE_BLOCK_GRANULARITY;
+	if (size_class < SCHEDULER_CLOSURE_BLOCK_CLASS_COUNT)
+		block_size = (size_class + 1) * SCHEDULER_CLOSURE_BLOCK_GRANULARITY;
+
+	Scheduler_Closure_Block_Header *header = nullptr;
+	Scheduler_Worker *worker = scheduler_current_worker;
+	if (worker != nullptr && worker->scheduler == self && size_class < SCHEDULER_CLOSURE_BLOCK_CLASS_COUNT)
+	{
+		header = worker->free_closure_blocks[size_class];
+		if (header != nullptr)
+		{
+			worker->free_closure_blocks[size_class] = header->next;
+			--worker->free_closure_block_counts[size_class];
+		}
+	}
+
+	if (header == nullptr)
+		header = (Scheduler_Closure_Block_Header *)memory::allocate(block_size, alignof(Scheduler_Closure_Block_Header)).data;
+	header->next = nullptr;
+	header->size = block_size;
+	return header + 1;
+}
+
+void
+scheduler_closure_deallocate(void *closure)
+{
+	Scheduler_Closure_Block_Header *header = (Scheduler_Closure_Block_Header *)closure - 1;
+	U64 size_class = header->size / SCHEDULER_CLOSURE_BLOCK_GRANULARITY - 1;
+
+	Scheduler_Worker *worker = scheduler_current_worker;
+	bool is_cached = worker != nullptr && header->size % SCHEDULER_CLOSURE_BLOCK_GRANULARITY == 0 && size_class < SCHEDULER_CLOSURE_BLOCK_CLASS_COUNT;
+	if (!is_cached || worker->free_closure_block_counts[size_class] == SCHEDULER_CLOSURE_BLOCK_CACHE_COUNT)
+	{
+		memory::deallocate(Memory_Block{header, header->size});
+		return;
+	}
+
+	header->next = worker->free_closure_blocks[size_class];
+	worker->free_closure_blocks[size_class] = header;
+	++worker->free_closure_block_counts[size_class];
+}
+
+constexpr U32 SCHEDULER_GRAPH_READY_TASK_BATCH_COUNT = 16;
+
+struct Scheduler_Graph_Edge
+{
+	U32 predecessor_node;
+	U32 successor_node;
+};
+
+struct Scheduler_Graph_Node
+{
+	Scheduler_Task task;
+	Scheduler_Graph *graph;
+	U32 predecessor_count;
+	U32 first_successor;
+	U32 successor_count;
+	Atomic<U32> remaining_predecessor_count;
+	U64 start_microseconds;
+	U64 end_microseconds;
+	U64 critical_path_microseconds;
+	U32 critical_path_predecessor;
+};
+
+/*
+	Nodes and edges are recorded as they are added. The first submit after a change compiles them into a
+	flat successor list, a topological order, and the list of root tasks, so later submits of the same
+	graph only reset one counter per node and never allocate.
+*/
+struct Scheduler_Graph
+{
+	Scheduler *scheduler;
+	Scheduler_Group *group;
+	Array<Scheduler_Graph_Node> nodes;
+	Array<Scheduler_Graph_Edge> edges;
+	Array<U32> successors;
+	Array<U32> topological_order;
+	Array<Scheduler_Task> root_tasks;
+	U64 submit_microseconds;
+	Scheduler_Priority priority;
+	bool is_compiled;
+	bool is_timing_enabled;
+};
+
+inline static void
+_scheduler_graph_validate_idle(Scheduler *self, Scheduler_Graph *graph)
+{
+	validate(graph->scheduler == self, "[SCHEDULER]: Task graph belongs to a different scheduler.");
+	validate(_scheduler_group_pending_task_count(graph->group) == 0, "[SCHEDULER]: Task graph is still running.");
+}
+
+inline static void
+_scheduler_graph_node_task(void *data)
+{
+	Scheduler_Graph_Node *node = (Scheduler_Graph_Node *)data;
+	Scheduler_Graph *graph = node->graph;
+	Scheduler_Task ready_tasks[SCHEDULER_GRAPH_READY_TASK_BATCH_COUNT];
+	bool is_timing_enabled = graph->is_timing_enabled;
+
+	// The first successor that becomes ready runs next on this worker as a continuation, the rest are queued.
+	while (node != nullptr)
+	{
+		if (is_timing_enabled)
+			node->start_microseconds = platform_query_microseconds();
+		node->task.function(node->task.data);
+		if (is_timing_enabled)
+			node->end_microseconds = platform_query_microseconds();
+
+		Scheduler_Graph_Node *continuation = nullptr;
+		U32 ready_task_count = 0;
+		for (U32 i = 0; i < node->successor_count; ++i)
+		{
+			Scheduler_Graph_Node *successor = &graph->nodes.data[graph->successors.data[node->first_successor + i]];
+			if (atomic_fetch_sub(successor->remaining_predecessor_count, (U32)1) != 1)
+				continue;
+
+			if (continuation == nullptr)
+			{
+				continuation = successor;
+				continue;
+			}
+
+			ready_tasks[ready_task_count++] = Scheduler_Task {
+				.function = _scheduler_graph_node_task,
+				.data = successor
+			};
+			if (ready_task_count == SCHEDULER_GRAPH_READY_TASK_BATCH_COUNT)
+			{
+				scheduler_submit(graph->scheduler, slice_from(ready_tasks, ready_task_count), graph->group, graph->priority);
+				ready_task_count = 0;
+			}
+		}
+
+		if (ready_task_count != 0)
+			scheduler_submit(graph->scheduler, slice_from(ready_tasks, ready_task_count), graph->group, graph->priority);
+		node = continuation;
+	}
+}
+
+inline static void
+_scheduler_graph_compile(Scheduler_Graph *graph)
+{
+	for (Scheduler_Graph_Node &node : graph->nodes)
+	{
+		node.predecessor_count = 0;
+		node.successor_count = 0;
+	}
+
+	for (const Scheduler_Graph_Edge &edge : graph->edges)
+	{
+		++graph->nodes[edge.predecessor_node].successor_count;
+		++graph->nodes[edge.successor_node].predecessor_count;
+	}
+
+	U32 first_successor = 0;
+	for (Scheduler_Graph_Node &node : graph->nodes)
+	{
+		node.first_successor = first_successor;
+		first_successor += node.successor_count;
+		node.successor_count = 0;
+	}
+
+	array_resize(graph->successors, graph->edges.count);
+	for (const Scheduler_Graph_Edge &edge : graph->edges)
+	{
+		Scheduler_Graph_Node &node = graph->nodes[edge.predecessor_node];
+		graph->successors[node.first_successor + node.successor_count] = edge.successor_node;
+		++node.successor_count;
+	}
+
+	// Kahn's algorithm, with the order array doubling as the queue of ready nodes.
+	array_clear(graph->topological_order);
+	array_clear(graph->root_tasks);
+	for (U32 i = 0; i < graph->nodes.count; ++i)
+	{
+		Scheduler_Graph_Node &node = graph->nodes[i];
+		node.remaining_predecessor_count = atomic_init(node.predecessor_count);
+		if (node.predecessor_count == 0)
+		{
+			array_push(graph->topological_order, i);
+			array_push(graph->root_tasks, Scheduler_Task {
+				.function = _scheduler_graph_node_task,
+				.data = &node
+			});
+		}
+	}
+
+	for (U64 i = 0; i < graph->topological_order.count; ++i)
+	{
+		const Scheduler_Graph_Node &node = graph->nodes[graph->topological_order[i]];
+		for (U32 j = 0; j < node.successor_count; ++j)
+		{
+			U32 successor_node = graph->successors[node.first_successor + j];
+			if (atomic_fetch_sub(graph->nodes[successor_node].remaining_predecessor_count, (U32)1, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED) == 1)
+				array_push(graph->topological_order, successor_node);
+		}
+	}
+	validate(graph->topological_order.count == graph->nodes.count, "[SCHEDULER]: Task graph contains a cycle.");
+
+	graph->is_compiled = true;
+}
+
+// Longest chain of measured task durations along the edges, returns the last node of that chain. Ties go to the
+// later node, so tasks that finish within the timer resolution still extend the chain.
+inline static U32
+_scheduler_graph_compute_critical_path(Scheduler_Graph *graph, Scheduler_Graph_Timing &timing)
+{
+	timing = Scheduler_Graph_Timing {};
+	if (graph->nodes.count == 0)
 		return U32_MAX;
 
-	return scheduler_current_worker->index;
+	if (!graph->is_compiled)
+		_scheduler_graph_compile(graph);
+
+	for (Scheduler_Graph_Node &node : graph->nodes)
+	{
+		node.critical_path_microseconds = 0;
+		node.critical_path_predecessor = U32_MAX;
+	}
+
+	U32 last_node = U32_MAX;
+	U64 end_microseconds = graph->submit_microseconds;
+	for (U32 index : graph->topological_order)
+	{
+		Scheduler_Graph_Node &node = graph->nodes[index];
+		U64 duration = node.end_microseconds - node.start_microseconds;
+		timing.work_microseconds += duration;
+		end_microseconds = u64_max(end_microseconds, node.end_microseconds);
+
+		node.critical_path_microseconds += duration;
+		if (node.critical_path_microseconds >= timing.critical_path_microseconds)
+		{
+			timing.critical_path_microseconds = node.critical_path_microseconds;
+			last_node = index;
+		}
+
+		for (U32 i = 0; i < node.successor_count; ++i)
+		{
+			U32 successor_node = graph->successors[node.first_successor + i];
+			Scheduler_Graph_Node &successor = graph->nodes[successor_node];
+			if (successor.critical_path_predecessor == U32_MAX || node.critical_path_microseconds > successor.critical_path_microseconds)
+			{
+				successor.critical_path_microseconds = node.critical_path_microseconds;
+				successor.critical_path_predecessor = index;
+			}
+		}
+	}
+
+	timing.elapsed_microseconds = end_microseconds - graph->submit_microseconds;
+	for (U32 index = last_node; index != U32_MAX; index = graph->nodes[index].critical_path_predecessor)
+		++timing.critical_path_node_count;
+	return last_node;
 }
 
-Scheduler_Stats
-scheduler_get_stats(Scheduler *self)
+Scheduler_Graph *
+scheduler_graph_init(Scheduler *self, bool is_timing_enabled)
 {
-	platform_mutex_lock(self->mutex);
-	Scheduler_Stats stats = {
-		.worker_count = self->worker_count,
-		.replacement_worker_count = (U32)self->workers.count - self->worker_count,
-		.active_replacement_worker_count = self->active_replacement_worker_count,
-		.blocked_worker_count = self->blocked_worker_count,
-		.active_task_count = self->active_task_count,
-		.queued_task_count = self->queued_task_count,
-		.live_group_count = self->live_group_count
-	};
-	platform_mutex_unlock(self->mutex);
-	return stats;
+	Scheduler_Graph *graph = memory::allocate_zeroed<Scheduler_Graph>();
+	graph->scheduler = self;
+	graph->group = scheduler_group_init(self);
+	graph->nodes = array_init<Scheduler_Graph_Node>();
+	graph->edges = array_init<Scheduler_Graph_Edge>();
+	graph->successors = array_init<U32>();
+	graph->topological_order = array_init<U32>();
+	graph->root_tasks = array_init<Scheduler_Task>();
+	graph->is_timing_enabled = is_timing_enabled;
+	return graph;
 }
 
 void
-scheduler_parallel_for(Scheduler *self, Scheduler_Parallel_For_Desc desc)
+scheduler_graph_deinit(Scheduler *self, Scheduler_Graph *graph)
+{
+	_scheduler_graph_validate_idle(self, graph);
+
+	array_deinit(graph->root_tasks);
+	array_deinit(graph->topological_order);
+	array_deinit(graph->successors);
+	array_deinit(graph->edges);
+	array_deinit(graph->nodes);
+	scheduler_group_deinit(self, graph->group);
+	memory::deallocate(graph);
+}
+
+U32
+scheduler_graph_add_task(Scheduler *self, Scheduler_Graph *graph, Scheduler_Task task)
+{
+	_scheduler_graph_validate_idle(self, graph);
+
+	array_push(graph->nodes, Scheduler_Graph_Node {
+		.task = task,
+		.graph = graph
+	});
+	graph->is_compiled = false;
+	return (U32)graph->nodes.count - 1;
+}
+
+void
+scheduler_graph_add_edge(Scheduler *self, Scheduler_Graph *graph, U32 predecessor_node, U32 successor_node)
+{
+	_scheduler_graph_validate_idle(self, graph);
+	validate(predecessor_node < graph->nodes.count && successor_node < graph->nodes.count, "[SCHEDULER]: Task graph edge references an unknown node.");
+	validate(predecessor_node != successor_node, "[SCHEDULER]: Task graph node cannot depend on itself.");
+
+	array_push(graph->edges, Scheduler_Graph_Edge {
+		.predecessor_node = predecessor_node,
+		.successor_node = successor_node
+	});
+	graph->is_compiled = false;
+}
+
+void
+scheduler_graph_clear(Scheduler *self, Scheduler_Graph *graph)
+{
+	_scheduler_graph_validate_idle(self, graph);
+
+	array_clear(graph->nodes);
+	array_clear(graph->edges);
+	array_clear(graph->successors);
+	array_clear(graph->topological_order);
+	array_clear(graph->root_tasks);
+	graph->is_compiled = false;
+}
+
+void
+scheduler_graph_submit(Scheduler *self, Scheduler_Graph *graph, Scheduler_Priority priority)
+{
+	_scheduler_graph_validate_idle(self, graph);
+
+	if (!graph->is_compiled)
+		_scheduler_graph_compile(graph);
+
+	// Relaxed is enough, the submit below publishes the counters together with the root tasks.
+	for (Scheduler_Graph_Node &node : graph->nodes)
+	{
+		atomic_store(node.remaining_predecessor_count, node.predecessor_count, COMPILER_ATOMIC_MEMORY_ORDER_RELAXED);
+		node.start_microseconds = 0;
+		node.end_microseconds = 0;
+	}
+
+	graph->submit_microseconds = platform_query_microseconds();
+	graph->priority = priority;
+	scheduler_submit(self, slice_from(graph->root_tasks), graph->group, priority);
+}
+
+void
+scheduler_graph_wait(Scheduler *self, Scheduler_Graph *graph)
+{
+	validate(graph->scheduler == self, "[SCHEDULER]: Task graph belongs to a different scheduler.");
+	scheduler_wait_group(self, graph->group);
+}
+
+Scheduler_Graph_Timing
+scheduler_graph_get_timing(Scheduler *self, Scheduler_Graph *graph)
+{
+	_scheduler_graph_validate_idle(self, graph);
+	validate(graph->is_timing_enabled, "[SCHEDULER]: Task graph was created without timing.");
+
+	Scheduler_Graph_Timing timing = {};
+	_scheduler_graph_compute_critical_path(graph, timing);
+	return timing;
+}
+
+U32
+scheduler_graph_get_critical_path(Scheduler *self, Scheduler_Graph *graph, Slice<U32> nodes)
+{
+	_scheduler_graph_validate_idle(self, graph);
+	validate(graph->is_timing_enabled, "[SCHEDULER]: Task graph was created without timing.");
+
+	Scheduler_Graph_Timing timing = {};
+	U32 last_node = _scheduler_graph_compute_critical_path(graph, timing);
+
+	// Walked backwards from the last node, written front to back.
+	U32 position = timing.critical_path_node_count;
+	for (U32 index = last_node; index != U32_MAX; index = graph->nodes[index].critical_path_predecessor)
+	{
+		--position;
+		if (position < nodes.count)
+			nodes[position] = index;
+	}
+	return timing.critical_path_node_count;
+}
+
+/*
+	Every token is carried through the stages by one task at a time. Parallel stages run right away. A serial
+	stage runs a token only when its index is the next one for that stage, otherwise the token is parked in the
+	stage's waiting slots and its task returns. The task that finishes a serial stage queues the parked token
+	with the next index, so serial stages never block a worker.
+
+	A token cannot pass a serial stage before the tokens in front of it, so the in-flight tokens parked at a
+	stage are the ones right behind its next index, and their indices are unique modulo the token count.
+*/
+struct Scheduler_Pipeline_Slot
+{
+	Scheduler_Pipeline_Token token;
+	Scheduler_Pipeline *pipeline;
+	Scheduler_Pipeline_Slot *next_free;
+	U32 stage_index;
+	bool is_dropped;
+};
+
+struct Scheduler_Pipeline_Stage_State
+{
+	Scheduler_Pipeline_Stage stage;
+	U64 next_token_index;
+	Array<Scheduler_Pipeline_Slot *> waiting_slots;
+};
+
+// The mutex guards the free slots, the source and the serial stage turns, stage functions run outside of it.
+// Only the task holding the source touches the next token index and allocates buffers.
+struct Scheduler_Pipeline
+{
+	Scheduler *scheduler;
+	Scheduler_Group *group;
+	Platform_Mutex *mutex;
+	Array<Scheduler_Pipeline_Stage_State> stages;
+	Array<Scheduler_Pipeline_Slot> slots;
+	Scheduler_Pipeline_Slot *free_slots;
+	U64 buffer_size;
+	U32 buffer_count;
+	U32 in_flight_token_count;
+	U32 max_in_flight_token_count;
+	U64 next_token_index;
+	U64 dropped_token_count;
+	Scheduler_Priority priority;
+	bool is_source_busy;
+	bool is_ended;
+};
+
+inline static void
+_scheduler_pipeline_validate_idle(Scheduler *self, Scheduler_Pipeline *pipeline)
+{
+	validate(pipeline->scheduler == self, "[SCHEDULER]: Pipeline belongs to a different scheduler.");
+	validate(_scheduler_group_pending_task_count(pipeline->group) == 0, "[SCHEDULER]: Pipeline is still running.");
+}
+
+inline static void
+_scheduler_pipeline_slot_task(void *data);
+
+// Hands a free slot to the source, unless the source is already running, the stream ended, or every token is in flight.
+inline static void
+_scheduler_pipeline_try_start_token(Scheduler_Pipeline *pipeline)
+{
+	Scheduler_Pipeline_Slot *slot = nullptr;
+	platform_mutex_lock(pipeline->mutex);
+	if (!pipeline->is_source_busy && !pipeline->is_ended && pipeline->free_slots != nullptr)
+	{
+		slot = pipeline->free_slots;
+		pipeline->free_slots = slot->next_free;
+		pipeline->is_source_busy = true;
+		++pipeline->in_flight_token_count;
+		pipeline->max_in_flight_token_count = u32_max(pipeline->max_in_flight_token_count, pipeline->in_flight_token_count);
+	}
+	platform_mutex_unlock(pipeline->mutex);
+
+	if (slot == nullptr)
+		return;
+
+	slot->stage_index = 0;
+	scheduler_submit(pipeline->scheduler, Scheduler_Task{.function = _scheduler_pipeline_slot_task, .data = slot}, pipeline->group, pipeline->priority);
+}
+
+inline static void
+_scheduler_pipeline_release_slot(Scheduler_Pipeline *pipeline, Scheduler_Pipeline_Slot *slot)
+{
+	platform_mutex_lock(pipeline->mutex);
+	slot->next_free = pipeline->free_slots;
+	pipeline->free_slots = slot;
+	--pipeline->in_flight_token_count;
+	if (slot->is_dropped)
+		++pipeline->dropped_token_count;
+	platform_mutex_unlock(pipeline->mutex);
+
+	_scheduler_pipeline_try_start_token(pipeline);
+}
+
+// Fills the slot with the next token. The source is released before the token moves on, so the next token is
+// read while this one goes through the later stages.
+inline static bool
+_scheduler_pipeline_run_source(Scheduler_Pipeline *pipeline, Scheduler_Pipeline_Slot *slot)
+{
+	Scheduler_Pipeline_Token &token = slot->token;
+	if (token.buffer == nullptr && pipeline->buffer_size != 0)
+	{
+		token.buffer = memory::allocate(pipeline->buffer_size, CACHE_LINE_SIZE).data;
+		token.buffer_size = pipeline->buffer_size;
+		++pipeline->buffer_count;
+	}
+	token.index = pipeline->next_token_index;
+	token.size = 0;
+	token.data = nullptr;
+	slot->is_dropped = false;
+
+	const Scheduler_Pipeline_Stage &source = pipeline->stages[0].stage;
+	bool has_token = source.function(&token, source.data);
+
+	platform_mutex_lock(pipeline->mutex);
+	pipeline->is_source_busy = false;
+	if (has_token)
+	{
+		++pipeline->next_token_index;
+	}
+	else
+	{
+		pipeline->is_ended = true;
+		slot->next_free = pipeline->free_slots;
+		pipeline->free_slots = slot;
+		--pipeline->in_flight_token_count;
+	}
+	platform_mutex_unlock(pipeline->mutex);
+
+	if (!has_token)
+		return false;
+
+	_scheduler_pipeline_try_start_token(pipeline);
+	slot->stage_index = 1;
+	return true;
+}
+
+inline static void
+_scheduler_pipeline_slot_task(void *data)
 {
-	if (desc.count == 0)
+	Scheduler_Pipeline_Slot *slot = (Scheduler_Pipeline_Slot *)data;
+	Scheduler_Pipeline *pipeline = slot->pipeline;
+	if (slot->stage_index == 0 && !_scheduler_pipeline_run_source(pipeline, slot))
 		return;
 
-	struct Scheduler_Parallel_For_Task_Context
+	U32 max_token_count = (U32)pipeline->slots.count;
+	for (U32 i = slot->stage_index; i < pipeline->stages.count; ++i)
 	{
-		void (*function)(U32 begin, U32 end, void *data);
-		void *data;
-		U32 begin;
-		U32 end;
-	};
+		Scheduler_Pipeline_Stage_State &state = pipeline->stages[i];
+		if (state.stage.mode == SCHEDULER_PIPELINE_STAGE_MODE_PARALLEL)
+		{
+			if (!slot->is_dropped)
+				slot->is_dropped = !state.stage.function(&slot->token, state.stage.data);
+			continue;
+		}
 
-	constexpr auto task_function = [](void *data) {
-		Scheduler_Parallel_For_Task_Context *context = (Scheduler_Parallel_For_Task_Context *)data;
-		context->function(context->begin, context->end, context->data);
-	};
+		platform_mutex_lock(pipeline->mutex);
+		if (state.next_token_index != slot->token.index)
+		{
+			slot->stage_index = i;
+			state.waiting_slots[slot->token.index % max_token_count] = slot;
+			platform_mutex_unlock(pipeline->mutex);
+			return;
+		}
+		platform_mutex_unlock(pipeline->mutex);
 
-	constexpr auto auto_chunk_size = [](Scheduler *self, U32 count) -> U32 {
-		U64 target_chunk_count = self->worker_count * 4;
-		if (target_chunk_count > count)
-			target_chunk_count = count;
-		return (U32)(((U64)count + target_chunk_count - 1) / target_chunk_count);
-	};
+		// Dropped tokens still take their turn, so the tokens behind them are not held up.
+		if (!slot->is_dropped)
+			slot->is_dropped = !state.stage.function(&slot->token, state.stage.data);
 
-	if (desc.chunk_size == 0)
-		desc.chunk_size = auto_chunk_size(self, desc.count);
+		platform_mutex_lock(pipeline->mutex);
+		++state.next_token_index;
+		Scheduler_Pipeline_Slot *&waiting_slot = state.waiting_slots[state.next_token_index % max_token_count];
+		Scheduler_Pipeline_Slot *next_slot = waiting_slot;
+		waiting_slot = nullptr;
+		platform_mutex_unlock(pipeline->mutex);
 
-	memory::Arena_Allocator_Mark temp_allocator_mark = memory::temp_allocator_mark();
-	DEFER(memory::temp_allocator_reset_to_mark(temp_allocator_mark));
+		if (next_slot != nullptr)
+			scheduler_submit(pipeline->scheduler, Scheduler_Task{.function = _scheduler_pipeline_slot_task, .data = next_slot}, pipeline->group, pipeline->priority);
+	}
+
+	_scheduler_pipeline_release_slot(pipeline, slot);
+}
 
-	U32 chunk_count = (U32)(((U64)desc.count + desc.chunk_size - 1) / desc.chunk_size);
-	Array<Scheduler_Parallel_For_Task_Context> contexts = array_init_with_count<Scheduler_Parallel_For_Task_Context>(chunk_count, memory::temp_allocator());
-	Array<Scheduler_Task> tasks = array_init_with_count<Scheduler_Task>(chunk_count, memory::temp_allocator());
+Scheduler_Pipeline *
+scheduler_pipeline_init(Scheduler *self, Scheduler_Pipeline_Desc desc)
+{
+	U32 max_token_count = desc.max_token_count != 0 ? desc.max_token_count : 2 * (U32)self->workers.count;
 
-	for (U32 i = 0; i < chunk_count; ++i)
+	Scheduler_Pipeline *pipeline = memory::allocate_zeroed<Scheduler_Pipeline>();
+	pipeline->scheduler = self;
+	pipeline->group = scheduler_group_init(self);
+	pipeline->mutex = platform_mutex_init();
+	pipeline->stages = array_init<Scheduler_Pipeline_Stage_State>();
+	pipeline->slots = array_init_with_count<Scheduler_Pipeline_Slot>(max_token_count);
+	pipeline->buffer_size = desc.buffer_size;
+	for (Scheduler_Pipeline_Slot &slot : pipeline->slots)
 	{
-		U32 begin = i * desc.chunk_size;
-		U32 remaining_count = desc.count - begin;
-		U32 range_count = u32_min(remaining_count, desc.chunk_size);
-		contexts[i] = Scheduler_Parallel_For_Task_Context {
-			.function = desc.function,
-			.data = desc.data,
-			.begin = begin,
-			.end = begin + range_count
-		};
-		tasks[i] = Scheduler_Task {
-			.function = task_function,
-			.data = &contexts[i]
+		slot = Scheduler_Pipeline_Slot {
+			.pipeline = pipeline,
+			.next_free = pipeline->free_slots
 		};
+		pipeline->free_slots = &slot;
 	}
+	return pipeline;
+}
 
-	Scheduler_Group *group = scheduler_group_init(self);
-	DEFER(scheduler_group_deinit(self, group));
-	scheduler_submit(self, slice_from(tasks), group);
-	scheduler_wait_group(self, group);
+void
+scheduler_pipeline_deinit(Scheduler *self, Scheduler_Pipeline *pipeline)
+{
+	_scheduler_pipeline_validate_idle(self, pipeline);
+
+	for (Scheduler_Pipeline_Slot &slot : pipeline->slots)
+		if (slot.token.buffer != nullptr)
+			memory::deallocate(Memory_Block{slot.token.buffer, slot.token.buffer_size});
+	for (Scheduler_Pipeline_Stage_State &state : pipeline->stages)
+		array_deinit(state.waiting_slots);
+	array_deinit(pipeline->slots);
+	array_deinit(pipeline->stages);
+	platform_mutex_deinit(pipeline->mutex);
+	scheduler_group_deinit(self, pipeline->group);
+	memory::deallocate(pipeline);
+}
+
+void
+scheduler_pipeline_add_stage(Scheduler *self, Scheduler_Pipeline *pipeline, Scheduler_Pipeline_Stage stage)
+{
+	_scheduler_pipeline_validate_idle(self, pipeline);
+	validate(stage.function != nullptr, "[SCHEDULER]: Pipeline stage has no function.");
+	validate(pipeline->stages.count != 0 || stage.mode == SCHEDULER_PIPELINE_STAGE_MODE_SERIAL, "[SCHEDULER]: Pipeline source stage must be serial.");
+
+	Array<Scheduler_Pipeline_Slot *> waiting_slots = array_init<Scheduler_Pipeline_Slot *>();
+	if (stage.mode == SCHEDULER_PIPELINE_STAGE_MODE_SERIAL)
+	{
+		array_resize(waiting_slots, pipeline->slots.count);
+		array_fill(waiting_slots, nullptr);
+	}
+	array_push(pipeline->stages, Scheduler_Pipeline_Stage_State {
+		.stage = stage,
+		.waiting_slots = waiting_slots
+	});
+}
+
+void
+scheduler_pipeline_submit(Scheduler *self, Scheduler_Pipeline *pipeline, Scheduler_Priority priority)
+{
+	_scheduler_pipeline_validate_idle(self, pipeline);
+	validate(pipeline->stages.count != 0, "[SCHEDULER]: Pipeline has no stages.");
+
+	for (Scheduler_Pipeline_Stage_State &state : pipeline->stages)
+		state.next_token_index = 0;
+	pipeline->next_token_index = 0;
+	pipeline->dropped_token_count = 0;
+	pipeline->max_in_flight_token_count = 0;
+	pipeline->priority = priority;
+	pipeline->is_ended = false;
+	_scheduler_pipeline_try_start_token(pipeline);
+}
+
+void
+scheduler_pipeline_wait(Scheduler *self, Scheduler_Pipeline *pipeline)
+{
+	validate(pipeline->scheduler == self, "[SCHEDULER]: Pipeline belongs to a different scheduler.");
+	scheduler_wait_group(self, pipeline->group);
+}
+
+Scheduler_Pipeline_Stats
+scheduler_pipeline_get_stats(Scheduler *self, Scheduler_Pipeline *pipeline)
+{
+	_scheduler_pipeline_validate_idle(self, pipeline);
+	return Scheduler_Pipeline_Stats {
+		.token_count = pipeline->next_token_index,
+		.dropped_token_count = pipeline->dropped_token_count,
+		.max_in_flight_token_count = pipeline->max_in_flight_token_count,
+		.buffer_count = pipeline->buffer_count,
+		.buffer_bytes = pipeline->buffer_count * pipeline->buffer_size
+	};
 }
\ No newline at end of file
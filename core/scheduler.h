@@ -2,23 +2,70 @@
 
 #include "core/export.h"
 #include "core/defines.h"
+#include "core/result.h"
+#include "core/validate.h"
+#include "core/math/u64.h"
+#include "core/memory/allocator.h"
 #include "core/containers/slice.h"
+#include "core/containers/handle_pool.h"
 
 /*
 TODO:
-- [ ] Keep heavier scheduler ideas parked until there is clear demand: priorities, fibers/sysmon, cancellation, dependency graph.
+- [ ] Keep heavier scheduler ideas parked until there is clear demand: sysmon.
 */
 
+// Workers drain high before normal before background. Normal is the zero value so it is the default in descs.
+enum Scheduler_Priority
+{
+	SCHEDULER_PRIORITY_NORMAL,
+	SCHEDULER_PRIORITY_HIGH,
+	SCHEDULER_PRIORITY_BACKGROUND,
+	SCHEDULER_PRIORITY_COUNT
+};
+
+enum Scheduler_Group_Status
+{
+	SCHEDULER_GROUP_STATUS_COMPLETED,
+	SCHEDULER_GROUP_STATUS_CANCELLED
+};
+
+/*
+	Pinned workers are bound to one logical processor each. `worker_processors` lists the processors in worker
+	order, wrapping around when there are more workers than entries, and replacement workers continue after the
+	regular ones. When it is empty, workers take one processor per physical core before any SMT sibling.
+	Pinning is best effort on platforms without affinity support, but stealing still prefers the nearest workers.
+
+	A non-zero `trace_event_capacity` turns on tracing: every worker records up to that many events into its own
+	buffer, and later events only update the summary counters in `Scheduler_Stats`.
+
+	A `max_worker_count` above `worker_count` makes the pool elastic between the two. The extra workers start
+	parked and inactive, one more is activated whenever more than `scale_up_queue_depth` tasks are queued per
+	active worker, or no queued task was taken for `scale_up_latency_microseconds`. An extra worker that stays
+	parked for `idle_timeout_milliseconds` is retired again, newest first. Zero thresholds take the defaults.
+*/
 struct Scheduler_Desc
 {
 	U32 worker_count;
 	U32 replacement_worker_count;
+	U32 max_worker_count;
+	U32 scale_up_queue_depth;
+	U32 scale_up_latency_microseconds;
+	U32 idle_timeout_milliseconds;
 	U32 initial_task_queue_capacity;
 	const char *worker_thread_name;
+	bool is_pinned;
+	Slice<const U32> worker_processors;
+	U32 trace_event_capacity;
 };
 
 struct Scheduler;
 struct Scheduler_Group;
+struct Scheduler_Graph;
+struct Scheduler_Pipeline;
+struct Scheduler_Timer;
+
+// Names a delayed or periodic task until it fires for the last time, after that it is stale and cancelling it fails.
+using Scheduler_Timer_Handle = Handle<Scheduler_Timer>;
 
 struct Scheduler_Task
 {
@@ -26,23 +73,163 @@ struct Scheduler_Task
 	void *data;
 };
 
+constexpr U64 SCHEDULER_CLOSURE_INLINE_SIZE = 48;
+
+// A task that carries its own state, copied by value into the queue entry. `invoke` receives the storage of
+// the copy being run. State that does not fit is kept in a closure block and `storage` holds a pointer to it.
+// A task dropped by a cancelled group is still invoked, with `is_cancelled` set, so it can release its state without running.
+struct Scheduler_Closure
+{
+	void (*invoke)(void *storage, bool is_cancelled);
+	alignas(8) U8 storage[SCHEDULER_CLOSURE_INLINE_SIZE];
+};
+
+// `chunk_size` is the grain: ranges are split lazily while workers are idle, but never below it.
+// Cancelling `cancellation_group` stops the grains that have not started yet. When it is null, a parallel for
+// called from a task follows the group of that task instead.
 struct Scheduler_Parallel_For_Desc
 {
 	U32 count;
 	U32 chunk_size;
 	void (*function)(U32 begin, U32 end, void *data);
 	void *data;
+	Scheduler_Priority priority;
+	Scheduler_Group *cancellation_group;
+};
+
+// Half-open box of cells, z spans [0, 1) for 2D tiles.
+struct Scheduler_Tile
+{
+	U32 begin_x;
+	U32 end_x;
+	U32 begin_y;
+	U32 end_y;
+	U32 begin_z;
+	U32 end_z;
+};
+
+struct Scheduler_Parallel_For_2D_Desc
+{
+	U32 count_x;
+	U32 count_y;
+	U32 tile_size_x;
+	U32 tile_size_y;
+	void (*function)(Scheduler_Tile tile, void *data);
+	void *data;
+	Scheduler_Priority priority;
+	Scheduler_Group *cancellation_group;
+};
+
+struct Scheduler_Parallel_For_3D_Desc
+{
+	U32 count_x;
+	U32 count_y;
+	U32 count_z;
+	U32 tile_size_x;
+	U32 tile_size_y;
+	U32 tile_size_z;
+	void (*function)(Scheduler_Tile tile, void *data);
+	void *data;
+	Scheduler_Priority priority;
+	Scheduler_Group *cancellation_group;
 };
 
 struct Scheduler_Stats
 {
 	U32 worker_count;
+	U32 active_worker_count;
 	U32 replacement_worker_count;
 	U32 active_replacement_worker_count;
 	U32 blocked_worker_count;
 	U32 active_task_count;
 	U32 queued_task_count;
+	U32 queued_task_counts[SCHEDULER_PRIORITY_COUNT];
 	U32 live_group_count;
+	U32 pending_timer_count;
+	U32 periodic_timer_count;
+	U32 live_coroutine_frame_count;
+
+	// Jitter is how late a timer fired after its deadline, the wheel ticks once per millisecond.
+	U64 fired_timer_count;
+	U64 timer_jitter_microseconds_total;
+	U64 timer_jitter_microseconds_max;
+
+	// Tasks of cancelled groups that were dropped from the queues without running.
+	U64 cancelled_task_count;
+
+	// Elastic pools only, how often a worker was activated for each threshold and retired after its idle timeout.
+	U64 scale_up_queue_depth_count;
+	U64 scale_up_latency_count;
+	U64 scale_down_count;
+
+	// Summed over all workers, they stay zero unless tracing is enabled.
+	U64 trace_task_count;
+	U64 trace_task_microseconds;
+	U64 trace_steal_count;
+	U64 trace_park_count;
+	U64 trace_park_microseconds;
+	U64 trace_unpark_count;
+	U64 trace_block_microseconds;
+	U64 trace_group_wait_microseconds;
+	U64 trace_dropped_event_count;
+};
+
+// Resumes a suspended coroutine or any other continuation once its group has no pending tasks, see `scheduler_group_add_waiter`.
+struct Scheduler_Group_Waiter
+{
+	Scheduler_Task task;
+	Scheduler_Priority priority;
+	Scheduler_Group_Waiter *next;
+};
+
+struct Scheduler_Graph_Timing
+{
+	U64 elapsed_microseconds;
+	U64 work_microseconds;
+	U64 critical_path_microseconds;
+	U32 critical_path_node_count;
+};
+
+enum Scheduler_Pipeline_Stage_Mode
+{
+	SCHEDULER_PIPELINE_STAGE_MODE_PARALLEL,
+	SCHEDULER_PIPELINE_STAGE_MODE_SERIAL
+};
+
+// One chunk of the stream. The buffer comes from the pipeline's pool and is handed to the next token once this one
+// leaves the last stage, `size` and `data` are left to the stages.
+struct Scheduler_Pipeline_Token
+{
+	U64 index;
+	void *buffer;
+	U64 buffer_size;
+	U64 size;
+	void *data;
+};
+
+// The first stage is the source, it fills the token and returns false once the stream has ended. A later stage
+// that returns false drops the token, the stages after it skip the token but serial ones still keep their order.
+struct Scheduler_Pipeline_Stage
+{
+	Scheduler_Pipeline_Stage_Mode mode;
+	bool (*function)(Scheduler_Pipeline_Token *token, void *data);
+	void *data;
+};
+
+// At most `max_token_count` tokens are in flight, 0 takes two per worker. `buffer_size` of 0 runs without buffers.
+struct Scheduler_Pipeline_Desc
+{
+	U32 max_token_count;
+	U64 buffer_size;
+};
+
+struct Scheduler_Pipeline_Stats
+{
+	U64 token_count;
+	U64 dropped_token_count;
+	U32 max_in_flight_token_count;
+	U32 buffer_count;
+	U64 buffer_bytes;
 };
 
 CORE_API Scheduler *
@@ -58,11 +245,49 @@ CORE_API void
 scheduler_group_deinit(Scheduler *self, Scheduler_Group *group);
 
 CORE_API void
-scheduler_submit(Scheduler *self, Slice<const Scheduler_Task> tasks, Scheduler_Group *group = nullptr);
+scheduler_submit(Scheduler *self, Slice<const Scheduler_Task> tasks, Scheduler_Group *group = nullptr, Scheduler_Priority priority = SCHEDULER_PRIORITY_NORMAL);
 
 CORE_API void
+scheduler_submit(Scheduler *self, const Scheduler_Closure &closure, Scheduler_Group *group = nullptr, Scheduler_Priority priority = SCHEDULER_PRIORITY_NORMAL);
+
+CORE_API Scheduler_Timer_Handle
+scheduler_submit_after(Scheduler *self, U32 delay_milliseconds, Scheduler_Task task, Scheduler_Group *group = nullptr, Scheduler_Priority priority = SCHEDULER_PRIORITY_NORMAL);
+
+// Queues the task once per period until it is cancelled or the scheduler shuts down. Each run counts against
+// the group while it is queued or running, the timer itself does not, so waiting for the group does not wait forever.
+CORE_API Scheduler_Timer_Handle
+scheduler_submit_every(Scheduler *self, U32 period_milliseconds, Scheduler_Task task, Scheduler_Group *group = nullptr, Scheduler_Priority priority = SCHEDULER_PRIORITY_NORMAL);
+
+// Returns false if the timer already fired for the last time or was cancelled. A run that was already queued still executes.
+CORE_API bool
+scheduler_timer_cancel(Scheduler *self, Scheduler_Timer_Handle timer);
+
+// Returns once no task of the group is queued or running. Tasks of a cancelled group are dropped when they
+// are dequeued, so the wait only lasts as long as the tasks that already run.
+CORE_API Scheduler_Group_Status
 scheduler_wait_group(Scheduler *self, Scheduler_Group *group);
 
+// Cancellation is sticky for the lifetime of the group. Tasks that already run keep running and may poll
+// `scheduler_group_is_cancelled` to stop early, delayed tasks that have not fired yet and periodic timers of the
+// group are dropped right away.
+CORE_API void
+scheduler_group_cancel(Scheduler *self, Scheduler_Group *group);
+
+CORE_API bool
+scheduler_group_is_cancelled(Scheduler *self, Scheduler_Group *group);
+
+// Returns false without registering the waiter if the group has no pending tasks, otherwise the waiter task is
+// submitted once the group drains. The waiter must stay alive until its task runs.
+CORE_API bool
+scheduler_group_add_waiter(Scheduler *self, Scheduler_Group *group, Scheduler_Group_Waiter *waiter);
+
+// Counts work that is not a queued task against the group, such as a suspended coroutine, until it is completed.
+CORE_API void
+scheduler_group_add_pending(Scheduler *self, Scheduler_Group *group);
+
+CORE_API void
+scheduler_group_complete_pending(Scheduler *self, Scheduler_Group *group);
+
 CORE_API void
 scheduler_wait_all(Scheduler *self);
 
@@ -75,8 +300,421 @@ scheduler_worker_block_clear(Scheduler *self);
 CORE_API U32
 scheduler_get_current_worker_index(Scheduler *self);
 
+// Returns U32_MAX if the scheduler is not pinned.
+CORE_API U32
+scheduler_get_worker_processor(Scheduler *self, U32 worker_index);
+
 CORE_API Scheduler_Stats
 scheduler_get_stats(Scheduler *self);
 
+// Chrome trace event JSON, loadable in Perfetto and chrome://tracing. Safe to call while workers are recording.
+CORE_API String
+scheduler_trace_to_json(Scheduler *self, memory::Allocator *allocator = memory::heap_allocator());
+
+CORE_API Error
+scheduler_trace_to_file(Scheduler *self, const char *filepath);
+
+CORE_API void
+scheduler_parallel_for(Scheduler *self, Scheduler_Parallel_For_Desc desc);
+
+CORE_API void
+scheduler_parallel_for_2d(Scheduler *self, Scheduler_Parallel_For_2D_Desc desc);
+
+CORE_API void
+scheduler_parallel_for_3d(Scheduler *self, Scheduler_Parallel_For_3D_Desc desc);
+
+// Coroutine frames are recycled through per size class free lists owned by the scheduler, frames that are too
+// large, or allocated without a scheduler, go to the heap.
+CORE_API void *
+scheduler_coroutine_frame_allocate(Scheduler *self, U64 size);
+
 CORE_API void
-scheduler_parallel_for(Scheduler *self, Scheduler_Parallel_For_Desc desc);
\ No newline at end of file
+scheduler_coroutine_frame_deallocate(void *frame);
+
+// Closure blocks come from the calling worker's free lists and go back to the free lists of the worker that
+// releases them. Blocks allocated outside a worker, or too large to be cached, go to the heap.
+CORE_API void *
+scheduler_closure_allocate(Scheduler *self, U64 size);
+
+CORE_API void
+scheduler_closure_deallocate(void *closure);
+
+CORE_API Scheduler_Graph *
+scheduler_graph_init(Scheduler *self, bool is_timing_enabled = false);
+
+CORE_API void
+scheduler_graph_deinit(Scheduler *self, Scheduler_Graph *graph);
+
+CORE_API U32
+scheduler_graph_add_task(Scheduler *self, Scheduler_Graph *graph, Scheduler_Task task);
+
+CORE_API void
+scheduler_graph_add_edge(Scheduler *self, Scheduler_Graph *graph, U32 predecessor_node, U32 successor_node);
+
+CORE_API void
+scheduler_graph_clear(Scheduler *self, Scheduler_Graph *graph);
+
+CORE_API void
+scheduler_graph_submit(Scheduler *self, Scheduler_Graph *graph, Scheduler_Priority priority = SCHEDULER_PRIORITY_NORMAL);
+
+CORE_API void
+scheduler_graph_wait(Scheduler *self, Scheduler_Graph *graph);
+
+CORE_API Scheduler_Graph_Timing
+scheduler_graph_get_timing(Scheduler *self, Scheduler_Graph *graph);
+
+CORE_API U32
+scheduler_graph_get_critical_path(Scheduler *self, Scheduler_Graph *graph, Slice<U32> nodes);
+
+CORE_API Scheduler_Pipeline *
+scheduler_pipeline_init(Scheduler *self, Scheduler_Pipeline_Desc desc = {});
+
+CORE_API void
+scheduler_pipeline_deinit(Scheduler *self, Scheduler_Pipeline *pipeline);
+
+CORE_API void
+scheduler_pipeline_add_stage(Scheduler *self, Scheduler_Pipeline *pipeline, Scheduler_Pipeline_Stage stage);
+
+CORE_API void
+scheduler_pipeline_submit(Scheduler *self, Scheduler_Pipeline *pipeline, Scheduler_Priority priority = SCHEDULER_PRIORITY_NORMAL);
+
+CORE_API void
+scheduler_pipeline_wait(Scheduler *self, Scheduler_Pipeline *pipeline);
+
+// Counts of the last run, and the buffers the pool holds so far.
+CORE_API Scheduler_Pipeline_Stats
+scheduler_pipeline_get_stats(Scheduler *self, Scheduler_Pipeline *pipeline);
+
+/*
+	Submits a callable as a task without any allocation when it is trivially copyable and fits in
+	`SCHEDULER_CLOSURE_INLINE_SIZE` bytes. Anything else is moved into a closure block and destroyed after it runs,
+	or when its group is cancelled before it could run.
+
+	Example:
+	```
+	scheduler_submit_fn(scheduler, [mesh, lod]() {
+		mesh_build_lod(mesh, lod);
+	}, group);
+	```
+*/
+template <typename TFunction>
+inline static void
+scheduler_submit_fn(Scheduler *self, TFunction &&function, Scheduler_Group *group = nullptr, Scheduler_Priority priority = SCHEDULER_PRIORITY_NORMAL)
+{
+	using Function = std::remove_cvref_t<TFunction>;
+	static_assert(alignof(Function) <= 16, "[SCHEDULER]: Closure alignment must not exceed 16 bytes.");
+
+	Scheduler_Closure closure = {};
+	if constexpr (sizeof(Function) <= SCHEDULER_CLOSURE_INLINE_SIZE && alignof(Function) <= alignof(Scheduler_Closure) && std::is_trivially_copyable_v<Function>)
+	{
+		::new (closure.storage) Function(std::forward<TFunction>(function));
+		closure.invoke = [](void *storage, bool is_cancelled) {
+			if (!is_cancelled)
+				(*(Function *)storage)();
+		};
+	}
+	else
+	{
+		Function *block = ::new (scheduler_closure_allocate(self, sizeof(Function))) Function(std::forward<TFunction>(function));
+		::memcpy(closure.storage, &block, sizeof(block));
+		closure.invoke = [](void *storage, bool is_cancelled) {
+			Function *block = nullptr;
+			::memcpy(&block, storage, sizeof(block));
+			if (!is_cancelled)
+				(*block)();
+			block->~Function();
+			scheduler_closure_deallocate(block);
+		};
+	}
+	scheduler_submit(self, closure, group, priority);
+}
+
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) Scheduler_Partial
+{
+	T value;
+};
+
+/*
+	`reduce_range(begin, end, partial)` folds the items of a range into `partial`, and `combine(a, b) -> T`
+	merges two partials. Every worker folds into its own cache-line aligned partial, which are combined in
+	worker order at the end, so `combine` must be associative and commutative.
+*/
+template <typename T, typename Reduce_Range, typename Combine>
+inline static T
+scheduler_parallel_reduce(Scheduler *self, U32 count, T identity, Reduce_Range reduce_range, Combine combine, U32 chunk_size = 0, Scheduler_Priority priority = SCHEDULER_PRIORITY_NORMAL)
+{
+	Scheduler_Stats stats = scheduler_get_stats(self);
+	U32 partial_count = stats.worker_count + stats.replacement_worker_count;
+	Memory_Block partials_block = memory::allocate(partial_count * sizeof(Scheduler_Partial<T>), alignof(Scheduler_Partial<T>));
+	Scheduler_Partial<T> *partials = (Scheduler_Partial<T> *)partials_block.data;
+	for (U32 i = 0; i < partial_count; ++i)
+		partials[i].value = identity;
+
+	struct Scheduler_Parallel_Reduce_Context
+	{
+		Scheduler *scheduler;
+		Scheduler_Partial<T> *partials;
+		const T *identity;
+		Reduce_Range *reduce_range;
+		Combine *combine;
+	};
+
+	Scheduler_Parallel_Reduce_Context context = {
+		.scheduler = self,
+		.partials = partials,
+		.identity = &identity,
+		.reduce_range = &reduce_range,
+		.combine = &combine
+	};
+
+	// Ranges fold into a local first, a worker that helps with nested work while folding must not see a half-updated partial.
+	scheduler_parallel_for(self, Scheduler_Parallel_For_Desc {
+		.count = count,
+		.chunk_size = chunk_size,
+		.function = [](U32 begin, U32 end, void *data) {
+			auto *reduce_context = (Scheduler_Parallel_Reduce_Context *)data;
+			T partial = *reduce_context->identity;
+			(*reduce_context->reduce_range)(begin, end, partial);
+
+			U32 worker_index = scheduler_get_current_worker_index(reduce_context->scheduler);
+			T &worker_partial = reduce_context->partials[worker_index].value;
+			worker_partial = (*reduce_context->combine)(worker_partial, partial);
+		},
+		.data = &context,
+		.priority = priority
+	});
+
+	T result = identity;
+	for (U32 i = 0; i < partial_count; ++i)
+		result = combine(result, partials[i].value);
+	memory::deallocate(partials_block);
+	return result;
+}
+
+/*
+	Inclusive scan, `output[i]` is `input[0]` combined with every item up to `input[i]`. Runs in two passes
+	over fixed blocks: the first reduces every block into its partial, the partials are scanned in order, and
+	the second pass scans every block again starting from the partial before it. `combine` must be associative.
+	`input` and `output` may be the same slice.
+*/
+template <typename T, typename Combine>
+inline static void
+scheduler_parallel_scan(Scheduler *self, std::type_identity_t<Slice<const T>> input, Slice<T> output, T identity, Combine combine, Scheduler_Priority priority = SCHEDULER_PRIORITY_NORMAL)
+{
+	constexpr U64 MIN_BLOCK_SIZE = 1024;
+	constexpr U64 BLOCKS_PER_WORKER = 4;
+	validate(output.count == input.count, "[SCHEDULER]: Scan input and output must have the same count.");
+	validate(input.count <= U32_MAX, "[SCHEDULER]: Scan count exceeds U32_MAX.");
+
+	Scheduler_Stats stats = scheduler_get_stats(self);
+	U64 block_count = u64_min((U64)stats.worker_count * BLOCKS_PER_WORKER, input.count / MIN_BLOCK_SIZE);
+	if (block_count <= 1)
+	{
+		T running = identity;
+		for (U64 i = 0; i < input.count; ++i)
+		{
+			running = combine(running, input.data[i]);
+			output.data[i] = running;
+		}
+		return;
+	}
+
+	Memory_Block partials_block = memory::allocate(block_count * sizeof(Scheduler_Partial<T>), alignof(Scheduler_Partial<T>));
+	Scheduler_Partial<T> *partials = (Scheduler_Partial<T> *)partials_block.data;
+
+	struct Scheduler_Parallel_Scan_Context
+	{
+		Slice<const T> input;
+		Slice<T> output;
+		Scheduler_Partial<T> *partials;
+		U64 block_count;
+		const T *identity;
+		Combine *combine;
+	};
+
+	Scheduler_Parallel_Scan_Context context = {
+		.input = input,
+		.output = output,
+		.partials = partials,
+		.block_count = block_count,
+		.identity = &identity,
+		.combine = &combine
+	};
+
+	scheduler_parallel_for(self, Scheduler_Parallel_For_Desc {
+		.count = (U32)block_count,
+		.chunk_size = 1,
+		.function = [](U32 begin, U32 end, void *data) {
+			auto *scan_context = (Scheduler_Parallel_Scan_Context *)data;
+			for (U32 block = begin; block < end; ++block)
+			{
+				U64 first = scan_context->input.count * block / scan_context->block_count;
+				U64 last = scan_context->input.count * (block + 1) / scan_context->block_count;
+				T partial = *scan_context->identity;
+				for (U64 i = first; i < last; ++i)
+					partial = (*scan_context->combine)(partial, scan_context->input.data[i]);
+				scan_context->partials[block].value = partial;
+			}
+		},
+		.data = &context,
+		.priority = priority
+	});
+
+	// Exclusive scan of the block partials, each block starts from everything before it.
+	T running = identity;
+	for (U64 block = 0; block < block_count; ++block)
+	{
+		T partial = partials[block].value;
+		partials[block].value = running;
+		running = combine(running, partial);
+	}
+
+	scheduler_parallel_for(self, Scheduler_Parallel_For_Desc {
+		.count = (U32)block_count,
+		.chunk_size = 1,
+		.function = [](U32 begin, U32 end, void *data) {
+			auto *scan_context = (Scheduler_Parallel_Scan_Context *)data;
+			for (U32 block = begin; block < end; ++block)
+			{
+				U64 first = scan_context->input.count * block / scan_context->block_count;
+				U64 last = scan_context->input.count * (block + 1) / scan_context->block_count;
+				T running = scan_context->partials[block].value;
+				for (U64 i = first; i < last; ++i)
+				{
+					running = (*scan_context->combine)(running, scan_context->input.data[i]);
+					scan_context->output.data[i] = running;
+				}
+			}
+		},
+		.data = &context,
+		.priority = priority
+	});
+
+	memory::deallocate(partials_block);
+}
+
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) Scheduler_Local_Instance
+{
+	T value;
+	bool is_created;
+};
+
+/*
+	One instance of `T` per worker thread, replacement and elastic workers included, each on its own cache lines.
+	A worker's instance is created as a copy of `identity` the first time that worker asks for it, so workers
+	that never ran a task using it cost nothing but the slot. Tasks use their worker's instance without any
+	synchronization. Once those tasks are waited for, `scheduler_local_combine` and `scheduler_local_for_each`
+	visit the created instances in worker order.
+
+	Example:
+	```
+	Scheduler_Local<Histogram> histograms = scheduler_local_init(scheduler, Histogram {});
+	for (const Sample_Batch &batch : batches)
+	{
+		scheduler_submit_fn(scheduler, [scheduler, &histograms, &batch]() {
+			Histogram &histogram = scheduler_local_get(scheduler, histograms);
+			for (U32 sample : batch.samples)
+				++histogram.bins[sample % HISTOGRAM_BIN_COUNT];
+		}, group);
+	}
+	scheduler_wait_group(scheduler, group);
+
+	Histogram histogram = scheduler_local_combine(scheduler, histograms, histogram_add);
+	scheduler_local_deinit(scheduler, histograms);
+	```
+*/
+template <typename T>
+struct Scheduler_Local
+{
+	Scheduler *scheduler;
+	Scheduler_Local_Instance<T> *instances;
+	U32 instance_count;
+	T identity;
+};
+
+template <typename T>
+inline static Scheduler_Local<T>
+scheduler_local_init(Scheduler *self, T identity = {})
+{
+	Scheduler_Stats stats = scheduler_get_stats(self);
+	U32 instance_count = stats.worker_count + stats.replacement_worker_count;
+	Scheduler_Local_Instance<T> *instances = (Scheduler_Local_Instance<T> *)memory::allocate(instance_count * sizeof(Scheduler_Local_Instance<T>), alignof(Scheduler_Local_Instance<T>)).data;
+	for (U32 i = 0; i < instance_count; ++i)
+		instances[i].is_created = false;
+
+	return Scheduler_Local<T> {
+		.scheduler = self,
+		.instances = instances,
+		.instance_count = instance_count,
+		.identity = identity
+	};
+}
+
+// Destroys the created instances, the next `scheduler_local_get` on every worker starts from `identity` again.
+template <typename T>
+inline static void
+scheduler_local_clear(Scheduler *self, Scheduler_Local<T> &local)
+{
+	validate(local.scheduler == self, "[SCHEDULER]: Scheduler local belongs to a different scheduler.");
+	for (U32 i = 0; i < local.instance_count; ++i)
+	{
+		Scheduler_Local_Instance<T> &instance = local.instances[i];
+		if (!instance.is_created)
+			continue;
+		instance.value.~T();
+		instance.is_created = false;
+	}
+}
+
+template <typename T>
+inline static void
+scheduler_local_deinit(Scheduler *self, Scheduler_Local<T> &local)
+{
+	scheduler_local_clear(self, local);
+	memory::deallocate(Memory_Block{local.instances, local.instance_count * sizeof(Scheduler_Local_Instance<T>)});
+	local = Scheduler_Local<T> {};
+}
+
+// Returns the calling worker's instance, only valid on a worker of the scheduler.
+template <typename T>
+inline static T &
+scheduler_local_get(Scheduler *self, Scheduler_Local<T> &local)
+{
+	validate(local.scheduler == self, "[SCHEDULER]: Scheduler local belongs to a different scheduler.");
+	U32 worker_index = scheduler_get_current_worker_index(self);
+	validate(worker_index < local.instance_count, "[SCHEDULER]: Scheduler local can only be used from a scheduler worker.");
+
+	Scheduler_Local_Instance<T> &instance = local.instances[worker_index];
+	if (!instance.is_created)
+	{
+		::new (&instance.value) T(local.identity);
+		instance.is_created = true;
+	}
+	return instance.value;
+}
+
+// Folds the created instances into `identity` in worker order with `combine(a, b) -> T`.
+template <typename T, typename Combine>
+inline static T
+scheduler_local_combine(Scheduler *self, const Scheduler_Local<T> &local, Combine combine)
+{
+	validate(local.scheduler == self, "[SCHEDULER]: Scheduler local belongs to a different scheduler.");
+	T result = local.identity;
+	for (U32 i = 0; i < local.instance_count; ++i)
+		if (local.instances[i].is_created)
+			result = combine(result, local.instances[i].value);
+	return result;
+}
+
+// Calls `function(value)` for every created instance in worker order.
+template <typename T, typename Function>
+inline static void
+scheduler_local_for_each(Scheduler *self, Scheduler_Local<T> &local, Function function)
+{
+	validate(local.scheduler == self, "[SCHEDULER]: Scheduler local belongs to a different scheduler.");
+	for (U32 i = 0; i < local.instance_count; ++i)
+		if (local.instances[i].is_created)
+			function(local.instances[i].value);
+}
\ No newline at end of file
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/validate.h"
+#include "core/scheduler.h"
+
+#include <coroutine>
+
+/*
+	A coroutine task suspends where a plain task would block. Awaiting a group, a timer or another coroutine
+	parks the frame instead of the worker, and the frame is queued again as a task by whichever worker
+	completes the dependency, so thousands of in-flight operations cost memory for their frames and no threads.
+
+	Coroutines start suspended and run once they are submitted with `scheduler_coroutine_submit`, or awaited
+	by another coroutine. A coroutine whose first parameter is a `Scheduler *` takes its frame from that
+	scheduler's frame pool, otherwise from the heap.
+
+	GCC pairs the single `operator delete` of the promise with its placement `operator new` in unoptimized
+	builds and reports `-Wmismatched-new-delete`, which a matching placement or sized `operator delete` does
+	not silence. Targets that define coroutines and build with GCC and `-Werror` need `-Wno-mismatched-new-delete`.
+
+	Example:
+	```
+	Scheduler_Coroutine
+	load_level(Scheduler *scheduler, Level *level)
+	{
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+		scheduler_submit(scheduler, slice_from(level->load_tasks), group);
+		co_await scheduler_coroutine_wait_group(scheduler, group);
+		scheduler_group_deinit(scheduler, group);
+
+		co_await scheduler_coroutine_sleep(scheduler, 16);
+		co_await build_navigation(scheduler, level);
+	}
+
+	scheduler_coroutine_submit(scheduler, load_level(scheduler, level), group);
+	```
+*/
+
+struct Scheduler_Coroutine_Promise;
+
+struct Scheduler_Coroutine
+{
+	using promise_type = Scheduler_Coroutine_Promise;
+
+	std::coroutine_handle<Scheduler_Coroutine_Promise> handle;
+
+	inline bool
+	await_ready() const noexcept
+	{
+		return false;
+	}
+
+	// Starts the awaited coroutine on the current worker, it resumes its caller when it returns.
+	inline std::coroutine_handle<>
+	await_suspend(std::coroutine_handle<Scheduler_Coroutine_Promise> caller) noexcept;
+
+	inline void
+	await_resume() noexcept
+	{
+		handle.destroy();
+	}
+};
+
+inline static void
+_scheduler_coroutine_resume(void *data)
+{
+	std::coroutine_handle<>::from_address(data).resume();
+}
+
+inline static Scheduler_Task
+_scheduler_coroutine_resume_task(std::coroutine_handle<> coroutine)
+{
+	return Scheduler_Task {
+		.function = _scheduler_coroutine_resume,
+		.data = coroutine.address()
+	};
+}
+
+struct Scheduler_Coroutine_Final_Awaiter
+{
+	inline bool
+	await_ready() const noexcept
+	{
+		return false;
+	}
+
+	inline std::coroutine_handle<>
+	await_suspend(std::coroutine_handle<Scheduler_Coroutine_Promise> coroutine) noexcept;
+
+	inline void
+	await_resume() const noexcept
+	{
+	}
+};
+
+struct Scheduler_Coroutine_Promise
+{
+	Scheduler *scheduler = nullptr;
+	Scheduler_Group *group = nullptr;
+	Scheduler_Priority priority = SCHEDULER_PRIORITY_NORMAL;
+	std::coroutine_handle<> caller = nullptr;
+
+	template <typename ...TArgs>
+	inline static void *
+	operator new(size_t size, Scheduler *scheduler, TArgs &&...)
+	{
+		return scheduler_coroutine_frame_allocate(scheduler, size);
+	}
+
+	inline static void *
+	operator new(size_t size)
+	{
+		return scheduler_coroutine_frame_allocate(nullptr, size);
+	}
+
+	inline static void
+	operator delete(void *frame)
+	{
+		scheduler_coroutine_frame_deallocate(frame);
+	}
+
+	inline Scheduler_Coroutine
+	get_return_object() noexcept
+	{
+		return Scheduler_Coroutine{std::coroutine_handle<Scheduler_Coroutine_Promise>::from_promise(*this)};
+	}
+
+	inline std::suspend_always
+	initial_suspend() const noexcept
+	{
+		return {};
+	}
+
+	inline Scheduler_Coroutine_Final_Awaiter
+	final_suspend() const noexcept
+	{
+		return {};
+	}
+
+	inline void
+	return_void() const noexcept
+	{
+	}
+
+	inline void
+	unhandled_exception() const noexcept
+	{
+		validate(false, "[SCHEDULER]: Unhandled exception in coroutine.");
+	}
+};
+
+inline std::coroutine_handle<>
+Scheduler_Coroutine::await_suspend(std::coroutine_handle<Scheduler_Coroutine_Promise> caller) noexcept
+{
+	Scheduler_Coroutine_Promise &promise = handle.promise();
+	promise.scheduler = caller.promise().scheduler;
+	promise.priority = caller.promise().priority;
+	promise.caller = caller;
+	return handle;
+}
+
+// An awaited coroutine hands the worker straight back to its caller. A submitted one releases its frame
+// before it completes its group, so a waiter that sees the group drain never sees the frame alive.
+inline std::coroutine_handle<>
+Scheduler_Coroutine_Final_Awaiter::await_suspend(std::coroutine_handle<Scheduler_Coroutine_Promise> coroutine) noexcept
+{
+	Scheduler_Coroutine_Promise &promise = coroutine.promise();
+	if (promise.caller)
+		return promise.caller;
+
+	Scheduler *scheduler = promise.scheduler;
+	Scheduler_Group *group = promise.group;
+	coroutine.destroy();
+	if (group != nullptr)
+		scheduler_group_complete_pending(scheduler, group);
+	return std::noop_coroutine();
+}
+
+struct Scheduler_Coroutine_Group_Awaiter
+{
+	Scheduler *scheduler;
+	Scheduler_Group *group;
+	Scheduler_Group_Waiter waiter;
+
+	inline bool
+	await_ready() const noexcept
+	{
+		return false;
+	}
+
+	// Nothing in the awaiter is touched once it is registered, the coroutine may already be running elsewhere.
+	inline bool
+	await_suspend(std::coroutine_handle<Scheduler_Coroutine_Promise> coroutine)
+	{
+		waiter = Scheduler_Group_Waiter {
+			.task = _scheduler_coroutine_resume_task(coroutine),
+			.priority = coroutine.promise().priority
+		};
+		return scheduler_group_add_waiter(scheduler, group, &waiter);
+	}
+
+	inline Scheduler_Group_Status
+	await_resume() const noexcept
+	{
+		return scheduler_group_is_cancelled(scheduler, group) ? SCHEDULER_GROUP_STATUS_CANCELLED : SCHEDULER_GROUP_STATUS_COMPLETED;
+	}
+};
+
+struct Scheduler_Coroutine_Sleep_Awaiter
+{
+	Scheduler *scheduler;
+	U32 milliseconds;
+
+	inline bool
+	await_ready() const noexcept
+	{
+		return false;
+	}
+
+	inline void
+	await_suspend(std::coroutine_handle<Scheduler_Coroutine_Promise> coroutine)
+	{
+		scheduler_submit_after(scheduler, milliseconds, _scheduler_coroutine_resume_task(coroutine), nullptr, coroutine.promise().priority);
+	}
+
+	inline void
+	await_resume() const noexcept
+	{
+	}
+};
+
+// Queues the coroutine as a task. The group, if any, stays pending until the coroutine returns.
+inline static void
+scheduler_coroutine_submit(Scheduler *self, Scheduler_Coroutine coroutine, Scheduler_Group *group = nullptr, Scheduler_Priority priority = SCHEDULER_PRIORITY_NORMAL)
+{
+	validate(coroutine.handle != nullptr, "[SCHEDULER]: Invalid coroutine.");
+
+	Scheduler_Coroutine_Promise &promise = coroutine.handle.promise();
+	promise.scheduler = self;
+	promise.group = group;
+	promise.priority = priority;
+	if (group != nullptr)
+		scheduler_group_add_pending(self, group);
+	scheduler_submit(self, _scheduler_coroutine_resume_task(coroutine.handle), nullptr, priority);
+}
+
+// Resumes immediately if the group has no pending tasks, and evaluates to the status of the group like `scheduler_wait_group`.
+// A coroutine must not await the group it was submitted with.
+inline static Scheduler_Coroutine_Group_Awaiter
+scheduler_coroutine_wait_group(Scheduler *self, Scheduler_Group *group)
+{
+	return Scheduler_Coroutine_Group_Awaiter {
+		.scheduler = self,
+		.group = group
+	};
+}
+
+inline static Scheduler_Coroutine_Sleep_Awaiter
+scheduler_coroutine_sleep(Scheduler *self, U32 milliseconds)
+{
+	return Scheduler_Coroutine_Sleep_Awaiter {
+		.scheduler = self,
+		.milliseconds = milliseconds
+	};
+}
\ No newline at end of file
@@ -0,0 +1,712 @@
+#pragma once
+
+#include "core/defer.h"
+#include "core/defines.h"
+#include "core/validate.h"
+#include "core/scheduler.h"
+#include "core/math/u64.h"
+#include "core/memory/allocator.h"
+#include "core/containers/array.h"
+#include "core/containers/slice.h"
+
+#include <string.h>
+#include <type_traits>
+
+/*
+	Comparators are callables `less(a, b) -> bool` that define a strict weak ordering.
+	Sorts are unstable unless stated otherwise and move elements with plain assignment.
+*/
+
+struct Sort_Less
+{
+	template <typename A, typename B>
+	inline bool
+	operator()(const A &a, const B &b) const
+	{
+		return a < b;
+	}
+};
+
+template <typename T>
+inline static void
+_sort_swap(T &a, T &b)
+{
+	T temp = a;
+	a = b;
+	b = temp;
+}
+
+template <typename T, typename Less>
+inline static void
+_sort_insertion(T *begin, T *end, Less &less)
+{
+	if (begin == end)
+		return;
+
+	for (T *current = begin + 1; current != end; ++current)
+	{
+		T *sift = current;
+		T *sift_1 = current - 1;
+		if (less(*sift, *sift_1))
+		{
+			T temp = *sift;
+			do
+			{
+				*sift-- = *sift_1;
+			} while (sift != begin && less(temp, *--sift_1));
+			*sift = temp;
+		}
+	}
+}
+
+// Assumes *(begin - 1) is not greater than any element in [begin, end).
+template <typename T, typename Less>
+inline static void
+_sort_insertion_unguarded(T *begin, T *end, Less &less)
+{
+	if (begin == end)
+		return;
+
+	for (T *current = begin + 1; current != end; ++current)
+	{
+		T *sift = current;
+		T *sift_1 = current - 1;
+		if (less(*sift, *sift_1))
+		{
+			T temp = *sift;
+			do
+			{
+				*sift-- = *sift_1;
+			} while (less(temp, *--sift_1));
+			*sift = temp;
+		}
+	}
+}
+
+// Gives up once more than a handful of elements had to move, returns whether the range ended up sorted.
+template <typename T, typename Less>
+inline static bool
+_sort_insertion_partial(T *begin, T *end, Less &less)
+{
+	constexpr U64 PARTIAL_INSERTION_SORT_LIMIT = 8;
+
+	if (begin == end)
+		return true;
+
+	U64 moved_count = 0;
+	for (T *current = begin + 1; current != end; ++current)
+	{
+		T *sift = current;
+		T *sift_1 = current - 1;
+		if (less(*sift, *sift_1))
+		{
+			T temp = *sift;
+			do
+			{
+				*sift-- = *sift_1;
+			} while (sift != begin && less(temp, *--sift_1));
+			*sift = temp;
+			moved_count += current - sift;
+		}
+
+		if (moved_count > PARTIAL_INSERTION_SORT_LIMIT)
+			return false;
+	}
+	return true;
+}
+
+template <typename T, typename Less>
+inline static void
+_sort_heap_sift_down(T *data, U64 index, U64 count, Less &less)
+{
+	T value = data[index];
+	while (true)
+	{
+		U64 child = index * 2 + 1;
+		if (child >= count)
+			break;
+		if (child + 1 < count && less(data[child], data[child + 1]))
+			++child;
+		if (!less(value, data[child]))
+			break;
+		data[index] = data[child];
+		index = child;
+	}
+	data[index] = value;
+}
+
+template <typename T, typename Less>
+inline static void
+_sort_heap(T *begin, T *end, Less &less)
+{
+	U64 count = end - begin;
+	for (U64 i = count / 2; i > 0; --i)
+		_sort_heap_sift_down(begin, i - 1, count, less);
+	for (U64 i = count; i > 1; --i)
+	{
+		_sort_swap(begin[0], begin[i - 1]);
+		_sort_heap_sift_down(begin, 0, i - 1, less);
+	}
+}
+
+template <typename T, typename Less>
+inline static void
+_sort_2(T *a, T *b, Less &less)
+{
+	if (less(*b, *a))
+		_sort_swap(*a, *b);
+}
+
+template <typename T, typename Less>
+inline static void
+_sort_3(T *a, T *b, T *c, Less &less)
+{
+	_sort_2(a, b, less);
+	_sort_2(b, c, less);
+	_sort_2(a, b, less);
+}
+
+// Partitions around *begin, elements equal to the pivot go right. Returns the pivot position.
+template <typename T, typename Less>
+inline static T *
+_sort_partition_right(T *begin, T *end, Less &less, bool &already_partitioned)
+{
+	T pivot = *begin;
+	T *first = begin;
+	T *last = end;
+
+	while (less(*++first, pivot));
+
+	if (first - 1 == begin)
+		while (first < last && !less(*--last, pivot));
+	else
+		while (!less(*--last, pivot));
+
+	already_partitioned = first >= last;
+
+	while (first < last)
+	{
+		_sort_swap(*first, *last);
+		while (less(*++first, pivot));
+		while (!less(*--last, pivot));
+	}
+
+	T *pivot_position = first - 1;
+	*begin = *pivot_position;
+	*pivot_position = pivot;
+	return pivot_position;
+}
+
+// Partitions around *begin, elements equal to the pivot go left. Used when the pivot equals the
+// element before the range, so the whole equal run is finished in one pass.
+template <typename T, typename Less>
+inline static T *
+_sort_partition_left(T *begin, T *end, Less &less)
+{
+	T pivot = *begin;
+	T *first = begin;
+	T *last = end;
+
+	while (less(pivot, *--last));
+
+	if (last + 1 == end)
+		while (first < last && !less(pivot, *++first));
+	else
+		while (!less(pivot, *++first));
+
+	while (first < last)
+	{
+		_sort_swap(*first, *last);
+		while (less(pivot, *--last));
+		while (!less(pivot, *++first));
+	}
+
+	T *pivot_position = last;
+	*begin = *pivot_position;
+	*pivot_position = pivot;
+	return pivot_position;
+}
+
+// Pattern-defeating quicksort (Orson Peters). Median-of-3 or ninther pivots, linear time on
+// sorted and equal runs, pattern breaking swaps on unbalanced partitions and a heap sort
+// fallback once too many bad partitions were seen.
+template <typename T, typename Less>
+inline static void
+_sort_pdq(T *begin, T *end, Less &less, U32 bad_allowed, bool leftmost)
+{
+	constexpr U64 INSERTION_SORT_THRESHOLD = 24;
+	constexpr U64 NINTHER_THRESHOLD = 128;
+
+	while (true)
+	{
+		U64 size = end - begin;
+		if (size < INSERTION_SORT_THRESHOLD)
+		{
+			if (leftmost)
+				_sort_insertion(begin, end, less);
+			else
+				_sort_insertion_unguarded(begin, end, less);
+			return;
+		}
+
+		U64 half = size / 2;
+		if (size > NINTHER_THRESHOLD)
+		{
+			_sort_3(begin, begin + half, end - 1, less);
+			_sort_3(begin + 1, begin + (half - 1), end - 2, less);
+			_sort_3(begin + 2, begin + (half + 1), end - 3, less);
+			_sort_3(begin + (half - 1), begin + half, begin + (half + 1), less);
+			_sort_swap(*begin, *(begin + half));
+		}
+		else
+		{
+			_sort_3(begin + half, begin, end - 1, less);
+		}
+
+		if (!leftmost && !less(*(begin - 1), *begin))
+		{
+			begin = _sort_partition_left(begin, end, less) + 1;
+			continue;
+		}
+
+		bool already_partitioned = false;
+		T *pivot_position = _sort_partition_right(begin, end, less, already_partitioned);
+
+		U64 left_size = pivot_position - begin;
+		U64 right_size = end - (pivot_position + 1);
+		bool highly_unbalanced = left_size < size / 8 || right_size < size / 8;
+		if (highly_unbalanced)
+		{
+			if (--bad_allowed == 0)
+			{
+				_sort_heap(begin, end, less);
+				return;
+			}
+
+			if (left_size >= INSERTION_SORT_THRESHOLD)
+			{
+				_sort_swap(begin[0], begin[left_size / 4]);
+				_sort_swap(pivot_position[-1], pivot_position[-(I64)(left_size / 4)]);
+				if (left_size > NINTHER_THRESHOLD)
+				{
+					_sort_swap(begin[1], begin[left_size / 4 + 1]);
+					_sort_swap(begin[2], begin[left_size / 4 + 2]);
+					_sort_swap(pivot_position[-2], pivot_position[-(I64)(left_size / 4 + 1)]);
+					_sort_swap(pivot_position[-3], pivot_position[-(I64)(left_size / 4 + 2)]);
+				}
+			}
+
+			if (right_size >= INSERTION_SORT_THRESHOLD)
+			{
+				_sort_swap(pivot_position[1], pivot_position[1 + right_size / 4]);
+				_sort_swap(end[-1], end[-(I64)(right_size / 4)]);
+				if (right_size > NINTHER_THRESHOLD)
+				{
+					_sort_swap(pivot_position[2], pivot_position[2 + right_size / 4]);
+					_sort_swap(pivot_position[3], pivot_position[3 + right_size / 4]);
+					_sort_swap(end[-2], end[-(I64)(1 + right_size / 4)]);
+					_sort_swap(end[-3], end[-(I64)(2 + right_size / 4)]);
+				}
+			}
+		}
+		else if (already_partitioned && _sort_insertion_partial(begin, pivot_position, less) && _sort_insertion_partial(pivot_position + 1, end, less))
+		{
+			return;
+		}
+
+		_sort_pdq(begin, pivot_position, less, bad_allowed, leftmost);
+		begin = pivot_position + 1;
+		leftmost = false;
+	}
+}
+
+template <typename T, typename Less = Sort_Less>
+inline static void
+slice_sort(Slice<T> values, Less less = {})
+{
+	if (values.count < 2)
+		return;
+	U32 bad_allowed = 64 - u64_leading_zero_count(values.count);
+	_sort_pdq(values.data, values.data + values.count, less, bad_allowed, true);
+}
+
+template <typename T, typename Less = Sort_Less>
+inline static void
+array_sort(Array<T> &self, Less less = {})
+{
+	slice_sort(slice_from(self), less);
+}
+
+template <typename T, typename Less = Sort_Less>
+inline static bool
+slice_is_sorted(Slice<T> values, Less less = {})
+{
+	for (U64 i = 1; i < values.count; ++i)
+		if (less(values.data[i], values.data[i - 1]))
+			return false;
+	return true;
+}
+
+template <typename T, typename Less = Sort_Less>
+inline static bool
+array_is_sorted(const Array<T> &self, Less less = {})
+{
+	return slice_is_sorted(slice_from(self), less);
+}
+
+// Maps a key to an unsigned integer of the same size whose unsigned order matches the key order.
+// Floats flip every bit when negative and only the sign bit otherwise, so -0.0 sorts before 0.0
+// and NaNs land at the ends.
+template <typename K>
+inline static auto
+_sort_radix_key_bits(K key)
+{
+	static_assert(std::is_arithmetic_v<K>, "[SORT]: Radix sort key must be an integer or floating point type.");
+
+	if constexpr (std::is_floating_point_v<K>)
+	{
+		using Bits = std::conditional_t<sizeof(K) == 8, U64, U32>;
+		constexpr Bits SIGN_BIT = (Bits)1 << (sizeof(K) * 8 - 1);
+		Bits bits = 0;
+		::memcpy(&bits, &key, sizeof(K));
+		return (bits & SIGN_BIT) ? (Bits)~bits : (Bits)(bits | SIGN_BIT);
+	}
+	else if constexpr (std::is_signed_v<K>)
+	{
+		using Bits = std::make_unsigned_t<K>;
+		constexpr Bits SIGN_BIT = (Bits)1 << (sizeof(K) * 8 - 1);
+		return (Bits)((Bits)key ^ SIGN_BIT);
+	}
+	else
+	{
+		return key;
+	}
+}
+
+// LSD radix sort, one byte per pass. Stable. Passes where every key shares the same byte are skipped.
+// `key(value)` must return an integer or floating point value.
+template <typename T, typename Key>
+requires (std::is_invocable_v<Key &, T &>)
+inline static void
+slice_radix_sort(Slice<T> values, Key key, memory::Allocator *allocator = memory::heap_allocator())
+{
+	using K = std::remove_cvref_t<decltype(key(values.data[0]))>;
+	constexpr U64 PASS_COUNT = sizeof(K);
+
+	if (values.count < 2)
+		return;
+
+	U64 histograms[PASS_COUNT][256] = {};
+	for (U64 i = 0; i < values.count; ++i)
+	{
+		auto bits = _sort_radix_key_bits(key(values.data[i]));
+		for (U64 pass = 0; pass < PASS_COUNT; ++pass)
+			++histograms[pass][(bits >> (pass * 8)) & 0xff];
+	}
+
+	allocator = allocator ? allocator : memory::heap_allocator();
+	T *scratch = (T *)memory::allocate(allocator, values.count * sizeof(T), alignof(T)).data;
+
+	T *source = values.data;
+	T *destination = scratch;
+	for (U64 pass = 0; pass < PASS_COUNT; ++pass)
+	{
+		U64 *histogram = histograms[pass];
+		auto first_bits = _sort_radix_key_bits(key(source[0]));
+		if (histogram[(first_bits >> (pass * 8)) & 0xff] == values.count)
+			continue;
+
+		U64 offset = 0;
+		for (U64 digit = 0; digit < 256; ++digit)
+		{
+			U64 count = histogram[digit];
+			histogram[digit] = offset;
+			offset += count;
+		}
+
+		for (U64 i = 0; i < values.count; ++i)
+		{
+			auto bits = _sort_radix_key_bits(key(source[i]));
+			destination[histogram[(bits >> (pass * 8)) & 0xff]++] = source[i];
+		}
+
+		T *temp = source;
+		source = destination;
+		destination = temp;
+	}
+
+	if (source != values.data)
+		for (U64 i = 0; i < values.count; ++i)
+			values.data[i] = source[i];
+
+	memory::deallocate(allocator, Memory_Block{scratch, values.count * sizeof(T)});
+}
+
+template <typename T>
+requires (std::is_arithmetic_v<std::remove_const_t<T>>)
+inline static void
+slice_radix_sort(Slice<T> values, memory::Allocator *allocator = memory::heap_allocator())
+{
+	slice_radix_sort(values, [](const T &value) { return value; }, allocator);
+}
+
+template <typename T, typename Key>
+requires (std::is_invocable_v<Key &, T &>)
+inline static void
+array_radix_sort(Array<T> &self, Key key, memory::Allocator *allocator = memory::heap_allocator())
+{
+	slice_radix_sort(slice_from(self), key, allocator);
+}
+
+template <typename T>
+requires (std::is_arithmetic_v<T>)
+inline static void
+array_radix_sort(Array<T> &self, memory::Allocator *allocator = memory::heap_allocator())
+{
+	slice_radix_sort(slice_from(self), allocator);
+}
+
+// Index of the first element that is not less than `value`, or `values.count`.
+// `less(element, value)` is used, so `value` may be a key of a different type.
+template <typename T, typename V, typename Less = Sort_Less>
+inline static U64
+slice_lower_bound(Slice<T> values, const V &value, Less less = {})
+{
+	U64 first = 0;
+	U64 count = values.count;
+	while (count > 0)
+	{
+		U64 step = count / 2;
+		if (less(values.data[first + step], value))
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+	return first;
+}
+
+// Index of the first element that is greater than `value`, or `values.count`.
+// `less(value, element)` is used, so `value` may be a key of a different type.
+template <typename T, typename V, typename Less = Sort_Less>
+inline static U64
+slice_upper_bound(Slice<T> values, const V &value, Less less = {})
+{
+	U64 first = 0;
+	U64 count = values.count;
+	while (count > 0)
+	{
+		U64 step = count / 2;
+		if (!less(value, values.data[first + step]))
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+	return first;
+}
+
+// Returns a pointer to an element equivalent to `value`, or `nullptr`.
+template <typename T, typename V, typename Less = Sort_Less>
+inline static T *
+slice_binary_search(Slice<T> values, const V &value, Less less = {})
+{
+	U64 index = slice_lower_bound(values, value, less);
+	if (index == values.count || less(value, values.data[index]))
+		return nullptr;
+	return values.data + index;
+}
+
+template <typename T, typename V, typename Less = Sort_Less>
+inline static U64
+array_lower_bound(const Array<T> &self, const V &value, Less less = {})
+{
+	return slice_lower_bound(slice_from(self), value, less);
+}
+
+template <typename T, typename V, typename Less = Sort_Less>
+inline static U64
+array_upper_bound(const Array<T> &self, const V &value, Less less = {})
+{
+	return slice_upper_bound(slice_from(self), value, less);
+}
+
+template <typename T, typename V, typename Less = Sort_Less>
+inline static const T *
+array_binary_search(const Array<T> &self, const V &value, Less less = {})
+{
+	return slice_binary_search(slice_from(self), value, less);
+}
+
+template <typename T, typename V, typename Less = Sort_Less>
+inline static T *
+array_binary_search(Array<T> &self, const V &value, Less less = {})
+{
+	return slice_binary_search(slice_from(self), value, less);
+}
+
+// Number of elements from `a` among the first `k` elements of the stable merge of `a` and `b`.
+template <typename T, typename Less>
+inline static U64
+_sort_merge_path(const T *a, U64 a_count, const T *b, U64 b_count, U64 k, Less &less)
+{
+	U64 low = k > b_count ? k - b_count : 0;
+	U64 high = u64_min(k, a_count);
+	while (low < high)
+	{
+		U64 middle = low + (high - low) / 2;
+		if (!less(b[k - middle - 1], a[middle]))
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+template <typename T, typename Less>
+inline static void
+_sort_merge(const T *a, const T *a_end, const T *b, const T *b_end, T *out, Less &less)
+{
+	while (a != a_end && b != b_end)
+	{
+		if (less(*b, *a))
+			*out++ = *b++;
+		else
+			*out++ = *a++;
+	}
+	while (a != a_end)
+		*out++ = *a++;
+	while (b != b_end)
+		*out++ = *b++;
+}
+
+template <typename T, typename Less>
+struct Sort_Parallel_Context
+{
+	T *source;
+	T *destination;
+	U64 count;
+	U32 block_count;
+	U32 run_block_count;
+	Less *less;
+};
+
+template <typename T, typename Less>
+inline static U64
+_sort_parallel_block_begin(const Sort_Parallel_Context<T, Less> *context, U64 block)
+{
+	return context->count * block / context->block_count;
+}
+
+// Sorts `values` in place on the scheduler workers: the range is cut into a power-of-two number of
+// blocks that are sorted independently, then merged pairwise. Every merge round is split along the
+// merge path into `block_count` equal output segments, so the last rounds still use every worker.
+// Uses a scratch buffer of `values.count` elements from `allocator`. Falls back to `slice_sort`
+// for small inputs or a single worker.
+template <typename T, typename Less = Sort_Less>
+inline static void
+slice_sort_parallel(Scheduler *scheduler, Slice<T> values, Less less = {}, memory::Allocator *allocator = memory::heap_allocator())
+{
+	constexpr U64 MIN_BLOCK_SIZE = 16 * 1024;
+
+	U32 worker_count = scheduler_get_stats(scheduler).worker_count;
+	if (worker_count <= 1 || values.count < MIN_BLOCK_SIZE * 2)
+	{
+		slice_sort(values, less);
+		return;
+	}
+
+	U64 block_count = u64_min(u64_next_power_of_two((U64)worker_count * 4), u64_previous_power_of_two(values.count / MIN_BLOCK_SIZE));
+	allocator = allocator ? allocator : memory::heap_allocator();
+	T *scratch = (T *)memory::allocate(allocator, values.count * sizeof(T), alignof(T)).data;
+	DEFER(memory::deallocate(allocator, Memory_Block{scratch, values.count * sizeof(T)}));
+
+	Sort_Parallel_Context<T, Less> context = {
+		.source = values.data,
+		.destination = scratch,
+		.count = values.count,
+		.block_count = (U32)block_count,
+		.run_block_count = 1,
+		.less = &less
+	};
+
+	scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+		.count = context.block_count,
+		.chunk_size = 1,
+		.function = [](U32 begin, U32 end, void *data) {
+			auto *sort_context = (Sort_Parallel_Context<T, Less> *)data;
+			for (U32 block = begin; block < end; ++block)
+			{
+				U64 first = _sort_parallel_block_begin(sort_context, block);
+				U64 last = _sort_parallel_block_begin(sort_context, block + 1);
+				slice_sort(Slice<T>{sort_context->source + first, last - first}, *sort_context->less);
+			}
+		},
+		.data = &context
+	});
+
+	for (; context.run_block_count < context.block_count; context.run_block_count *= 2)
+	{
+		scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+			.count = context.block_count,
+			.chunk_size = 1,
+			.function = [](U32 begin, U32 end, void *data) {
+				auto *sort_context = (Sort_Parallel_Context<T, Less> *)data;
+				U32 pair_block_count = sort_context->run_block_count * 2;
+				for (U32 segment = begin; segment < end; ++segment)
+				{
+					U32 pair_first_block = segment - segment % pair_block_count;
+					U64 a_begin = _sort_parallel_block_begin(sort_context, pair_first_block);
+					U64 b_begin = _sort_parallel_block_begin(sort_context, pair_first_block + sort_context->run_block_count);
+					U64 b_end = _sort_parallel_block_begin(sort_context, pair_first_block + pair_block_count);
+					const T *a = sort_context->source + a_begin;
+					const T *b = sort_context->source + b_begin;
+					U64 a_count = b_begin - a_begin;
+					U64 b_count = b_end - b_begin;
+
+					U64 k_begin = _sort_parallel_block_begin(sort_context, segment) - a_begin;
+					U64 k_end = _sort_parallel_block_begin(sort_context, segment + 1) - a_begin;
+					U64 i_begin = _sort_merge_path(a, a_count, b, b_count, k_begin, *sort_context->less);
+					U64 i_end = _sort_merge_path(a, a_count, b, b_count, k_end, *sort_context->less);
+					_sort_merge(a + i_begin, a + i_end, b + (k_begin - i_begin), b + (k_end - i_end), sort_context->destination + a_begin + k_begin, *sort_context->less);
+				}
+			},
+			.data = &context
+		});
+
+		T *temp = context.source;
+		context.source = context.destination;
+		context.destination = temp;
+	}
+
+	if (context.source != values.data)
+	{
+		scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+			.count = context.block_count,
+			.chunk_size = 1,
+			.function = [](U32 begin, U32 end, void *data) {
+				auto *sort_context = (Sort_Parallel_Context<T, Less> *)data;
+				U64 first = _sort_parallel_block_begin(sort_context, begin);
+				U64 last = _sort_parallel_block_begin(sort_context, end);
+				for (U64 i = first; i < last; ++i)
+					sort_context->destination[i] = sort_context->source[i];
+			},
+			.data = &context
+		});
+	}
+}
+
+template <typename T, typename Less = Sort_Less>
+inline static void
+array_sort_parallel(Scheduler *scheduler, Array<T> &self, Less less = {}, memory::Allocator *allocator = memory::heap_allocator())
+{
+	slice_sort_parallel(scheduler, slice_from(self), less, allocator);
+}
\ No newline at end of file
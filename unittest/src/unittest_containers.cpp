@@ -1,13 +1,21 @@
 #include <core/tester.h>
 #include <core/defer.h>
 #include <core/containers/array.h>
+#include <core/containers/b_tree_map.h>
+#include <core/containers/bit_array.h>
 #include <core/containers/hash_set.h>
 #include <core/containers/hash_table.h>
+#include <core/containers/handle_pool.h>
 #include <core/containers/ring_buffer.h>
+#include <core/containers/spsc_queue.h>
+#include <core/containers/mpmc_queue.h>
 #include <core/containers/slice.h>
 #include <core/containers/stack_array.h>
+#include <core/containers/stack_bit_array.h>
 #include <core/containers/string.h>
 #include <core/containers/string_interner.h>
+#include <core/memory/pool_allocator.h>
+#include <core/platform/platform.h>
 
 TESTER_TEST("[CONTAINERS]: Array")
 {
@@ -1799,4 +1807,804 @@ TESTER_TEST("[CONTAINERS]: Ring_Buffer")
 		for (U64 i = 0; i < rb2.count; ++i)
 			TESTER_CHECK(rb2[i] == rb1[i]);
 	}
+}
+
+TESTER_TEST("[CONTAINERS]: Spsc_Queue")
+{
+	// ("init")
+	{
+		auto queue = spsc_queue_init<I32>(5);
+		DEFER(spsc_queue_deinit(queue));
+
+		TESTER_CHECK(queue.data != nullptr);
+		TESTER_CHECK(queue.capacity == 8);
+		TESTER_CHECK(queue.allocator != nullptr);
+		TESTER_CHECK(spsc_queue_is_empty(queue));
+	}
+
+	// ("push / pop — FIFO until full")
+	{
+		auto queue = spsc_queue_init<I32>(4);
+		DEFER(spsc_queue_deinit(queue));
+
+		for (I32 i = 0; i < 4; ++i)
+			TESTER_CHECK(spsc_queue_push(queue, i));
+		TESTER_CHECK(!spsc_queue_push(queue, 4));
+		TESTER_CHECK(spsc_queue_count(queue) == 4);
+
+		I32 value = -1;
+		for (I32 i = 0; i < 4; ++i)
+		{
+			TESTER_CHECK(spsc_queue_pop(queue, value));
+			TESTER_CHECK(value == i);
+		}
+		TESTER_CHECK(!spsc_queue_pop(queue, value));
+		TESTER_CHECK(spsc_queue_is_empty(queue));
+	}
+
+	// ("batch push / pop with wrap-around")
+	{
+		auto queue = spsc_queue_init<I32>(8);
+		DEFER(spsc_queue_deinit(queue));
+
+		I32 input[] = {0, 1, 2, 3, 4, 5};
+		I32 output[8] = {};
+		TESTER_CHECK(spsc_queue_push_batch(queue, slice_from(input)) == 6);
+		TESTER_CHECK(spsc_queue_pop_batch(queue, slice_from(output, 4)) == 4);
+		TESTER_CHECK(output[0] == 0 && output[3] == 3);
+
+		// Only 6 slots are free now; the rest of the batch is rejected.
+		I32 more[] = {6, 7, 8, 9, 10, 11, 12, 13};
+		TESTER_CHECK(spsc_queue_push_batch(queue, slice_from(more)) == 6);
+		TESTER_CHECK(spsc_queue_pop_batch(queue, slice_from(output)) == 8);
+		for (I32 i = 0; i < 8; ++i)
+			TESTER_CHECK(output[i] == i + 4);
+		TESTER_CHECK(spsc_queue_pop_batch(queue, slice_from(output)) == 0);
+	}
+}
+
+struct Spsc_Queue_Test_Context
+{
+	Spsc_Queue<U64> *queue;
+	U64 item_count;
+	U64 sum;
+	bool in_order;
+};
+
+inline static void
+_spsc_queue_test_producer(void *data)
+{
+	Spsc_Queue_Test_Context *context = (Spsc_Queue_Test_Context *)data;
+	for (U64 i = 0; i < context->item_count; ++i)
+		while (!spsc_queue_push(*context->queue, i))
+			compiler_cpu_pause();
+}
+
+TESTER_TEST("[CONTAINERS]: Spsc_Queue Threads")
+{
+	constexpr U64 ITEM_COUNT = 50000;
+
+	auto queue = spsc_queue_init<U64>(1024);
+	DEFER(spsc_queue_deinit(queue));
+
+	Spsc_Queue_Test_Context context = {
+		.queue = &queue,
+		.item_count = ITEM_COUNT,
+		.in_order = true
+	};
+	Platform_Thread *producer = platform_thread_init(Platform_Thread_Desc {
+		.function = _spsc_queue_test_producer,
+		.data = &context,
+		.name = "SpscQueueTest"
+	});
+
+	U64 expected = 0;
+	U64 values[16];
+	while (expected < ITEM_COUNT)
+	{
+		U64 count = spsc_queue_pop_batch(queue, slice_from(values));
+		for (U64 i = 0; i < count; ++i)
+		{
+			if (values[i] != expected)
+				context.in_order = false;
+			context.sum += values[i];
+			++expected;
+		}
+		if (count == 0)
+			compiler_cpu_pause();
+	}
+	platform_thread_deinit(producer);
+
+	TESTER_CHECK(context.in_order);
+	TESTER_CHECK(context.sum == ITEM_COUNT * (ITEM_COUNT - 1) / 2);
+	TESTER_CHECK(spsc_queue_is_empty(queue));
+}
+
+TESTER_TEST("[CONTAINERS]: Mpmc_Queue")
+{
+	// ("init")
+	{
+		auto queue = mpmc_queue_init<I32>(3);
+		DEFER(mpmc_queue_deinit(queue));
+
+		TESTER_CHECK(queue.cells != nullptr);
+		TESTER_CHECK(queue.capacity == 4);
+		TESTER_CHECK(queue.allocator != nullptr);
+		TESTER_CHECK(mpmc_queue_is_empty(queue));
+	}
+
+	// ("push / pop — FIFO until full")
+	{
+		auto queue = mpmc_queue_init<I32>(4);
+		DEFER(mpmc_queue_deinit(queue));
+
+		for (I32 i = 0; i < 4; ++i)
+			TESTER_CHECK(mpmc_queue_push(queue, i));
+		TESTER_CHECK(!mpmc_queue_push(queue, 4));
+		TESTER_CHECK(mpmc_queue_count(queue) == 4);
+
+		I32 value = -1;
+		for (I32 i = 0; i < 4; ++i)
+		{
+			TESTER_CHECK(mpmc_queue_pop(queue, value));
+			TESTER_CHECK(value == i);
+		}
+		TESTER_CHECK(!mpmc_queue_pop(queue, value));
+
+		// Second lap reuses the cells.
+		TESTER_CHECK(mpmc_queue_push(queue, 42));
+		TESTER_CHECK(mpmc_queue_pop(queue, value));
+		TESTER_CHECK(value == 42);
+	}
+
+	// ("batch push / pop with wrap-around")
+	{
+		auto queue = mpmc_queue_init<I32>(8);
+		DEFER(mpmc_queue_deinit(queue));
+
+		I32 input[] = {0, 1, 2, 3, 4, 5};
+		I32 output[8] = {};
+		TESTER_CHECK(mpmc_queue_push_batch(queue, slice_from(input)) == 6);
+		TESTER_CHECK(mpmc_queue_pop_batch(queue, slice_from(output, 4)) == 4);
+		TESTER_CHECK(output[0] == 0 && output[3] == 3);
+
+		I32 more[] = {6, 7, 8, 9, 10, 11, 12, 13};
+		TESTER_CHECK(mpmc_queue_push_batch(queue, slice_from(more)) == 6);
+		TESTER_CHECK(mpmc_queue_pop_batch(queue, slice_from(output)) == 8);
+		for (I32 i = 0; i < 8; ++i)
+			TESTER_CHECK(output[i] == i + 4);
+		TESTER_CHECK(mpmc_queue_pop_batch(queue, slice_from(output)) == 0);
+		TESTER_CHECK(mpmc_queue_is_empty(queue));
+	}
+}
+
+struct Mpmc_Queue_Test_Context
+{
+	Mpmc_Queue<U64> *queue;
+	Atomic<U64> *consumed_count;
+	Atomic<U64> *consumed_sum;
+	U64 item_count;
+	U64 producer_count;
+	U64 producer_index;
+	bool use_batch;
+};
+
+inline static void
+_mpmc_queue_test_producer(void *data)
+{
+	Mpmc_Queue_Test_Context *context = (Mpmc_Queue_Test_Context *)data;
+	U64 begin = context->producer_index * context->item_count;
+	U64 end = begin + context->item_count;
+	if (context->use_batch)
+	{
+		U64 values[8];
+		for (U64 i = begin; i < end;)
+		{
+			U64 count = u64_min(end - i, count_of(values));
+			for (U64 j = 0; j < count; ++j)
+				values[j] = i + j;
+			U64 pushed = mpmc_queue_push_batch(*context->queue, slice_from(values, count));
+			if (pushed == 0)
+				compiler_cpu_pause();
+			i += pushed;
+		}
+	}
+	else
+	{
+		for (U64 i = begin; i < end; ++i)
+			while (!mpmc_queue_push(*context->queue, i))
+				compiler_cpu_pause();
+	}
+}
+
+inline static void
+_mpmc_queue_test_consumer(void *data)
+{
+	Mpmc_Queue_Test_Context *context = (Mpmc_Queue_Test_Context *)data;
+	U64 total_count = context->item_count * context->producer_count;
+	U64 values[8];
+	while (atomic_load(*context->consumed_count) < total_count)
+	{
+		U64 count = 0;
+		if (context->use_batch)
+			count = mpmc_queue_pop_batch(*context->queue, slice_from(values));
+		else
+			count = mpmc_queue_pop(*context->queue, values[0]) ? 1 : 0;
+
+		if (count == 0)
+		{
+			compiler_cpu_pause();
+			continue;
+		}
+
+		U64 sum = 0;
+		for (U64 i = 0; i < count; ++i)
+			sum += values[i];
+		atomic_fetch_add(*context->consumed_sum, sum);
+		atomic_fetch_add(*context->consumed_count, count);
+	}
+}
+
+TESTER_TEST("[CONTAINERS]: Mpmc_Queue Threads")
+{
+	constexpr U64 PRODUCER_COUNT = 3;
+	constexpr U64 CONSUMER_COUNT = 3;
+	constexpr U64 ITEM_COUNT = 10000;
+	constexpr U64 TOTAL_COUNT = PRODUCER_COUNT * ITEM_COUNT;
+
+	for (bool use_batch : {false, true})
+	{
+		auto queue = mpmc_queue_init<U64>(1024);
+		DEFER(mpmc_queue_deinit(queue));
+
+		Atomic<U64> consumed_count = atomic_init((U64)0);
+		Atomic<U64> consumed_sum = atomic_init((U64)0);
+		Mpmc_Queue_Test_Context contexts[PRODUCER_COUNT + CONSUMER_COUNT];
+		Platform_Thread *threads[PRODUCER_COUNT + CONSUMER_COUNT];
+		for (U64 i = 0; i < PRODUCER_COUNT + CONSUMER_COUNT; ++i)
+		{
+			contexts[i] = Mpmc_Queue_Test_Context {
+				.queue = &queue,
+				.consumed_count = &consumed_count,
+				.consumed_sum = &consumed_sum,
+				.item_count = ITEM_COUNT,
+				.producer_count = PRODUCER_COUNT,
+				.producer_index = i,
+				.use_batch = use_batch
+			};
+			threads[i] = platform_thread_init(Platform_Thread_Desc {
+				.function = i < PRODUCER_COUNT ? _mpmc_queue_test_producer : _mpmc_queue_test_consumer,
+				.data = &contexts[i],
+				.name = "MpmcQueueTest"
+			});
+		}
+
+		for (U64 i = 0; i < PRODUCER_COUNT + CONSUMER_COUNT; ++i)
+			platform_thread_deinit(threads[i]);
+
+		TESTER_CHECK(atomic_load(consumed_count) == TOTAL_COUNT);
+		TESTER_CHECK(atomic_load(consumed_sum) == TOTAL_COUNT * (TOTAL_COUNT - 1) / 2);
+		TESTER_CHECK(mpmc_queue_is_empty(queue));
+	}
+}
+
+TESTER_TEST("[CONTAINERS]: Bit_Array")
+{
+	// ("init")
+	{
+		auto bits = bit_array_init();
+		DEFER(bit_array_deinit(bits));
+
+		TESTER_CHECK(bits.words    == nullptr);
+		TESTER_CHECK(bits.count    == 0);
+		TESTER_CHECK(bits.capacity == 0);
+		TESTER_CHECK(bit_array_none(bits));
+		TESTER_CHECK(bit_array_find_next_set(bits) == 0);
+
+		U64 visited_count = 0;
+		for (U64 index : bit_array_set_bits(bits))
+		{
+			unused(index);
+			++visited_count;
+		}
+		TESTER_CHECK(visited_count == 0);
+	}
+
+	// ("set / unset / get")
+	{
+		auto bits = bit_array_init_with_count(130);
+		DEFER(bit_array_deinit(bits));
+
+		TESTER_CHECK(bits.count == 130);
+		TESTER_CHECK(bit_array_count_set(bits) == 0);
+
+		bit_array_set(bits, 0);
+		bit_array_set(bits, 63);
+		bit_array_set(bits, 64);
+		bit_array_set(bits, 129);
+		TESTER_CHECK(bit_array_get(bits, 0));
+		TESTER_CHECK(bits[63]);
+		TESTER_CHECK(bits[64]);
+		TESTER_CHECK(bits[129]);
+		TESTER_CHECK(bits[1] == false);
+		TESTER_CHECK(bit_array_count_set(bits) == 4);
+		TESTER_CHECK(bit_array_any(bits));
+
+		bit_array_unset(bits, 63);
+		TESTER_CHECK(bits[63] == false);
+		TESTER_CHECK(bit_array_count_set(bits) == 3);
+	}
+
+	// ("set_all / unset_all")
+	{
+		auto bits = bit_array_init_with_count(200);
+		DEFER(bit_array_deinit(bits));
+
+		bit_array_set_all(bits);
+		TESTER_CHECK(bit_array_count_set(bits) == 200);
+		TESTER_CHECK(bit_array_find_next_unset(bits) == 200);
+
+		bit_array_unset_all(bits);
+		TESTER_CHECK(bit_array_count_set(bits) == 0);
+		TESTER_CHECK(bit_array_none(bits));
+	}
+
+	// ("find_next_set / find_next_unset")
+	{
+		auto bits = bit_array_init_with_count(300);
+		DEFER(bit_array_deinit(bits));
+
+		bit_array_set(bits, 5);
+		bit_array_set(bits, 70);
+		bit_array_set(bits, 299);
+		TESTER_CHECK(bit_array_find_next_set(bits)      == 5);
+		TESTER_CHECK(bit_array_find_next_set(bits, 5)   == 5);
+		TESTER_CHECK(bit_array_find_next_set(bits, 6)   == 70);
+		TESTER_CHECK(bit_array_find_next_set(bits, 71)  == 299);
+		TESTER_CHECK(bit_array_find_next_set(bits, 300) == 300);
+
+		bit_array_set_all(bits);
+		bit_array_unset(bits, 128);
+		TESTER_CHECK(bit_array_find_next_unset(bits)      == 128);
+		TESTER_CHECK(bit_array_find_next_unset(bits, 129) == 300);
+	}
+
+	// ("set bits iteration")
+	{
+		auto bits = bit_array_init_with_count(1000);
+		DEFER(bit_array_deinit(bits));
+
+		for (U64 i = 0; i < bits.count; i += 7)
+			bit_array_set(bits, i);
+
+		U64 expected = 0;
+		U64 visited_count = 0;
+		for (U64 index : bit_array_set_bits(bits))
+		{
+			TESTER_CHECK(index == expected);
+			expected += 7;
+			++visited_count;
+		}
+		TESTER_CHECK(visited_count == bit_array_count_set(bits));
+		TESTER_CHECK(visited_count == 143);
+	}
+
+	// ("and / or / and_not")
+	{
+		auto a = bit_array_init_with_count(517);
+		auto b = bit_array_init_with_count(517);
+		DEFER(bit_array_deinit(a); bit_array_deinit(b));
+
+		for (U64 i = 0; i < a.count; ++i)
+		{
+			if (i % 2 == 0)
+				bit_array_set(a, i);
+			if (i % 3 == 0)
+				bit_array_set(b, i);
+		}
+
+		auto and_bits = bit_array_copy(a);
+		auto or_bits = bit_array_copy(a);
+		auto and_not_bits = clone(a);
+		DEFER(bit_array_deinit(and_bits); bit_array_deinit(or_bits); bit_array_deinit(and_not_bits));
+
+		bit_array_and(and_bits, b);
+		bit_array_or(or_bits, b);
+		bit_array_and_not(and_not_bits, b);
+
+		bool all_match = true;
+		for (U64 i = 0; i < a.count; ++i)
+		{
+			all_match &= and_bits[i]     == (i % 2 == 0 && i % 3 == 0);
+			all_match &= or_bits[i]      == (i % 2 == 0 || i % 3 == 0);
+			all_match &= and_not_bits[i] == (i % 2 == 0 && i % 3 != 0);
+		}
+		TESTER_CHECK(all_match);
+		TESTER_CHECK(bit_array_count_set(and_bits) == 87);
+	}
+
+	// ("resize")
+	{
+		auto bits = bit_array_init();
+		DEFER(bit_array_deinit(bits));
+
+		bit_array_resize(bits, 100);
+		TESTER_CHECK(bits.count == 100);
+		TESTER_CHECK(bit_array_none(bits));
+
+		bit_array_set_all(bits);
+		bit_array_resize(bits, 70);
+		TESTER_CHECK(bit_array_count_set(bits) == 70);
+
+		bit_array_resize(bits, 1000);
+		TESTER_CHECK(bit_array_count_set(bits) == 70);
+		TESTER_CHECK(bit_array_find_next_unset(bits) == 70);
+	}
+}
+
+TESTER_TEST("[CONTAINERS]: Stack_Bit_Array")
+{
+	// ("set / unset / get")
+	{
+		Stack_Bit_Array<100> bits;
+		TESTER_CHECK(stack_bit_array_none(bits));
+
+		stack_bit_array_set(bits, 3);
+		stack_bit_array_set(bits, 99);
+		TESTER_CHECK(bits[3]);
+		TESTER_CHECK(stack_bit_array_get(bits, 99));
+		TESTER_CHECK(stack_bit_array_count_set(bits) == 2);
+		TESTER_CHECK(stack_bit_array_find_next_set(bits, 4) == 99);
+
+		stack_bit_array_unset(bits, 3);
+		TESTER_CHECK(bits[3] == false);
+		TESTER_CHECK(stack_bit_array_find_next_set(bits) == 99);
+	}
+
+	// ("set_all / operations / iteration")
+	{
+		Stack_Bit_Array<300> a;
+		Stack_Bit_Array<300> b;
+		stack_bit_array_set_all(a);
+		TESTER_CHECK(stack_bit_array_count_set(a) == 300);
+
+		for (U64 i = 0; i < 300; i += 10)
+			stack_bit_array_set(b, i);
+
+		stack_bit_array_and_not(a, b);
+		TESTER_CHECK(stack_bit_array_count_set(a) == 270);
+		TESTER_CHECK(stack_bit_array_find_next_unset(a) == 0);
+
+		stack_bit_array_or(a, b);
+		TESTER_CHECK(stack_bit_array_count_set(a) == 300);
+
+		stack_bit_array_and(a, b);
+		U64 expected = 0;
+		for (U64 index : stack_bit_array_set_bits(a))
+		{
+			TESTER_CHECK(index == expected);
+			expected += 10;
+		}
+		TESTER_CHECK(expected == 300);
+
+		stack_bit_array_unset_all(a);
+		TESTER_CHECK(stack_bit_array_none(a));
+	}
+}
+
+TESTER_TEST("[CONTAINERS]: B_Tree_Map")
+{
+	// ("insert / find / overwrite")
+	{
+		auto map = b_tree_map_init<U64, U64>();
+		DEFER(b_tree_map_deinit(map));
+		TESTER_CHECK(map.count == 0);
+		TESTER_CHECK(b_tree_map_find(map, (U64)1) == nullptr);
+		TESTER_CHECK(begin(map) == end(map));
+
+		for (U64 i = 0; i < 1000; ++i)
+			b_tree_map_insert(map, (i * 7919) % 1000, i);
+		TESTER_CHECK(map.count == 1000);
+		TESTER_CHECK(map.height > 1);
+
+		for (U64 i = 0; i < 1000; ++i)
+		{
+			U64 *value = b_tree_map_find(map, (i * 7919) % 1000);
+			TESTER_CHECK(value != nullptr && *value == i);
+		}
+		TESTER_CHECK(!b_tree_map_contains(map, (U64)1000));
+
+		U64 *value = b_tree_map_insert(map, (U64)5, (U64)42);
+		TESTER_CHECK(*value == 42);
+		TESTER_CHECK(*b_tree_map_find(map, (U64)5) == 42);
+		TESTER_CHECK(map.count == 1000);
+	}
+
+	// ("sorted iteration")
+	{
+		auto map = b_tree_map_init<I32, I32>();
+		DEFER(b_tree_map_deinit(map));
+		for (I32 i = 0; i < 500; ++i)
+			b_tree_map_insert(map, 499 - i, i);
+
+		I32 expected = 0;
+		for (auto [key, value] : map)
+		{
+			TESTER_CHECK(key == expected);
+			TESTER_CHECK(value == 499 - expected);
+			value = -key;
+			++expected;
+		}
+		TESTER_CHECK(expected == 500);
+		TESTER_CHECK(*b_tree_map_find(map, 10) == -10);
+	}
+
+	// ("lower_bound / upper_bound / range")
+	{
+		auto map = b_tree_map_init<U32, U32>();
+		DEFER(b_tree_map_deinit(map));
+		for (U32 i = 0; i < 1000; ++i)
+			b_tree_map_insert(map, i * 2, i);
+
+		TESTER_CHECK((*b_tree_map_lower_bound(map, 10u)).key == 10);
+		TESTER_CHECK((*b_tree_map_lower_bound(map, 11u)).key == 12);
+		TESTER_CHECK((*b_tree_map_upper_bound(map, 10u)).key == 12);
+		TESTER_CHECK(b_tree_map_lower_bound(map, 1999u) == end(map));
+		TESTER_CHECK(b_tree_map_upper_bound(map, 1998u) == end(map));
+
+		U32 expected = 100;
+		for (auto [key, value] : b_tree_map_range(map, 100u, 301u))
+		{
+			TESTER_CHECK(key == expected);
+			TESTER_CHECK(value == expected / 2);
+			expected += 2;
+		}
+		TESTER_CHECK(expected == 302);
+
+		U64 count = 0;
+		for (auto entry : b_tree_map_range(map, 301u, 100u))
+		{
+			unused(entry);
+			++count;
+		}
+		TESTER_CHECK(count == 0);
+
+		// A const map only hands out const values.
+		const B_Tree_Map<U32, U32> &const_map = map;
+		static_assert(std::is_same_v<decltype((*begin(const_map)).value), const U32 &>);
+		static_assert(std::is_same_v<decltype((*b_tree_map_lower_bound(const_map, 10u)).value), const U32 &>);
+		static_assert(std::is_same_v<decltype((*begin(b_tree_map_range(const_map, 100u, 301u))).value), const U32 &>);
+		static_assert(std::is_same_v<decltype((*begin(map)).value), U32 &>);
+		TESTER_CHECK((*b_tree_map_lower_bound(const_map, 11u)).key == 12);
+		TESTER_CHECK((*b_tree_map_upper_bound(const_map, 10u)).key == 12);
+		TESTER_CHECK(b_tree_map_upper_bound(const_map, 1998u) == end(const_map));
+
+		count = 0;
+		for (auto [key, value] : b_tree_map_range(const_map, 100u, 301u))
+			count += value;
+		TESTER_CHECK(count == (50 + 150) * 101 / 2);
+	}
+
+	// ("random insert / remove against reference")
+	{
+		constexpr U64 KEY_COUNT = 4096;
+		auto map = b_tree_map_init<U64, U64>();
+		auto reference = array_init_with_count<U64>(KEY_COUNT);
+		DEFER(b_tree_map_deinit(map); array_deinit(reference));
+		for (U64 &value : reference)
+			value = U64_MAX;
+
+		U64 state = 0x9E3779B97F4A7C15ull;
+		U64 reference_count = 0;
+		for (U64 i = 0; i < 40000; ++i)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			U64 key = (state >> 33) % KEY_COUNT;
+			if ((state >> 20) % 3 == 0)
+			{
+				bool removed = b_tree_map_remove(map, key);
+				TESTER_CHECK(removed == (reference[key] != U64_MAX));
+				if (removed)
+					--reference_count;
+				reference[key] = U64_MAX;
+			}
+			else
+			{
+				if (reference[key] == U64_MAX)
+					++reference_count;
+				b_tree_map_insert(map, key, i);
+				reference[key] = i;
+			}
+		}
+		TESTER_CHECK(map.count == reference_count);
+
+		U64 visited = 0;
+		U64 previous_key = 0;
+		for (auto [key, value] : map)
+		{
+			TESTER_CHECK(visited == 0 || previous_key < key);
+			TESTER_CHECK(reference[key] == value);
+			previous_key = key;
+			++visited;
+		}
+		TESTER_CHECK(visited == reference_count);
+
+		for (U64 key = 0; key < KEY_COUNT; ++key)
+			b_tree_map_remove(map, key);
+		TESTER_CHECK(map.count == 0);
+		TESTER_CHECK(map.root == nullptr);
+		TESTER_CHECK(begin(map) == end(map));
+	}
+
+	// ("bulk load")
+	{
+		auto entries = array_init<B_Tree_Map_Entry<U64, U64>>();
+		DEFER(array_deinit(entries));
+		for (U64 i = 0; i < 10000; ++i)
+			array_push(entries, B_Tree_Map_Entry<U64, U64>{i * 3, i});
+
+		auto map = b_tree_map_init_from_sorted<U64, U64>(slice_from(entries));
+		DEFER(b_tree_map_deinit(map));
+		TESTER_CHECK(map.count == 10000);
+
+		U64 expected = 0;
+		for (auto [key, value] : map)
+		{
+			TESTER_CHECK(key == expected * 3 && value == expected);
+			++expected;
+		}
+		TESTER_CHECK(expected == 10000);
+		TESTER_CHECK(*b_tree_map_find(map, (U64)2997) == 999);
+
+		for (U64 i = 0; i < 10000; i += 2)
+			TESTER_CHECK(b_tree_map_remove(map, i * 3));
+		b_tree_map_insert(map, (U64)1, (U64)1);
+		TESTER_CHECK(map.count == 5001);
+		TESTER_CHECK((*b_tree_map_upper_bound(map, (U64)0)).key == 1);
+		TESTER_CHECK((*b_tree_map_upper_bound(map, (U64)1)).key == 3);
+	}
+
+	// ("copy / clone")
+	{
+		auto map = b_tree_map_init<U64, String>();
+		DEFER(destroy(map));
+		b_tree_map_insert(map, (U64)2, string_from("two"));
+		b_tree_map_insert(map, (U64)1, string_from("one"));
+
+		auto copy = b_tree_map_copy(map);
+		DEFER(b_tree_map_deinit(copy));
+		TESTER_CHECK(copy.count == 2);
+		TESTER_CHECK(b_tree_map_find(copy, (U64)1)->data == b_tree_map_find(map, (U64)1)->data);
+
+		auto cloned = clone(map);
+		DEFER(destroy(cloned));
+		TESTER_CHECK(cloned.count == 2);
+		TESTER_CHECK(*b_tree_map_find(cloned, (U64)2) == "two");
+		TESTER_CHECK(b_tree_map_find(cloned, (U64)2)->data != b_tree_map_find(map, (U64)2)->data);
+	}
+
+	// ("pool allocator")
+	{
+		memory::Pool_Allocator *pool = memory::pool_allocator_init(B_Tree_Map<U64, U64>::NODE_SIZE, 64);
+		DEFER(memory::pool_allocator_deinit(pool));
+
+		auto map = b_tree_map_init<U64, U64>(pool);
+		DEFER(b_tree_map_deinit(map));
+		for (U64 i = 0; i < 5000; ++i)
+			b_tree_map_insert(map, i, i * i);
+		for (U64 i = 0; i < 5000; i += 3)
+			b_tree_map_remove(map, i);
+		for (U64 i = 0; i < 5000; ++i)
+		{
+			const U64 *value = b_tree_map_find(map, i);
+			TESTER_CHECK(i % 3 == 0 ? value == nullptr : *value == i * i);
+		}
+	}
+}
+
+TESTER_TEST("[CONTAINERS]: Handle_Pool")
+{
+	// ("insert / get / remove")
+	{
+		auto pool = handle_pool_init<I32>();
+		DEFER(handle_pool_deinit(pool));
+
+		Handle<I32> invalid = {};
+		TESTER_CHECK(!handle_pool_is_valid(pool, invalid));
+		TESTER_CHECK(handle_pool_get(pool, invalid) == nullptr);
+
+		Handle<I32> a = handle_pool_insert(pool, 1);
+		Handle<I32> b = handle_pool_insert(pool, 2);
+		Handle<I32> c = handle_pool_insert(pool, 3);
+		TESTER_CHECK(pool.count == 3);
+		TESTER_CHECK(pool[a] == 1);
+		TESTER_CHECK(*handle_pool_get(pool, b) == 2);
+		TESTER_CHECK(pool[c] == 3);
+
+		TESTER_CHECK(handle_pool_remove(pool, a));
+		TESTER_CHECK(!handle_pool_remove(pool, a));
+		TESTER_CHECK(pool.count == 2);
+		TESTER_CHECK(!handle_pool_is_valid(pool, a));
+		TESTER_CHECK(handle_pool_get(pool, a) == nullptr);
+		TESTER_CHECK(pool[b] == 2);
+		TESTER_CHECK(pool[c] == 3);
+
+		pool[c] = 30;
+		TESTER_CHECK(*handle_pool_get(pool, c) == 30);
+	}
+
+	// ("stale handles after slot reuse")
+	{
+		auto pool = handle_pool_init<U64>();
+		DEFER(handle_pool_deinit(pool));
+
+		Handle<U64> first = handle_pool_insert(pool, (U64)10);
+		handle_pool_remove(pool, first);
+		Handle<U64> second = handle_pool_insert(pool, (U64)20);
+		TESTER_CHECK(second.index == first.index);
+		TESTER_CHECK(second.generation != first.generation);
+		TESTER_CHECK(second != first);
+		TESTER_CHECK(handle_pool_get(pool, first) == nullptr);
+		TESTER_CHECK(pool[second] == 20);
+
+		handle_pool_clear(pool);
+		TESTER_CHECK(pool.count == 0);
+		TESTER_CHECK(!handle_pool_is_valid(pool, second));
+		Handle<U64> third = handle_pool_insert(pool, (U64)30);
+		TESTER_CHECK(third.index == first.index);
+		TESTER_CHECK(pool[third] == 30);
+	}
+
+	// ("dense iteration")
+	{
+		auto pool = handle_pool_init<U64>();
+		auto handles = array_init<Handle<U64>>();
+		DEFER(handle_pool_deinit(pool); array_deinit(handles));
+
+		for (U64 i = 0; i < 1000; ++i)
+			array_push(handles, handle_pool_insert(pool, i));
+		for (U64 i = 0; i < 1000; i += 2)
+			TESTER_CHECK(handle_pool_remove(pool, handles[i]));
+		TESTER_CHECK(pool.count == 500);
+		TESTER_CHECK(pool.values.count == 500);
+
+		U64 sum = 0;
+		for (U64 value : pool)
+		{
+			TESTER_CHECK(value % 2 == 1);
+			sum += value;
+		}
+		TESTER_CHECK(sum == 250000);
+
+		for (U64 i = 0; i < pool.values.count; ++i)
+		{
+			Handle<U64> handle = handle_pool_handle_at(pool, i);
+			TESTER_CHECK(handle == handles[pool.values[i]]);
+		}
+
+		for (U64 i = 0; i < 1000; ++i)
+		{
+			const U64 *value = handle_pool_get(pool, handles[i]);
+			TESTER_CHECK(i % 2 == 0 ? value == nullptr : *value == i);
+		}
+	}
+
+	// ("copy / clone")
+	{
+		auto pool = handle_pool_init<String>();
+		DEFER(destroy(pool));
+		Handle<String> a = handle_pool_insert(pool, string_from("a"));
+		Handle<String> b = handle_pool_insert(pool, string_from("b"));
+
+		auto cloned = clone(pool);
+		DEFER(destroy(cloned));
+		TESTER_CHECK(cloned.count == 2);
+		TESTER_CHECK(cloned[a] == "a");
+		TESTER_CHECK(cloned[b] == "b");
+		TESTER_CHECK(cloned[a].data != pool[a].data);
+
+		auto copy = handle_pool_copy(pool);
+		DEFER(handle_pool_deinit(copy));
+		TESTER_CHECK(copy[b].data == pool[b].data);
+	}
 }
\ No newline at end of file
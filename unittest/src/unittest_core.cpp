@@ -1,12 +1,16 @@
 #include <core/tester.h>
 #include <core/atomic.h>
 #include <core/command_line.h>
+#include <core/ecs.h>
 #include <core/json.h>
 #include <core/base64.h>
 #include <core/log.h>
 #include <core/result.h>
 #include <core/scheduler.h>
+#include <core/scheduler_coroutine.h>
+#include <core/sort.h>
 #include <core/validate.h>
+#include <core/math/u32.h>
 #include <core/memory/allocator.h>
 #include <core/memory/pool_allocator.h>
 #include <core/memory/arena_allocator.h>
@@ -426,6 +430,62 @@ TESTER_TEST("[CORE]: Scheduler Worker Queries")
 	scheduler_deinit(scheduler);
 }
 
+TESTER_TEST("[CORE]: Scheduler Pinned Workers")
+{
+	Scheduler *unpinned_scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 2
+	});
+	TESTER_CHECK(scheduler_get_worker_processor(unpinned_scheduler, 0) == U32_MAX);
+	TESTER_CHECK(scheduler_get_worker_processor(unpinned_scheduler, 1) == U32_MAX);
+	scheduler_deinit(unpinned_scheduler);
+
+	Array<Platform_Processor> processors = platform_get_processor_topology();
+	DEFER(array_deinit(processors));
+
+	// More workers than processors wraps around, replacement workers included.
+	U32 worker_processors[] = {processors[0].index};
+	Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 2,
+		.replacement_worker_count = 1,
+		.is_pinned = true,
+		.worker_processors = worker_processors
+	});
+	for (U32 i = 0; i < 3; ++i)
+		TESTER_CHECK(scheduler_get_worker_processor(scheduler, i) == processors[0].index);
+
+	U32 values[1024] = {};
+	scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+		.count = 1024,
+		.function = [](U32 begin, U32 end, void *data) {
+			U32 *values = (U32 *)data;
+			for (U32 i = begin; i < end; ++i)
+				values[i] = i;
+		},
+		.data = values
+	});
+	U32 mismatch_count = 0;
+	for (U32 i = 0; i < 1024; ++i)
+		mismatch_count += values[i] != i;
+	TESTER_CHECK(mismatch_count == 0);
+	scheduler_deinit(scheduler);
+
+	// Default placement takes distinct processors while there are enough of them.
+	U32 worker_count = (U32)u64_min(processors.count, 4);
+	Scheduler *spread_scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = worker_count,
+		.is_pinned = true
+	});
+	U32 duplicate_count = 0;
+	for (U32 i = 0; i < worker_count; ++i)
+	{
+		U32 processor_index = scheduler_get_worker_processor(spread_scheduler, i);
+		for (U32 j = 0; j < i; ++j)
+			duplicate_count += scheduler_get_worker_processor(spread_scheduler, j) == processor_index;
+	}
+	TESTER_CHECK(duplicate_count == 0);
+	scheduler_deinit(spread_scheduler);
+}
+
 struct Scheduler_Test_Worker_Blocking_Context
 {
 	Scheduler *scheduler;
@@ -795,6 +855,7 @@ TESTER_TEST("[CORE]: Scheduler Stats")
 	TESTER_CHECK(stats.blocked_worker_count == 1);
 	TESTER_CHECK(stats.active_task_count == 1);
 	TESTER_CHECK(stats.queued_task_count == TASK_COUNT);
+	TESTER_CHECK(stats.queued_task_counts[SCHEDULER_PRIORITY_NORMAL] == TASK_COUNT);
 	TESTER_CHECK(stats.live_group_count == 1);
 
 	platform_mutex_lock(mutex);
@@ -936,6 +997,185 @@ TESTER_TEST("[CORE]: Scheduler Submit Batch")
 	platform_mutex_deinit(mutex);
 }
 
+struct Scheduler_Test_Closure_Payload
+{
+	Atomic<U32> *destroyed_count;
+	U32 values[64];
+
+	Scheduler_Test_Closure_Payload(Atomic<U32> *destroyed_count)
+		: destroyed_count(destroyed_count), values{}
+	{
+	}
+
+	Scheduler_Test_Closure_Payload(const Scheduler_Test_Closure_Payload &other)
+		: destroyed_count(other.destroyed_count)
+	{
+		::memcpy(values, other.values, sizeof(values));
+	}
+
+	~Scheduler_Test_Closure_Payload()
+	{
+		atomic_fetch_add(*destroyed_count, (U32)1);
+	}
+};
+
+TESTER_TEST("[CORE]: Scheduler Submit Fn")
+{
+	constexpr U32 TASK_COUNT = 256;
+
+	Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 2
+	});
+	Scheduler_Group *group = scheduler_group_init(scheduler);
+
+	// Captures that fit stay inline in the queue entry.
+	Atomic<U32> sum = atomic_init((U32)0);
+	for (U32 i = 0; i < TASK_COUNT; ++i)
+	{
+		scheduler_submit_fn(scheduler, [&sum, i]() {
+			atomic_fetch_add(sum, i);
+		}, group);
+	}
+	scheduler_wait_group(scheduler, group);
+	TESTER_CHECK(atomic_load(sum) == TASK_COUNT * (TASK_COUNT - 1) / 2);
+
+	// Large captures go to closure blocks, submitted both from outside and from workers, which recycle them.
+	Atomic<U32> large_sum = atomic_init((U32)0);
+	U32 values[32] = {};
+	for (U32 i = 0; i < 32; ++i)
+		values[i] = i;
+	for (U32 i = 0; i < TASK_COUNT; ++i)
+	{
+		scheduler_submit_fn(scheduler, [scheduler, group, &large_sum, values]() {
+			scheduler_submit_fn(scheduler, [&large_sum, values]() {
+				for (U32 value : values)
+					atomic_fetch_add(large_sum, value);
+			}, group);
+		}, group);
+	}
+	scheduler_wait_group(scheduler, group);
+	TESTER_CHECK(atomic_load(large_sum) == TASK_COUNT * 32 * 31 / 2);
+
+	// Captures that are not trivially copyable are destroyed exactly once, after they run.
+	Atomic<U32> destroyed_count = atomic_init((U32)0);
+	Atomic<U32> run_count = atomic_init((U32)0);
+	{
+		Scheduler_Test_Closure_Payload payload = {&destroyed_count};
+		for (U32 i = 0; i < TASK_COUNT; ++i)
+		{
+			scheduler_submit_fn(scheduler, [&run_count, payload]() {
+				atomic_fetch_add(run_count, (U32)1 + payload.values[0]);
+			}, group);
+		}
+		scheduler_wait_group(scheduler, group);
+	}
+	TESTER_CHECK(atomic_load(run_count) == TASK_COUNT);
+	TESTER_CHECK(atomic_load(destroyed_count) == TASK_COUNT * 2 + 1);
+
+	scheduler_group_deinit(scheduler, group);
+	scheduler_deinit(scheduler);
+}
+
+inline static void
+_scheduler_test_traced_blocking_task(void *data)
+{
+	Scheduler *scheduler = (Scheduler *)data;
+	scheduler_worker_block_ahead(scheduler);
+	platform_thread_sleep(1);
+	scheduler_worker_block_clear(scheduler);
+}
+
+inline static U32
+_scheduler_test_count_trace_events(const JSON_Value &trace, const char *name)
+{
+	JSON_Value events = json_value_object_find(trace, "traceEvents");
+	U32 count = 0;
+	for (const JSON_Value &event : events.as_array)
+		count += json_value_object_find(event, "name").as_string == name;
+	return count;
+}
+
+TESTER_TEST("[CORE]: Scheduler Tracing")
+{
+	constexpr U32 TASK_COUNT = 64;
+
+	Scheduler *untraced_scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 2
+	});
+	Platform_Mutex *mutex = platform_mutex_init();
+	Scheduler_Test_Task_Context context = {
+		.mutex = mutex
+	};
+	for (U32 i = 0; i < TASK_COUNT; ++i)
+		scheduler_submit(untraced_scheduler, Scheduler_Task{.function = _scheduler_test_task, .data = &context});
+	scheduler_wait_all(untraced_scheduler);
+
+	Scheduler_Stats stats = scheduler_get_stats(untraced_scheduler);
+	TESTER_CHECK(stats.trace_task_count == 0);
+	TESTER_CHECK(stats.trace_park_count == 0);
+	TESTER_CHECK(stats.trace_dropped_event_count == 0);
+	{
+		auto [trace, error] = json_value_from_string(scheduler_trace_to_json(untraced_scheduler, memory::temp_allocator()), memory::temp_allocator());
+		TESTER_CHECK(error == false);
+		TESTER_CHECK(_scheduler_test_count_trace_events(trace, "thread_name") == 3);
+		TESTER_CHECK(_scheduler_test_count_trace_events(trace, "Task") == 0);
+	}
+	scheduler_deinit(untraced_scheduler);
+
+	Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 2,
+		.replacement_worker_count = 1,
+		.trace_event_capacity = 1024
+	});
+	Scheduler_Group *group = scheduler_group_init(scheduler);
+	for (U32 i = 0; i < TASK_COUNT; ++i)
+		scheduler_submit(scheduler, Scheduler_Task{.function = _scheduler_test_delayed_task, .data = &context}, group);
+	scheduler_submit(scheduler, Scheduler_Task{.function = _scheduler_test_traced_blocking_task, .data = scheduler}, group);
+	scheduler_wait_group(scheduler, group);
+	scheduler_group_deinit(scheduler, group);
+	scheduler_wait_all(scheduler);
+
+	stats = scheduler_get_stats(scheduler);
+	TESTER_CHECK(stats.trace_task_count == TASK_COUNT + 1);
+	TESTER_CHECK(stats.trace_task_microseconds >= TASK_COUNT * 1000);
+	TESTER_CHECK(stats.trace_block_microseconds >= 1000);
+	TESTER_CHECK(stats.trace_dropped_event_count == 0);
+	{
+		auto [trace, error] = json_value_from_string(scheduler_trace_to_json(scheduler, memory::temp_allocator()), memory::temp_allocator());
+		TESTER_CHECK(error == false);
+		TESTER_CHECK(_scheduler_test_count_trace_events(trace, "thread_name") == 4);
+		TESTER_CHECK(_scheduler_test_count_trace_events(trace, "Task") == TASK_COUNT + 1);
+		TESTER_CHECK(_scheduler_test_count_trace_events(trace, "Block") == 1);
+		TESTER_CHECK(_scheduler_test_count_trace_events(trace, "Group Wait") == 1);
+		TESTER_CHECK(_scheduler_test_count_trace_events(trace, "Steal") == stats.trace_steal_count);
+	}
+	scheduler_deinit(scheduler);
+
+	// A full buffer drops events but keeps counting them.
+	Scheduler *small_scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 1,
+		.trace_event_capacity = 4
+	});
+	for (U32 i = 0; i < TASK_COUNT; ++i)
+		scheduler_submit(small_scheduler, Scheduler_Task{.function = _scheduler_test_task, .data = &context});
+	scheduler_wait_all(small_scheduler);
+
+	stats = scheduler_get_stats(small_scheduler);
+	TESTER_CHECK(stats.trace_task_count == TASK_COUNT);
+	TESTER_CHECK(stats.trace_dropped_event_count != 0);
+	{
+		auto [trace, error] = json_value_from_string(scheduler_trace_to_json(small_scheduler, memory::temp_allocator()), memory::temp_allocator());
+		TESTER_CHECK(error == false);
+		TESTER_CHECK(_scheduler_test_count_trace_events(trace, "Task") <= 4);
+	}
+	scheduler_deinit(small_scheduler);
+
+	platform_mutex_lock(mutex);
+	TESTER_CHECK(context.finished_count == TASK_COUNT * 3);
+	platform_mutex_unlock(mutex);
+	platform_mutex_deinit(mutex);
+}
+
 TESTER_TEST("[CORE]: Scheduler Deinit Drains Tasks")
 {
 	constexpr U32 TASK_COUNT = 64;
@@ -1145,6 +1385,277 @@ TESTER_TEST("[CORE]: Scheduler Parallel For Small Chunk Stress")
 	platform_mutex_deinit(mutex);
 }
 
+struct Scheduler_Test_Lazy_Split_Context
+{
+	Scheduler *scheduler;
+	Platform_Mutex *mutex;
+	U32 next_begin;
+	bool is_sequential;
+	U32 visit_counts[64];
+	U32 worker_mask;
+};
+
+TESTER_TEST("[CORE]: Scheduler Parallel For Lazy Splitting")
+{
+	Platform_Mutex *mutex = platform_mutex_init();
+	DEFER(platform_mutex_deinit(mutex));
+
+	// ("busy workers do not split")
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 1,
+			.initial_task_queue_capacity = 16
+		});
+
+		// The only worker runs the range, so nobody is idle and the range runs front to back in single grains.
+		Scheduler_Test_Lazy_Split_Context context = {
+			.scheduler = scheduler,
+			.mutex = mutex,
+			.is_sequential = true
+		};
+		scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+			.count = 1000,
+			.chunk_size = 3,
+			.function = [](U32 begin, U32 end, void *data) {
+				Scheduler_Test_Lazy_Split_Context *context = (Scheduler_Test_Lazy_Split_Context *)data;
+				context->is_sequential &= begin == context->next_begin && end - begin <= 3;
+				context->next_begin = end;
+			},
+			.data = &context
+		});
+		TESTER_CHECK(context.is_sequential);
+		TESTER_CHECK(context.next_begin == 1000);
+
+		scheduler_deinit(scheduler);
+	}
+
+	// ("idle workers take split ranges")
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 4,
+			.initial_task_queue_capacity = 16
+		});
+
+		Scheduler_Test_Lazy_Split_Context context = {
+			.scheduler = scheduler,
+			.mutex = mutex
+		};
+		scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+			.count = 64,
+			.chunk_size = 1,
+			.function = [](U32 begin, U32 end, void *data) {
+				Scheduler_Test_Lazy_Split_Context *context = (Scheduler_Test_Lazy_Split_Context *)data;
+				U32 worker_index = scheduler_get_current_worker_index(context->scheduler);
+				platform_thread_sleep(1);
+
+				platform_mutex_lock(context->mutex);
+				for (U32 i = begin; i < end; ++i)
+					++context->visit_counts[i];
+				context->worker_mask |= 1u << worker_index;
+				platform_mutex_unlock(context->mutex);
+			},
+			.data = &context
+		});
+
+		bool is_visited_once = true;
+		for (U32 visit_count : context.visit_counts)
+			is_visited_once &= visit_count == 1;
+		TESTER_CHECK(is_visited_once);
+		TESTER_CHECK(u32_popcount(context.worker_mask) > 1);
+
+		scheduler_deinit(scheduler);
+	}
+}
+
+struct Scheduler_Test_Tile_Context
+{
+	Platform_Mutex *mutex;
+	U32 count_x;
+	U32 count_y;
+	U32 tile_size_x;
+	U32 tile_size_y;
+	U32 tile_size_z;
+	U8 *visit_counts;
+	bool is_tile_bounded;
+};
+
+inline static void
+_scheduler_test_tile(Scheduler_Tile tile, void *data)
+{
+	Scheduler_Test_Tile_Context *context = (Scheduler_Test_Tile_Context *)data;
+	platform_mutex_lock(context->mutex);
+	context->is_tile_bounded &= tile.end_x - tile.begin_x <= context->tile_size_x && tile.begin_x % context->tile_size_x == 0;
+	context->is_tile_bounded &= tile.end_y - tile.begin_y <= context->tile_size_y && tile.begin_y % context->tile_size_y == 0;
+	context->is_tile_bounded &= tile.end_z - tile.begin_z <= context->tile_size_z && tile.begin_z % context->tile_size_z == 0;
+	for (U32 z = tile.begin_z; z < tile.end_z; ++z)
+		for (U32 y = tile.begin_y; y < tile.end_y; ++y)
+			for (U32 x = tile.begin_x; x < tile.end_x; ++x)
+				++context->visit_counts[(z * context->count_y + y) * context->count_x + x];
+	platform_mutex_unlock(context->mutex);
+}
+
+TESTER_TEST("[CORE]: Scheduler Parallel For 2D And 3D")
+{
+	Platform_Mutex *mutex = platform_mutex_init();
+	DEFER(platform_mutex_deinit(mutex));
+
+	Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 3,
+		.initial_task_queue_capacity = 64
+	});
+	DEFER(scheduler_deinit(scheduler));
+
+	// ("2d")
+	{
+		constexpr U32 COUNT_X = 100;
+		constexpr U32 COUNT_Y = 37;
+
+		U8 visit_counts[COUNT_X * COUNT_Y] = {};
+		Scheduler_Test_Tile_Context context = {
+			.mutex = mutex,
+			.count_x = COUNT_X,
+			.count_y = COUNT_Y,
+			.tile_size_x = 16,
+			.tile_size_y = 8,
+			.tile_size_z = 1,
+			.visit_counts = visit_counts,
+			.is_tile_bounded = true
+		};
+		scheduler_parallel_for_2d(scheduler, Scheduler_Parallel_For_2D_Desc {
+			.count_x = COUNT_X,
+			.count_y = COUNT_Y,
+			.tile_size_x = 16,
+			.tile_size_y = 8,
+			.function = _scheduler_test_tile,
+			.data = &context
+		});
+
+		bool is_visited_once = true;
+		for (U8 visit_count : visit_counts)
+			is_visited_once &= visit_count == 1;
+		TESTER_CHECK(is_visited_once);
+		TESTER_CHECK(context.is_tile_bounded);
+	}
+
+	// ("3d")
+	{
+		constexpr U32 COUNT_X = 9;
+		constexpr U32 COUNT_Y = 20;
+		constexpr U32 COUNT_Z = 33;
+
+		U8 visit_counts[COUNT_X * COUNT_Y * COUNT_Z] = {};
+		Scheduler_Test_Tile_Context context = {
+			.mutex = mutex,
+			.count_x = COUNT_X,
+			.count_y = COUNT_Y,
+			.tile_size_x = 4,
+			.tile_size_y = 4,
+			.tile_size_z = 4,
+			.visit_counts = visit_counts,
+			.is_tile_bounded = true
+		};
+		scheduler_parallel_for_3d(scheduler, Scheduler_Parallel_For_3D_Desc {
+			.count_x = COUNT_X,
+			.count_y = COUNT_Y,
+			.count_z = COUNT_Z,
+			.tile_size_x = 4,
+			.tile_size_y = 4,
+			.tile_size_z = 4,
+			.function = _scheduler_test_tile,
+			.data = &context
+		});
+
+		bool is_visited_once = true;
+		for (U8 visit_count : visit_counts)
+			is_visited_once &= visit_count == 1;
+		TESTER_CHECK(is_visited_once);
+		TESTER_CHECK(context.is_tile_bounded);
+	}
+
+	// ("empty")
+	{
+		scheduler_parallel_for_2d(scheduler, Scheduler_Parallel_For_2D_Desc {
+			.count_x = 0,
+			.count_y = 10,
+			.function = _scheduler_test_tile
+		});
+		scheduler_parallel_for_3d(scheduler, Scheduler_Parallel_For_3D_Desc {
+			.count_x = 10,
+			.count_y = 10,
+			.count_z = 0,
+			.function = _scheduler_test_tile
+		});
+	}
+}
+
+TESTER_TEST("[CORE]: Scheduler Parallel Reduce And Scan")
+{
+	Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 4,
+		.initial_task_queue_capacity = 64
+	});
+	DEFER(scheduler_deinit(scheduler));
+
+	// ("reduce")
+	{
+		constexpr U32 COUNT = 100'000;
+
+		U64 sum = scheduler_parallel_reduce(scheduler, COUNT, (U64)0,
+			[](U32 begin, U32 end, U64 &partial) {
+				for (U32 i = begin; i < end; ++i)
+					partial += i;
+			},
+			[](U64 a, U64 b) { return a + b; },
+			7);
+		TESTER_CHECK(sum == (U64)COUNT * (COUNT - 1) / 2);
+
+		U32 min = scheduler_parallel_reduce(scheduler, COUNT, U32_MAX,
+			[](U32 begin, U32 end, U32 &partial) {
+				for (U32 i = begin; i < end; ++i)
+					partial = u32_min(partial, (i * 7919u + 13u) % 100'003u);
+			},
+			[](U32 a, U32 b) { return u32_min(a, b); });
+		U32 expected_min = U32_MAX;
+		for (U32 i = 0; i < COUNT; ++i)
+			expected_min = u32_min(expected_min, (i * 7919u + 13u) % 100'003u);
+		TESTER_CHECK(min == expected_min);
+
+		U64 empty_sum = scheduler_parallel_reduce(scheduler, 0, (U64)0, [](U32, U32, U64 &) {}, [](U64 a, U64 b) { return a + b; });
+		TESTER_CHECK(empty_sum == 0);
+	}
+
+	// ("scan")
+	{
+		for (U32 count : {0u, 1u, 1000u, 4096u, 100'001u})
+		{
+			Array<U64> input = array_init_with_count<U64>(count);
+			Array<U64> output = array_init_with_count<U64>(count);
+			DEFER(array_deinit(input); array_deinit(output));
+			for (U32 i = 0; i < count; ++i)
+				input[i] = i % 17;
+
+			auto add = [](U64 a, U64 b) { return a + b; };
+			scheduler_parallel_scan(scheduler, slice_from(input), slice_from(output), (U64)0, add);
+
+			bool is_scanned = true;
+			U64 running = 0;
+			for (U32 i = 0; i < count; ++i)
+			{
+				running += input[i];
+				is_scanned &= output[i] == running;
+			}
+			TESTER_CHECK(is_scanned);
+
+			// In place.
+			scheduler_parallel_scan(scheduler, slice_from(input), slice_from(input), (U64)0, add);
+			bool is_scanned_in_place = true;
+			for (U32 i = 0; i < count; ++i)
+				is_scanned_in_place &= input[i] == output[i];
+			TESTER_CHECK(is_scanned_in_place);
+		}
+	}
+}
+
 struct Scheduler_Test_Blocking_Task_Context
 {
 	Platform_Mutex *mutex;
@@ -1171,12 +1682,16 @@ _scheduler_test_blocking_task(void *data)
 struct Scheduler_Test_Stealing_Context
 {
 	Scheduler *scheduler;
+	Scheduler_Group *group;
+	Slice<const Scheduler_Task> tasks;
 	Platform_Mutex *mutex;
 	Platform_Condition_Variable *condition_variable;
 	U32 blocked_worker_index;
 	U32 finished_count;
 	U32 stolen_task_count;
 	U32 first_stolen_task_index;
+	U32 last_stolen_task_index;
+	bool is_steal_order_increasing;
 	bool block_started;
 	bool release;
 	bool blocking_finished;
@@ -1185,7 +1700,6 @@ struct Scheduler_Test_Stealing_Context
 struct Scheduler_Test_Stealing_Task
 {
 	Scheduler_Test_Stealing_Context *context;
-	U32 queued_worker_index;
 	U32 index;
 };
 
@@ -1195,8 +1709,13 @@ _scheduler_test_stealing_blocking_task(void *data)
 	Scheduler_Test_Stealing_Context *context = (Scheduler_Test_Stealing_Context *)data;
 	U32 worker_index = scheduler_get_current_worker_index(context->scheduler);
 
+	// Tasks submitted from a worker land in its own deque, so every one of them has to be stolen while it blocks.
 	platform_mutex_lock(context->mutex);
 	context->blocked_worker_index = worker_index;
+	platform_mutex_unlock(context->mutex);
+	scheduler_submit(context->scheduler, context->tasks, context->group);
+
+	platform_mutex_lock(context->mutex);
 	context->block_started = true;
 	platform_condition_variable_signal(context->condition_variable);
 	while (!context->release)
@@ -1214,10 +1733,13 @@ _scheduler_test_stealing_task(void *data)
 
 	platform_mutex_lock(context->mutex);
 	++context->finished_count;
-	if (task->queued_worker_index == context->blocked_worker_index && worker_index != context->blocked_worker_index)
+	if (worker_index != context->blocked_worker_index)
 	{
 		if (context->first_stolen_task_index == U32_MAX)
 			context->first_stolen_task_index = task->index;
+		else if (task->index < context->last_stolen_task_index)
+			context->is_steal_order_increasing = false;
+		context->last_stolen_task_index = task->index;
 		++context->stolen_task_count;
 	}
 	platform_mutex_unlock(context->mutex);
@@ -1235,34 +1757,23 @@ TESTER_TEST("[CORE]: Scheduler Steals From Blocked Worker")
 		.initial_task_queue_capacity = TASK_COUNT + 1
 	});
 	Scheduler_Group *group = scheduler_group_init(scheduler);
+
 	Scheduler_Test_Stealing_Context context = {
 		.scheduler = scheduler,
+		.group = group,
 		.mutex = mutex,
 		.condition_variable = condition_variable,
 		.blocked_worker_index = U32_MAX,
-		.first_stolen_task_index = U32_MAX
+		.first_stolen_task_index = U32_MAX,
+		.is_steal_order_increasing = true
 	};
 
-	scheduler_submit(scheduler, Scheduler_Task {
-		.function = _scheduler_test_stealing_blocking_task,
-		.data = &context
-	});
-
-	platform_mutex_lock(mutex);
-	while (!context.block_started)
-		platform_condition_variable_wait(condition_variable, mutex);
-	U32 blocked_worker_index = context.blocked_worker_index;
-	platform_mutex_unlock(mutex);
-
-	TESTER_CHECK(blocked_worker_index < WORKER_COUNT);
-
 	Scheduler_Test_Stealing_Task task_data[TASK_COUNT];
 	Scheduler_Task tasks[TASK_COUNT];
 	for (U32 i = 0; i < TASK_COUNT; ++i)
 	{
 		task_data[i] = Scheduler_Test_Stealing_Task {
 			.context = &context,
-			.queued_worker_index = (1 + i) % WORKER_COUNT,
 			.index = i
 		};
 		tasks[i] = Scheduler_Task {
@@ -1270,26 +1781,38 @@ TESTER_TEST("[CORE]: Scheduler Steals From Blocked Worker")
 			.data = &task_data[i]
 		};
 	}
+	context.tasks = slice_from(tasks);
+
+	scheduler_submit(scheduler, Scheduler_Task {
+		.function = _scheduler_test_stealing_blocking_task,
+		.data = &context
+	});
+
+	platform_mutex_lock(mutex);
+	while (!context.block_started)
+		platform_condition_variable_wait(condition_variable, mutex);
+	U32 blocked_worker_index = context.blocked_worker_index;
+	platform_mutex_unlock(mutex);
+
+	TESTER_CHECK(blocked_worker_index < WORKER_COUNT);
 
-	scheduler_submit(scheduler, slice_from(tasks), group);
 	scheduler_wait_group(scheduler, group);
 
 	platform_mutex_lock(mutex);
 	U32 finished_count = context.finished_count;
 	U32 stolen_task_count = context.stolen_task_count;
 	U32 first_stolen_task_index = context.first_stolen_task_index;
+	bool is_steal_order_increasing = context.is_steal_order_increasing;
 	bool blocking_finished = context.blocking_finished;
 	context.release = true;
 	platform_condition_variable_signal(condition_variable);
 	platform_mutex_unlock(mutex);
 
-	U32 expected_first_stolen_task_index = TASK_COUNT - 1;
-	while ((1 + expected_first_stolen_task_index) % WORKER_COUNT != blocked_worker_index)
-		--expected_first_stolen_task_index;
-
+	// Thieves take from the top of the deque, so the oldest task is stolen first.
 	TESTER_CHECK(finished_count == TASK_COUNT);
-	TESTER_CHECK(stolen_task_count > 0);
-	TESTER_CHECK(first_stolen_task_index == expected_first_stolen_task_index);
+	TESTER_CHECK(stolen_task_count == TASK_COUNT);
+	TESTER_CHECK(first_stolen_task_index == 0);
+	TESTER_CHECK(is_steal_order_increasing);
 	TESTER_CHECK(!blocking_finished);
 
 	scheduler_wait_all(scheduler);
@@ -1478,32 +2001,1434 @@ TESTER_TEST("[CORE]: Scheduler Worker Wait Group Multi Worker")
 	platform_mutex_deinit(mutex);
 }
 
-TESTER_TEST("[CORE]: Arena_Allocator")
+struct Scheduler_Test_Graph_Context
 {
-	U64 page_size = platform_virtual_memory_get_page_size();
-
-	memory::Arena_Allocator *arena = memory::arena_allocator_init(1024);
-	DEFER(memory::arena_allocator_deinit(arena));
+	Atomic<U32> finished_count;
+	U32 finish_order[128];
+	U32 sleep_milliseconds[128];
+};
 
-	Memory_Block a = memory::arena_allocator_allocate(arena, 4, 1);
-	Memory_Block b = memory::arena_allocator_allocate(arena, 8, 1);
+struct Scheduler_Test_Graph_Node
+{
+	Scheduler_Test_Graph_Context *context;
+	U32 index;
+};
 
-	TESTER_CHECK(a.data != nullptr);
-	TESTER_CHECK(b.data != nullptr);
+inline static void
+_scheduler_test_graph_task(void *data)
+{
+	Scheduler_Test_Graph_Node *node = (Scheduler_Test_Graph_Node *)data;
+	if (node->context->sleep_milliseconds[node->index] != 0)
+		platform_thread_sleep(node->context->sleep_milliseconds[node->index]);
+	node->context->finish_order[node->index] = atomic_fetch_add(node->context->finished_count, (U32)1);
+}
 
-	TESTER_CHECK(memory::arena_allocator_get_used(arena) == 12);
-	TESTER_CHECK(memory::arena_allocator_get_peak(arena) == 12);
+TESTER_TEST("[CORE]: Scheduler Graph")
+{
+	Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 3,
+		.initial_task_queue_capacity = 256
+	});
+	Scheduler_Graph *graph = scheduler_graph_init(scheduler, true);
 
-	arena_allocator_clear(arena);
+	Scheduler_Test_Graph_Context context = {};
+	Scheduler_Test_Graph_Node nodes[128];
+	for (U32 i = 0; i < 128; ++i)
+		nodes[i] = Scheduler_Test_Graph_Node{.context = &context, .index = i};
 
-	TESTER_CHECK(memory::arena_allocator_get_used(arena) == 0);
-	TESTER_CHECK(memory::arena_allocator_get_peak(arena) == 12);
+	auto add_task = [&](U32 index) -> U32 {
+		return scheduler_graph_add_task(scheduler, graph, Scheduler_Task{.function = _scheduler_test_graph_task, .data = &nodes[index]});
+	};
 
-	Memory_Block reused = memory::arena_allocator_allocate(arena, 4, 1);
-	TESTER_CHECK(reused.data == a.data);
-	arena_allocator_clear(arena);
+	// ("empty graph")
+	{
+		scheduler_graph_submit(scheduler, graph);
+		scheduler_graph_wait(scheduler, graph);
+		Scheduler_Graph_Timing timing = scheduler_graph_get_timing(scheduler, graph);
+		TESTER_CHECK(timing.critical_path_node_count == 0);
+	}
 
-	Memory_Block large = memory::arena_allocator_allocate(arena, page_size + 32, 1);
+	// ("diamond, re-run")
+	{
+		U32 a = add_task(0);
+		U32 b = add_task(1);
+		U32 c = add_task(2);
+		U32 d = add_task(3);
+		scheduler_graph_add_edge(scheduler, graph, a, b);
+		scheduler_graph_add_edge(scheduler, graph, a, c);
+		scheduler_graph_add_edge(scheduler, graph, b, d);
+		scheduler_graph_add_edge(scheduler, graph, c, d);
+
+		bool is_ordered = true;
+		for (U32 frame = 0; frame < 16; ++frame)
+		{
+			context.finished_count = atomic_init((U32)0);
+			scheduler_graph_submit(scheduler, graph);
+			scheduler_graph_wait(scheduler, graph);
+
+			is_ordered &= atomic_load(context.finished_count) == 4;
+			is_ordered &= context.finish_order[a] == 0;
+			is_ordered &= context.finish_order[b] < context.finish_order[d];
+			is_ordered &= context.finish_order[c] < context.finish_order[d];
+			is_ordered &= context.finish_order[d] == 3;
+		}
+		TESTER_CHECK(is_ordered);
+		TESTER_CHECK(scheduler_get_stats(scheduler).queued_task_count == 0);
+	}
+
+	// ("fan out and fan in")
+	{
+		scheduler_graph_clear(scheduler, graph);
+		U32 root = add_task(0);
+		U32 sink = add_task(127);
+		for (U32 i = 1; i < 127; ++i)
+		{
+			U32 node = add_task(i);
+			scheduler_graph_add_edge(scheduler, graph, root, node);
+			scheduler_graph_add_edge(scheduler, graph, node, sink);
+		}
+
+		bool is_ordered = true;
+		for (U32 frame = 0; frame < 8; ++frame)
+		{
+			context.finished_count = atomic_init((U32)0);
+			scheduler_graph_submit(scheduler, graph);
+			scheduler_graph_wait(scheduler, graph);
+
+			is_ordered &= atomic_load(context.finished_count) == 128;
+			is_ordered &= context.finish_order[0] == 0;
+			is_ordered &= context.finish_order[127] == 127;
+		}
+		TESTER_CHECK(is_ordered);
+	}
+
+	// ("critical path")
+	{
+		scheduler_graph_clear(scheduler, graph);
+		context.sleep_milliseconds[1] = 20;
+		context.sleep_milliseconds[2] = 1;
+		U32 a = add_task(0);
+		U32 b = add_task(1);
+		U32 c = add_task(2);
+		U32 d = add_task(3);
+		scheduler_graph_add_edge(scheduler, graph, a, b);
+		scheduler_graph_add_edge(scheduler, graph, a, c);
+		scheduler_graph_add_edge(scheduler, graph, b, d);
+		scheduler_graph_add_edge(scheduler, graph, c, d);
+
+		scheduler_graph_submit(scheduler, graph);
+		scheduler_graph_wait(scheduler, graph);
+
+		Scheduler_Graph_Timing timing = scheduler_graph_get_timing(scheduler, graph);
+		TESTER_CHECK(timing.critical_path_node_count == 3);
+		TESTER_CHECK(timing.critical_path_microseconds >= 20'000);
+		TESTER_CHECK(timing.work_microseconds >= timing.critical_path_microseconds);
+		TESTER_CHECK(timing.elapsed_microseconds >= timing.critical_path_microseconds);
+
+		U32 path[3] = {};
+		TESTER_CHECK(scheduler_graph_get_critical_path(scheduler, graph, slice_from(path)) == 3);
+		TESTER_CHECK(path[0] == a && path[1] == b && path[2] == d);
+
+		U32 tail[1] = {};
+		TESTER_CHECK(scheduler_graph_get_critical_path(scheduler, graph, slice_from(tail)) == 3);
+		TESTER_CHECK(tail[0] == a);
+
+		context.sleep_milliseconds[1] = 0;
+		context.sleep_milliseconds[2] = 0;
+	}
+
+	scheduler_graph_deinit(scheduler, graph);
+	scheduler_deinit(scheduler);
+}
+
+struct Scheduler_Test_Priority_Context
+{
+	Atomic<U32> run_count;
+	U32 run_order[256];
+};
+
+struct Scheduler_Test_Priority_Task
+{
+	Scheduler_Test_Priority_Context *context;
+	U32 index;
+};
+
+inline static void
+_scheduler_test_priority_task(void *data)
+{
+	Scheduler_Test_Priority_Task *task = (Scheduler_Test_Priority_Task *)data;
+	task->context->run_order[task->index] = atomic_fetch_add(task->context->run_count, (U32)1);
+}
+
+struct Scheduler_Test_Latency_Context
+{
+	Atomic<U64> start_microseconds;
+};
+
+inline static void
+_scheduler_test_latency_task(void *data)
+{
+	Scheduler_Test_Latency_Context *context = (Scheduler_Test_Latency_Context *)data;
+	atomic_store(context->start_microseconds, platform_query_microseconds());
+}
+
+inline static void
+_scheduler_test_background_task(void *)
+{
+	U64 begin = platform_query_microseconds();
+	while (platform_query_microseconds() - begin < 20)
+		compiler_cpu_pause();
+}
+
+TESTER_TEST("[CORE]: Scheduler Priorities")
+{
+	Platform_Mutex *mutex = platform_mutex_init();
+	Platform_Condition_Variable *condition_variable = platform_condition_variable_init();
+	DEFER(platform_condition_variable_deinit(condition_variable); platform_mutex_deinit(mutex));
+
+	// Holds the only worker busy, so every later submit is queued before anything runs.
+	auto block_worker = [&](Scheduler *scheduler, Scheduler_Test_Blocking_Task_Context &blocking_context) {
+		blocking_context = Scheduler_Test_Blocking_Task_Context {
+			.mutex = mutex,
+			.condition_variable = condition_variable
+		};
+		scheduler_submit(scheduler, Scheduler_Task{.function = _scheduler_test_blocking_task, .data = &blocking_context});
+		platform_mutex_lock(mutex);
+		while (!blocking_context.started)
+			platform_condition_variable_wait(condition_variable, mutex);
+		platform_mutex_unlock(mutex);
+	};
+
+	auto release_worker = [&](Scheduler_Test_Blocking_Task_Context &blocking_context) {
+		platform_mutex_lock(mutex);
+		blocking_context.release = true;
+		platform_condition_variable_signal(condition_variable);
+		platform_mutex_unlock(mutex);
+	};
+
+	// ("lanes drain from high to background")
+	{
+		constexpr U32 LANE_TASK_COUNT = 8;
+
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 1,
+			.initial_task_queue_capacity = 64
+		});
+
+		Scheduler_Test_Priority_Context context = {};
+		Scheduler_Test_Priority_Task task_data[3 * LANE_TASK_COUNT];
+		Scheduler_Task tasks[3 * LANE_TASK_COUNT];
+		for (U32 i = 0; i < 3 * LANE_TASK_COUNT; ++i)
+		{
+			task_data[i] = Scheduler_Test_Priority_Task{.context = &context, .index = i};
+			tasks[i] = Scheduler_Task{.function = _scheduler_test_priority_task, .data = &task_data[i]};
+		}
+
+		Scheduler_Test_Blocking_Task_Context blocking_context = {};
+		block_worker(scheduler, blocking_context);
+
+		// Submitted in reverse order of how they should run.
+		scheduler_submit(scheduler, slice_from(tasks + 2 * LANE_TASK_COUNT, LANE_TASK_COUNT), nullptr, SCHEDULER_PRIORITY_BACKGROUND);
+		scheduler_submit(scheduler, slice_from(tasks + LANE_TASK_COUNT, LANE_TASK_COUNT), nullptr, SCHEDULER_PRIORITY_NORMAL);
+		scheduler_submit(scheduler, slice_from(tasks, LANE_TASK_COUNT), nullptr, SCHEDULER_PRIORITY_HIGH);
+
+		Scheduler_Stats stats = scheduler_get_stats(scheduler);
+		TESTER_CHECK(stats.queued_task_count == 3 * LANE_TASK_COUNT);
+		TESTER_CHECK(stats.queued_task_counts[SCHEDULER_PRIORITY_HIGH] == LANE_TASK_COUNT);
+		TESTER_CHECK(stats.queued_task_counts[SCHEDULER_PRIORITY_NORMAL] == LANE_TASK_COUNT);
+		TESTER_CHECK(stats.queued_task_counts[SCHEDULER_PRIORITY_BACKGROUND] == LANE_TASK_COUNT);
+
+		release_worker(blocking_context);
+		scheduler_wait_all(scheduler);
+
+		bool is_lane_ordered = true;
+		for (U32 i = 0; i < 3 * LANE_TASK_COUNT; ++i)
+			is_lane_ordered &= context.run_order[i] / LANE_TASK_COUNT == i / LANE_TASK_COUNT;
+		TESTER_CHECK(is_lane_ordered);
+
+		stats = scheduler_get_stats(scheduler);
+		for (U32 i = 0; i < SCHEDULER_PRIORITY_COUNT; ++i)
+			TESTER_CHECK(stats.queued_task_counts[i] == 0);
+
+		scheduler_deinit(scheduler);
+	}
+
+	// ("background lane is not starved")
+	{
+		constexpr U32 HIGH_TASK_COUNT = 255;
+
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 1,
+			.initial_task_queue_capacity = 256
+		});
+
+		Scheduler_Test_Priority_Context context = {};
+		Scheduler_Test_Priority_Task task_data[HIGH_TASK_COUNT + 1];
+		Scheduler_Task tasks[HIGH_TASK_COUNT + 1];
+		for (U32 i = 0; i < HIGH_TASK_COUNT + 1; ++i)
+		{
+			task_data[i] = Scheduler_Test_Priority_Task{.context = &context, .index = i};
+			tasks[i] = Scheduler_Task{.function = _scheduler_test_priority_task, .data = &task_data[i]};
+		}
+
+		Scheduler_Test_Blocking_Task_Context blocking_context = {};
+		block_worker(scheduler, blocking_context);
+		scheduler_submit(scheduler, slice_from(tasks + HIGH_TASK_COUNT, 1), nullptr, SCHEDULER_PRIORITY_BACKGROUND);
+		scheduler_submit(scheduler, slice_from(tasks, HIGH_TASK_COUNT), nullptr, SCHEDULER_PRIORITY_HIGH);
+		release_worker(blocking_context);
+		scheduler_wait_all(scheduler);
+
+		TESTER_CHECK(context.run_order[HIGH_TASK_COUNT] < HIGH_TASK_COUNT);
+		TESTER_CHECK(context.run_order[HIGH_TASK_COUNT] <= 64);
+
+		scheduler_deinit(scheduler);
+	}
+
+	// ("high priority tail latency under background saturation")
+	{
+		constexpr U32 BACKGROUND_TASK_COUNT = 20'000;
+		constexpr U32 SAMPLE_COUNT = 100;
+
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 2,
+			.initial_task_queue_capacity = BACKGROUND_TASK_COUNT
+		});
+
+		Array<Scheduler_Task> background_tasks = array_init_with_count<Scheduler_Task>(BACKGROUND_TASK_COUNT);
+		DEFER(array_deinit(background_tasks));
+		for (Scheduler_Task &task : background_tasks)
+			task = Scheduler_Task{.function = _scheduler_test_background_task};
+		scheduler_submit(scheduler, slice_from(background_tasks), nullptr, SCHEDULER_PRIORITY_BACKGROUND);
+
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+		Scheduler_Test_Latency_Context context = {};
+		Array<U64> latencies = array_init<U64>();
+		DEFER(array_deinit(latencies));
+		for (U32 i = 0; i < SAMPLE_COUNT; ++i)
+		{
+			U64 submit_microseconds = platform_query_microseconds();
+			scheduler_submit(scheduler, Scheduler_Task{.function = _scheduler_test_latency_task, .data = &context}, group, SCHEDULER_PRIORITY_HIGH);
+			scheduler_wait_group(scheduler, group);
+			array_push(latencies, atomic_load(context.start_microseconds) - submit_microseconds);
+		}
+		U32 remaining_background_task_count = scheduler_get_stats(scheduler).queued_task_counts[SCHEDULER_PRIORITY_BACKGROUND];
+
+		array_sort(latencies);
+		U64 p99_latency = latencies[SAMPLE_COUNT * 99 / 100];
+
+		// Draining the background backlog takes at least 200 ms per worker, high tasks must not wait for it.
+		TESTER_CHECK(remaining_background_task_count > 0);
+		TESTER_CHECK(p99_latency < 50'000);
+
+		scheduler_wait_all(scheduler);
+		scheduler_group_deinit(scheduler, group);
+		scheduler_deinit(scheduler);
+	}
+}
+
+inline static void
+_scheduler_test_counter_task(void *data)
+{
+	Atomic<U32> *counter = (Atomic<U32> *)data;
+	atomic_fetch_add(*counter, (U32)1);
+}
+
+inline static Scheduler_Coroutine
+_scheduler_test_coroutine_chain(Scheduler *scheduler, U32 depth, Atomic<U32> *counter)
+{
+	if (depth != 0)
+		co_await _scheduler_test_coroutine_chain(scheduler, depth - 1, counter);
+	atomic_fetch_add(*counter, (U32)1);
+}
+
+struct Scheduler_Test_Coroutine_Fan_Out
+{
+	Atomic<U32> counter;
+	Scheduler_Task tasks[64];
+	U32 counter_after_wait;
+};
+
+inline static Scheduler_Coroutine
+_scheduler_test_coroutine_fan_out(Scheduler *scheduler, Scheduler_Test_Coroutine_Fan_Out *fan_out)
+{
+	Scheduler_Group *group = scheduler_group_init(scheduler);
+	scheduler_submit(scheduler, slice_from(fan_out->tasks), group);
+	co_await scheduler_coroutine_wait_group(scheduler, group);
+	fan_out->counter_after_wait = atomic_load(fan_out->counter);
+
+	// A drained group resumes right away.
+	co_await scheduler_coroutine_wait_group(scheduler, group);
+	scheduler_group_deinit(scheduler, group);
+}
+
+inline static Scheduler_Coroutine
+_scheduler_test_coroutine_sleep(Scheduler *scheduler, U32 milliseconds, Atomic<U32> *counter)
+{
+	co_await scheduler_coroutine_sleep(scheduler, milliseconds);
+	atomic_fetch_add(*counter, (U32)1);
+}
+
+TESTER_TEST("[CORE]: Scheduler Coroutine")
+{
+	// ("await coroutine")
+	{
+		constexpr U32 DEPTH = 1000;
+
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 1,
+			.initial_task_queue_capacity = 64
+		});
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+
+		// Each awaited coroutine resumes its caller directly, so the chain does not grow the worker stack.
+		Atomic<U32> counter = atomic_init((U32)0);
+		scheduler_coroutine_submit(scheduler, _scheduler_test_coroutine_chain(scheduler, DEPTH, &counter), group);
+		scheduler_wait_group(scheduler, group);
+		TESTER_CHECK(atomic_load(counter) == DEPTH + 1);
+		TESTER_CHECK(scheduler_get_stats(scheduler).live_coroutine_frame_count == 0);
+
+		scheduler_group_deinit(scheduler, group);
+		scheduler_deinit(scheduler);
+	}
+
+	// ("await group")
+	{
+		constexpr U32 COROUTINE_COUNT = 16;
+
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 1,
+			.initial_task_queue_capacity = 1024
+		});
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+
+		// A single worker runs every fan-out, which only works if the waiting coroutines do not hold it.
+		Scheduler_Test_Coroutine_Fan_Out fan_outs[COROUTINE_COUNT] = {};
+		for (U32 i = 0; i < COROUTINE_COUNT; ++i)
+		{
+			for (Scheduler_Task &task : fan_outs[i].tasks)
+				task = Scheduler_Task{.function = _scheduler_test_counter_task, .data = &fan_outs[i].counter};
+			scheduler_coroutine_submit(scheduler, _scheduler_test_coroutine_fan_out(scheduler, &fan_outs[i]), group);
+		}
+		scheduler_wait_group(scheduler, group);
+
+		bool is_every_group_drained = true;
+		for (U32 i = 0; i < COROUTINE_COUNT; ++i)
+			is_every_group_drained &= fan_outs[i].counter_after_wait == 64;
+		TESTER_CHECK(is_every_group_drained);
+
+		Scheduler_Stats stats = scheduler_get_stats(scheduler);
+		TESTER_CHECK(stats.live_coroutine_frame_count == 0);
+		TESTER_CHECK(stats.live_group_count == 1);
+
+		scheduler_group_deinit(scheduler, group);
+		scheduler_deinit(scheduler);
+	}
+
+	// ("await timer")
+	{
+		constexpr U32 COROUTINE_COUNT = 1000;
+		constexpr U32 SLEEP_MILLISECONDS = 100;
+
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 1,
+			.initial_task_queue_capacity = COROUTINE_COUNT
+		});
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+
+		Atomic<U32> counter = atomic_init((U32)0);
+		U64 begin = platform_query_microseconds();
+		for (U32 i = 0; i < COROUTINE_COUNT; ++i)
+			scheduler_coroutine_submit(scheduler, _scheduler_test_coroutine_sleep(scheduler, SLEEP_MILLISECONDS, &counter), group);
+		TESTER_CHECK(scheduler_get_stats(scheduler).live_coroutine_frame_count == COROUTINE_COUNT);
+		scheduler_wait_group(scheduler, group);
+		U64 elapsed_microseconds = platform_query_microseconds() - begin;
+
+		// Sleeping one after the other would take 100 seconds on the single worker.
+		TESTER_CHECK(atomic_load(counter) == COROUTINE_COUNT);
+		TESTER_CHECK(elapsed_microseconds >= SLEEP_MILLISECONDS * 1000);
+		TESTER_CHECK(elapsed_microseconds < 10 * SLEEP_MILLISECONDS * 1000);
+
+		Scheduler_Stats stats = scheduler_get_stats(scheduler);
+		TESTER_CHECK(stats.pending_timer_count == 0);
+		TESTER_CHECK(stats.live_coroutine_frame_count == 0);
+
+		// Frames released by the first batch are reused by the next one.
+		counter = atomic_init((U32)0);
+		for (U32 i = 0; i < COROUTINE_COUNT; ++i)
+			scheduler_coroutine_submit(scheduler, _scheduler_test_coroutine_sleep(scheduler, 1, &counter), group);
+		scheduler_wait_group(scheduler, group);
+		TESTER_CHECK(atomic_load(counter) == COROUTINE_COUNT);
+
+		scheduler_group_deinit(scheduler, group);
+		scheduler_deinit(scheduler);
+	}
+
+	// ("submit after")
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 2,
+			.initial_task_queue_capacity = 64
+		});
+
+		Scheduler_Test_Latency_Context context = {};
+		U64 submit_microseconds = platform_query_microseconds();
+		scheduler_submit_after(scheduler, 20, Scheduler_Task{.function = _scheduler_test_latency_task, .data = &context});
+		TESTER_CHECK(scheduler_get_stats(scheduler).pending_timer_count == 1);
+
+		// Waiting for all work includes tasks that are not due yet.
+		scheduler_wait_all(scheduler);
+		TESTER_CHECK(atomic_load(context.start_microseconds) >= submit_microseconds + 20'000);
+		TESTER_CHECK(scheduler_get_stats(scheduler).pending_timer_count == 0);
+
+		// Shutdown waits for pending timers.
+		Atomic<U32> counter = atomic_init((U32)0);
+		scheduler_submit_after(scheduler, 10, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter}, nullptr, SCHEDULER_PRIORITY_BACKGROUND);
+		scheduler_deinit(scheduler);
+		TESTER_CHECK(atomic_load(counter) == 1);
+	}
+}
+
+TESTER_TEST("[CORE]: Scheduler Timers")
+{
+	// ("submit every")
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 2,
+			.initial_task_queue_capacity = 64
+		});
+
+		Atomic<U32> counter = atomic_init((U32)0);
+		Scheduler_Timer_Handle timer = scheduler_submit_every(scheduler, 2, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter});
+		TESTER_CHECK(scheduler_get_stats(scheduler).periodic_timer_count == 1);
+		TESTER_CHECK(scheduler_get_stats(scheduler).pending_timer_count == 0);
+
+		// A periodic timer does not keep waiting for all work from returning.
+		scheduler_wait_all(scheduler);
+
+		while (atomic_load(counter) < 5)
+			platform_thread_sleep(1);
+		TESTER_CHECK(scheduler_timer_cancel(scheduler, timer));
+		TESTER_CHECK(!scheduler_timer_cancel(scheduler, timer));
+		scheduler_wait_all(scheduler);
+
+		U32 fired_count = atomic_load(counter);
+		platform_thread_sleep(10);
+		TESTER_CHECK(atomic_load(counter) == fired_count);
+
+		Scheduler_Stats stats = scheduler_get_stats(scheduler);
+		TESTER_CHECK(stats.periodic_timer_count == 0);
+		TESTER_CHECK(stats.fired_timer_count == fired_count);
+		TESTER_CHECK(stats.timer_jitter_microseconds_max >= stats.timer_jitter_microseconds_total / stats.fired_timer_count);
+
+		// Uncancelled periodic timers stop with the scheduler.
+		scheduler_submit_every(scheduler, 1, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter});
+		scheduler_deinit(scheduler);
+	}
+
+	// ("cancel")
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 2,
+			.initial_task_queue_capacity = 64
+		});
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+
+		Atomic<U32> counter = atomic_init((U32)0);
+		Scheduler_Timer_Handle timer = scheduler_submit_after(scheduler, 60'000, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter}, group);
+		TESTER_CHECK(scheduler_get_stats(scheduler).pending_timer_count == 1);
+
+		// Cancelling releases the group right away instead of after a minute.
+		U64 begin = platform_query_microseconds();
+		TESTER_CHECK(scheduler_timer_cancel(scheduler, timer));
+		scheduler_wait_group(scheduler, group);
+		scheduler_wait_all(scheduler);
+		TESTER_CHECK(platform_query_microseconds() - begin < 1'000'000);
+		TESTER_CHECK(atomic_load(counter) == 0);
+		TESTER_CHECK(scheduler_get_stats(scheduler).pending_timer_count == 0);
+
+		// A timer that fired is stale.
+		timer = scheduler_submit_after(scheduler, 1, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter}, group);
+		scheduler_wait_group(scheduler, group);
+		TESTER_CHECK(atomic_load(counter) == 1);
+		TESTER_CHECK(!scheduler_timer_cancel(scheduler, timer));
+
+		scheduler_group_deinit(scheduler, group);
+		scheduler_deinit(scheduler);
+	}
+
+	// ("wheel levels")
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 1,
+			.initial_task_queue_capacity = 64
+		});
+
+		// Delays past 64 ms start in an upper level and cascade down before they fire.
+		constexpr U32 DELAYS[] = {0, 1, 3, 63, 64, 65, 130, 300};
+		Scheduler_Test_Latency_Context contexts[sizeof(DELAYS) / sizeof(DELAYS[0])] = {};
+		U64 submit_microseconds = platform_query_microseconds();
+		for (U64 i = 0; i < sizeof(DELAYS) / sizeof(DELAYS[0]); ++i)
+			scheduler_submit_after(scheduler, DELAYS[i], Scheduler_Task{.function = _scheduler_test_latency_task, .data = &contexts[i]});
+		TESTER_CHECK(scheduler_get_stats(scheduler).pending_timer_count == sizeof(DELAYS) / sizeof(DELAYS[0]));
+
+		scheduler_wait_all(scheduler);
+		for (U64 i = 0; i < sizeof(DELAYS) / sizeof(DELAYS[0]); ++i)
+			TESTER_CHECK(atomic_load(contexts[i].start_microseconds) >= submit_microseconds + DELAYS[i] * 1000);
+
+		Scheduler_Stats stats = scheduler_get_stats(scheduler);
+		TESTER_CHECK(stats.pending_timer_count == 0);
+		TESTER_CHECK(stats.fired_timer_count == sizeof(DELAYS) / sizeof(DELAYS[0]));
+		scheduler_deinit(scheduler);
+	}
+}
+
+TESTER_TEST("[CORE]: Scheduler Group Cancellation")
+{
+	constexpr U32 TASK_COUNT = 256;
+
+	// ("drops queued tasks")
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 1
+		});
+		Scheduler_Group *blocker_group = scheduler_group_init(scheduler);
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+
+		// The only worker is held busy so every task of the group is still queued when it is cancelled.
+		Atomic<U32> is_released = atomic_init((U32)0);
+		scheduler_submit_fn(scheduler, [&is_released]() {
+			while (atomic_load(is_released) == 0)
+				platform_thread_sleep(0);
+		}, blocker_group);
+
+		Atomic<U32> counter = atomic_init((U32)0);
+		Atomic<U32> destroyed_count = atomic_init((U32)0);
+		{
+			Scheduler_Test_Closure_Payload payload = {&destroyed_count};
+			for (U32 i = 0; i < TASK_COUNT; ++i)
+			{
+				scheduler_submit(scheduler, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter}, group);
+				scheduler_submit_fn(scheduler, [&counter, payload]() {
+					atomic_fetch_add(counter, (U32)1 + payload.values[0]);
+				}, group);
+			}
+
+			TESTER_CHECK(!scheduler_group_is_cancelled(scheduler, group));
+			scheduler_group_cancel(scheduler, group);
+			TESTER_CHECK(scheduler_group_is_cancelled(scheduler, group));
+
+			atomic_store(is_released, (U32)1);
+			TESTER_CHECK(scheduler_wait_group(scheduler, group) == SCHEDULER_GROUP_STATUS_CANCELLED);
+			TESTER_CHECK(scheduler_wait_group(scheduler, blocker_group) == SCHEDULER_GROUP_STATUS_COMPLETED);
+		}
+
+		// Dropped closures still release their state exactly once.
+		TESTER_CHECK(atomic_load(counter) == 0);
+		TESTER_CHECK(atomic_load(destroyed_count) == TASK_COUNT * 2 + 1);
+		TESTER_CHECK(scheduler_get_stats(scheduler).cancelled_task_count == TASK_COUNT * 2);
+
+		// Cancellation is sticky, later tasks of the group are dropped as well.
+		scheduler_submit(scheduler, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter}, group);
+		TESTER_CHECK(scheduler_wait_group(scheduler, group) == SCHEDULER_GROUP_STATUS_CANCELLED);
+		TESTER_CHECK(atomic_load(counter) == 0);
+
+		scheduler_group_deinit(scheduler, group);
+		scheduler_group_deinit(scheduler, blocker_group);
+		scheduler_deinit(scheduler);
+	}
+
+	// ("running tasks poll")
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 2
+		});
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+
+		Atomic<U32> is_started = atomic_init((U32)0);
+		Atomic<U32> is_stopped = atomic_init((U32)0);
+		scheduler_submit_fn(scheduler, [scheduler, group, &is_started, &is_stopped]() {
+			atomic_store(is_started, (U32)1);
+			while (!scheduler_group_is_cancelled(scheduler, group))
+				platform_thread_sleep(0);
+			atomic_store(is_stopped, (U32)1);
+		}, group);
+
+		while (atomic_load(is_started) == 0)
+			platform_thread_sleep(0);
+		scheduler_group_cancel(scheduler, group);
+		TESTER_CHECK(scheduler_wait_group(scheduler, group) == SCHEDULER_GROUP_STATUS_CANCELLED);
+		TESTER_CHECK(atomic_load(is_stopped) == 1);
+
+		scheduler_group_deinit(scheduler, group);
+		scheduler_deinit(scheduler);
+	}
+
+	// ("delayed tasks")
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 2
+		});
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+
+		Atomic<U32> counter = atomic_init((U32)0);
+		Scheduler_Timer_Handle timer = scheduler_submit_after(scheduler, 60'000, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter}, group);
+
+		// The group is released right away instead of when the delay runs out.
+		U64 begin = platform_query_microseconds();
+		scheduler_group_cancel(scheduler, group);
+		TESTER_CHECK(scheduler_wait_group(scheduler, group) == SCHEDULER_GROUP_STATUS_CANCELLED);
+		scheduler_wait_all(scheduler);
+		TESTER_CHECK(platform_query_microseconds() - begin < 1'000'000);
+		TESTER_CHECK(!scheduler_timer_cancel(scheduler, timer));
+		TESTER_CHECK(atomic_load(counter) == 0);
+
+		Scheduler_Stats stats = scheduler_get_stats(scheduler);
+		TESTER_CHECK(stats.pending_timer_count == 0);
+		TESTER_CHECK(stats.cancelled_task_count == 1);
+
+		scheduler_group_deinit(scheduler, group);
+		scheduler_deinit(scheduler);
+	}
+
+	// ("periodic timers")
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 2
+		});
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+
+		Atomic<U32> counter = atomic_init((U32)0);
+		Scheduler_Timer_Handle timer = scheduler_submit_every(scheduler, 1, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter}, group);
+		while (atomic_load(counter) < 3)
+			platform_thread_sleep(1);
+
+		// The timer stops with its group, so the group can be deinitialized once the runs already queued are done.
+		scheduler_group_cancel(scheduler, group);
+		TESTER_CHECK(scheduler_get_stats(scheduler).periodic_timer_count == 0);
+		TESTER_CHECK(!scheduler_timer_cancel(scheduler, timer));
+		TESTER_CHECK(scheduler_wait_group(scheduler, group) == SCHEDULER_GROUP_STATUS_CANCELLED);
+
+		U32 run_count = atomic_load(counter);
+		platform_thread_sleep(10);
+		TESTER_CHECK(atomic_load(counter) == run_count);
+		TESTER_CHECK(scheduler_get_stats(scheduler).periodic_timer_count == 0);
+
+		scheduler_group_deinit(scheduler, group);
+		scheduler_deinit(scheduler);
+	}
+
+	// ("parallel for")
+	{
+		constexpr U32 COUNT = 100'000;
+
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 2
+		});
+		Scheduler_Group *group = scheduler_group_init(scheduler);
+
+		struct Scheduler_Test_Cancel_Context
+		{
+			Scheduler *scheduler;
+			Scheduler_Group *group;
+			Atomic<U32> processed_count;
+		};
+
+		Scheduler_Test_Cancel_Context context = {
+			.scheduler = scheduler,
+			.group = group
+		};
+
+		auto cancel_on_first_grain = [](U32 begin, U32 end, void *data) {
+			Scheduler_Test_Cancel_Context *context = (Scheduler_Test_Cancel_Context *)data;
+			atomic_fetch_add(context->processed_count, end - begin);
+			scheduler_group_cancel(context->scheduler, context->group);
+		};
+
+		// A parallel for called from a task follows the group of that task.
+		scheduler_submit_fn(scheduler, [scheduler, &context, cancel_on_first_grain]() {
+			scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+				.count = COUNT,
+				.chunk_size = 1,
+				.function = cancel_on_first_grain,
+				.data = &context
+			});
+		}, group);
+		TESTER_CHECK(scheduler_wait_group(scheduler, group) == SCHEDULER_GROUP_STATUS_CANCELLED);
+		TESTER_CHECK(atomic_load(context.processed_count) != 0);
+		TESTER_CHECK(atomic_load(context.processed_count) < COUNT);
+		scheduler_group_deinit(scheduler, group);
+
+		// Callers outside the scheduler pass the group explicitly.
+		group = scheduler_group_init(scheduler);
+		context.group = group;
+		context.processed_count = atomic_init((U32)0);
+		scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+			.count = COUNT,
+			.chunk_size = 1,
+			.function = cancel_on_first_grain,
+			.data = &context,
+			.cancellation_group = group
+		});
+		TESTER_CHECK(atomic_load(context.processed_count) != 0);
+		TESTER_CHECK(atomic_load(context.processed_count) < COUNT);
+		TESTER_CHECK(scheduler_get_stats(scheduler).live_group_count == 1);
+
+		scheduler_group_deinit(scheduler, group);
+		scheduler_deinit(scheduler);
+	}
+}
+
+struct Scheduler_Test_Group_Thread_Context
+{
+	Scheduler *scheduler;
+	Atomic<U32> counter;
+};
+
+inline static void
+_scheduler_test_group_thread(void *data)
+{
+	Scheduler_Test_Group_Thread_Context *context = (Scheduler_Test_Group_Thread_Context *)data;
+	for (U32 i = 0; i < 200; ++i)
+	{
+		Scheduler_Group *group = scheduler_group_init(context->scheduler);
+		for (U32 j = 0; j < 8; ++j)
+			scheduler_submit(context->scheduler, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &context->counter}, group);
+		scheduler_wait_group(context->scheduler, group);
+		scheduler_group_deinit(context->scheduler, group);
+	}
+}
+
+TESTER_TEST("[CORE]: Scheduler Group Pool")
+{
+	constexpr U32 THREAD_COUNT = 4;
+
+	Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 2
+	});
+
+	// Released groups are handed out again, from the shared list outside of workers and from their own list inside.
+	Scheduler_Group *group = scheduler_group_init(scheduler);
+	scheduler_group_deinit(scheduler, group);
+	TESTER_CHECK(scheduler_group_init(scheduler) == group);
+
+	Scheduler_Group *first_group = nullptr;
+	Scheduler_Group *second_group = nullptr;
+	scheduler_submit_fn(scheduler, [scheduler, &first_group, &second_group]() {
+		first_group = scheduler_group_init(scheduler);
+		scheduler_group_deinit(scheduler, first_group);
+		second_group = scheduler_group_init(scheduler);
+		scheduler_group_deinit(scheduler, second_group);
+	}, group);
+	scheduler_wait_group(scheduler, group);
+	TESTER_CHECK(first_group == second_group);
+
+	// A recycled group starts out neither cancelled nor pending.
+	scheduler_group_cancel(scheduler, group);
+	scheduler_group_deinit(scheduler, group);
+	group = scheduler_group_init(scheduler);
+	TESTER_CHECK(!scheduler_group_is_cancelled(scheduler, group));
+	TESTER_CHECK(scheduler_wait_group(scheduler, group) == SCHEDULER_GROUP_STATUS_COMPLETED);
+	scheduler_group_deinit(scheduler, group);
+
+	// Threads outside the scheduler sleep on their own groups at the same time.
+	Scheduler_Test_Group_Thread_Context context = {.scheduler = scheduler};
+	Platform_Thread *threads[THREAD_COUNT];
+	for (U32 i = 0; i < THREAD_COUNT; ++i)
+	{
+		threads[i] = platform_thread_init(Platform_Thread_Desc {
+			.function = _scheduler_test_group_thread,
+			.data = &context,
+			.name = "SchedGroupTest"
+		});
+	}
+	for (U32 i = 0; i < THREAD_COUNT; ++i)
+		platform_thread_join(threads[i]);
+	for (U32 i = 0; i < THREAD_COUNT; ++i)
+		platform_thread_deinit(threads[i]);
+	TESTER_CHECK(atomic_load(context.counter) == THREAD_COUNT * 200 * 8);
+	TESTER_CHECK(scheduler_get_stats(scheduler).live_group_count == 0);
+
+	// Many small parallel for calls from inside a task wait by parking the worker between grains of others.
+	Atomic<U32> sum = atomic_init((U32)0);
+	group = scheduler_group_init(scheduler);
+	for (U32 i = 0; i < 4; ++i)
+	{
+		scheduler_submit_fn(scheduler, [scheduler, &sum]() {
+			for (U32 call = 0; call < 100; ++call)
+			{
+				scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+					.count = 64,
+					.chunk_size = 4,
+					.function = [](U32 begin, U32 end, void *data) {
+						atomic_fetch_add(*(Atomic<U32> *)data, end - begin);
+					},
+					.data = &sum
+				});
+			}
+		}, group);
+	}
+	scheduler_wait_group(scheduler, group);
+	scheduler_group_deinit(scheduler, group);
+	TESTER_CHECK(atomic_load(sum) == 4 * 100 * 64);
+
+	scheduler_deinit(scheduler);
+}
+
+inline static U32
+_scheduler_test_wait_for_active_worker_count(Scheduler *scheduler, U32 active_worker_count)
+{
+	Scheduler_Stats stats = scheduler_get_stats(scheduler);
+	for (U32 i = 0; i < 400 && stats.active_worker_count != active_worker_count; ++i)
+	{
+		platform_thread_sleep(5);
+		stats = scheduler_get_stats(scheduler);
+	}
+	return stats.active_worker_count;
+}
+
+TESTER_TEST("[CORE]: Scheduler Elastic Workers")
+{
+	// Fixed pools keep every worker active and never scale.
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 2,
+			.max_worker_count = 2
+		});
+		Scheduler_Stats stats = scheduler_get_stats(scheduler);
+		TESTER_CHECK(stats.worker_count == 2);
+		TESTER_CHECK(stats.active_worker_count == 2);
+		scheduler_deinit(scheduler);
+	}
+
+	// A deep queue activates workers up to the maximum, and they retire again once idle.
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 1,
+			.max_worker_count = 4,
+			.scale_up_queue_depth = 4,
+			.idle_timeout_milliseconds = 10
+		});
+		Scheduler_Stats stats = scheduler_get_stats(scheduler);
+		TESTER_CHECK(stats.worker_count == 4);
+		TESTER_CHECK(stats.active_worker_count == 1);
+
+		Atomic<U32> counter = atomic_init((U32)0);
+		Scheduler_Task tasks[64];
+		for (Scheduler_Task &task : tasks)
+			task = Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter};
+		scheduler_submit(scheduler, slice_from(tasks));
+		scheduler_wait_all(scheduler);
+		TESTER_CHECK(atomic_load(counter) == 64);
+
+		stats = scheduler_get_stats(scheduler);
+		TESTER_CHECK(stats.scale_up_queue_depth_count >= 1);
+		TESTER_CHECK(stats.active_worker_count <= 4);
+
+		TESTER_CHECK(_scheduler_test_wait_for_active_worker_count(scheduler, 1) == 1);
+		stats = scheduler_get_stats(scheduler);
+		TESTER_CHECK(stats.scale_down_count == stats.scale_up_queue_depth_count + stats.scale_up_latency_count);
+
+		// Retired workers are activated again by the next burst.
+		scheduler_submit(scheduler, slice_from(tasks));
+		scheduler_wait_all(scheduler);
+		TESTER_CHECK(atomic_load(counter) == 128);
+		TESTER_CHECK(scheduler_get_stats(scheduler).scale_up_queue_depth_count > stats.scale_up_queue_depth_count);
+		scheduler_deinit(scheduler);
+	}
+
+	// A queued task that waits behind a long one activates a worker even though the queue is shallow.
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 1,
+			.max_worker_count = 2,
+			.scale_up_queue_depth = 1000,
+			.scale_up_latency_microseconds = 1000,
+			.idle_timeout_milliseconds = 10
+		});
+
+		Atomic<U32> is_started = atomic_init((U32)0);
+		Atomic<U32> is_released = atomic_init((U32)0);
+		Atomic<U32> counter = atomic_init((U32)0);
+		scheduler_submit_fn(scheduler, [&is_started, &is_released]() {
+			atomic_store(is_started, (U32)1);
+			while (atomic_load(is_released) == 0)
+				platform_thread_sleep(1);
+		});
+		while (atomic_load(is_started) == 0)
+			platform_thread_sleep(1);
+
+		scheduler_submit(scheduler, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter});
+		platform_thread_sleep(5);
+		scheduler_submit(scheduler, Scheduler_Task{.function = _scheduler_test_counter_task, .data = &counter});
+
+		// The activated worker runs both queued tasks while the first worker is still busy.
+		for (U32 i = 0; i < 400 && atomic_load(counter) != 2; ++i)
+			platform_thread_sleep(5);
+		TESTER_CHECK(atomic_load(counter) == 2);
+		atomic_store(is_released, (U32)1);
+		scheduler_wait_all(scheduler);
+
+		Scheduler_Stats stats = scheduler_get_stats(scheduler);
+		TESTER_CHECK(stats.scale_up_latency_count == 1);
+		TESTER_CHECK(stats.scale_up_queue_depth_count == 0);
+		TESTER_CHECK(_scheduler_test_wait_for_active_worker_count(scheduler, 1) == 1);
+		TESTER_CHECK(scheduler_get_stats(scheduler).scale_down_count == 1);
+		scheduler_deinit(scheduler);
+	}
+}
+
+struct Scheduler_Test_Pipeline_Context
+{
+	U64 token_count;
+	Atomic<U32> in_flight_count;
+	Atomic<U32> max_in_flight_count;
+	Array<U64> output;
+	bool is_ordered;
+};
+
+inline static bool
+_scheduler_test_pipeline_source(Scheduler_Pipeline_Token *token, void *data)
+{
+	Scheduler_Test_Pipeline_Context *context = (Scheduler_Test_Pipeline_Context *)data;
+	if (token->index == context->token_count)
+		return false;
+
+	U32 in_flight_count = atomic_fetch_add(context->in_flight_count, (U32)1) + 1;
+	U32 max_in_flight_count = atomic_load(context->max_in_flight_count);
+	while (in_flight_count > max_in_flight_count && !atomic_compare_exchange(context->max_in_flight_count, max_in_flight_count, in_flight_count))
+	{
+	}
+
+	*(U64 *)token->buffer = token->index;
+	token->size = sizeof(U64);
+	return true;
+}
+
+// Tokens leave the test's in-flight count where they are dropped or written.
+inline static bool
+_scheduler_test_pipeline_transform(Scheduler_Pipeline_Token *token, void *data)
+{
+	Scheduler_Test_Pipeline_Context *context = (Scheduler_Test_Pipeline_Context *)data;
+	U64 *value = (U64 *)token->buffer;
+	*value = *value * 3;
+	if (*value % 7 != 0)
+		return true;
+
+	atomic_fetch_sub(context->in_flight_count, (U32)1);
+	return false;
+}
+
+inline static bool
+_scheduler_test_pipeline_write(Scheduler_Pipeline_Token *token, void *data)
+{
+	Scheduler_Test_Pipeline_Context *context = (Scheduler_Test_Pipeline_Context *)data;
+	U64 value = *(U64 *)token->buffer;
+	if (context->output.count != 0 && context->output[context->output.count - 1] >= value)
+		context->is_ordered = false;
+	array_push(context->output, value);
+	atomic_fetch_sub(context->in_flight_count, (U32)1);
+	return true;
+}
+
+TESTER_TEST("[CORE]: Scheduler Pipeline")
+{
+	constexpr U64 TOKEN_COUNT = 2000;
+	constexpr U32 MAX_TOKEN_COUNT = 6;
+
+	Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 4
+	});
+
+	Scheduler_Test_Pipeline_Context context = {.token_count = TOKEN_COUNT, .output = array_init<U64>(), .is_ordered = true};
+	DEFER(array_deinit(context.output));
+
+	Scheduler_Pipeline *pipeline = scheduler_pipeline_init(scheduler, Scheduler_Pipeline_Desc {
+		.max_token_count = MAX_TOKEN_COUNT,
+		.buffer_size = 64
+	});
+	scheduler_pipeline_add_stage(scheduler, pipeline, Scheduler_Pipeline_Stage {
+		.mode = SCHEDULER_PIPELINE_STAGE_MODE_SERIAL,
+		.function = _scheduler_test_pipeline_source,
+		.data = &context
+	});
+	scheduler_pipeline_add_stage(scheduler, pipeline, Scheduler_Pipeline_Stage {
+		.mode = SCHEDULER_PIPELINE_STAGE_MODE_PARALLEL,
+		.function = _scheduler_test_pipeline_transform,
+		.data = &context
+	});
+	scheduler_pipeline_add_stage(scheduler, pipeline, Scheduler_Pipeline_Stage {
+		.mode = SCHEDULER_PIPELINE_STAGE_MODE_SERIAL,
+		.function = _scheduler_test_pipeline_write,
+		.data = &context
+	});
+
+	U64 expected_dropped_count = (TOKEN_COUNT + 6) / 7;
+	for (U32 run = 0; run < 3; ++run)
+	{
+		array_clear(context.output);
+		scheduler_pipeline_submit(scheduler, pipeline);
+		scheduler_pipeline_wait(scheduler, pipeline);
+
+		// Serial stages see the surviving tokens in stream order, and the buffers are reused across runs.
+		Scheduler_Pipeline_Stats stats = scheduler_pipeline_get_stats(scheduler, pipeline);
+		TESTER_CHECK(context.is_ordered);
+		TESTER_CHECK(context.output.count == TOKEN_COUNT - expected_dropped_count);
+		TESTER_CHECK(stats.token_count == TOKEN_COUNT);
+		TESTER_CHECK(stats.dropped_token_count == expected_dropped_count);
+		TESTER_CHECK(stats.max_in_flight_token_count <= MAX_TOKEN_COUNT);
+		TESTER_CHECK(stats.buffer_count >= 1 && stats.buffer_count <= MAX_TOKEN_COUNT);
+		TESTER_CHECK(stats.buffer_bytes == stats.buffer_count * 64);
+	}
+	TESTER_CHECK(atomic_load(context.in_flight_count) == 0);
+	TESTER_CHECK(atomic_load(context.max_in_flight_count) <= MAX_TOKEN_COUNT);
+
+	// A source that ends right away runs no other stage.
+	context.token_count = 0;
+	array_clear(context.output);
+	scheduler_pipeline_submit(scheduler, pipeline);
+	scheduler_pipeline_wait(scheduler, pipeline);
+	TESTER_CHECK(context.output.count == 0);
+	TESTER_CHECK(scheduler_pipeline_get_stats(scheduler, pipeline).token_count == 0);
+
+	scheduler_pipeline_deinit(scheduler, pipeline);
+	TESTER_CHECK(scheduler_get_stats(scheduler).live_group_count == 0);
+	scheduler_deinit(scheduler);
+}
+
+struct Scheduler_Test_Histogram
+{
+	U32 bins[16];
+};
+
+TESTER_TEST("[CORE]: Scheduler Local")
+{
+	constexpr U32 COUNT = 100'000;
+
+	// Every worker counts into its own instance, combining them gives the full histogram.
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 4
+		});
+
+		struct Scheduler_Test_Local_Context
+		{
+			Scheduler *scheduler;
+			Scheduler_Local<Scheduler_Test_Histogram> histograms;
+		};
+
+		Scheduler_Test_Local_Context context = {.scheduler = scheduler, .histograms = scheduler_local_init(scheduler, Scheduler_Test_Histogram {})};
+		TESTER_CHECK(context.histograms.instance_count == 4);
+		for (U32 run = 0; run < 2; ++run)
+		{
+			scheduler_parallel_for(scheduler, Scheduler_Parallel_For_Desc {
+				.count = COUNT,
+				.chunk_size = 64,
+				.function = [](U32 begin, U32 end, void *data) {
+					auto *local_context = (Scheduler_Test_Local_Context *)data;
+					Scheduler_Test_Histogram &histogram = scheduler_local_get(local_context->scheduler, local_context->histograms);
+					for (U32 i = begin; i < end; ++i)
+						++histogram.bins[i % 16];
+				},
+				.data = &context
+			});
+
+			Scheduler_Test_Histogram histogram = scheduler_local_combine(scheduler, context.histograms, [](Scheduler_Test_Histogram a, const Scheduler_Test_Histogram &b) {
+				for (U32 i = 0; i < 16; ++i)
+					a.bins[i] += b.bins[i];
+				return a;
+			});
+			bool is_complete = true;
+			for (U32 i = 0; i < 16; ++i)
+				is_complete &= histogram.bins[i] == COUNT / 16;
+			TESTER_CHECK(is_complete);
+
+			U32 created_count = 0;
+			scheduler_local_for_each(scheduler, context.histograms, [&created_count](Scheduler_Test_Histogram &) { ++created_count; });
+			TESTER_CHECK(created_count >= 1 && created_count <= 4);
+
+			// Cleared instances start from the identity again on the next run.
+			scheduler_local_clear(scheduler, context.histograms);
+			created_count = 0;
+			scheduler_local_for_each(scheduler, context.histograms, [&created_count](Scheduler_Test_Histogram &) { ++created_count; });
+			TESTER_CHECK(created_count == 0);
+		}
+
+		scheduler_local_deinit(scheduler, context.histograms);
+		scheduler_deinit(scheduler);
+	}
+
+	// Replacement workers that run tasks while a worker blocks get their own instance.
+	{
+		Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+			.worker_count = 1,
+			.replacement_worker_count = 1
+		});
+
+		Scheduler_Local<U64> counts = scheduler_local_init(scheduler, (U64)0);
+		TESTER_CHECK(counts.instance_count == 2);
+
+		Atomic<U32> finished_count = atomic_init((U32)0);
+		scheduler_submit_fn(scheduler, [scheduler, &counts, &finished_count]() {
+			++scheduler_local_get(scheduler, counts);
+			scheduler_worker_block_ahead(scheduler);
+			for (U32 i = 0; i < 100; ++i)
+			{
+				scheduler_submit_fn(scheduler, [scheduler, &counts, &finished_count]() {
+					++scheduler_local_get(scheduler, counts);
+					atomic_fetch_add(finished_count, (U32)1);
+				});
+			}
+			while (atomic_load(finished_count) != 100)
+				platform_thread_sleep(1);
+			scheduler_worker_block_clear(scheduler);
+		});
+		scheduler_wait_all(scheduler);
+
+		TESTER_CHECK(scheduler_local_combine(scheduler, counts, [](U64 a, U64 b) { return a + b; }) == 101);
+		U32 created_count = 0;
+		scheduler_local_for_each(scheduler, counts, [&created_count](U64 &) { ++created_count; });
+		TESTER_CHECK(created_count == 2);
+
+		scheduler_local_deinit(scheduler, counts);
+		scheduler_deinit(scheduler);
+	}
+}
+
+struct Sort_Test_Record
+{
+	U32 key;
+	U32 order;
+};
+
+inline static U64
+_sort_test_random(U64 &state)
+{
+	state = state * 6364136223846793005ull + 1442695040888963407ull;
+	return state >> 33;
+}
+
+TESTER_TEST("[CORE]: Sort")
+{
+	// ("slice_sort")
+	{
+		for (U64 count : {0, 1, 2, 23, 24, 129, 1000, 20000})
+		{
+			Array<I32> values = array_init_with_count<I32>(count);
+			DEFER(array_deinit(values));
+
+			U64 state = count;
+			I64 sum = 0;
+			for (I32 &value : values)
+			{
+				value = (I32)(_sort_test_random(state) % 2001) - 1000;
+				sum += value;
+			}
+
+			array_sort(values);
+			TESTER_CHECK(array_is_sorted(values));
+
+			I64 sorted_sum = 0;
+			for (I32 value : values)
+				sorted_sum += value;
+			TESTER_CHECK(sorted_sum == sum);
+		}
+	}
+
+	// ("slice_sort patterns")
+	{
+		constexpr U64 COUNT = 5000;
+		Array<U32> values = array_init_with_count<U32>(COUNT);
+		DEFER(array_deinit(values));
+
+		for (U64 i = 0; i < COUNT; ++i)
+			values[i] = (U32)i;
+		array_sort(values);
+		TESTER_CHECK(array_is_sorted(values));
+
+		for (U64 i = 0; i < COUNT; ++i)
+			values[i] = (U32)(COUNT - i);
+		array_sort(values);
+		TESTER_CHECK(array_is_sorted(values));
+
+		for (U64 i = 0; i < COUNT; ++i)
+			values[i] = 7;
+		array_sort(values);
+		TESTER_CHECK(array_is_sorted(values));
+
+		for (U64 i = 0; i < COUNT; ++i)
+			values[i] = (U32)(i % 2 == 0 ? i : COUNT - i);
+		array_sort(values);
+		TESTER_CHECK(array_is_sorted(values));
+	}
+
+	// ("slice_sort comparator")
+	{
+		I32 values[] = {5, 1, 4, 2, 3};
+		slice_sort(slice_from(values), [](I32 a, I32 b) { return a > b; });
+		TESTER_CHECK(values[0] == 5);
+		TESTER_CHECK(values[4] == 1);
+		TESTER_CHECK(slice_is_sorted(slice_from(values), [](I32 a, I32 b) { return a > b; }));
+	}
+
+	// ("slice_radix_sort integers")
+	{
+		Array<I64> values = array_init_with_count<I64>(10000);
+		Array<I64> expected = array_init_with_count<I64>(10000);
+		DEFER(array_deinit(values); array_deinit(expected));
+
+		U64 state = 1;
+		for (U64 i = 0; i < values.count; ++i)
+		{
+			values[i] = (I64)(_sort_test_random(state) << 20) - (I64)(_sort_test_random(state) << 20);
+			expected[i] = values[i];
+		}
+
+		array_radix_sort(values);
+		array_sort(expected);
+		bool all_match = true;
+		for (U64 i = 0; i < values.count; ++i)
+			all_match &= values[i] == expected[i];
+		TESTER_CHECK(all_match);
+
+		U8 bytes[] = {200, 3, 255, 0, 17};
+		slice_radix_sort(slice_from(bytes));
+		TESTER_CHECK(bytes[0] == 0 && bytes[1] == 3 && bytes[2] == 17 && bytes[3] == 200 && bytes[4] == 255);
+	}
+
+	// ("slice_radix_sort floats")
+	{
+		F32 values[] = {3.5f, -0.0f, -2.25f, 0.0f, 100.0f, -1000.0f, 1.0e-6f, -1.0e-6f};
+		slice_radix_sort(slice_from(values));
+		TESTER_CHECK(values[0] == -1000.0f);
+		TESTER_CHECK(values[1] == -2.25f);
+		TESTER_CHECK(values[2] == -1.0e-6f);
+		TESTER_CHECK(values[5] == 1.0e-6f);
+		TESTER_CHECK(values[7] == 100.0f);
+		TESTER_CHECK(slice_is_sorted(slice_from(values)));
+
+		F64 doubles[] = {2.0, -3.0, 0.5, -0.5};
+		slice_radix_sort(slice_from(doubles));
+		TESTER_CHECK(doubles[0] == -3.0 && doubles[1] == -0.5 && doubles[2] == 0.5 && doubles[3] == 2.0);
+	}
+
+	// ("slice_radix_sort key is stable")
+	{
+		Array<Sort_Test_Record> records = array_init_with_count<Sort_Test_Record>(1000);
+		DEFER(array_deinit(records));
+		for (U32 i = 0; i < records.count; ++i)
+			records[i] = Sort_Test_Record{.key = (i * 7919) % 10, .order = i};
+
+		array_radix_sort(records, [](const Sort_Test_Record &record) { return record.key; });
+
+		bool stable = true;
+		for (U64 i = 1; i < records.count; ++i)
+		{
+			stable &= records[i - 1].key <= records[i].key;
+			if (records[i - 1].key == records[i].key)
+				stable &= records[i - 1].order < records[i].order;
+		}
+		TESTER_CHECK(stable);
+	}
+
+	// ("lower_bound / upper_bound / binary_search")
+	{
+		auto values = array_init_from<I32>({1, 3, 3, 3, 7, 9});
+		DEFER(array_deinit(values));
+
+		TESTER_CHECK(array_lower_bound(values, 3)  == 1);
+		TESTER_CHECK(array_upper_bound(values, 3)  == 4);
+		TESTER_CHECK(array_lower_bound(values, 0)  == 0);
+		TESTER_CHECK(array_lower_bound(values, 10) == 6);
+		TESTER_CHECK(array_upper_bound(values, 9)  == 6);
+		TESTER_CHECK(array_lower_bound(values, 4)  == 4);
+
+		const I32 *found = array_binary_search(values, 7);
+		TESTER_CHECK(found != nullptr && *found == 7);
+		TESTER_CHECK(array_binary_search(values, 5) == nullptr);
+
+		Sort_Test_Record records[] = {{1, 0}, {4, 1}, {9, 2}};
+		auto key_less = [](const auto &a, const auto &b) {
+			if constexpr (std::is_same_v<std::decay_t<decltype(a)>, Sort_Test_Record>)
+				return a.key < (U32)b;
+			else
+				return (U32)a < b.key;
+		};
+		TESTER_CHECK(slice_lower_bound(slice_from(records), 4u, key_less) == 1);
+		TESTER_CHECK(slice_upper_bound(slice_from(records), 4u, key_less) == 2);
+		Sort_Test_Record *record = slice_binary_search(slice_from(records), 9u, key_less);
+		TESTER_CHECK(record != nullptr && record->order == 2);
+	}
+}
+
+TESTER_TEST("[CORE]: Sort Parallel")
+{
+	Scheduler *scheduler = scheduler_init(Scheduler_Desc {
+		.worker_count = 4,
+		.initial_task_queue_capacity = 64
+	});
+	DEFER(scheduler_deinit(scheduler));
+
+	for (U64 count : {1000, 100000, 150000, 300007})
+	{
+		Array<U64> values = array_init_with_count<U64>(count);
+		Array<U64> expected = array_init_with_count<U64>(count);
+		DEFER(array_deinit(values); array_deinit(expected));
+
+		U64 state = count;
+		for (U64 i = 0; i < count; ++i)
+		{
+			values[i] = _sort_test_random(state) % (count / 2);
+			expected[i] = values[i];
+		}
+
+		array_sort_parallel(scheduler, values);
+		array_radix_sort(expected);
+
+		bool all_match = true;
+		for (U64 i = 0; i < count; ++i)
+			all_match &= values[i] == expected[i];
+		TESTER_CHECK(all_match);
+	}
+
+	// ("comparator")
+	{
+		Array<I32> values = array_init_with_count<I32>(200000);
+		DEFER(array_deinit(values));
+		for (U64 i = 0; i < values.count; ++i)
+			values[i] = (I32)(i * 2654435761u % 100003);
+
+		auto greater = [](I32 a, I32 b) { return a > b; };
+		array_sort_parallel(scheduler, values, greater);
+		TESTER_CHECK(array_is_sorted(values, greater));
+	}
+}
+
+TESTER_TEST("[CORE]: Arena_Allocator")
+{
+	U64 page_size = platform_virtual_memory_get_page_size();
+
+	memory::Arena_Allocator *arena = memory::arena_allocator_init(1024);
+	DEFER(memory::arena_allocator_deinit(arena));
+
+	Memory_Block a = memory::arena_allocator_allocate(arena, 4, 1);
+	Memory_Block b = memory::arena_allocator_allocate(arena, 8, 1);
+
+	TESTER_CHECK(a.data != nullptr);
+	TESTER_CHECK(b.data != nullptr);
+
+	TESTER_CHECK(memory::arena_allocator_get_used(arena) == 12);
+	TESTER_CHECK(memory::arena_allocator_get_peak(arena) == 12);
+
+	arena_allocator_clear(arena);
+
+	TESTER_CHECK(memory::arena_allocator_get_used(arena) == 0);
+	TESTER_CHECK(memory::arena_allocator_get_peak(arena) == 12);
+
+	Memory_Block reused = memory::arena_allocator_allocate(arena, 4, 1);
+	TESTER_CHECK(reused.data == a.data);
+	arena_allocator_clear(arena);
+
+	Memory_Block large = memory::arena_allocator_allocate(arena, page_size + 32, 1);
 	U8 *large_bytes = (U8 *)large.data;
 	large_bytes[0] = 1;
 	large_bytes[page_size + 31] = 2;
@@ -1805,6 +3730,270 @@ TESTER_TEST("[CORE]: Result")
 	}
 }
 
+struct Ecs_Test_Position
+{
+	F32 x, y, z;
+};
+
+struct Ecs_Test_Velocity
+{
+	F32 x, y, z;
+};
+
+struct Ecs_Test_Health
+{
+	U64 current;
+	U64 max;
+};
+
+TESTER_TEST("[CORE]: ECS")
+{
+	constexpr U32 ENTITY_COUNT = 5'000;
+
+	ecs::ECS world = ecs::ecs_new();
+	DEFER(ecs::ecs_free(world));
+	ecs::ecs_add_table<Ecs_Test_Position>(world);
+	ecs::ecs_add_table<Ecs_Test_Velocity>(world);
+	ecs::ecs_add_table<Ecs_Test_Health>(world);
+
+	// Type ids are shared by every world, component indices are local to the world that registered them.
+	TESTER_CHECK(ecs::component_type_id<Ecs_Test_Position>() != ecs::component_type_id<Ecs_Test_Velocity>());
+	TESTER_CHECK(ecs::component_type_id<Ecs_Test_Position>() == ecs::ecs_component_type_id((U64)typeid(Ecs_Test_Position).hash_code()));
+	TESTER_CHECK(world.component_index<const Ecs_Test_Position>() == world.component_index<Ecs_Test_Position>());
+	{
+		ecs::ECS other_world = ecs::ecs_new();
+		DEFER(ecs::ecs_free(other_world));
+		ecs::ecs_add_table<Ecs_Test_Health>(other_world);
+		ecs::ecs_add_table<Ecs_Test_Position>(other_world);
+		TESTER_CHECK(other_world.component_index<Ecs_Test_Health>() == 0);
+		TESTER_CHECK(other_world.component_index<Ecs_Test_Position>() == 1);
+		TESTER_CHECK(world.component_index<Ecs_Test_Health>() == 2);
+	}
+
+	Array<ecs::Entity> entities = array_init<ecs::Entity>();
+	DEFER(array_deinit(entities));
+	for (U32 i = 0; i < ENTITY_COUNT; ++i)
+	{
+		ecs::Entity e = ecs::ecs_entity_new(world);
+		array_push(entities, e);
+
+		Ecs_Test_Position *position = ecs::ecs_component_write<Ecs_Test_Position>(world, e);
+		TESTER_CHECK(position->x == 0 && position->y == 0 && position->z == 0);
+		*position = Ecs_Test_Position{(F32)i, 0, 0};
+		if (i % 2 == 0)
+			*ecs::ecs_component_write<Ecs_Test_Velocity>(world, e) = Ecs_Test_Velocity{1, 2, 3};
+		if (i % 3 == 0)
+			*ecs::ecs_component_write<Ecs_Test_Health>(world, e) = Ecs_Test_Health{i, 100};
+	}
+
+	// Entities are spread over four archetypes, each larger than one chunk.
+	TESTER_CHECK(world.archetypes.count == 4);
+	for (const ecs::Archetype &archetype : world.archetypes)
+		TESTER_CHECK(archetype.chunks.count > 1);
+
+	// Adding components moved the rows, the values written before the move are kept.
+	bool is_moved_correctly = true;
+	for (U32 i = 0; i < ENTITY_COUNT; ++i)
+	{
+		const Ecs_Test_Position *position = ecs::ecs_component_read<Ecs_Test_Position>(world, entities[i]);
+		const Ecs_Test_Velocity *velocity = ecs::ecs_component_read<Ecs_Test_Velocity>(world, entities[i]);
+		const Ecs_Test_Health *health = ecs::ecs_component_read<Ecs_Test_Health>(world, entities[i]);
+		is_moved_correctly &= position != nullptr && position->x == (F32)i;
+		is_moved_correctly &= (velocity != nullptr) == (i % 2 == 0);
+		is_moved_correctly &= (health != nullptr) == (i % 3 == 0);
+		if (health)
+			is_moved_correctly &= health->current == i && health->max == 100;
+	}
+	TESTER_CHECK(is_moved_correctly);
+
+	TESTER_CHECK(ecs::ecs_entity_list<Ecs_Test_Position>(world).count == ENTITY_COUNT);
+	TESTER_CHECK(ecs::ecs_entity_list<Ecs_Test_Position, Ecs_Test_Velocity>(world).count == (ENTITY_COUNT + 1) / 2);
+	TESTER_CHECK(ecs::ecs_entity_list<Ecs_Test_Velocity, Ecs_Test_Health>(world).count == (ENTITY_COUNT + 5) / 6);
+
+	U32 visited_count = 0;
+	ecs::ecs_for_each<Ecs_Test_Position, Ecs_Test_Velocity>(world, [&](ecs::Entity e, Ecs_Test_Position &position, const Ecs_Test_Velocity &velocity) {
+		position.x += velocity.x;
+		position.y += velocity.y;
+		visited_count += ecs::ecs_component_read<Ecs_Test_Velocity>(world, e) == &velocity;
+	});
+	TESTER_CHECK(visited_count == (ENTITY_COUNT + 1) / 2);
+	TESTER_CHECK(ecs::ecs_component_read<Ecs_Test_Position>(world, entities[4])->x == 5);
+	TESTER_CHECK(ecs::ecs_component_read<Ecs_Test_Position>(world, entities[4])->y == 2);
+	TESTER_CHECK(ecs::ecs_component_read<Ecs_Test_Position>(world, entities[5])->y == 0);
+
+	// Removing moves rows back, and the row moved into each hole keeps its values.
+	for (U32 i = 0; i < ENTITY_COUNT; i += 4)
+		ecs::ecs_component_remove<Ecs_Test_Velocity>(world, entities[i]);
+	ecs::ecs_component_remove<Ecs_Test_Velocity>(world, entities[1]);
+
+	is_moved_correctly = true;
+	for (U32 i = 0; i < ENTITY_COUNT; ++i)
+	{
+		const Ecs_Test_Position *position = ecs::ecs_component_read<Ecs_Test_Position>(world, entities[i]);
+		const Ecs_Test_Velocity *velocity = ecs::ecs_component_read<Ecs_Test_Velocity>(world, entities[i]);
+		is_moved_correctly &= position != nullptr && position->x == (F32)i + (i % 2 == 0 ? 1 : 0);
+		is_moved_correctly &= (velocity != nullptr) == (i % 4 == 2);
+		if (velocity)
+			is_moved_correctly &= velocity->z == 3;
+	}
+	TESTER_CHECK(is_moved_correctly);
+	TESTER_CHECK(ecs::ecs_entity_list<Ecs_Test_Velocity>(world).count == ENTITY_COUNT / 4);
+
+	// An entity that loses its last component stays alive without being stored in an archetype.
+	ecs::ecs_component_remove<Ecs_Test_Position>(world, entities[1]);
+	TESTER_CHECK(ecs::ecs_component_read<Ecs_Test_Position>(world, entities[1]) == nullptr);
+	TESTER_CHECK(ecs::ecs_entity_is_alive(world, entities[1]));
+	TESTER_CHECK(world.entity_slots[ecs::entity_index(entities[1])].archetype_index == ecs::ECS_INVALID_INDEX);
+
+	for (U32 i = 0; i < ENTITY_COUNT; ++i)
+		ecs::ecs_entity_free(world, entities[i]);
+	TESTER_CHECK(world.entity_count == 0);
+	TESTER_CHECK(ecs::ecs_entity_list<Ecs_Test_Position>(world).count == 0);
+	for (const ecs::Archetype &archetype : world.archetypes)
+		TESTER_CHECK(archetype.count == 0 && archetype.chunks.count == 0);
+}
+
+TESTER_TEST("[CORE]: ECS Query")
+{
+	ecs::ECS world = ecs::ecs_new();
+	DEFER(ecs::ecs_free(world));
+	ecs::ecs_add_table<Ecs_Test_Position>(world);
+	ecs::ecs_add_table<Ecs_Test_Velocity>(world);
+	ecs::ecs_add_table<Ecs_Test_Health>(world);
+
+	// Created before any archetype exists, the query picks up archetypes as they are added.
+	ecs::Query<Ecs_Test_Position, const Ecs_Test_Velocity> query = ecs::ecs_query_init<Ecs_Test_Position, const Ecs_Test_Velocity>(world);
+	DEFER(ecs::ecs_query_deinit(query));
+	TESTER_CHECK(ecs::ecs_query_count(query) == 0);
+
+	Array<ecs::Entity> entities = array_init<ecs::Entity>();
+	DEFER(array_deinit(entities));
+	for (U32 i = 0; i < 3'000; ++i)
+	{
+		ecs::Entity e = ecs::ecs_entity_new(world);
+		array_push(entities, e);
+		*ecs::ecs_component_write<Ecs_Test_Position>(world, e) = Ecs_Test_Position{(F32)i, 0, 0};
+		if (i % 2 == 0)
+			*ecs::ecs_component_write<Ecs_Test_Velocity>(world, e) = Ecs_Test_Velocity{1, 0, 0};
+	}
+
+	TESTER_CHECK(ecs::ecs_query_count(query) == 1'500);
+	TESTER_CHECK(query.archetype_indices.count == 1);
+
+	U32 visited_count = 0;
+	ecs::ecs_query_for_each(query, [&](ecs::Entity e, Ecs_Test_Position &position, const Ecs_Test_Velocity &velocity) {
+		position.x += velocity.x;
+		visited_count += ecs::ecs_component_read<Ecs_Test_Position>(world, e) == &position;
+	});
+	TESTER_CHECK(visited_count == 1'500);
+	TESTER_CHECK(ecs::ecs_component_read<Ecs_Test_Position>(world, entities[10])->x == 11);
+	TESTER_CHECK(ecs::ecs_component_read<Ecs_Test_Position>(world, entities[11])->x == 11);
+
+	// A new component combination adds an archetype, and only that one is checked on the next update.
+	for (U32 i = 0; i < 3'000; i += 4)
+		*ecs::ecs_component_write<Ecs_Test_Health>(world, entities[i]) = Ecs_Test_Health{i, 100};
+	TESTER_CHECK(ecs::ecs_query_count(query) == 1'500);
+	TESTER_CHECK(query.archetype_indices.count == 2);
+	TESTER_CHECK(query.checked_archetype_count == world.archetypes.count);
+
+	U32 chunk_count = 0;
+	U64 row_count = 0;
+	bool is_dense = true;
+	ecs::ecs_query_for_each_chunk(query, [&](ecs::Entity *chunk_entities, U32 count, Ecs_Test_Position *positions, const Ecs_Test_Velocity *velocities) {
+		++chunk_count;
+		row_count += count;
+		for (U32 row = 0; row < count; ++row)
+		{
+			is_dense &= ecs::ecs_component_read<Ecs_Test_Position>(world, chunk_entities[row]) == &positions[row];
+			is_dense &= ecs::ecs_component_read<Ecs_Test_Velocity>(world, chunk_entities[row]) == &velocities[row];
+		}
+	});
+	TESTER_CHECK(is_dense);
+	TESTER_CHECK(row_count == 1'500);
+	TESTER_CHECK(chunk_count >= 2);
+
+	// Queries over other combinations see the same storage.
+	ecs::Query<Ecs_Test_Health> health_query = ecs::ecs_query_init<Ecs_Test_Health>(world);
+	DEFER(ecs::ecs_query_deinit(health_query));
+	U64 health_sum = 0;
+	ecs::ecs_query_for_each(health_query, [&](ecs::Entity, const Ecs_Test_Health &health) {
+		health_sum += health.current;
+	});
+	TESTER_CHECK(ecs::ecs_query_count(health_query) == 750);
+	TESTER_CHECK(health_sum == 750ull * 2'996 / 2);
+
+	for (ecs::Entity e : entities)
+		ecs::ecs_entity_free(world, e);
+	TESTER_CHECK(ecs::ecs_query_count(query) == 0);
+	TESTER_CHECK(ecs::ecs_query_count(health_query) == 0);
+}
+
+TESTER_TEST("[CORE]: ECS Entities")
+{
+	ecs::ECS world = ecs::ecs_new();
+	DEFER(ecs::ecs_free(world));
+	ecs::ecs_add_table<Ecs_Test_Position>(world);
+
+	ecs::Entity a = ecs::ecs_entity_new(world);
+	ecs::Entity b = ecs::ecs_entity_new(world);
+	TESTER_CHECK(a && b && a != b);
+	TESTER_CHECK(ecs::entity_index(a) == 0 && ecs::entity_index(b) == 1);
+	TESTER_CHECK(ecs::entity_generation(a) == 0);
+	TESTER_CHECK(ecs::ecs_entity_is_alive(world, a));
+	TESTER_CHECK(!ecs::ecs_entity_is_alive(world, ecs::Entity{}));
+	TESTER_CHECK(world.entity_count == 2);
+
+	ecs::ecs_component_write<Ecs_Test_Position>(world, a)->x = 1;
+	ecs::ecs_component_write<Ecs_Test_Position>(world, b)->x = 2;
+
+	// A freed slot is reused with the next generation, and the stale entity no longer reaches it.
+	ecs::ecs_entity_free(world, a);
+	TESTER_CHECK(!ecs::ecs_entity_is_alive(world, a));
+	TESTER_CHECK(ecs::ecs_component_read<Ecs_Test_Position>(world, a) == nullptr);
+	TESTER_CHECK(ecs::ecs_component_read<Ecs_Test_Position>(world, b)->x == 2);
+
+	ecs::Entity c = ecs::ecs_entity_new(world);
+	TESTER_CHECK(ecs::entity_index(c) == ecs::entity_index(a));
+	TESTER_CHECK(ecs::entity_generation(c) == ecs::entity_generation(a) + 1);
+	TESTER_CHECK(ecs::ecs_entity_is_alive(world, c));
+	TESTER_CHECK(!ecs::ecs_entity_is_alive(world, a));
+	TESTER_CHECK(ecs::ecs_component_read<Ecs_Test_Position>(world, c) == nullptr);
+
+	// Operations on a stale entity are ignored.
+	ecs::ecs_component_remove<Ecs_Test_Position>(world, a);
+	ecs::ecs_entity_free(world, a);
+	TESTER_CHECK(ecs::ecs_entity_is_alive(world, c));
+	TESTER_CHECK(world.entity_count == 2);
+
+	// Bulk creation reuses free slots before growing the registry.
+	Array<ecs::Entity> entities = array_init_with_count<ecs::Entity>(1'000);
+	DEFER(array_deinit(entities));
+	ecs::ecs_entity_new(world, slice_from(entities));
+	for (U32 i = 0; i < entities.count; ++i)
+		ecs::ecs_component_write<Ecs_Test_Position>(world, entities[i])->x = (F32)i;
+	TESTER_CHECK(world.entity_count == 1'002);
+	TESTER_CHECK(world.entity_slots.count == 1'002);
+
+	ecs::ecs_entity_free(world, slice_from(entities));
+	TESTER_CHECK(world.entity_count == 2);
+	TESTER_CHECK(ecs::ecs_entity_list<Ecs_Test_Position>(world).count == 1);
+
+	Array<ecs::Entity> recycled = array_init_with_count<ecs::Entity>(1'000);
+	DEFER(array_deinit(recycled));
+	ecs::ecs_entity_new(world, slice_from(recycled));
+	TESTER_CHECK(world.entity_slots.count == 1'002);
+
+	bool is_recycled = true;
+	for (U32 i = 0; i < recycled.count; ++i)
+	{
+		is_recycled &= ecs::entity_generation(recycled[i]) == 1;
+		is_recycled &= !ecs::ecs_entity_is_alive(world, entities[i]);
+		is_recycled &= ecs::ecs_entity_is_alive(world, recycled[i]);
+	}
+	TESTER_CHECK(is_recycled);
+	TESTER_CHECK(ecs::ecs_component_read<Ecs_Test_Position>(world, b)->x == 2);
+}
+
 TESTER_TEST("[CORE]: JSON")
 {
 	// TODO: Add json_value_object_find().
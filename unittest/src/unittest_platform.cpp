@@ -1,5 +1,6 @@
 #include <core/tester.h>
 #include <core/defer.h>
+#include <core/atomic.h>
 #include <core/platform/platform.h>
 
 inline static bool
@@ -90,6 +91,50 @@ TESTER_TEST("[PLATFORM] thread")
 	TESTER_CHECK(platform_get_logical_processor_count() > 0);
 }
 
+struct Platform_Thread_Affinity_Test_Context
+{
+	U32 processor_index;
+	bool is_pinned;
+};
+
+inline static void
+_platform_thread_affinity_test_entry(void *data)
+{
+	Platform_Thread_Affinity_Test_Context *context = (Platform_Thread_Affinity_Test_Context *)data;
+	context->is_pinned = platform_thread_set_current_affinity(context->processor_index);
+}
+
+TESTER_TEST("[PLATFORM] processor topology")
+{
+	Array<Platform_Processor> processors = platform_get_processor_topology();
+	DEFER(array_deinit(processors));
+
+	TESTER_CHECK(processors.count > 0);
+	for (U64 i = 0; i < processors.count; ++i)
+	{
+		const Platform_Processor &processor = processors[i];
+		if (i > 0)
+			TESTER_CHECK(processor.index > processors[i - 1].index);
+		TESTER_CHECK(processor.core_id <= processor.index);
+		TESTER_CHECK(processor.l2_cache_id == U32_MAX || processor.l2_cache_id <= processor.index);
+		TESTER_CHECK(processor.l3_cache_id == U32_MAX || processor.l3_cache_id <= processor.index);
+	}
+
+	Platform_Thread_Affinity_Test_Context context = {
+		.processor_index = processors[0].index
+	};
+	Platform_Thread *thread = platform_thread_init(Platform_Thread_Desc {
+		.function = _platform_thread_affinity_test_entry,
+		.data = &context,
+		.name = "CoreTest"
+	});
+	platform_thread_join(thread);
+	platform_thread_deinit(thread);
+	#if PLATFORM_WINDOWS || PLATFORM_LINUX
+		TESTER_CHECK(context.is_pinned);
+	#endif
+}
+
 struct Platform_Mutex_Test_Context
 {
 	Platform_Mutex *mutex;
@@ -262,6 +307,65 @@ TESTER_TEST("[PLATFORM] condition variable broadcast")
 	platform_mutex_deinit(mutex);
 }
 
+struct Platform_Address_Wait_Test_Context
+{
+	Atomic<U32> value;
+	Atomic<U32> wake_count;
+};
+
+inline static void
+_platform_address_wait_test_entry(void *data)
+{
+	Platform_Address_Wait_Test_Context *context = (Platform_Address_Wait_Test_Context *)data;
+	while (atomic_load(context->value) == 0)
+		platform_address_wait(&context->value.value, 0);
+	atomic_fetch_add(context->wake_count, (U32)1);
+}
+
+TESTER_TEST("[PLATFORM] address wait")
+{
+	constexpr U32 THREAD_COUNT = 4;
+
+	Platform_Address_Wait_Test_Context context = {};
+
+	// A value that already changed returns right away.
+	platform_address_wait(&context.value.value, 1);
+
+	Platform_Thread *threads[THREAD_COUNT] = {};
+	for (U32 i = 0; i < THREAD_COUNT; ++i)
+	{
+		threads[i] = platform_thread_init(Platform_Thread_Desc {
+			.function = _platform_address_wait_test_entry,
+			.data = &context
+		});
+	}
+
+	platform_thread_sleep(10);
+	TESTER_CHECK(atomic_load(context.wake_count) == 0);
+	atomic_store(context.value, (U32)1);
+	platform_address_wake_all(&context.value.value);
+
+	for (U32 i = 0; i < THREAD_COUNT; ++i)
+		platform_thread_deinit(threads[i]);
+
+	TESTER_CHECK(atomic_load(context.wake_count) == THREAD_COUNT);
+}
+
+TESTER_TEST("[PLATFORM] semaphore timed wait")
+{
+	Platform_Semaphore *semaphore = platform_semaphore_init();
+	DEFER(platform_semaphore_deinit(semaphore));
+
+	U64 begin_microseconds = platform_query_microseconds();
+	TESTER_CHECK(platform_semaphore_wait_for(semaphore, 5) == false);
+	TESTER_CHECK(platform_query_microseconds() - begin_microseconds >= 4000);
+
+	platform_semaphore_signal(semaphore, 2);
+	TESTER_CHECK(platform_semaphore_wait_for(semaphore, 0));
+	TESTER_CHECK(platform_semaphore_wait_for(semaphore, 1000));
+	TESTER_CHECK(platform_semaphore_wait_for(semaphore, 0) == false);
+}
+
 TESTER_TEST("[PLATFORM] path utilities")
 {
 	String executable_path = platform_path_get_executable_path(memory::temp_allocator());